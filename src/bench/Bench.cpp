@@ -0,0 +1,701 @@
+// Microbenchmarks for the engine hot paths. Runs headless against the real Luau VM
+// and Luau3D module, and prints JSON results with stable names:
+//   luau3d_bench [--filter <substring>] [--out <file.json>] [--min-time <seconds>]
+#include "engine/Luau3D.h"
+#include "engine/LuauBinding.h"
+#include "engine/MeshBuilder.h"
+#include "engine/MeshOptimizer.h"
+#include "engine/ThreadPool.h"
+#include "engine/Null/NullGUI.h"
+#include "engine/Null/NullRenderer.h"
+#include "lua.h"
+#include "lualib.h"
+#include "luacode.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Harness
+
+// Discards everything written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double bytesPerOp;  // 0 when throughput is not meaningful
+};
+
+struct BenchOptions {
+    std::string filter;
+    std::string outPath;
+    double minTime = 0.2;  // Seconds per sample
+};
+
+const int SampleCount = 5;
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options) : options(options) {}
+
+    // Time op; reports the median of several samples, each long enough to be stable
+    void run(const std::string& name, const std::function<void()>& op, double bytesPerOp = 0.0) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            return;
+        }
+
+        // Calibrate the batch size to roughly minTime
+        uint64_t batch = 1;
+        for (;;) {
+            double seconds = timeBatch(op, batch);
+            if (seconds >= options.minTime || batch >= (uint64_t(1) << 30)) break;
+            double scale = seconds > 0.0 ? options.minTime / seconds * 1.2 : 10.0;
+            batch = std::max<uint64_t>(batch + 1, static_cast<uint64_t>(batch * std::min(scale, 10.0)));
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < SampleCount; i++) {
+            samples.push_back(timeBatch(op, batch) * 1e9 / batch);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result = {name, batch * SampleCount, samples[SampleCount / 2], bytesPerOp};
+        std::cerr << name << ": " << result.nsPerOp << " ns/op";
+        if (bytesPerOp > 0.0) {
+            std::cerr << ", " << bytesPerOp / result.nsPerOp * 1e9 / (1024.0 * 1024.0) << " MB/s";
+        }
+        std::cerr << std::endl;
+        results.push_back(result);
+    }
+
+    std::string toJson() const {
+        std::ostringstream json;
+        json << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            json << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                 << ", \"ns_per_op\": " << r.nsPerOp << ", \"ops_per_sec\": " << 1e9 / r.nsPerOp;
+            if (r.bytesPerOp > 0.0) {
+                json << ", \"bytes_per_op\": " << r.bytesPerOp
+                     << ", \"mb_per_sec\": " << r.bytesPerOp / r.nsPerOp * 1e9 / (1024.0 * 1024.0);
+            }
+            json << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n}\n";
+        return json.str();
+    }
+
+private:
+    static double timeBatch(const std::function<void()>& op, uint64_t batch) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; i++) {
+            op();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    BenchOptions options;
+    std::vector<BenchResult> results;
+};
+
+// Compile and run a chunk, aborting the run on errors (a broken benchmark must not report numbers)
+void runChunk(lua_State* L, const std::string& source, const char* chunkName) {
+    size_t bytecodeSize = 0;
+    char* bytecode = luau_compile(source.c_str(), source.size(), nullptr, &bytecodeSize);
+    int status = luau_load(L, chunkName, bytecode, bytecodeSize, 0);
+    free(bytecode);
+    if (status != 0 || lua_pcall(L, 0, 0, 0) != 0) {
+        std::cerr << "Benchmark setup failed in " << chunkName << ": " << lua_tostring(L, -1) << std::endl;
+        std::exit(1);
+    }
+}
+
+// Call a global Lua function with no arguments
+void callGlobal(lua_State* L, const char* name) {
+    lua_getglobal(L, name);
+    if (lua_pcall(L, 0, 0, 0) != 0) {
+        std::cerr << "Benchmark " << name << " failed: " << lua_tostring(L, -1) << std::endl;
+        std::exit(1);
+    }
+}
+
+const char* SetupSource = R"(
+luau3d = require("luau3d.luau")
+gui = require("gui.luau")
+
+-- Interleaved {x, y, z, r, g, b} triangles
+function makeVertices(count)
+    local vertices = table.create(count * 6)
+    for i = 1, count do
+        local base = (i - 1) * 6
+        vertices[base + 1] = i % 17
+        vertices[base + 2] = i % 13
+        vertices[base + 3] = i % 11
+        vertices[base + 4] = 1
+        vertices[base + 5] = 0.5
+        vertices[base + 6] = 0.25
+    end
+    return vertices
+end
+)";
+
+// A script of roughly lineCount lines exercising common syntax
+std::string makeScript(int functionCount) {
+    std::ostringstream source;
+    source << "local luau3d = require(\"luau3d.luau\")\n";
+    for (int i = 0; i < functionCount; i++) {
+        source << "local function update" << i << "(dt: number, t: {number})\n"
+               << "    local sum = 0\n"
+               << "    for k = 1, #t do\n"
+               << "        sum += t[k] * dt + math.sin(k * " << i << ")\n"
+               << "    end\n"
+               << "    if sum > " << i << " then return { value = sum, name = \"f" << i << "\" } end\n"
+               << "    return nil\n"
+               << "end\n";
+    }
+    return source.str();
+}
+
+// Shuffle a mesh's triangles and renumber its vertices at random, as geometry from an
+// exporter that ignores vertex order can arrive
+void shuffleMesh(Mesh& mesh, uint32_t seed) {
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    const size_t triangleCount = mesh.indices.size() / 3;
+    for (size_t t = triangleCount; t > 1; t--) {
+        size_t other = next() % t;
+        for (int corner = 0; corner < 3; corner++) {
+            std::swap(mesh.indices[(t - 1) * 3 + corner], mesh.indices[other * 3 + corner]);
+        }
+    }
+    std::vector<uint32_t> order(mesh.vertexCount);
+    for (size_t v = 0; v < order.size(); v++) order[v] = static_cast<uint32_t>(v);
+    for (size_t v = order.size(); v > 1; v--) std::swap(order[v - 1], order[next() % v]);
+    const size_t stride = mesh.layout.getStride();
+    std::vector<uint8_t> vertices(mesh.vertices.size());
+    for (size_t v = 0; v < order.size(); v++) {
+        memcpy(&vertices[order[v] * stride], &mesh.vertices[v * stride], stride);
+    }
+    mesh.vertices.swap(vertices);
+    for (uint32_t& index : mesh.indices) index = order[index];
+}
+
+// Software vertex stage with a FIFO post-transform cache the size MeshOptimizer
+// assumes: vertices are fetched and transformed only on a cache miss, as on a GPU
+float shadeVertices(const Mesh& mesh) {
+    const int CacheSize = MeshOptimizer::CacheSize;
+    uint32_t tags[CacheSize];
+    float cached[CacheSize][4];
+    for (int i = 0; i < CacheSize; i++) tags[i] = UINT32_MAX;
+    int head = 0;
+    float sum = 0.0f;
+    for (uint32_t index : mesh.indices) {
+        int slot = -1;
+        for (int i = 0; i < CacheSize; i++) {
+            if (tags[i] == index) slot = i;
+        }
+        if (slot < 0) {
+            float p[4];
+            unpackAttribute(mesh.layout, mesh.getVertexData(), index, VertexAttribute::Position, p);
+            slot = head;
+            head = (head + 1) % CacheSize;
+            tags[slot] = index;
+            cached[slot][0] = 0.9f * p[0] - 0.1f * p[2] + 0.5f;
+            cached[slot][1] = 0.8f * p[1] + 0.2f * p[2] - 0.25f;
+            cached[slot][2] = 0.1f * p[0] + 0.9f * p[2] - 5.0f;
+            cached[slot][3] = -cached[slot][2];
+        }
+        sum += cached[slot][0] / cached[slot][3] + cached[slot][1] / cached[slot][3];
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minTime = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: luau3d_bench [--filter <substring>] [--out <file.json>] [--min-time <seconds>]" << std::endl;
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    // The engine logs to stdout (e.g. every require); keep stdout for the JSON report
+    static NullBuffer engineLog;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(&engineLog);
+
+    LuauBinding binding;
+    if (!binding.initialize()) {
+        std::cerr << "Failed to initialize Luau binding" << std::endl;
+        return 1;
+    }
+    NullGUI gui(&binding);
+    NullRenderer renderer(&gui);
+    gui.initialize("luau3d_bench", 800, 600);
+    renderer.initialize();
+    ThreadPool threadPool(1);
+    Luau3D luau3d(&gui, &renderer, &threadPool);
+    binding.registerInternalModule(&luau3d);
+    binding.registerInternalModule(&gui);
+
+    lua_State* L = binding.getLuaState();
+    runChunk(L, SetupSource, "=setup");
+
+    BenchRunner runner(options);
+
+    // Lua -> C vertex marshaling
+    for (int vertexCount : {36, 1024, 16384, 131072}) {
+        std::string suffix = std::to_string(vertexCount);
+        double bytes = vertexCount * 6.0 * sizeof(double);
+        runChunk(L, "V = makeVertices(" + suffix + ")\n"
+                    "function benchAdd() luau3d.clearModels(); luau3d.addModel({ vertices = V }) end\n"
+                    "function benchUpdate() luau3d.updateModel(0, { vertices = V }) end\n",
+                 "=marshal");
+        runner.run("marshal/addModel/" + suffix, [L]() { callGlobal(L, "benchAdd"); }, bytes);
+        runChunk(L, "luau3d.clearModels(); luau3d.addModel({ vertices = V })", "=marshal");
+        runner.run("marshal/updateModel/" + suffix, [L]() { callGlobal(L, "benchUpdate"); }, bytes);
+    }
+
+    // Partial vertex updates into the 131072-vertex model, from a table and from a buffer,
+    // including the frame that hands the range to the renderer
+    runChunk(L, "luau3d.clearModels(); luau3d.addModel({ vertices = V })\n"
+                "P = makeVertices(256)\n"
+                "B = buffer.create(#P * 4)\n"
+                "for i, v in P do buffer.writef32(B, (i - 1) * 4, v) end\n"
+                "function benchPartialTable() luau3d.updateModelVertices(0, 65536, P) end\n"
+                "function benchPartialBuffer() luau3d.updateModelVertices(0, 65536, B) end\n",
+             "=marshal");
+    double partialBytes = 256 * 6.0 * sizeof(float);
+    runner.run("marshal/updateModelVertices/256_of_131072_table", [&luau3d, L]() {
+        callGlobal(L, "benchPartialTable");
+        luau3d.presentFrame(L);
+    }, partialBytes);
+    runner.run("marshal/updateModelVertices/256_of_131072_buffer", [&luau3d, L]() {
+        callGlobal(L, "benchPartialBuffer");
+        luau3d.presentFrame(L);
+    }, partialBytes);
+    runChunk(L, "luau3d.clearModels(); V = nil; P = nil; B = nil", "=marshal");
+
+    // luau_compile + luau_load through LuauBinding::loadScript
+    std::filesystem::path scriptDir = std::filesystem::temp_directory_path() / "luau3d_bench";
+    std::filesystem::create_directories(scriptDir);
+    for (int functionCount : {10, 1000}) {
+        std::string source = makeScript(functionCount);
+        std::filesystem::path path = scriptDir / ("script" + std::to_string(functionCount) + ".luau");
+        std::ofstream(path) << source;
+        std::string pathString = path.string();
+        runner.run("compile/loadScript/" + std::to_string(functionCount) + "_functions", [&]() {
+            if (!binding.loadScript(pathString)) std::exit(1);
+            lua_pop(L, 1);
+        }, static_cast<double>(source.size()));
+    }
+
+    // require() of an already loaded module
+    runChunk(L, "function benchRequire() local m = require(\"luau3d.luau\") end", "=require");
+    runner.run("require/cacheHit", [L]() { callGlobal(L, "benchRequire"); });
+
+    // Keyboard callback dispatch; callbacks accumulate, so register up to each count
+    int registeredCallbacks = 0;
+    for (int callbackCount : {1, 8}) {
+        runChunk(L, "keys = 0\nfor i = 1, " + std::to_string(callbackCount - registeredCallbacks) +
+                    " do gui.registerKeyboardCallback(function(key, action) keys += 1 end) end", "=input");
+        registeredCallbacks = callbackCount;
+        runner.run("input/keyboardDispatch/" + std::to_string(callbackCount) + "_callbacks",
+                   [&gui]() { gui.handleKeyEvent("A", "press"); });
+    }
+
+    // Model add/remove churn with a shared mesh, 1000 models resident
+    runChunk(L, "cube = luau3d.createBoxMesh()\n"
+                "for i = 1, 1000 do luau3d.addModel({ mesh = cube }) end\n"
+                "function benchChurnBack() luau3d.removeModel(luau3d.addModel({ mesh = cube })) end\n"
+                "function benchChurnFront() luau3d.removeModel(0); luau3d.addModel({ mesh = cube }) end\n",
+             "=churn");
+    runner.run("models/churn/addRemoveBack_1000", [L]() { callGlobal(L, "benchChurnBack"); });
+    runner.run("models/churn/removeFrontAddBack_1000", [L]() { callGlobal(L, "benchChurnFront"); });
+
+    // Per-call bindings against one luau3d.submit of the same changes, encoded the way
+    // scripts/commands.luau does (SetModelVisible = 1, SetModelPosition = 3)
+    runChunk(L, "luau3d.clearModels()\n"
+                "for i = 1, 1000 do luau3d.addModel({ mesh = cube }) end\n"
+                "step = 0\n"
+                "batch = buffer.create(32768)\n"
+                "function benchVisibleCalls()\n"
+                "    step += 1\n"
+                "    for i = 0, 999 do luau3d.setModelVisible(i, (i + step) % 2 == 0) end\n"
+                "end\n"
+                "function benchVisibleBatched()\n"
+                "    step += 1\n"
+                "    for i = 0, 999 do\n"
+                "        local at = i * 12\n"
+                "        buffer.writeu32(batch, at, 1)\n"
+                "        buffer.writeu32(batch, at + 4, i)\n"
+                "        buffer.writeu32(batch, at + 8, if (i + step) % 2 == 0 then 1 else 0)\n"
+                "    end\n"
+                "    luau3d.submit(batch, 1000)\n"
+                "end\n"
+                "function benchPositionCalls()\n"
+                "    step += 1\n"
+                "    for i = 0, 999 do luau3d.setModelCFrame(i, { position = { i % 10, step % 7, -20 } }) end\n"
+                "end\n"
+                "function benchPositionBatched()\n"
+                "    step += 1\n"
+                "    for i = 0, 999 do\n"
+                "        local at = i * 20\n"
+                "        buffer.writeu32(batch, at, 3)\n"
+                "        buffer.writeu32(batch, at + 4, i)\n"
+                "        buffer.writef32(batch, at + 8, i % 10)\n"
+                "        buffer.writef32(batch, at + 12, step % 7)\n"
+                "        buffer.writef32(batch, at + 16, -20)\n"
+                "    end\n"
+                "    luau3d.submit(batch, 1000)\n"
+                "end\n",
+             "=batch");
+    runner.run("batch/setModelVisible/1000_calls", [L]() { callGlobal(L, "benchVisibleCalls"); });
+    runner.run("batch/setModelVisible/1000_commands", [L]() { callGlobal(L, "benchVisibleBatched"); });
+    runner.run("batch/setModelPosition/1000_calls", [L]() { callGlobal(L, "benchPositionCalls"); });
+    runner.run("batch/setModelPosition/1000_commands", [L]() { callGlobal(L, "benchPositionBatched"); });
+
+    // Model userdata: create 1000, drop them, collect, and remove them at the next frame
+    runChunk(L, "luau3d.clearModels()\n"
+                "function benchCreateModels()\n"
+                "    for i = 1, 1000 do\n"
+                "        luau3d.createModel({ mesh = cube, cframe = { position = { i % 10, i % 7, -i % 13 } } })\n"
+                "    end\n"
+                "end\n",
+             "=objects");
+    runner.run("objects/createModel/1000_collected", [&luau3d, L]() {
+        callGlobal(L, "benchCreateModels");
+        lua_gc(L, LUA_GCCOLLECT, 0);
+        luau3d.presentFrame(L);
+    });
+
+    // Geometry interning: 1000 models from the same 36-vertex array, hashed and shared
+    runChunk(L, "luau3d.clearModels()\n"
+                "local cubeVertices = {}\n"
+                "for i = 1, 36 * 6 do cubeVertices[i] = (i * 7919) % 101 / 100 end\n"
+                "function benchIdenticalArrays()\n"
+                "    luau3d.clearModels()\n"
+                "    for i = 1, 1000 do\n"
+                "        luau3d.addModel({ vertices = cubeVertices, cframe = { position = { i % 10, i % 7, -i % 13 } } })\n"
+                "    end\n"
+                "end\n",
+             "=geometry");
+    runner.run("geometry/addModel/1000_identical_arrays", [L]() { callGlobal(L, "benchIdenticalArrays"); });
+
+    // Render submission: scene update, draw list build and IRenderer::render. Damage
+    // tracking would skip these static frames, so every frame is redrawn in full.
+    runChunk(L, "luau3d.setDamageTracking(false)", "=render");
+    for (int modelCount : {100, 1000, 10000}) {
+        runChunk(L, "luau3d.clearModels()\n"
+                    "for i = 1, " + std::to_string(modelCount) + " do\n"
+                    "    luau3d.addModel({ mesh = cube, visible = i % 4 ~= 0,\n"
+                    "        cframe = { position = { i % 10, i % 7, -i % 13 } } })\n"
+                    "end\n",
+                 "=render");
+        runner.run("render/submit/" + std::to_string(modelCount) + "_models", [&luau3d, L]() { luau3d.presentFrame(L); });
+    }
+
+    // Clustered lights: cluster build, and per-item light selection during submission.
+    // Point and spot lights scattered through the view frustum, 1000 models in front of the eye.
+    runChunk(L, "luau3d.clearModels()\n"
+                "for i = 1, 1000 do\n"
+                "    local z = -(2 + i % 40)\n"
+                "    luau3d.addModel({ mesh = cube, cframe = { position = { (i % 21 - 10) * -z / 12, (i % 17 - 8) * -z / 10, z } } })\n"
+                "end\n"
+                "function setLights(count)\n"
+                "    luau3d.clearLights()\n"
+                "    for i = 1, count do\n"
+                "        local z = -(2 + (i * 7) % 45)\n"
+                "        luau3d.setLight(i, { position = { ((i * 13) % 41 - 20) * -z / 20, ((i * 11) % 37 - 18) * -z / 18, z, 1 },\n"
+                "            diffuse = { 1, 0.8, 0.6 }, quadraticAttenuation = 4,\n"
+                "            spotCutoff = if i % 3 == 0 then 40 else nil, spotDirection = { 0, -1, -0.5 } })\n"
+                "    end\n"
+                "end\n",
+             "=lights");
+    for (int lightCount : {10, 100, 1000}) {
+        std::string suffix = std::to_string(lightCount) + "_lights";
+        runChunk(L, "setLights(" + std::to_string(lightCount) + ")", "=lights");
+        luau3d.presentFrame(L);  // Builds the clusters
+
+        // The same lights as setLights, built directly
+        LightClusters clusters;
+        std::vector<LightProperties> lights(lightCount);
+        std::vector<bool> active(lights.size(), true);
+        for (size_t i = 0; i < lights.size(); i++) {
+            size_t n = i + 1;
+            float z = -(2.0f + (n * 7) % 45);
+            lights[i].position = {((n * 13) % 41 - 20.0f) * -z / 20.0f, ((n * 11) % 37 - 18.0f) * -z / 18.0f, z, 1.0f};
+            lights[i].diffuse = {1.0f, 0.8f, 0.6f};
+            lights[i].spotDirection = {0.0f, -1.0f, -0.5f};
+            lights[i].spotExponent = -1.0f;
+            lights[i].spotCutoff = n % 3 == 0 ? 40.0f : -1.0f;
+            lights[i].constantAttenuation = -1.0f;
+            lights[i].linearAttenuation = -1.0f;
+            lights[i].quadraticAttenuation = 4.0f;
+        }
+        runner.run("lights/build/" + suffix, [&]() { clusters.build(lights, active); });
+        runner.run("render/submit/1000_models_" + suffix, [&luau3d, L]() { luau3d.presentFrame(L); });
+    }
+    runChunk(L, "luau3d.clearLights()", "=lights");
+
+    // Occlusion culling: 10000 cubes in a grid, half of them behind a wall, with and
+    // without the culling pass
+    runChunk(L, "luau3d.clearModels()\n"
+                "luau3d.addModel({ mesh = luau3d.createBoxMesh({ size = { 8, 8, 0.2 } }), occluder = true, cframe = { position = { -4, 0, -5 } } })\n"
+                "for i = 0, 9999 do\n"
+                "    luau3d.addModel({ mesh = cube, cframe = { position = { (i % 100 - 50) * 0.3, (i // 100 - 50) * 0.3, -20 } } })\n"
+                "end\n",
+             "=occlusion");
+    runner.run("render/submit/10000_models_occlusion", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runChunk(L, "luau3d.setOcclusionCulling(false)", "=occlusion");
+    runner.run("render/submit/10000_models_no_occlusion", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runChunk(L, "luau3d.setOcclusionCulling(true)\nluau3d.clearModels()", "=occlusion");
+
+    // Damage tracking: a static scene skips its frames; one moving model redraws a few tiles
+    runChunk(L, "luau3d.setDamageTracking(true)\n"
+                "for i = 0, 9999 do\n"
+                "    luau3d.addModel({ mesh = cube, cframe = { position = { (i % 100 - 50) * 0.3, (i // 100 - 50) * 0.3, -20 } } })\n"
+                "end\n"
+                "step = 0\n"
+                "function benchMoveOne()\n"
+                "    step += 1\n"
+                "    luau3d.setModelCFrame(5050, { position = { step % 10 * 0.1, 0, -20 } })\n"
+                "end\n",
+             "=damage");
+    luau3d.presentFrame(L);
+    runner.run("render/damage/10000_models_static", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runner.run("render/damage/10000_models_1_moving", [&luau3d, L]() {
+        callGlobal(L, "benchMoveOne");
+        luau3d.presentFrame(L);
+    });
+    runChunk(L, "luau3d.clearModels()", "=damage");
+
+    // Skeletal animation: a 64-joint chain bending along a 65536-vertex strip, two clips
+    // blended. Sampling alone, then the frame that samples, skins and submits it.
+    runChunk(L, "local parents, bindPose = {}, {}\n"
+                "for j = 0, 63 do\n"
+                "    parents[j + 1] = j - 1\n"
+                "    bindPose[j + 1] = { translation = { 0, if j == 0 then 0 else 1, 0 } }\n"
+                "end\n"
+                "skeleton = luau3d.createSkeleton({ parents = parents, bindPose = bindPose })\n"
+                "local function makeClip(axis)\n"
+                "    local tracks = {}\n"
+                "    for j = 1, 63 do\n"
+                "        local times, rotations = {}, {}\n"
+                "        for k = 0, 29 do\n"
+                "            local half = math.sin(k / 29 * math.pi * 2 + j) * 0.05\n"
+                "            times[k + 1] = k / 29\n"
+                "            for c = 1, 3 do table.insert(rotations, if c == axis then math.sin(half) else 0) end\n"
+                "            table.insert(rotations, math.cos(half))\n"
+                "        end\n"
+                "        tracks[j] = { joint = j, times = times, rotations = rotations }\n"
+                "    end\n"
+                "    return luau3d.createAnimationClip(skeleton, { duration = 1, tracks = tracks })\n"
+                "end\n"
+                "walk, sway = makeClip(3), makeClip(1)\n"
+                "local vertices = table.create(65536 * 17)\n"
+                "for i = 0, 65535 do\n"
+                "    local y = i / 1024\n"
+                "    local joint = math.min(63, y // 1)\n"
+                "    for _, v in { i % 2 * 0.1, y, 0, 1, 1, 1, 0, 0, 1, joint, math.min(63, joint + 1), 0, 0, 0.75, 0.25, 0, 0 } do\n"
+                "        table.insert(vertices, v)\n"
+                "    end\n"
+                "end\n"
+                "luau3d.addModel({ vertices = vertices, format = \"skinned\", cframe = { position = { 0, -32, -80 } } })\n"
+                "luau3d.setModelSkeleton(0, skeleton)\n"
+                "animationTime = 0\n"
+                "function benchAnimate()\n"
+                "    animationTime += 1 / 60\n"
+                "    luau3d.setModelAnimation(0, { { clip = walk, time = animationTime, weight = 0.7 },\n"
+                "        { clip = sway, time = animationTime * 0.5, weight = 0.3 } })\n"
+                "end\n",
+             "=animation");
+    {
+        std::shared_ptr<Skeleton> skeleton = luau3d.getSkeleton(0);
+        AnimationLayer layers[2] = {{luau3d.getAnimationClip(0).get(), 0.0f, 0.7f, true},
+                                    {luau3d.getAnimationClip(1).get(), 0.0f, 0.3f, true}};
+        std::vector<JointPose> scratch, pose;
+        std::vector<JointMatrix> matrices;
+        runner.run("animation/sample/64_joints_2_layers", [&]() {
+            layers[0].time += 1.0f / 60.0f;
+            layers[1].time += 0.5f / 60.0f;
+            Animation::blend(*skeleton, layers, 2, scratch, pose);
+            Animation::computeSkinMatrices(*skeleton, pose, matrices);
+        });
+    }
+    runner.run("animation/skin/65536_vertices_64_joints", [&luau3d, L]() {
+        callGlobal(L, "benchAnimate");
+        luau3d.presentFrame(L);
+    }, 65536 * 28.0);
+    runChunk(L, "luau3d.clearModels()", "=animation");
+
+    // Tweens: 10000 models ping-ponging between two cframes, advanced natively every frame
+    runChunk(L, "for i = 0, 9999 do\n"
+                "    local model = luau3d.addModel({ mesh = cube, cframe = { position = { (i % 100 - 50) * 0.3, (i // 100 - 50) * 0.3, -20 } } })\n"
+                "    luau3d.tween(model, { position = { (i % 100 - 50) * 0.3, (i // 100 - 50) * 0.3, -25 },\n"
+                "        look = { 0, 1, 0 }, up = { 0, 0, 1 } }, 1 + i % 7, \"quadInOut\", \"pingpong\")\n"
+                "end\n",
+             "=tween");
+    runner.run("tween/update/10000_tweens", [&luau3d, L]() { luau3d.advanceTweens(L); });
+    runner.run("render/submit/10000_tweens", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runChunk(L, "luau3d.clearModels()", "=tween");
+
+    // Collisions: 50000 spheres and boxes scattered through a slab, a fifth of them tweening
+    runChunk(L, "math.randomseed(1)\n"
+                "for i = 0, 49999 do\n"
+                "    local position = { math.random() * 300 - 150, math.random() * 90 - 45, math.random() * 90 - 135 }\n"
+                "    local model = luau3d.addModel({ mesh = cube, cframe = { position = position } })\n"
+                "    luau3d.setModelCollider(model, if i % 2 == 0 then \"sphere\" else \"box\")\n"
+                "    if i % 5 == 0 then\n"
+                "        luau3d.tween(model, { position = { position[1] + 2, position[2], position[3] } }, 1 + i % 3, \"linear\", \"pingpong\")\n"
+                "    end\n"
+                "end\n",
+             "=collision");
+    luau3d.presentFrame(L);
+    runner.run("collision/update/50000_bodies", [&luau3d, L]() { luau3d.updateCollisions(L); });
+    runner.run("render/submit/50000_colliders", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runChunk(L, "luau3d.clearModels()", "=collision");
+
+    // Raycasts: 1000 icospheres of 1280 triangles in front of the eye, rays fanned across them
+    runChunk(L, "local ball = luau3d.createIcosphereMesh({ subdivisions = 3 })\n"
+                "for i = 0, 999 do\n"
+                "    luau3d.addModel({ mesh = ball, cframe = { position = { (i % 40 - 20) * 1.5, (i // 40 % 25 - 12) * 1.5, -30 - i // 200 * 4 } } })\n"
+                "end\n"
+                "luau3d.raycastTriangles({ 0, 0, 0 }, { 0, 0, -1 })\n",
+             "=raycast");
+    {
+        std::vector<float> rays(4096 * 6);
+        for (int i = 0; i < 4096; i++) {
+            float* ray = &rays[i * 6];
+            ray[0] = ray[1] = ray[2] = 0.0f;
+            ray[3] = (i % 64 - 32) / 32.0f;
+            ray[4] = (i / 64 - 32) / 48.0f;
+            ray[5] = -1.0f;
+        }
+        RaycastHit hit;
+        size_t next = 0;
+        runner.run("raycast/single/1000_models", [&]() {
+            const float* ray = &rays[(next++ % 4096) * 6];
+            luau3d.raycastTriangles(ray, ray + 3, 1000.0f, hit);
+        });
+        std::vector<RaycastHit> hits;
+        runner.run("raycast/batch/4096_rays_1000_models", [&]() {
+            luau3d.raycastTriangles(rays.data(), 4096, 1000.0f, hits);
+        });
+    }
+    runChunk(L, "luau3d.clearModels()", "=raycast");
+
+    // Particles: one emitter holding 1000000 long-lived particles spread through a box
+    runChunk(L, "local emitter = luau3d.createParticleEmitter({ rate = 0, maxParticles = 1000000, lifetime = 1000,\n"
+                "    speed = { 0, 1 }, spread = math.pi, radius = 10, drag = 0.5, size = 0.05,\n"
+                "    cframe = { position = { 0, 0, -30 } } })\n"
+                "luau3d.emitParticles(emitter, 1000000)\n",
+             "=particles");
+    luau3d.presentFrame(L);
+    runner.run("particles/update/1000000_particles", [&luau3d]() { luau3d.advanceParticles(); }, 1000000 * 64.0);
+    runner.run("render/submit/1000000_particles", [&luau3d, L]() { luau3d.presentFrame(L); });
+    runChunk(L, "luau3d.clearModels()", "=particles");
+
+    // Mesh optimization: a shuffled 5-level icosphere (20480 triangles) against the same
+    // mesh after MeshOptimizer, through a software vertex stage with a post-transform cache
+    {
+        MeshBuildOptions buildOptions;
+        buildOptions.layout = VertexLayout::compactNormal();
+        Mesh shuffled = *MeshBuilder::icosphere(1.0f, 5, buildOptions);
+        shuffleMesh(shuffled, 12345u);
+        Mesh optimized = shuffled;
+        MeshOptimizer::Report report;
+        MeshOptimizer::optimize(optimized, &report);
+        std::cerr << "meshopt: ACMR " << report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+                  << report.before.atvr << " -> " << report.after.atvr << std::endl;
+
+        runner.run("meshopt/optimize/icosphere_20480_triangles", [&shuffled]() {
+            Mesh copy = shuffled;
+            MeshOptimizer::optimize(copy);
+        });
+        volatile float sink = 0.0f;
+        runner.run("meshopt/vertex_stage/shuffled_20480_triangles", [&]() { sink = sink + shadeVertices(shuffled); });
+        runner.run("meshopt/vertex_stage/optimized_20480_triangles", [&]() { sink = sink + shadeVertices(optimized); });
+    }
+
+    // Terrain: a 2049x2049 16-bit heightmap in 1024 chunks seen from above its middle
+    {
+        const int samples = 2049;
+        std::vector<uint16_t> heights(static_cast<size_t>(samples) * samples);
+        for (int j = 0; j < samples; j++) {
+            for (int i = 0; i < samples; i++) {
+                heights[static_cast<size_t>(j) * samples + i] =
+                    static_cast<uint16_t>(32767.0 + 32000.0 * std::sin(i * 0.013) * std::cos(j * 0.021));
+            }
+        }
+        std::filesystem::path heightmap = scriptDir / "terrain.r16";
+        std::ofstream(heightmap, std::ios::binary).write(reinterpret_cast<const char*>(heights.data()),
+                                                        heights.size() * sizeof(uint16_t));
+        TerrainSettings settings;
+        settings.path = heightmap.string();
+        settings.cellSize = 2.0f;
+        settings.viewDistance = 1500.0f;
+        CFrame cframe;
+        cframe.position[1] = -150.0f;
+        size_t root = 0;
+        std::string error;
+        if (!luau3d.addTerrain(settings, true, cframe, root, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        // Stream everything in range before measuring the steady state
+        do {
+            luau3d.updateTerrains();
+            threadPool.wait();
+            threadPool.runCompletions();
+        } while (luau3d.getTerrain(root)->getStats().pending > 0 || luau3d.getTerrain(root)->getStats().requested > 0);
+        runner.run("terrain/update/1024_chunks", [&luau3d]() { luau3d.updateTerrains(); });
+        runner.run("render/submit/terrain_1024_chunks", [&luau3d, L]() { luau3d.presentFrame(L); });
+        // Flying over the terrain: every step moves a chunk's width and streams the new levels
+        int step = 0;
+        runner.run("terrain/stream/fly_1024_chunks", [&]() {
+            cframe.position[0] = static_cast<float>(step++ % 16) * 128.0f - 1024.0f;
+            luau3d.setModelCFrame(root, cframe);
+            luau3d.updateTerrains();
+            threadPool.wait();
+            threadPool.runCompletions();
+        });
+    }
+    runChunk(L, "luau3d.clearModels()", "=terrain");
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::string json = runner.toJson();
+    if (!options.outPath.empty()) {
+        std::ofstream(options.outPath) << json;
+    }
+    std::cout << json;
+    std::filesystem::remove_all(scriptDir);
+    return 0;
+}
@@ -0,0 +1,387 @@
+#include "Animation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float MaxQuantized = 65535.0f;
+// Smallest three components lie within +-1/sqrt(2)
+const float RotationRange = 0.70710678f;
+const float RotationSteps = 32767.0f;
+
+void normalize(float q[4]) {
+    float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (length < 1e-12f) {
+        q[0] = q[1] = q[2] = 0.0f;
+        q[3] = 1.0f;
+        return;
+    }
+    float inverse = 1.0f / length;
+    for (int i = 0; i < 4; i++) q[i] *= inverse;
+}
+
+uint16_t quantize(float value, float min, float extent) {
+    if (extent <= 0.0f) return 0;
+    float t = (value - min) / extent;
+    t = std::min(1.0f, std::max(0.0f, t));
+    return static_cast<uint16_t>(t * MaxQuantized + 0.5f);
+}
+
+float dequantize(uint16_t value, float min, float extent) {
+    return min + extent * (value / MaxQuantized);
+}
+
+void packRotation(const float rotation[4], uint16_t out[3]) {
+    float q[4] = {rotation[0], rotation[1], rotation[2], rotation[3]};
+    normalize(q);
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (std::fabs(q[i]) > std::fabs(q[largest])) largest = i;
+    }
+    // q and -q are the same rotation; keep the dropped component positive
+    float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+    int word = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) continue;
+        float t = (q[i] * sign + RotationRange) / (2.0f * RotationRange);
+        t = std::min(1.0f, std::max(0.0f, t));
+        out[word++] = static_cast<uint16_t>(t * RotationSteps + 0.5f);
+    }
+    // The dropped component's index goes in the spare top bits of the first two words
+    out[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    out[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+}
+
+void unpackRotation(const uint16_t in[3], float q[4]) {
+    int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+    float sum = 0.0f;
+    int word = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) continue;
+        float t = (in[word++] & 0x7fff) / RotationSteps;
+        q[i] = t * (2.0f * RotationRange) - RotationRange;
+        sum += q[i] * q[i];
+    }
+    q[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+}
+
+// Per-component range of a channel with 3 values per key
+void computeRange(const std::vector<float>& values, float min[3], float extent[3]) {
+    for (int c = 0; c < 3; c++) {
+        float lo = values[c], hi = values[c];
+        for (size_t i = c; i < values.size(); i += 3) {
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+        min[c] = lo;
+        extent[c] = hi - lo;
+    }
+}
+
+void lerp3(const float a[3], const float b[3], float t, float out[3]) {
+    for (int c = 0; c < 3; c++) out[c] = a[c] + (b[c] - a[c]) * t;
+}
+
+// Normalized lerp along the shorter arc
+void nlerp(const float a[4], const float b[4], float t, float out[4]) {
+    float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    float sign = dot < 0.0f ? -1.0f : 1.0f;
+    for (int c = 0; c < 4; c++) out[c] = a[c] + (b[c] * sign - a[c]) * t;
+    normalize(out);
+}
+
+} // namespace
+
+bool Skeleton::finalize(std::string& error) {
+    size_t count = parents.size();
+    if (count == 0 || count > 256) {
+        error = "skeleton must have 1 to 256 joints";
+        return false;
+    }
+    if (bindPose.size() != count) {
+        error = "skeleton bind pose must have one entry per joint";
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (parents[i] < -1 || parents[i] >= static_cast<int>(i)) {
+            error = "joint " + std::to_string(i) + " must have a parent listed before it";
+            return false;
+        }
+        normalize(bindPose[i].rotation);
+    }
+
+    std::vector<JointMatrix> model(count);
+    inverseBind.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        JointMatrix local = Animation::toMatrix(bindPose[i]);
+        model[i] = parents[i] < 0 ? local : Animation::multiply(model[parents[i]], local);
+        if (!Animation::invert(model[i], inverseBind[i])) {
+            error = "joint " + std::to_string(i) + " has a singular bind transform";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AnimationClip::build(const Skeleton& skeleton, float duration, const std::vector<JointTrack>& source, std::string& error) {
+    if (!(duration > 0.0f)) {
+        error = "clip duration must be positive";
+        return false;
+    }
+    this->duration = duration;
+    jointTracks.assign(skeleton.getJointCount(), -1);
+    tracks.clear();
+    keyTimes.clear();
+    packed.clear();
+
+    for (size_t t = 0; t < source.size(); t++) {
+        const JointTrack& track = source[t];
+        std::string where = "track " + std::to_string(t + 1);
+        if (track.joint < 0 || track.joint >= static_cast<int>(skeleton.getJointCount())) {
+            error = where + " has an invalid joint";
+            return false;
+        }
+        if (jointTracks[track.joint] >= 0) {
+            error = where + " animates a joint that already has a track";
+            return false;
+        }
+        size_t keys = track.times.size();
+        if (keys == 0) {
+            error = where + " has no keys";
+            return false;
+        }
+        for (size_t k = 1; k < keys; k++) {
+            if (track.times[k] < track.times[k - 1]) {
+                error = where + " key times must be ascending";
+                return false;
+            }
+        }
+        if ((!track.translations.empty() && track.translations.size() != keys * 3) ||
+            (!track.rotations.empty() && track.rotations.size() != keys * 4) ||
+            (!track.scales.empty() && track.scales.size() != keys * 3)) {
+            error = where + " channels must have one value per key";
+            return false;
+        }
+
+        Track packedTrack;
+        packedTrack.firstKey = static_cast<uint32_t>(keyTimes.size());
+        packedTrack.keyCount = static_cast<uint32_t>(keys);
+        for (float time : track.times) {
+            keyTimes.push_back(quantize(time, 0.0f, duration));
+        }
+        if (!track.translations.empty()) {
+            Range& range = packedTrack.translationRange;
+            computeRange(track.translations, range.min, range.extent);
+            packedTrack.translations = static_cast<int32_t>(packed.size());
+            for (size_t i = 0; i < track.translations.size(); i++) {
+                packed.push_back(quantize(track.translations[i], range.min[i % 3], range.extent[i % 3]));
+            }
+        }
+        if (!track.rotations.empty()) {
+            packedTrack.rotations = static_cast<int32_t>(packed.size());
+            for (size_t k = 0; k < keys; k++) {
+                uint16_t words[3];
+                packRotation(&track.rotations[k * 4], words);
+                packed.insert(packed.end(), words, words + 3);
+            }
+        }
+        if (!track.scales.empty()) {
+            Range& range = packedTrack.scaleRange;
+            computeRange(track.scales, range.min, range.extent);
+            packedTrack.scales = static_cast<int32_t>(packed.size());
+            for (size_t i = 0; i < track.scales.size(); i++) {
+                packed.push_back(quantize(track.scales[i], range.min[i % 3], range.extent[i % 3]));
+            }
+        }
+        jointTracks[track.joint] = static_cast<int32_t>(tracks.size());
+        tracks.push_back(packedTrack);
+    }
+    return true;
+}
+
+size_t AnimationClip::getCompressedBytes() const {
+    return tracks.size() * sizeof(Track) + keyTimes.size() * sizeof(uint16_t) +
+           packed.size() * sizeof(uint16_t) + jointTracks.size() * sizeof(int32_t);
+}
+
+void AnimationClip::sample(float time, bool loop, std::vector<JointPose>& pose) const {
+    float fraction = time / duration;
+    if (loop) {
+        fraction -= std::floor(fraction);
+    }
+    fraction = std::min(1.0f, std::max(0.0f, fraction));
+    uint16_t key = static_cast<uint16_t>(fraction * MaxQuantized + 0.5f);
+
+    size_t joints = std::min(pose.size(), jointTracks.size());
+    for (size_t joint = 0; joint < joints; joint++) {
+        if (jointTracks[joint] < 0) continue;
+        const Track& track = tracks[jointTracks[joint]];
+
+        // Keys a and b bracket the time; t is the blend between them
+        const uint16_t* first = keyTimes.data() + track.firstKey;
+        const uint16_t* last = first + track.keyCount;
+        size_t b = std::upper_bound(first, last, key) - first;
+        size_t a = b > 0 ? b - 1 : 0;
+        b = std::min(b, static_cast<size_t>(track.keyCount - 1));
+        float t = 0.0f;
+        if (b != a && first[b] != first[a]) {
+            t = static_cast<float>(key - first[a]) / static_cast<float>(first[b] - first[a]);
+        }
+
+        JointPose& out = pose[joint];
+        if (track.translations >= 0) {
+            const uint16_t* values = packed.data() + track.translations;
+            const Range& range = track.translationRange;
+            float from[3], to[3];
+            for (int c = 0; c < 3; c++) {
+                from[c] = dequantize(values[a * 3 + c], range.min[c], range.extent[c]);
+                to[c] = dequantize(values[b * 3 + c], range.min[c], range.extent[c]);
+            }
+            lerp3(from, to, t, out.translation);
+        }
+        if (track.rotations >= 0) {
+            const uint16_t* values = packed.data() + track.rotations;
+            float from[4], to[4];
+            unpackRotation(values + a * 3, from);
+            unpackRotation(values + b * 3, to);
+            nlerp(from, to, t, out.rotation);
+        }
+        if (track.scales >= 0) {
+            const uint16_t* values = packed.data() + track.scales;
+            const Range& range = track.scaleRange;
+            float from[3], to[3];
+            for (int c = 0; c < 3; c++) {
+                from[c] = dequantize(values[a * 3 + c], range.min[c], range.extent[c]);
+                to[c] = dequantize(values[b * 3 + c], range.min[c], range.extent[c]);
+            }
+            lerp3(from, to, t, out.scale);
+        }
+    }
+}
+
+namespace Animation {
+
+void blend(const Skeleton& skeleton, const AnimationLayer* layers, size_t layerCount,
+           std::vector<JointPose>& scratch, std::vector<JointPose>& out) {
+    size_t joints = skeleton.getJointCount();
+    float total = 0.0f;
+    for (size_t i = 0; i < layerCount; i++) {
+        if (layers[i].clip && layers[i].weight > 0.0f) total += layers[i].weight;
+    }
+    if (total <= 0.0f) {
+        out = skeleton.bindPose;
+        return;
+    }
+
+    // Accumulate weighted channels; the bind pose makes up any weight below 1
+    float scale = total > 1.0f ? 1.0f / total : 1.0f;
+    float bindWeight = total < 1.0f ? 1.0f - total : 0.0f;
+    out.resize(joints);
+    for (size_t j = 0; j < joints; j++) {
+        const JointPose& bind = skeleton.bindPose[j];
+        JointPose& pose = out[j];
+        for (int c = 0; c < 3; c++) {
+            pose.translation[c] = bind.translation[c] * bindWeight;
+            pose.scale[c] = bind.scale[c] * bindWeight;
+        }
+        for (int c = 0; c < 4; c++) pose.rotation[c] = bind.rotation[c] * bindWeight;
+    }
+
+    for (size_t i = 0; i < layerCount; i++) {
+        const AnimationLayer& layer = layers[i];
+        if (!layer.clip || layer.weight <= 0.0f) continue;
+        float weight = layer.weight * scale;
+        scratch = skeleton.bindPose;
+        layer.clip->sample(layer.time, layer.loop, scratch);
+        for (size_t j = 0; j < joints; j++) {
+            const JointPose& sampled = scratch[j];
+            JointPose& pose = out[j];
+            for (int c = 0; c < 3; c++) {
+                pose.translation[c] += sampled.translation[c] * weight;
+                pose.scale[c] += sampled.scale[c] * weight;
+            }
+            // Flip to the accumulated hemisphere so opposite signs don't cancel
+            const float* bind = skeleton.bindPose[j].rotation;
+            float dot = sampled.rotation[0] * bind[0] + sampled.rotation[1] * bind[1] +
+                        sampled.rotation[2] * bind[2] + sampled.rotation[3] * bind[3];
+            float signedWeight = dot < 0.0f ? -weight : weight;
+            for (int c = 0; c < 4; c++) pose.rotation[c] += sampled.rotation[c] * signedWeight;
+        }
+    }
+    for (size_t j = 0; j < joints; j++) normalize(out[j].rotation);
+}
+
+void computeSkinMatrices(const Skeleton& skeleton, const std::vector<JointPose>& pose,
+                         std::vector<JointMatrix>& out) {
+    size_t joints = skeleton.getJointCount();
+    out.resize(joints);
+    // Model-space transforms first; parents precede children, so one pass suffices
+    for (size_t j = 0; j < joints; j++) {
+        JointMatrix local = toMatrix(pose[j]);
+        int parent = skeleton.parents[j];
+        out[j] = parent < 0 ? local : multiply(out[parent], local);
+    }
+    for (size_t j = 0; j < joints; j++) {
+        out[j] = multiply(out[j], skeleton.inverseBind[j]);
+    }
+}
+
+JointMatrix toMatrix(const JointPose& pose) {
+    const float* q = pose.rotation;
+    const float* s = pose.scale;
+    float xx = q[0] * q[0], yy = q[1] * q[1], zz = q[2] * q[2];
+    float xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+    float wx = q[3] * q[0], wy = q[3] * q[1], wz = q[3] * q[2];
+    JointMatrix m;
+    m.m[0] = (1.0f - 2.0f * (yy + zz)) * s[0];
+    m.m[1] = 2.0f * (xy - wz) * s[1];
+    m.m[2] = 2.0f * (xz + wy) * s[2];
+    m.m[3] = pose.translation[0];
+    m.m[4] = 2.0f * (xy + wz) * s[0];
+    m.m[5] = (1.0f - 2.0f * (xx + zz)) * s[1];
+    m.m[6] = 2.0f * (yz - wx) * s[2];
+    m.m[7] = pose.translation[1];
+    m.m[8] = 2.0f * (xz - wy) * s[0];
+    m.m[9] = 2.0f * (yz + wx) * s[1];
+    m.m[10] = (1.0f - 2.0f * (xx + yy)) * s[2];
+    m.m[11] = pose.translation[2];
+    return m;
+}
+
+JointMatrix multiply(const JointMatrix& a, const JointMatrix& b) {
+    JointMatrix m;
+    for (int row = 0; row < 3; row++) {
+        const float* r = a.m + row * 4;
+        for (int col = 0; col < 4; col++) {
+            m.m[row * 4 + col] = r[0] * b.m[col] + r[1] * b.m[4 + col] + r[2] * b.m[8 + col];
+        }
+        m.m[row * 4 + 3] += r[3];
+    }
+    return m;
+}
+
+bool invert(const JointMatrix& matrix, JointMatrix& out) {
+    const float* m = matrix.m;
+    float c00 = m[5] * m[10] - m[6] * m[9];
+    float c01 = m[6] * m[8] - m[4] * m[10];
+    float c02 = m[4] * m[9] - m[5] * m[8];
+    float det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+    if (std::fabs(det) < 1e-12f) return false;
+    float inv = 1.0f / det;
+    float* o = out.m;
+    o[0] = c00 * inv;
+    o[1] = (m[2] * m[9] - m[1] * m[10]) * inv;
+    o[2] = (m[1] * m[6] - m[2] * m[5]) * inv;
+    o[4] = c01 * inv;
+    o[5] = (m[0] * m[10] - m[2] * m[8]) * inv;
+    o[6] = (m[2] * m[4] - m[0] * m[6]) * inv;
+    o[8] = c02 * inv;
+    o[9] = (m[1] * m[8] - m[0] * m[9]) * inv;
+    o[10] = (m[0] * m[5] - m[1] * m[4]) * inv;
+    for (int row = 0; row < 3; row++) {
+        o[row * 4 + 3] = -(o[row * 4] * m[3] + o[row * 4 + 1] * m[7] + o[row * 4 + 2] * m[11]);
+    }
+    return true;
+}
+
+} // namespace Animation
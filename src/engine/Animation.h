@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local transform of one joint relative to its parent
+struct JointPose {
+    float translation[3] = {0.0f, 0.0f, 0.0f};
+    float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};  // Unit quaternion x, y, z, w
+    float scale[3] = {1.0f, 1.0f, 1.0f};
+};
+
+// Row-major 3x4 affine matrix: rotation/scale in the first three columns, translation in the fourth
+struct JointMatrix {
+    float m[12];
+};
+
+// Joint hierarchy and bind pose. Parents precede their children.
+struct Skeleton {
+    std::vector<int> parents;  // -1 for roots
+    std::vector<JointPose> bindPose;
+    std::vector<JointMatrix> inverseBind;  // Model space to joint space, set by finalize
+
+    size_t getJointCount() const { return parents.size(); }
+
+    // Check the hierarchy and compute inverseBind
+    bool finalize(std::string& error);
+};
+
+// Keyframes of one joint as scripts provide them; empty channels keep the bind pose
+struct JointTrack {
+    int joint = 0;
+    std::vector<float> times;         // Seconds, ascending
+    std::vector<float> translations;  // 3 per key
+    std::vector<float> rotations;     // 4 per key (x, y, z, w)
+    std::vector<float> scales;        // 3 per key
+};
+
+// Keyframes compressed to 16-bit times, 48-bit rotations (smallest three components at
+// 15 bits each) and 16 bits per translation/scale component within each track's range.
+class AnimationClip {
+public:
+    bool build(const Skeleton& skeleton, float duration, const std::vector<JointTrack>& tracks, std::string& error);
+
+    float getDuration() const { return duration; }
+    size_t getJointCount() const { return jointTracks.size(); }
+    size_t getCompressedBytes() const;
+
+    // Overwrite the animated channels of pose (sized to the joint count) at time.
+    // Looping clips wrap time; others clamp it.
+    void sample(float time, bool loop, std::vector<JointPose>& pose) const;
+
+private:
+    struct Range {
+        float min[3];
+        float extent[3];
+    };
+
+    struct Track {
+        uint32_t firstKey = 0;
+        uint32_t keyCount = 0;
+        // Offsets into packed (3 values per key), -1 when the channel is not animated
+        int32_t translations = -1;
+        int32_t rotations = -1;
+        int32_t scales = -1;
+        Range translationRange;
+        Range scaleRange;
+    };
+
+    float duration = 0.0f;
+    std::vector<int32_t> jointTracks;  // Track per joint, -1 for none
+    std::vector<Track> tracks;
+    std::vector<uint16_t> keyTimes;    // Fraction of the duration
+    std::vector<uint16_t> packed;
+};
+
+// One clip's contribution to a blended pose
+struct AnimationLayer {
+    const AnimationClip* clip = nullptr;
+    float time = 0.0f;
+    float weight = 1.0f;
+    bool loop = true;
+};
+
+namespace Animation {
+    // Blend the layers' poses. Weights summing below 1 leave the rest to the bind pose;
+    // above 1 they are normalized. scratch is reused between calls.
+    void blend(const Skeleton& skeleton, const AnimationLayer* layers, size_t layerCount,
+               std::vector<JointPose>& scratch, std::vector<JointPose>& out);
+
+    // Skinning matrices (model-space joint transform times inverse bind) for a local pose
+    void computeSkinMatrices(const Skeleton& skeleton, const std::vector<JointPose>& pose,
+                             std::vector<JointMatrix>& out);
+
+    JointMatrix toMatrix(const JointPose& pose);
+    JointMatrix multiply(const JointMatrix& a, const JointMatrix& b);
+    // Inverse of an affine matrix; false when singular
+    bool invert(const JointMatrix& matrix, JointMatrix& out);
+}
@@ -0,0 +1,520 @@
+#include "CollisionWorld.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+inline float dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline void sub3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[0] - b[0];
+    out[1] = a[1] - b[1];
+    out[2] = a[2] - b[2];
+}
+
+inline void cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// Separating axis test of two oriented boxes
+bool boxesTouch(const CollisionWorld::Box& a, const CollisionWorld::Box& b) {
+    const float Epsilon = 1e-6f;
+    float r[3][3], absR[3][3], t[3], d[3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[i][j] = dot3(a.axes[i], b.axes[j]);
+            // Near-parallel edges make the cross product axes degenerate
+            absR[i][j] = std::fabs(r[i][j]) + Epsilon;
+        }
+    }
+    sub3(b.center, a.center, d);
+    for (int i = 0; i < 3; i++) t[i] = dot3(d, a.axes[i]);
+
+    for (int i = 0; i < 3; i++) {
+        float rb = b.half[0] * absR[i][0] + b.half[1] * absR[i][1] + b.half[2] * absR[i][2];
+        if (std::fabs(t[i]) > a.half[i] + rb) return false;
+    }
+    for (int j = 0; j < 3; j++) {
+        float ra = a.half[0] * absR[0][j] + a.half[1] * absR[1][j] + a.half[2] * absR[2][j];
+        if (std::fabs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) > ra + b.half[j]) return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            float ra = a.half[i1] * absR[i2][j] + a.half[i2] * absR[i1][j];
+            float rb = b.half[j1] * absR[i][j2] + b.half[j2] * absR[i][j1];
+            if (std::fabs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) return false;
+        }
+    }
+    return true;
+}
+
+// Sphere against an oriented box, through the box point closest to the center
+bool sphereTouchesBox(const float center[3], float radius, const CollisionWorld::Box& box) {
+    float d[3];
+    sub3(center, box.center, d);
+    float distance = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float t = dot3(d, box.axes[i]);
+        float excess = std::fabs(t) - box.half[i];
+        if (excess > 0.0f) distance += excess * excess;
+    }
+    return distance <= radius * radius;
+}
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+void closestPointOnTriangle(const float p[3], const float a[3], const float b[3], const float c[3], float out[3]) {
+    float ab[3], ac[3], ap[3];
+    sub3(b, a, ab);
+    sub3(c, a, ac);
+    sub3(p, a, ap);
+    float d1 = dot3(ab, ap), d2 = dot3(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) { std::memcpy(out, a, 3 * sizeof(float)); return; }
+
+    float bp[3];
+    sub3(p, b, bp);
+    float d3 = dot3(ab, bp), d4 = dot3(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) { std::memcpy(out, b, 3 * sizeof(float)); return; }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        for (int i = 0; i < 3; i++) out[i] = a[i] + v * ab[i];
+        return;
+    }
+
+    float cp[3];
+    sub3(p, c, cp);
+    float d5 = dot3(ab, cp), d6 = dot3(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) { std::memcpy(out, c, 3 * sizeof(float)); return; }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        for (int i = 0; i < 3; i++) out[i] = a[i] + w * ac[i];
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        for (int i = 0; i < 3; i++) out[i] = b[i] + w * (c[i] - b[i]);
+        return;
+    }
+
+    float denominator = 1.0f / (va + vb + vc);
+    float v = vb * denominator, w = vc * denominator;
+    for (int i = 0; i < 3; i++) out[i] = a[i] + ab[i] * v + ac[i] * w;
+}
+
+// Triangle against a box of half extents h centered on the origin, along the
+// coordinate axes (separating axis test)
+bool triangleTouchesBox(const float v[3][3], const float h[3]) {
+    for (int axis = 0; axis < 3; axis++) {
+        float lo = std::min(v[0][axis], std::min(v[1][axis], v[2][axis]));
+        float hi = std::max(v[0][axis], std::max(v[1][axis], v[2][axis]));
+        if (lo > h[axis] || hi < -h[axis]) return false;
+    }
+
+    float edges[3][3];
+    sub3(v[1], v[0], edges[0]);
+    sub3(v[2], v[1], edges[1]);
+    sub3(v[0], v[2], edges[2]);
+
+    float normal[3];
+    cross3(edges[0], edges[1], normal);
+    float distance = dot3(normal, v[0]);
+    float extent = h[0] * std::fabs(normal[0]) + h[1] * std::fabs(normal[1]) + h[2] * std::fabs(normal[2]);
+    if (std::fabs(distance) > extent) return false;
+
+    for (int i = 0; i < 3; i++) {
+        float unit[3] = {0.0f, 0.0f, 0.0f};
+        unit[i] = 1.0f;
+        for (int e = 0; e < 3; e++) {
+            float axis[3];
+            cross3(unit, edges[e], axis);
+            float p0 = dot3(axis, v[0]), p1 = dot3(axis, v[1]), p2 = dot3(axis, v[2]);
+            float r = h[0] * std::fabs(axis[0]) + h[1] * std::fabs(axis[1]) + h[2] * std::fabs(axis[2]);
+            if (std::min(p0, std::min(p1, p2)) > r || std::max(p0, std::max(p1, p2)) < -r) return false;
+        }
+    }
+    return true;
+}
+
+void readPosition(const Mesh& mesh, const VertexAttributeDesc& desc, size_t vertex, float out[3]) {
+    const uint8_t* data = mesh.getVertexData();
+    if (desc.type == VertexComponentType::Float32) {
+        std::memcpy(out, data + vertex * mesh.layout.getStride() + desc.offset, 3 * sizeof(float));
+        return;
+    }
+    float values[4];
+    unpackAttribute(mesh.layout, data, vertex, VertexAttribute::Position, values);
+    std::memcpy(out, values, 3 * sizeof(float));
+}
+
+// World point to the local space of cframe (rotation rows right, up and -look)
+void toLocal(const CFrame& cframe, const float world[3], float local[3]) {
+    float d[3];
+    sub3(world, cframe.position, d);
+    for (int c = 0; c < 3; c++) {
+        local[c] = cframe.right[c] * d[0] + cframe.up[c] * d[1] - cframe.look[c] * d[2];
+    }
+}
+
+void directionToLocal(const CFrame& cframe, const float world[3], float local[3]) {
+    for (int c = 0; c < 3; c++) {
+        local[c] = cframe.right[c] * world[0] + cframe.up[c] * world[1] - cframe.look[c] * world[2];
+    }
+}
+
+inline uint64_t pairKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+} // namespace
+
+CollisionWorld::CollisionWorld(ThreadPool* threadPool) : threadPool(threadPool) {
+}
+
+void CollisionWorld::setCollider(size_t row, const Collider& collider) {
+    if (colliders.size() <= row) {
+        if (collider.shape == Shape::None) return;
+        colliders.resize(row + 1);
+    }
+    colliders[row] = collider;
+}
+
+void CollisionWorld::removeRow(size_t index) {
+    if (index < colliders.size()) {
+        colliders.erase(colliders.begin() + index);
+    }
+    if (index < inOrder.size()) {
+        inOrder.erase(inOrder.begin() + index);
+    }
+    if (index < active.size()) {
+        active.erase(active.begin() + index);
+    }
+    if (index < bodies.size()) {
+        bodies.erase(bodies.begin() + index);
+    }
+    auto shift = [index](uint32_t row) { return row > index ? row - 1 : row; };
+    size_t kept = 0;
+    for (const SweepEntry& entry : order) {
+        if (entry.row == index) continue;
+        order[kept] = entry;
+        order[kept++].row = shift(entry.row);
+    }
+    order.resize(kept);
+
+    // Pairs of the removed row disappear without an end event; later rows shift
+    kept = 0;
+    for (uint64_t key : previous) {
+        uint32_t a = static_cast<uint32_t>(key >> 32), b = static_cast<uint32_t>(key);
+        if (a == index || b == index) continue;
+        previous[kept++] = pairKey(shift(a), shift(b));
+    }
+    previous.resize(kept);
+}
+
+void CollisionWorld::clear() {
+    colliders.clear();
+    bodies.clear();
+    order.clear();
+    inOrder.clear();
+    active.clear();
+    contacts.clear();
+    previous.clear();
+    began.clear();
+    stayed.clear();
+    ended.clear();
+}
+
+bool CollisionWorld::meshTouches(uint32_t meshRow, uint32_t other) const {
+    const Body& body = bodies[meshRow];
+    const Mesh& mesh = *body.mesh;
+    const VertexAttributeDesc* position = mesh.layout.find(VertexAttribute::Position);
+    if (!position) return false;
+
+    // The other shape, moved into the mesh's local space
+    const Body& target = bodies[other];
+    bool sphere = colliders[other].shape == Shape::Sphere;
+    float center[3], axes[3][3];
+    toLocal(body.cframe, target.box.center, center);
+    for (int i = 0; i < 3; i++) {
+        directionToLocal(body.cframe, target.box.axes[i], axes[i]);
+    }
+
+    const uint32_t* indices = mesh.getIndexData();
+    size_t triangleCount = mesh.isIndexed() ? mesh.getIndexCount() / 3 : mesh.vertexCount / 3;
+    for (size_t t = 0; t < triangleCount; t++) {
+        float v[3][3];
+        for (int k = 0; k < 3; k++) {
+            size_t vertex = mesh.isIndexed() ? indices[t * 3 + k] : t * 3 + k;
+            readPosition(mesh, *position, vertex, v[k]);
+        }
+        if (sphere) {
+            float closest[3], d[3];
+            closestPointOnTriangle(center, v[0], v[1], v[2], closest);
+            sub3(center, closest, d);
+            if (dot3(d, d) <= target.radius * target.radius) return true;
+        } else {
+            // Triangle in the box's frame
+            float boxSpace[3][3];
+            for (int k = 0; k < 3; k++) {
+                float d[3];
+                sub3(v[k], center, d);
+                for (int i = 0; i < 3; i++) boxSpace[k][i] = dot3(d, axes[i]);
+            }
+            if (triangleTouchesBox(boxSpace, target.box.half)) return true;
+        }
+    }
+    return false;
+}
+
+bool CollisionWorld::touches(uint32_t a, uint32_t b) const {
+    Shape shapeA = colliders[a].shape, shapeB = colliders[b].shape;
+    if (shapeA == Shape::Mesh) return meshTouches(a, b);
+    if (shapeB == Shape::Mesh) return meshTouches(b, a);
+    if (shapeA == Shape::Aabb && shapeB == Shape::Aabb) return true;  // The broadphase test
+
+    const Body& bodyA = bodies[a];
+    const Body& bodyB = bodies[b];
+    if (shapeA == Shape::Sphere && shapeB == Shape::Sphere) {
+        float d[3];
+        sub3(bodyA.box.center, bodyB.box.center, d);
+        float reach = bodyA.radius + bodyB.radius;
+        return dot3(d, d) <= reach * reach;
+    }
+    if (shapeA == Shape::Sphere) return sphereTouchesBox(bodyA.box.center, bodyA.radius, bodyB.box);
+    if (shapeB == Shape::Sphere) return sphereTouchesBox(bodyB.box.center, bodyB.radius, bodyA.box);
+    return boxesTouch(bodyA.box, bodyB.box);
+}
+
+bool CollisionWorld::isActive(const ModelStore& models, size_t row) const {
+    const Mesh* mesh = models.getMesh(row).get();
+    return colliders[row].shape != Shape::None && mesh && mesh->vertexCount > 0;
+}
+
+void CollisionWorld::computeBody(const ModelStore& models, size_t row) {
+    active[row] = isActive(models, row);
+    if (!active[row]) return;
+    const Collider& collider = colliders[row];
+    Body& body = bodies[row];
+    const Bounds& bounds = models.getBounds(row);
+    const CFrame& cframe = models.getCFrame(row);
+    float localCenter[3], half[3];
+    for (int i = 0; i < 3; i++) {
+        localCenter[i] = (bounds.min[i] + bounds.max[i]) * 0.5f;
+        half[i] = (bounds.max[i] - bounds.min[i]) * 0.5f;
+    }
+    cframe.transformPoint(localCenter, body.box.center);
+    // Local axis c points along column c of the rotation
+    const float rotation[3][3] = {
+        {cframe.right[0], cframe.right[1], cframe.right[2]},
+        {cframe.up[0], cframe.up[1], cframe.up[2]},
+        {-cframe.look[0], -cframe.look[1], -cframe.look[2]},
+    };
+    float extent[3];
+    for (int r = 0; r < 3; r++) {
+        extent[r] = std::fabs(rotation[r][0]) * half[0] + std::fabs(rotation[r][1]) * half[1] +
+                    std::fabs(rotation[r][2]) * half[2];
+    }
+
+    if (collider.shape == Shape::Aabb) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) body.box.axes[i][j] = i == j ? 1.0f : 0.0f;
+            body.box.half[i] = extent[i];
+        }
+    } else {
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 3; r++) body.box.axes[c][r] = rotation[r][c];
+            body.box.half[c] = half[c];
+        }
+    }
+    if (collider.shape == Shape::Sphere) {
+        body.radius = std::max(half[0], std::max(half[1], half[2]));
+        for (int i = 0; i < 3; i++) extent[i] = body.radius;
+    }
+    body.mesh = collider.shape == Shape::Mesh ? models.getMesh(row).get() : nullptr;
+    body.cframe = cframe;
+    for (int i = 0; i < 3; i++) {
+        body.min[i] = body.box.center[i] - extent[i];
+        body.max[i] = body.box.center[i] + extent[i];
+    }
+}
+
+void CollisionWorld::update(const ModelStore& models) {
+    auto start = std::chrono::steady_clock::now();
+    stats = Stats();
+    size_t rowCount = std::min(colliders.size(), models.size());
+    bodies.resize(rowCount);
+    inOrder.resize(rowCount, 0);
+    active.resize(rowCount);
+
+    // World bounds of every collider, in parallel blocks of rows
+    size_t blocks = (rowCount + BatchSize - 1) / BatchSize;
+    threadPool->parallelFor(blocks, [this, &models, rowCount](size_t block) {
+        size_t end = std::min(rowCount, (block + 1) * BatchSize);
+        for (size_t row = block * BatchSize; row < end; row++) {
+            computeBody(models, row);
+        }
+    });
+    for (size_t row = 0; row < rowCount; row++) {
+        if (!inOrder[row] && active[row]) {
+            inOrder[row] = 1;
+            order.push_back({0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, static_cast<uint32_t>(row)});
+        }
+    }
+
+    // Refresh the bounds of the ordered entries, dropping rows that lost their collider
+    // or geometry, then restore the x order. Bodies move little between frames, so
+    // insertion sort does close to one pass; large reshuffles (e.g. many new colliders)
+    // fall back to a full sort.
+    size_t kept = 0;
+    for (const SweepEntry& entry : order) {
+        uint32_t row = entry.row;
+        if (row < rowCount && active[row]) {
+            const Body& body = bodies[row];
+            order[kept++] = {body.min[0], body.max[0], body.min[1], body.max[1], body.min[2], body.max[2], row};
+        } else if (row < inOrder.size()) {
+            inOrder[row] = 0;
+        }
+    }
+    order.resize(kept);
+    size_t budget = order.size() * 8, moves = 0;
+    for (size_t i = 1; i < order.size() && moves <= budget; i++) {
+        SweepEntry entry = order[i];
+        size_t j = i;
+        for (; j > 0 && order[j - 1].minX > entry.minX; j--) {
+            order[j] = order[j - 1];
+            moves++;
+        }
+        order[j] = entry;
+    }
+    if (moves > budget) {
+        std::sort(order.begin(), order.end(),
+                  [](const SweepEntry& a, const SweepEntry& b) { return a.minX < b.minX; });
+    }
+    stats.colliders = order.size();
+
+    // Split the y/z plane into columns, each with its own sweep. Distributing the
+    // sorted order keeps every column sorted by min x without sorting again.
+    float lowY = 1e30f, highY = -1e30f, lowZ = 1e30f, highZ = -1e30f, size = 0.0f;
+    for (const SweepEntry& entry : order) {
+        lowY = std::min(lowY, entry.minY);
+        highY = std::max(highY, entry.maxY);
+        lowZ = std::min(lowZ, entry.minZ);
+        highZ = std::max(highZ, entry.maxZ);
+        size += std::max(entry.maxY - entry.minY, entry.maxZ - entry.minZ);
+    }
+    int grid = static_cast<int>(std::sqrt(order.size() / static_cast<double>(ColumnBodies)));
+    grid = std::max(1, std::min(MaxGrid, grid));
+    float span = std::max(highY - lowY, highZ - lowZ);
+    // Columns narrower than a couple of bodies would list most bodies several times
+    float averageSize = order.empty() ? 1.0f : size / order.size();
+    float cell = std::max(span / grid, averageSize * 2.0f);
+    if (!(cell > 0.0f)) cell = 1.0f;
+    grid = std::max(1, std::min(grid, static_cast<int>(std::ceil(span / cell))));
+    const float inverseCell = 1.0f / cell;
+    auto cellOf = [grid, inverseCell](float value, float low) {
+        return std::max(0, std::min(grid - 1, static_cast<int>((value - low) * inverseCell)));
+    };
+
+    columnStart.assign(static_cast<size_t>(grid) * grid + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+        for (const SweepEntry& entry : order) {
+            int y0 = cellOf(entry.minY, lowY), y1 = cellOf(entry.maxY, lowY);
+            int z0 = cellOf(entry.minZ, lowZ), z1 = cellOf(entry.maxZ, lowZ);
+            for (int y = y0; y <= y1; y++) {
+                for (int z = z0; z <= z1; z++) {
+                    size_t column = static_cast<size_t>(y) * grid + z;
+                    if (pass == 0) {
+                        columnStart[column + 1]++;
+                    } else {
+                        sweep[columnFill[column]++] = entry;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (size_t column = 1; column < columnStart.size(); column++) {
+                columnStart[column] += columnStart[column - 1];
+            }
+            sweep.resize(columnStart.back());
+            columnFill.assign(columnStart.begin(), columnStart.end() - 1);
+        }
+    }
+
+    // Sweep each column: every entry against the following ones until their min x passes
+    // its max x. A pair listed in several columns is kept in the one holding the low
+    // corner of its overlap.
+    size_t columnCount = columnStart.size() - 1;
+    size_t batches = std::min(columnCount, static_cast<size_t>(64));
+    batchPairs.resize(batches);
+    batchCandidates.assign(batches, 0);
+    threadPool->parallelFor(batches, [&](size_t batch) {
+        std::vector<uint64_t>& pairs = batchPairs[batch];
+        pairs.clear();
+        for (size_t column = batch; column < columnCount; column += batches) {
+            int columnY = static_cast<int>(column / grid), columnZ = static_cast<int>(column % grid);
+            size_t end = columnStart[column + 1];
+            for (size_t i = columnStart[column]; i < end; i++) {
+                const SweepEntry& a = sweep[i];
+                const Collider& colliderA = colliders[a.row];
+                for (size_t j = i + 1; j < end && sweep[j].minX <= a.maxX; j++) {
+                    const SweepEntry& b = sweep[j];
+                    if (b.minY > a.maxY || b.maxY < a.minY || b.minZ > a.maxZ || b.maxZ < a.minZ) continue;
+                    if (cellOf(std::max(a.minY, b.minY), lowY) != columnY ||
+                        cellOf(std::max(a.minZ, b.minZ), lowZ) != columnZ) continue;
+                    const Collider& colliderB = colliders[b.row];
+                    if (!(colliderA.group & colliderB.mask) || !(colliderB.group & colliderA.mask)) continue;
+                    batchCandidates[batch]++;
+                    if (touches(a.row, b.row)) {
+                        pairs.push_back(pairKey(a.row, b.row));
+                    }
+                }
+            }
+        }
+    });
+
+    contacts.clear();
+    for (size_t batch = 0; batch < batches; batch++) {
+        contacts.insert(contacts.end(), batchPairs[batch].begin(), batchPairs[batch].end());
+        stats.candidates += batchCandidates[batch];
+    }
+    std::sort(contacts.begin(), contacts.end());
+
+    // Compare with last frame's contacts (both sorted)
+    began.clear();
+    stayed.clear();
+    ended.clear();
+    auto append = [](std::vector<uint32_t>& out, uint64_t key) {
+        out.push_back(static_cast<uint32_t>(key >> 32));
+        out.push_back(static_cast<uint32_t>(key));
+    };
+    size_t i = 0, j = 0;
+    while (i < contacts.size() || j < previous.size()) {
+        if (j == previous.size() || (i < contacts.size() && contacts[i] < previous[j])) {
+            append(began, contacts[i++]);
+        } else if (i == contacts.size() || previous[j] < contacts[i]) {
+            append(ended, previous[j++]);
+        } else {
+            append(stayed, contacts[i]);
+            i++;
+            j++;
+        }
+    }
+    previous.swap(contacts);
+
+    stats.contacts = previous.size();
+    stats.began = began.size() / 2;
+    stats.ended = ended.size() / 2;
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Collision detection between models that have a collider. Every frame each collider's
+// world box is derived from its model's cached mesh bounds and transform. Sweep and
+// prune along x finds overlapping boxes: the x order is kept from the previous frame and
+// re-sorted incrementally, then split into columns of a coarse y/z grid that are swept
+// in parallel. Candidate pairs go through the narrowphase of their shapes. Contacts are
+// compared with the previous frame's to report began, stayed and ended pairs together.
+class CollisionWorld {
+public:
+    enum class Shape : uint8_t {
+        None,
+        Aabb,    // World-aligned box around the transformed bounds
+        Sphere,  // Bounds center, radius of the largest half extent
+        Box,     // Bounds box, oriented with the model
+        Mesh,    // The model's triangles
+    };
+
+    struct Collider {
+        Shape shape = Shape::None;
+        // Two colliders touch when each one's group shares a bit with the other's mask
+        uint32_t group = 1;
+        uint32_t mask = 0xffffffffu;
+    };
+
+    struct Stats {
+        size_t colliders = 0;
+        size_t candidates = 0;  // Broadphase pairs
+        size_t contacts = 0;    // Pairs touching after the narrowphase
+        size_t began = 0;
+        size_t ended = 0;
+        double milliseconds = 0.0;
+    };
+
+    static const size_t BatchSize = 1024;  // Rows per parallel bounds job
+    static const int ColumnBodies = 32;    // Target bodies per sweep column
+    static constexpr int MaxGrid = 64;         // Columns per side, at most
+
+    explicit CollisionWorld(ThreadPool* threadPool);
+
+    // Shape::None removes the row's collider
+    void setCollider(size_t row, const Collider& collider);
+    Collider getCollider(size_t row) const { return row < colliders.size() ? colliders[row] : Collider(); }
+
+    // Keep the rows parallel to the model rows; contacts of a removed row are dropped
+    void removeRow(size_t index);
+    void clear();
+
+    // Find this frame's contacts from the models' world transforms and bounds
+    void update(const ModelStore& models);
+
+    // Row pairs flattened as {a1, b1, a2, b2, ...} with a < b, as of the last update
+    const std::vector<uint32_t>& getBegan() const { return began; }
+    const std::vector<uint32_t>& getStayed() const { return stayed; }
+    const std::vector<uint32_t>& getEnded() const { return ended; }
+
+    const Stats& getStats() const { return stats; }
+
+    // Oriented box in world space
+    struct Box {
+        float center[3];
+        float axes[3][3];  // Unit axes
+        float half[3];     // Half extent along each axis
+    };
+
+private:
+    struct Body {
+        float min[3], max[3];  // World-aligned bounds
+        Box box;
+        float radius;          // Sphere shape only
+        const Mesh* mesh;      // Mesh shape only
+        CFrame cframe;         // Mesh shape only
+    };
+
+    // Collider row with its world bounds inline, for sorting and sweeping
+    struct SweepEntry {
+        float minX, maxX, minY, maxY, minZ, maxZ;
+        uint32_t row;
+    };
+
+    // Has a collider and geometry
+    bool isActive(const ModelStore& models, size_t row) const;
+    void computeBody(const ModelStore& models, size_t row);
+    bool touches(uint32_t a, uint32_t b) const;
+    // Triangles of a's mesh against b (a sphere, or any other shape's box)
+    bool meshTouches(uint32_t meshRow, uint32_t other) const;
+
+    ThreadPool* threadPool;
+    std::vector<Collider> colliders;  // Per model row
+    std::vector<Body> bodies;         // Per model row, valid for rows with colliders
+    std::vector<uint8_t> active;      // Per row: has a collider and geometry this frame
+    std::vector<SweepEntry> order;    // Colliders by min x, kept between frames
+    std::vector<uint8_t> inOrder;     // Per row: listed in order
+    std::vector<SweepEntry> sweep;    // Scratch, grouped by column and in order
+    std::vector<uint32_t> columnStart;  // Scratch, first sweep entry per column
+    std::vector<uint32_t> columnFill;
+    std::vector<std::vector<uint64_t>> batchPairs;  // Per sweep batch
+    std::vector<size_t> batchCandidates;
+    std::vector<uint64_t> contacts;   // This frame's pairs as (a << 32 | b), sorted
+    std::vector<uint64_t> previous;   // Last frame's
+    std::vector<uint32_t> began, stayed, ended;
+    Stats stats;
+};
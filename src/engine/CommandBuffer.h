@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Commands scripts batch into a buffer and hand to luau3d.submit in one call, instead
+// of one binding call each. A command is a u32 opcode followed by its fields, all
+// little-endian u32 or f32, so every field is 4-byte aligned. scripts/commands.luau
+// writes them; Luau3D::applyCommands decodes them.
+enum class CommandOp : uint32_t {
+    SetModelVisible = 1,      // model, visible (0 or 1)
+    SetModelCFrame = 2,       // model, position[3], look[3], up[3], right[3]
+    SetModelPosition = 3,     // model, position[3]; the orientation is kept
+    SetClearColor = 4,        // r, g, b, a
+    SetLight = 5,             // light (1-based), fields (CommandLightField bits), then LightFloats floats
+    RemoveLight = 6,          // light (1-based)
+    UpdateModelVertices = 7,  // model, first vertex, float count, then the floats
+};
+
+// Which vectors of a SetLight command are set; absent ones keep the renderer defaults.
+// Vectors are stored as four floats; position uses the fourth only with PositionW.
+enum CommandLightField : uint32_t {
+    LightPosition = 1 << 0,
+    LightAmbient = 1 << 1,
+    LightDiffuse = 1 << 2,
+    LightSpecular = 1 << 3,
+    LightSpotDirection = 1 << 4,
+    LightPositionW = 1 << 5,
+};
+
+// SetLight floats: position[4], ambient[4], diffuse[4], specular[4], spotDirection[3],
+// spotExponent, spotCutoff, constant, linear and quadratic attenuation (< 0 for defaults)
+const uint32_t LightFloats = 24;
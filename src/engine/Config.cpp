@@ -1,8 +1,9 @@
 #include "Config.h"
 #include <iostream>
 #include <filesystem>
+#include <cstdlib>
 
-Config::Config() : showHelp(false) {
+Config::Config() : replayFast(false), headless(false), frameLimit(0), fixedDeltaTime(0.0), instanceCount(1), showHelp(false) {
     // Default script path is main.luau in current directory
     scriptPath = "main.luau";
 }
@@ -26,13 +27,79 @@ bool Config::parseArguments(int argc, char* argv[]) {
                 return false;
             }
         }
+        else if (arg == "--record" || arg == "--replay") {
+            if (i + 1 < argc) {
+                (arg == "--record" ? recordPath : replayPath) = argv[++i];
+            }
+            else {
+                std::cerr << "Error: " << arg << " requires a trace path argument" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--fast") {
+            replayFast = true;
+        }
+        else if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--frames") {
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+                frameLimit = std::atoi(argv[++i]);
+            }
+            else {
+                std::cerr << "Error: --frames requires a positive frame count" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--instances") {
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+                instanceCount = std::atoi(argv[++i]);
+                headless = true;
+            }
+            else {
+                std::cerr << "Error: --instances requires a positive engine count" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--fixed-dt") {
+            // The step is optional and defaults to 60 frames per second
+            fixedDeltaTime = 1.0 / 60.0;
+            if (i + 1 < argc) {
+                char* end = nullptr;
+                double step = std::strtod(argv[i + 1], &end);
+                if (end != argv[i + 1] && *end == '\0') {
+                    if (step <= 0.0) {
+                        std::cerr << "Error: --fixed-dt requires a positive step in seconds" << std::endl;
+                        return false;
+                    }
+                    fixedDeltaTime = step;
+                    i++;
+                }
+            }
+        }
         else {
             // If no recognized argument, treat it as a script path
             scriptPath = arg;
         }
     }
 
-    // Check if the script file exists
+    if (!recordPath.empty() && !replayPath.empty()) {
+        std::cerr << "Error: --record and --replay cannot be combined" << std::endl;
+        return false;
+    }
+    if (instanceCount > 1 && (!recordPath.empty() || !replayPath.empty())) {
+        std::cerr << "Error: --instances cannot be combined with --record or --replay" << std::endl;
+        return false;
+    }
+
+    // Check if the script (or trace) file exists
+    if (!replayPath.empty()) {
+        if (!std::filesystem::exists(replayPath)) {
+            std::cerr << "Error: Trace file '" << replayPath << "' not found" << std::endl;
+            return false;
+        }
+        return true;
+    }
     if (!std::filesystem::exists(scriptPath)) {
         std::cerr << "Error: Script file '" << scriptPath << "' not found" << std::endl;
         return false;
@@ -47,6 +114,13 @@ void Config::printHelp() const {
     std::cout << "Options:\n";
     std::cout << "  --help, -h           Show this help message\n";
     std::cout << "  --run <script>, -r   Run the specified script\n";
+    std::cout << "  --record <trace>     Record API calls, input and frame timing to a trace\n";
+    std::cout << "  --replay <trace>     Drive the engine from a trace instead of a script\n";
+    std::cout << "  --fast               Replay as fast as possible instead of at recorded speed\n";
+    std::cout << "  --headless           Run without a window or GPU and print throughput at exit\n";
+    std::cout << "  --frames <n>         Stop after n frames\n";
+    std::cout << "  --fixed-dt [seconds] Report a constant frame time to scripts (default 1/60)\n";
+    std::cout << "  --instances <n>      Run n headless engines concurrently and print their combined throughput\n";
     std::cout << "\n";
     std::cout << "If no script is specified, the engine will attempt to run 'main.luau'\n";
     std::cout << "in the current working directory.\n";
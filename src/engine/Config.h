@@ -13,11 +13,25 @@ public:
     // Get configuration values
     const std::string& getScriptPath() const { return scriptPath; }
     bool shouldShowHelp() const { return showHelp; }
+    const std::string& getRecordPath() const { return recordPath; }
+    const std::string& getReplayPath() const { return replayPath; }
+    bool isReplayFast() const { return replayFast; }
+    bool isHeadless() const { return headless; }
+    int getFrameLimit() const { return frameLimit; }
+    double getFixedDeltaTime() const { return fixedDeltaTime; }
+    int getInstanceCount() const { return instanceCount; }
 
     // Print help message
     void printHelp() const;
 
 private:
     std::string scriptPath;
+    std::string recordPath;   // Trace to record while running the script
+    std::string replayPath;   // Trace to replay instead of running a script
+    bool replayFast;          // Replay without waiting for recorded frame times
+    bool headless;            // Run without a window or GPU
+    int frameLimit;           // Stop after this many frames; 0 runs until the window closes
+    double fixedDeltaTime;    // Seconds reported by getDeltaTime each frame; 0 uses wall clock
+    int instanceCount;        // Headless engines running the script side by side
     bool showHelp;
 }; 
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "DamageTracker.h"
+#include <algorithm>
+
+namespace {
+
+// Rasterization can touch pixels just outside the projected bounds
+const float Margin = 1.0f / 512.0f;
+
+struct Span {
+    int x0, x1;
+    size_t rect;
+};
+
+} // namespace
+
+DamageTracker::DamageTracker()
+    : fullDamage(true), frames(0), skippedFrames(0), totalDamagedPercent(0.0) {
+}
+
+void DamageTracker::removeRow(size_t index) {
+    if (index < rowRects.size()) {
+        damage(rowRects[index], pendingDamage);
+        rowRects.erase(rowRects.begin() + index);
+    }
+}
+
+void DamageTracker::clear() {
+    rowRects.clear();
+    fullDamage = true;
+}
+
+ScreenRect DamageTracker::rowRect(const ModelStore& models, size_t row) const {
+    ScreenRect rect;
+    const Mesh* mesh = models.getMesh(row).get();
+    if (!models.isVisible(row) || !mesh || mesh->vertexCount == 0) {
+        return rect;
+    }
+    float nearest;
+    if (!frustum.projectBounds(models.getCFrame(row), models.getBounds(row), rect, nearest)) {
+        // Reaches past the near plane; assume it covers the window
+        rect.minX = rect.minY = 0.0f;
+        rect.maxX = rect.maxY = 1.0f;
+        return rect;
+    }
+    rect.minX = std::max(0.0f, rect.minX - Margin);
+    rect.minY = std::max(0.0f, rect.minY - Margin);
+    rect.maxX = std::min(1.0f, rect.maxX + Margin);
+    rect.maxY = std::min(1.0f, rect.maxY + Margin);
+    return rect;
+}
+
+void DamageTracker::damage(const ScreenRect& rect, TileMask& mask) const {
+    if (rect.isEmpty()) return;
+    int x0 = std::max(0, static_cast<int>(rect.minX * TilesX));
+    int x1 = std::min(TilesX - 1, static_cast<int>(rect.maxX * TilesX));
+    int y0 = std::max(0, static_cast<int>(rect.minY * TilesY));
+    int y1 = std::min(TilesY - 1, static_cast<int>(rect.maxY * TilesY));
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            mask.set(y * TilesX + x);
+        }
+    }
+}
+
+bool DamageTracker::touches(const ScreenRect& rect, const TileMask& mask) const {
+    if (rect.isEmpty()) return false;
+    int x0 = std::max(0, static_cast<int>(rect.minX * TilesX));
+    int x1 = std::min(TilesX - 1, static_cast<int>(rect.maxX * TilesX));
+    int y0 = std::max(0, static_cast<int>(rect.minY * TilesY));
+    int y1 = std::min(TilesY - 1, static_cast<int>(rect.maxY * TilesY));
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            if (mask.test(y * TilesX + x)) return true;
+        }
+    }
+    return false;
+}
+
+void DamageTracker::buildRects(const TileMask& mask) {
+    // Runs of damaged tiles in each row, merged with identical runs of the row below
+    rects.clear();
+    std::vector<Span> previous, current;
+    for (int y = 0; y < TilesY; y++) {
+        current.clear();
+        for (int x = 0; x < TilesX; x++) {
+            if (!mask.test(y * TilesX + x)) continue;
+            int start = x;
+            while (x + 1 < TilesX && mask.test(y * TilesX + x + 1)) x++;
+
+            auto below = std::find_if(previous.begin(), previous.end(),
+                                      [start, x](const Span& span) { return span.x0 == start && span.x1 == x; });
+            if (below != previous.end()) {
+                rects[below->rect].maxY = static_cast<float>(y + 1) / TilesY;
+                current.push_back({start, x, below->rect});
+            } else {
+                ScreenRect rect;
+                rect.minX = static_cast<float>(start) / TilesX;
+                rect.maxX = static_cast<float>(x + 1) / TilesX;
+                rect.minY = static_cast<float>(y) / TilesY;
+                rect.maxY = static_cast<float>(y + 1) / TilesY;
+                rects.push_back(rect);
+                current.push_back({start, x, rects.size() - 1});
+            }
+        }
+        previous.swap(current);
+    }
+}
+
+bool DamageTracker::update(ModelStore& models, std::vector<DrawItem>& items, int bufferAge) {
+    frames++;
+    stats = Stats();
+
+    // Changed rows damage where they were and where they are now
+    TileMask frameDamage = pendingDamage;
+    pendingDamage.reset();
+    rowRects.resize(models.size());
+    models.collectChanged(changedRows);
+    stats.changedModels = changedRows.size();
+    for (uint32_t row : changedRows) {
+        damage(rowRects[row], frameDamage);
+        rowRects[row] = rowRect(models, row);
+        damage(rowRects[row], frameDamage);
+    }
+    if (fullDamage) {
+        frameDamage.set();
+        fullDamage = false;
+    }
+
+    // Nothing changed: the window already shows this frame
+    if (frameDamage.none()) {
+        stats.skipped = true;
+        stats.skippedItems = items.size();
+        skippedFrames++;
+        items.clear();
+        rects.clear();
+        return false;
+    }
+
+    // The back buffer is also missing the damage of the frames since it was last drawn
+    TileMask redraw = frameDamage;
+    if (bufferAge <= 0 || bufferAge > MaxBufferAge) {
+        redraw.set();
+    } else {
+        for (int age = 1; age < bufferAge; age++) {
+            redraw |= history[age - 1];
+        }
+    }
+    for (int age = MaxBufferAge - 1; age > 0; age--) {
+        history[age] = history[age - 1];
+    }
+    history[0] = frameDamage;
+
+    stats.damagedTiles = redraw.count();
+    stats.damagedPercent = 100.0 * stats.damagedTiles / TileCount;
+    totalDamagedPercent += stats.damagedPercent;
+    if (redraw.all()) {
+        rects.clear();
+        stats.drawnItems = items.size();
+        return true;
+    }
+
+    buildRects(redraw);
+    size_t kept = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        if (touches(rowRects[items[i].model], redraw)) {
+            items[kept++] = items[i];
+        }
+    }
+    stats.drawnItems = kept;
+    stats.skippedItems = items.size() - kept;
+    items.resize(kept);
+    return true;
+}
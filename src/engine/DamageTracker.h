@@ -0,0 +1,74 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "ModelStore.h"
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+// Tracks which parts of the window changed, so static regions are not redrawn. Models
+// whose transform, geometry or visibility changed damage the screen tiles under their
+// old and new bounds. A frame redraws the tiles damaged since the back buffer last held
+// its contents (the renderer's buffer age) and is skipped when there are none.
+class DamageTracker {
+public:
+    static const int TilesX = 16;
+    static const int TilesY = 16;
+    static const int TileCount = TilesX * TilesY;
+    static const int MaxBufferAge = 3;
+
+    struct Stats {
+        size_t changedModels = 0;
+        size_t damagedTiles = 0;      // Tiles redrawn
+        double damagedPercent = 0.0;  // Share of the window redrawn
+        size_t drawnItems = 0;        // Items overlapping the redrawn tiles
+        size_t skippedItems = 0;      // Visible items left as they were
+        bool skipped = false;         // Nothing to redraw
+    };
+
+    DamageTracker();
+
+    void setFrustum(const ViewFrustum& frustum) { this->frustum = frustum; }
+
+    // Damage the whole window on the next update (clear color, lights, frame capture)
+    void invalidate() { fullDamage = true; }
+
+    // Keep the per-model rectangles parallel to the model rows
+    void removeRow(size_t index);
+    void clear();
+
+    // Fold this frame's model changes into the damage and drop the items outside the
+    // region to redraw. Returns false when nothing needs redrawing.
+    bool update(ModelStore& models, std::vector<DrawItem>& items, int bufferAge);
+
+    // Region to redraw as merged tile rectangles; empty when the whole window is redrawn
+    const std::vector<ScreenRect>& getRects() const { return rects; }
+
+    // Stats of the last update
+    const Stats& getStats() const { return stats; }
+    // Totals over every update, for per-frame averages
+    uint64_t getFrames() const { return frames; }
+    uint64_t getSkippedFrames() const { return skippedFrames; }
+    double getTotalDamagedPercent() const { return totalDamagedPercent; }
+
+private:
+    typedef std::bitset<TileCount> TileMask;
+
+    // Window rectangle of a row, clipped; empty when hidden
+    ScreenRect rowRect(const ModelStore& models, size_t row) const;
+    void damage(const ScreenRect& rect, TileMask& mask) const;
+    bool touches(const ScreenRect& rect, const TileMask& mask) const;
+    void buildRects(const TileMask& mask);
+
+    ViewFrustum frustum;
+    std::vector<ScreenRect> rowRects;  // Where each row was last drawn
+    std::vector<uint32_t> changedRows; // Scratch
+    TileMask pendingDamage;            // Removed rows, between updates
+    bool fullDamage;
+    TileMask history[MaxBufferAge];    // Damage of the last rendered frames, newest first
+    std::vector<ScreenRect> rects;
+    Stats stats;
+    uint64_t frames;
+    uint64_t skippedFrames;
+    double totalDamagedPercent;
+};
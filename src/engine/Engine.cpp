@@ -6,15 +6,26 @@
 #include "Mac/GLRenderer.h"
 #include "Mac/GUI.h"
 #endif
+#include "Null/NullGUI.h"
+#include <chrono>
 #include <iostream>
 
 Engine::Engine() {}
 
 Engine::~Engine() {
-    // Cleanup handled by unique_ptr
+    // Cleanup handled by unique_ptr; the trace is flushed when the recorder closes
 }
 
-bool Engine::initialize(const std::string& windowTitle, int width, int height) {
+bool Engine::startRecording(const std::string& tracePath) {
+    recorder = std::make_unique<TraceRecorder>();
+    if (!recorder->open(tracePath)) {
+        recorder.reset();
+        return false;
+    }
+    return true;
+}
+
+bool Engine::initialize(const std::string& windowTitle, int width, int height, bool headless) {
     try {
         // Initialize Luau binding
         luauBinding = std::make_unique<LuauBinding>();
@@ -22,10 +33,23 @@ bool Engine::initialize(const std::string& windowTitle, int width, int height) {
             std::cerr << "Failed to initialize Luau binding" << std::endl;
             return false;
         }
+        luauBinding->setRecorder(recorder.get());
 
         // Initialize modules
-        gui = std::make_unique<GUI>(luauBinding.get());
-        renderer = std::make_unique<GLRenderer>(gui.get());
+        if (headless) {
+            gui = std::make_unique<NullGUI>(luauBinding.get());
+            auto headlessRenderer = std::make_unique<NullRenderer>(gui.get());
+            nullRenderer = headlessRenderer.get();
+            renderer = std::move(headlessRenderer);
+        } else {
+#if defined(_WIN32) || defined(__APPLE__)
+            gui = std::make_unique<GUI>(luauBinding.get());
+            renderer = std::make_unique<GLRenderer>(gui.get());
+#else
+            std::cerr << "No windowed backend on this platform; run with --headless" << std::endl;
+            return false;
+#endif
+        }
 
         if (!gui->initialize(windowTitle, width, height)) {
             std::cerr << "Failed to initialize gui" << std::endl;
@@ -37,8 +61,9 @@ bool Engine::initialize(const std::string& windowTitle, int width, int height) {
             return false;
         }
 
-        // Initialize Luau3D
-        luau3d = std::make_unique<Luau3D>(gui.get(), renderer.get());
+        // Initialize Luau3D with background workers for asset loading
+        threadPool = std::make_unique<ThreadPool>(threadCount);
+        luau3d = std::make_unique<Luau3D>(gui.get(), renderer.get(), threadPool.get());
 
         // Register modules
         registerModule(luau3d.get());
@@ -50,19 +75,70 @@ bool Engine::initialize(const std::string& windowTitle, int width, int height) {
     }
 }
 
-void Engine::registerModule(const ILuauModule* module) {
+void Engine::registerModule(ILuauModule* module) {
     if (luauBinding && module) {
-        luauBinding->registerInternalModule(module->getModuleName(), module->getExports());
+        luauBinding->registerInternalModule(module);
     }
 }
 
-void Engine::run() {
+void Engine::setFixedDeltaTime(double seconds) {
+    luau3d->setFixedDeltaTime(seconds);
+}
+
+int Engine::run(int frameLimit, bool report) {
+    auto start = std::chrono::steady_clock::now();
+
     // Execute any pending Luau code
     luauBinding->execute();
 
-    while (gui->isWindowOpen()) {
-        luau3d->present(luauBinding->getLuaState());
+    int frame = 0;
+    while (gui->isWindowOpen() && (frameLimit <= 0 || frame < frameLimit)) {
+        if (recorder) {
+            recorder->beginFrame();
+        }
+        luau3d->presentFrame(luauBinding->getLuaState());
+        frame++;
+    }
+    if (recorder) {
+        recorder->close();
+    }
+
+    if (nullRenderer && report) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        nullRenderer->report(seconds);
+        std::cout << "Models: " << luau3d->getModelCount() << ", Lua heap: "
+                  << lua_gc(luauBinding->getLuaState(), LUA_GCCOUNT, 0) << " KB" << std::endl;
+        const DamageTracker& damage = luau3d->getDamageTracker();
+        if (damage.getFrames() > 0) {
+            uint64_t drawn = damage.getFrames() - damage.getSkippedFrames();
+            std::cout << "Damage: " << damage.getSkippedFrames() << " of " << damage.getFrames()
+                      << " frames unchanged, " << (drawn > 0 ? damage.getTotalDamagedPercent() / drawn : 0.0)
+                      << "% of the window redrawn per drawn frame" << std::endl;
+        }
+        const OcclusionCuller& culler = luau3d->getOcclusionCuller();
+        if (culler.getFrames() > 0) {
+            std::cout << "Occluded per frame: " << static_cast<double>(culler.getTotalOccluded()) / culler.getFrames()
+                      << " (last frame " << culler.getStats().occluded << " of " << culler.getStats().tested
+                      << ", " << culler.getStats().milliseconds << " ms)" << std::endl;
+        }
+    }
+    return frame;
+}
+
+bool Engine::replay(const std::string& tracePath, bool fast) {
+    TraceReplayer replayer;
+    if (!replayer.open(tracePath)) {
+        return false;
+    }
+    replayer.addModule(luau3d.get());
+    replayer.addModule(gui.get());
+
+    lua_State* L = luauBinding->getLuaState();
+    while (gui->isWindowOpen() && replayer.replayFrame(L, gui.get(), fast)) {
+        luau3d->presentFrame(L);
     }
+    replayer.report();
+    return true;
 }
 
 bool Engine::loadScript(const std::string& scriptPath) {
@@ -7,6 +7,9 @@
 #include "ILuauModule.h"
 #include "Luau3D.h"
 #include "IGUI.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Null/NullRenderer.h"
 
 // The main engine class
 class Engine {
@@ -14,21 +17,40 @@ public:
     Engine();
     ~Engine();
 
-    // Initialize the engine
-    bool initialize(const std::string& windowTitle, int width, int height);
+    // Initialize the engine. Headless engines use the null GUI and renderer: no window,
+    // no GPU, and frames run as fast as the scripts allow.
+    bool initialize(const std::string& windowTitle, int width, int height, bool headless = false);
 
-    // Run the main game loop
-    void run();
+    // Worker threads of the engine's pool (0 picks the default); call before initialize
+    void setThreadCount(unsigned int count) { threadCount = count; }
+
+    // Run the main game loop, until the window closes or after frameLimit frames (if > 0).
+    // Headless runs print throughput stats at exit unless report is false.
+    // Returns the number of frames run.
+    int run(int frameLimit = 0, bool report = true);
+
+    // Report a constant frame time to scripts instead of wall-clock time (0 restores it)
+    void setFixedDeltaTime(double seconds);
+
+    // Record a trace of the session; call before initialize
+    bool startRecording(const std::string& tracePath);
+
+    // Drive the engine from a recorded trace instead of a script
+    bool replay(const std::string& tracePath, bool fast);
 
     // Load and execute a Luau script
     bool loadScript(const std::string& scriptPath);
 
     // Register a module with the Luau binding
-    void registerModule(const ILuauModule* module);
+    void registerModule(ILuauModule* module);
 
 private:
+    std::unique_ptr<ThreadPool> threadPool;  // Declared first so workers outlive the modules
     std::unique_ptr<IRenderer> renderer;
     std::unique_ptr<LuauBinding> luauBinding;
     std::unique_ptr<Luau3D> luau3d;
     std::unique_ptr<IGUI> gui;
+    std::unique_ptr<TraceRecorder> recorder;
+    NullRenderer* nullRenderer = nullptr;  // Set when headless; owned by renderer
+    unsigned int threadCount = 0;
 }; 
\ No newline at end of file
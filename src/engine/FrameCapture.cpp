@@ -0,0 +1,131 @@
+#include "FrameCapture.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+FrameCapture::FrameCapture(ThreadPool* threadPool, size_t maxPending)
+    : threadPool(threadPool), maxPending(maxPending > 0 ? maxPending : 1), pending(0),
+      continuous(false), continuousFormat(ImageFormat::Png), continuousFrame(0) {}
+
+FrameCapture::~FrameCapture() {
+    // Workers reference the buffers and this object until they finish
+    std::unique_lock<std::mutex> lock(mutex);
+    bufferReleased.wait(lock, [this] { return pending == 0; });
+}
+
+void FrameCapture::requestFrame(const std::string& path) {
+    requests.push_back(path);
+}
+
+void FrameCapture::startContinuous(const std::string& prefix, ImageFormat format) {
+    continuous = true;
+    continuousPrefix = prefix;
+    continuousFormat = format;
+    continuousFrame = 0;
+}
+
+void FrameCapture::stopContinuous() {
+    continuous = false;
+}
+
+FrameCapture::Buffer* FrameCapture::acquireBuffer(bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (freeBuffers.empty() && buffers.size() < maxPending) {
+        buffers.push_back(std::make_unique<Buffer>());
+        freeBuffers.push_back(buffers.back().get());
+    }
+    if (freeBuffers.empty()) {
+        if (!wait) {
+            stats.dropped++;
+            return nullptr;
+        }
+        bufferReleased.wait(lock, [this] { return !freeBuffers.empty(); });
+    }
+    Buffer* buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    pending++;
+    return buffer;
+}
+
+void FrameCapture::captureFrame(IRenderer* renderer) {
+    if (requests.empty() && !continuous) {
+        return;
+    }
+
+    // One readback serves every path requested for this frame
+    std::vector<std::string> paths;
+    paths.swap(requests);
+    std::vector<ImageFormat> formats;
+    for (const std::string& path : paths) {
+        formats.push_back(ImageEncoder::formatFromPath(path));
+    }
+    if (continuous) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%06llu", static_cast<unsigned long long>(continuousFrame++));
+        paths.push_back(continuousPrefix + number + ImageEncoder::getExtension(continuousFormat));
+        formats.push_back(continuousFormat);
+    }
+
+    // Explicit requests must not be lost, so they wait for a buffer; continuous
+    // capture keeps the frame rate instead
+    bool wait = paths.size() > 1 || !continuous;
+    Buffer* buffer = acquireBuffer(wait);
+    if (!buffer) {
+        return;
+    }
+    if (!renderer->readPixels(buffer->pixels, buffer->width, buffer->height)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.failed++;
+        freeBuffers.push_back(buffer);
+        pending--;
+        bufferReleased.notify_all();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.captured++;
+        // Every path encodes from the same buffer; the last write releases it
+        buffer->users = static_cast<int>(paths.size());
+    }
+    for (size_t i = 0; i < paths.size(); i++) {
+        encode(buffer, paths[i], formats[i]);
+    }
+}
+
+void FrameCapture::encode(Buffer* buffer, const std::string& path, ImageFormat format) {
+    auto error = std::make_shared<std::string>();
+    threadPool->submit(
+        [this, buffer, path, format, error]() {
+            auto start = std::chrono::steady_clock::now();
+            bool written = ImageEncoder::writeFile(path, format, buffer->pixels.data(), buffer->width,
+                                                   buffer->height, *error);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::error_code ec;
+            uintmax_t size = written ? std::filesystem::file_size(path, ec) : 0;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.encodeSeconds += seconds;
+            if (written) {
+                stats.written++;
+                stats.bytesWritten += ec ? 0 : size;
+            } else {
+                stats.failed++;
+            }
+            if (--buffer->users == 0) {
+                freeBuffers.push_back(buffer);
+                pending--;
+                bufferReleased.notify_all();
+            }
+        },
+        [error]() {
+            if (!error->empty()) {
+                std::cerr << "Frame capture failed: " << *error << std::endl;
+            }
+        });
+}
+
+FrameCapture::Stats FrameCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "ImageEncoder.h"
+#include "ThreadPool.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Writes rendered frames to image files without stalling the frame. The renderer reads
+// pixels into a pooled buffer (the only main-thread cost); encoding and file writes run
+// on the thread pool. At most maxPending frames are in flight: single captures wait for
+// a free buffer, continuous capture drops the frame instead.
+class FrameCapture {
+public:
+    struct Stats {
+        uint64_t captured = 0;   // Frames read back
+        uint64_t dropped = 0;    // Continuous frames skipped because every buffer was busy
+        uint64_t written = 0;    // Images on disk
+        uint64_t failed = 0;     // Readback or write failures
+        uint64_t bytesWritten = 0;
+        double encodeSeconds = 0.0;  // Worker time spent encoding and writing
+    };
+
+    FrameCapture(ThreadPool* threadPool, size_t maxPending = 3);
+    ~FrameCapture();  // Waits for pending images
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Capture the next rendered frame to path; the format comes from the extension
+    void requestFrame(const std::string& path);
+
+    // Capture every frame to <prefix><frame number, 6 digits><extension>. Numbers count
+    // frames since the start, so dropped frames leave gaps.
+    void startContinuous(const std::string& prefix, ImageFormat format);
+    void stopContinuous();
+    bool isContinuous() const { return continuous; }
+    // Whether the next captureFrame reads anything back
+    bool wantsFrame() const { return continuous || !requests.empty(); }
+
+    // Read back the finished frame if anything wants it. Call after rendering and
+    // before the renderer presents.
+    void captureFrame(IRenderer* renderer);
+
+    Stats getStats() const;
+
+private:
+    struct Buffer {
+        std::vector<uint8_t> pixels;  // RGBA8, bottom row first
+        int width = 0;
+        int height = 0;
+        int users = 0;  // Writes still reading the pixels
+    };
+
+    // Null when every buffer is in flight and wait is false
+    Buffer* acquireBuffer(bool wait);
+    void encode(Buffer* buffer, const std::string& path, ImageFormat format);
+
+    ThreadPool* threadPool;
+    size_t maxPending;
+    std::vector<std::unique_ptr<Buffer>> buffers;  // Grows up to maxPending
+    std::vector<Buffer*> freeBuffers;
+    size_t pending;  // Buffers in flight
+    mutable std::mutex mutex;
+    std::condition_variable bufferReleased;
+    Stats stats;
+
+    std::vector<std::string> requests;  // Main thread only
+    bool continuous;
+    std::string continuousPrefix;
+    ImageFormat continuousFormat;
+    uint64_t continuousFrame;
+};
@@ -0,0 +1,149 @@
+#include "GeometryCache.h"
+#include <cstring>
+
+static const uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t Prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t hashRound(uint64_t acc, uint64_t input) {
+    acc += input * Prime2;
+    acc = rotateLeft(acc, 31);
+    return acc * Prime1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= hashRound(0, value);
+    return acc * Prime1 + Prime4;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        // Four lanes over 32-byte stripes
+        uint64_t v1 = seed + Prime1 + Prime2;
+        uint64_t v2 = seed + Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = hashRound(v1, read64(p));
+            v2 = hashRound(v2, read64(p + 8));
+            v3 = hashRound(v3, read64(p + 16));
+            v4 = hashRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + Prime5;
+    }
+    hash += static_cast<uint64_t>(size);
+
+    // Tail: 8, 4, then single bytes
+    for (; p + 8 <= end; p += 8) {
+        hash ^= hashRound(0, read64(p));
+        hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(p)) * Prime1;
+        hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= static_cast<uint64_t>(*p) * Prime5;
+        hash = rotateLeft(hash, 11) * Prime1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::shared_ptr<Mesh> GeometryCache::intern(const std::vector<float>& vertices, const VertexLayout& layout) {
+    size_t vertexCount = vertices.size() / layout.getSourceFloatsPerVertex();
+    scratch.resize(vertexCount * layout.getStride());
+    packVertices(layout, vertices.data(), vertexCount, scratch.data());
+    uint64_t hash = hashBytes(scratch.data(), scratch.size(), layout.getStride());
+    stats.lookups++;
+
+    // Equal hashes are confirmed byte for byte
+    auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        std::shared_ptr<Mesh> mesh = it->second.lock();
+        if (mesh && mesh->layout == layout && mesh->getVertexDataSize() == scratch.size() &&
+            !mesh->isIndexed() && memcmp(mesh->getVertexData(), scratch.data(), scratch.size()) == 0) {
+            stats.hits++;
+            stats.hitBytesTotal += scratch.size();
+            return mesh;
+        }
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->layout = layout;
+    mesh->vertexCount = vertexCount;
+    mesh->vertices.swap(scratch);
+    if (entries.size() >= pruneAt) {
+        prune();
+        pruneAt = entries.size() * 2 > 64 ? entries.size() * 2 : 64;
+    }
+    entries.emplace(hash, mesh);
+    return mesh;
+}
+
+void GeometryCache::prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.expired()) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const GeometryCache::Stats& GeometryCache::getStats() {
+    prune();
+    stats.meshes = 0;
+    stats.meshBytes = 0;
+    stats.dedupedBytes = 0;
+    for (const auto& entry : entries) {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock()) {
+            stats.meshes++;
+            stats.meshBytes += mesh->getVertexDataSize();
+            // Every holder past the first would otherwise own a copy; one of the
+            // references counted is the lock above
+            long holders = mesh.use_count() - 1;
+            if (holders > 1) {
+                stats.dedupedBytes += static_cast<size_t>(holders - 1) * mesh->getVertexDataSize();
+            }
+        }
+    }
+    return stats;
+}
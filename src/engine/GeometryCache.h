@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// 64-bit xxHash (XXH64) of size bytes
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// Intern table for geometry built from script vertex arrays. Packed vertex data is
+// hashed, and identical content in the same layout resolves to one shared Mesh, so
+// models made from the same array share storage. Entries are weak: a mesh goes once no
+// model or handle uses it. Shared meshes are never written in place (writers copy
+// first, see Luau3D::updateModelVertices), and a private mesh rewritten in place simply
+// stops matching its old content.
+class GeometryCache {
+public:
+    struct Stats {
+        size_t meshes = 0;        // Interned meshes still alive
+        size_t meshBytes = 0;     // Their vertex data
+        size_t lookups = 0;
+        size_t hits = 0;          // Lookups that shared an existing mesh
+        size_t dedupedBytes = 0;  // Vertex bytes not stored again by the current sharers
+        size_t hitBytesTotal = 0; // Vertex bytes of every hit so far; never goes down
+    };
+
+    // The mesh for vertices in layout, shared with identical earlier geometry
+    std::shared_ptr<Mesh> intern(const std::vector<float>& vertices, const VertexLayout& layout);
+
+    const Stats& getStats();
+
+private:
+    // Drop entries whose mesh is gone
+    void prune();
+
+    std::unordered_multimap<uint64_t, std::weak_ptr<Mesh>> entries;
+    size_t pruneAt = 64;           // Entry count that triggers the next prune
+    std::vector<uint8_t> scratch;  // Packed vertices, moved into the mesh on a miss
+    Stats stats;
+};
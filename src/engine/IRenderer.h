@@ -2,6 +2,9 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include "Mesh.h"
 
 struct CFrame {
     float position[3];    // Position (x, y, z)
@@ -16,16 +19,82 @@ struct CFrame {
         up[0] = 0.0f; up[1] = 1.0f; up[2] = 0.0f;         // Up is +Y
         right[0] = 1.0f; right[1] = 0.0f; right[2] = 0.0f; // Right is +X
     }
+
+    // World position of a local point; the rotation rows are right, up and -look
+    void transformPoint(const float local[3], float world[3]) const {
+        world[0] = position[0] + right[0] * local[0] + right[1] * local[1] + right[2] * local[2];
+        world[1] = position[1] + up[0] * local[0] + up[1] * local[1] + up[2] * local[2];
+        world[2] = position[2] - look[0] * local[0] - look[1] * local[1] - look[2] * local[2];
+    }
+};
+
+// Rectangle in normalized window coordinates (0..1, origin bottom-left)
+struct ScreenRect {
+    float minX = 0.0f, minY = 0.0f;
+    float maxX = 0.0f, maxY = 0.0f;
+
+    bool isEmpty() const { return minX >= maxX || minY >= maxY; }
+};
+
+// glFrustum parameters of the renderers' projection. There is no camera yet: the eye
+// sits at the world origin looking down -z, so view space is world space.
+struct ViewFrustum {
+    float left = -1.0f, right = 1.0f;
+    float bottom = -1.0f, top = 1.0f;
+    float nearPlane = 1.0f, farPlane = 100.0f;
+
+    // Project a view-space point to normalized window coordinates and 1/depth;
+    // false when it is in front of the near plane
+    bool project(const float point[3], float& x, float& y, float& inverseDepth) const {
+        float depth = -point[2];
+        if (depth < nearPlane) return false;
+        inverseDepth = 1.0f / depth;
+        x = (point[0] * nearPlane * inverseDepth - left) / (right - left);
+        y = (point[1] * nearPlane * inverseDepth - bottom) / (top - bottom);
+        return true;
+    }
+
+    // Window rectangle (unclipped) and largest 1/depth of a transformed box; false when
+    // the box reaches in front of the near plane
+    bool projectBounds(const CFrame& cframe, const Bounds& bounds, ScreenRect& rect, float& nearestInverseDepth) const {
+        rect.minX = rect.minY = 1e30f;
+        rect.maxX = rect.maxY = -1e30f;
+        nearestInverseDepth = 0.0f;
+        for (int corner = 0; corner < 8; corner++) {
+            float local[3] = {
+                (corner & 1) ? bounds.max[0] : bounds.min[0],
+                (corner & 2) ? bounds.max[1] : bounds.min[1],
+                (corner & 4) ? bounds.max[2] : bounds.min[2],
+            };
+            float world[3], x, y, inverseDepth;
+            cframe.transformPoint(local, world);
+            if (!project(world, x, y, inverseDepth)) return false;
+            rect.minX = x < rect.minX ? x : rect.minX;
+            rect.maxX = x > rect.maxX ? x : rect.maxX;
+            rect.minY = y < rect.minY ? y : rect.minY;
+            rect.maxY = y > rect.maxY ? y : rect.maxY;
+            nearestInverseDepth = inverseDepth > nearestInverseDepth ? inverseDepth : nearestInverseDepth;
+        }
+        return true;
+    }
 };
 
-struct Model {
-    std::vector<float> vertices;  // Interleaved position (3) and color (3) data
-    bool visible;
-    CFrame cframe;
-    // Future: Add model view information here
-    // - Transform matrix
-    // - Material properties
-    // - Shader information
+// Vertices of a mesh rewritten in place since the previous frame
+struct MeshUpdate {
+    const Mesh* mesh;
+    const VertexRange* ranges;  // Sorted and disjoint
+    size_t rangeCount;
+};
+
+// One visible model, as handed to the renderer each frame
+struct DrawItem {
+    const Mesh* mesh;   // Never null or empty
+    CFrame cframe;      // World space
+    uint32_t model;     // Index of the model the item was built from
+    // Lights to shade the item with, strongest first, as indices into the list
+    // passed to IRenderer::setLights
+    const uint32_t* lights = nullptr;
+    uint32_t lightCount = 0;
 };
 
 struct LightProperties {
@@ -64,10 +133,32 @@ public:
     virtual int getWidth() const = 0;
     virtual int getHeight() const = 0;
 
-    // Light management
-    virtual void setLight(int lightNum, const LightProperties& properties) = 0;
+    // Light management. The list may hold any number of lights; each draw item names
+    // the few that affect it. Entries not referenced by any item are ignored.
+    virtual void setLights(const std::vector<LightProperties>& lights) = 0;
     virtual void enableLighting(bool enable) = 0;
 
-    // Render all visible models
-    virtual void render(const std::vector<Model>& models) = 0;
+    // Meshes rewritten in place since the last frame, before render. Renderers that keep
+    // GPU copies upload just these ranges; wholesale replacements change Mesh::revision
+    // instead and are not listed.
+    virtual void updateMeshes(const std::vector<MeshUpdate>& updates) = 0;
+
+    // Meshes that are about to be destroyed; drop any copies of them. The pointers are
+    // only identities and may be reused by later meshes.
+    virtual void releaseMeshes(const std::vector<const Mesh*>& meshes) = 0;
+
+    // Render the visible models collected for this frame
+    virtual void render(const std::vector<DrawItem>& items) = 0;
+
+    // Frames since the back buffer last held what the next frame draws over: 1 when
+    // swaps copy, 2 when they exchange two buffers, 0 when its contents are undefined
+    virtual int getBufferAge() const = 0;
+
+    // Limit the next clear and render to rects; empty redraws the whole window
+    virtual void setDamage(const std::vector<ScreenRect>& rects) = 0;
+
+    // Copy the rendered frame into pixels (resized to fit) as RGBA8, bottom row first.
+    // Call after render and before endFrame. Backends with asynchronous readback may
+    // return a frame rendered a frame or two earlier while reads come every frame.
+    virtual bool readPixels(std::vector<uint8_t>& pixels, int& width, int& height) = 0;
 }; 
\ No newline at end of file
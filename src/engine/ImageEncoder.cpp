@@ -0,0 +1,406 @@
+#include "ImageEncoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+void putU32BE(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// ---------------------------------------------------------------------------
+// Deflate (RFC 1951) with a single fixed-Huffman block and greedy LZ77 matching.
+// Rendered frames are dominated by flat regions, which this handles well without
+// the cost of building dynamic code tables.
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out), bits(0), count(0) {}
+
+    // Write value LSB first
+    void write(uint32_t value, int length) {
+        bits |= static_cast<uint64_t>(value) << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are stored MSB first
+    void writeCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        write(reversed, length);
+    }
+
+    void flush() {
+        if (count > 0) {
+            out.push_back(static_cast<uint8_t>(bits));
+        }
+        bits = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t bits;
+    int count;
+};
+
+const uint16_t LengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t DistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                   7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Fixed literal/length code for symbols 0..287
+void writeSymbol(BitWriter& writer, int symbol) {
+    if (symbol < 144) writer.writeCode(0x30 + symbol, 8);
+    else if (symbol < 256) writer.writeCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) writer.writeCode(symbol - 256, 7);
+    else writer.writeCode(0xC0 + symbol - 280, 8);
+}
+
+void writeMatch(BitWriter& writer, int length, int distance) {
+    int lengthCode = 28;
+    while (LengthBase[lengthCode] > length) lengthCode--;
+    writeSymbol(writer, 257 + lengthCode);
+    writer.write(length - LengthBase[lengthCode], LengthExtra[lengthCode]);
+
+    int distanceCode = 29;
+    while (DistanceBase[distanceCode] > distance) distanceCode--;
+    writer.writeCode(distanceCode, 5);
+    writer.write(distance - DistanceBase[distanceCode], DistanceExtra[distanceCode]);
+}
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // 5552 is the largest block that cannot overflow before the modulo
+        size_t block = std::min<size_t>(size, 5552);
+        size -= block;
+        while (block-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// zlib stream (RFC 1950) around one deflate block
+void zlibCompress(const std::vector<uint8_t>& input, std::vector<uint8_t>& out) {
+    const int WindowSize = 32768;
+    const int MinMatch = 3;
+    const int MaxMatch = 258;
+    const int HashBits = 15;
+
+    out.push_back(0x78);  // 32K window, deflate
+    out.push_back(0x01);  // Fastest compression level, no dictionary
+
+    BitWriter writer(out);
+    writer.write(1, 1);  // Final block
+    writer.write(1, 2);  // Fixed Huffman codes
+
+    std::vector<int> head(size_t(1) << HashBits, -1);
+    const uint8_t* data = input.data();
+    int size = static_cast<int>(input.size());
+    auto hash = [data](int i) {
+        uint32_t v = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+        return (v * 2654435761u) >> (32 - HashBits);
+    };
+
+    int i = 0;
+    while (i < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (i + MinMatch <= size) {
+            uint32_t h = hash(i);
+            int candidate = head[h];
+            head[h] = i;
+            if (candidate >= 0 && i - candidate <= WindowSize) {
+                int limit = std::min(MaxMatch, size - i);
+                int length = 0;
+                while (length < limit && data[candidate + length] == data[i + length]) length++;
+                if (length >= MinMatch) {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                }
+            }
+        }
+
+        if (bestLength > 0) {
+            writeMatch(writer, bestLength, bestDistance);
+            // Index the skipped positions so later matches can find them
+            int end = std::min(i + bestLength, size - MinMatch + 1);
+            for (int j = i + 1; j < end; j++) {
+                head[hash(j)] = j;
+            }
+            i += bestLength;
+        } else {
+            writeSymbol(writer, data[i]);
+            i++;
+        }
+    }
+    writeSymbol(writer, 256);  // End of block
+    writer.flush();
+
+    putU32BE(out, adler32(input.data(), input.size()));
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void writeChunk(std::vector<uint8_t>& out, const char type[4], const std::vector<uint8_t>& data) {
+    putU32BE(out, static_cast<uint32_t>(data.size()));
+    size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putU32BE(out, crc32(out.data() + typeOffset, data.size() + 4));
+}
+
+uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+bool encodePng(const uint8_t* pixels, int width, int height, std::vector<uint8_t>& out) {
+    const int Channels = 4;
+    size_t rowBytes = static_cast<size_t>(width) * Channels;
+
+    // Filter each row with whichever of None/Sub/Up/Paeth gives the smallest
+    // sum of absolute residuals (the heuristic recommended by the PNG spec)
+    std::vector<uint8_t> filtered((rowBytes + 1) * height);
+    std::vector<uint8_t> candidate[4];
+    for (auto& row : candidate) row.resize(rowBytes);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels + (height - 1 - y) * rowBytes;
+        const uint8_t* above = y > 0 ? pixels + (height - y) * rowBytes : nullptr;
+        uint64_t bestScore = UINT64_MAX;
+        int bestFilter = 0;
+        for (int filter = 0; filter < 4; filter++) {
+            uint8_t* dst = candidate[filter].data();
+            uint64_t score = 0;
+            for (size_t x = 0; x < rowBytes; x++) {
+                int left = x >= Channels ? row[x - Channels] : 0;
+                int up = above ? above[x] : 0;
+                int upLeft = above && x >= Channels ? above[x - Channels] : 0;
+                uint8_t predicted = 0;
+                switch (filter) {
+                    case 1: predicted = static_cast<uint8_t>(left); break;
+                    case 2: predicted = static_cast<uint8_t>(up); break;
+                    case 3: predicted = paeth(left, up, upLeft); break;
+                }
+                dst[x] = static_cast<uint8_t>(row[x] - predicted);
+                score += static_cast<int8_t>(dst[x]) < 0 ? -static_cast<int8_t>(dst[x]) : dst[x];
+            }
+            if (score < bestScore) {
+                bestScore = score;
+                bestFilter = filter;
+            }
+        }
+        uint8_t* filteredRow = filtered.data() + y * (rowBytes + 1);
+        filteredRow[0] = static_cast<uint8_t>(bestFilter == 3 ? 4 : bestFilter);  // PNG numbers Paeth as 4
+        std::memcpy(filteredRow + 1, candidate[bestFilter].data(), rowBytes);
+    }
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    putU32BE(header, static_cast<uint32_t>(width));
+    putU32BE(header, static_cast<uint32_t>(height));
+    header.push_back(8);  // Bit depth
+    header.push_back(6);  // Truecolor with alpha
+    header.push_back(0);  // Deflate
+    header.push_back(0);  // Adaptive filtering
+    header.push_back(0);  // No interlace
+    writeChunk(out, "IHDR", header);
+
+    std::vector<uint8_t> compressed;
+    compressed.reserve(filtered.size() / 4);
+    zlibCompress(filtered, compressed);
+    writeChunk(out, "IDAT", compressed);
+    writeChunk(out, "IEND", {});
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// QOI (https://qoiformat.org/qoi-specification.pdf)
+
+bool encodeQoi(const uint8_t* pixels, int width, int height, std::vector<uint8_t>& out) {
+    struct Rgba { uint8_t r, g, b, a; };
+    auto same = [](const Rgba& x, const Rgba& y) { return x.r == y.r && x.g == y.g && x.b == y.b && x.a == y.a; };
+
+    out.clear();
+    out.reserve(static_cast<size_t>(width) * height * 2 + 22);
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    putU32BE(out, static_cast<uint32_t>(width));
+    putU32BE(out, static_cast<uint32_t>(height));
+    out.push_back(4);  // RGBA
+    out.push_back(0);  // sRGB with linear alpha
+
+    Rgba index[64] = {};
+    Rgba previous = {0, 0, 0, 255};
+    int run = 0;
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels + (height - 1 - y) * rowBytes;
+        for (int x = 0; x < width; x++) {
+            Rgba px = {row[x * 4], row[x * 4 + 1], row[x * 4 + 2], row[x * 4 + 3]};
+            if (same(px, previous)) {
+                if (++run == 62) {
+                    out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                run = 0;
+            }
+
+            int slot = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+            if (same(index[slot], px)) {
+                out.push_back(static_cast<uint8_t>(slot));
+            } else {
+                index[slot] = px;
+                if (px.a == previous.a) {
+                    int8_t dr = static_cast<int8_t>(px.r - previous.r);
+                    int8_t dg = static_cast<int8_t>(px.g - previous.g);
+                    int8_t db = static_cast<int8_t>(px.b - previous.b);
+                    int8_t drg = static_cast<int8_t>(dr - dg);
+                    int8_t dbg = static_cast<int8_t>(db - dg);
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        out.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                        out.push_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+                    } else {
+                        out.insert(out.end(), {0xFE, px.r, px.g, px.b});
+                    }
+                } else {
+                    out.insert(out.end(), {0xFF, px.r, px.g, px.b, px.a});
+                }
+            }
+            previous = px;
+        }
+    }
+    if (run > 0) {
+        out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+    }
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+    return true;
+}
+
+bool encodeRaw(const uint8_t* pixels, int width, int height, std::vector<uint8_t>& out) {
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    out.resize(rowBytes * height);
+    for (int y = 0; y < height; y++) {
+        std::memcpy(out.data() + y * rowBytes, pixels + (height - 1 - y) * rowBytes, rowBytes);
+    }
+    return true;
+}
+
+} // namespace
+
+namespace ImageEncoder {
+
+ImageFormat formatFromPath(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".png") return ImageFormat::Png;
+    if (extension == ".qoi") return ImageFormat::Qoi;
+    return ImageFormat::Raw;
+}
+
+const char* getExtension(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::Png: return ".png";
+        case ImageFormat::Qoi: return ".qoi";
+        case ImageFormat::Raw: return ".rgba";
+    }
+    return ".rgba";
+}
+
+bool encode(ImageFormat format, const uint8_t* pixels, int width, int height, std::vector<uint8_t>& out) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    switch (format) {
+        case ImageFormat::Png: return encodePng(pixels, width, height, out);
+        case ImageFormat::Qoi: return encodeQoi(pixels, width, height, out);
+        case ImageFormat::Raw: return encodeRaw(pixels, width, height, out);
+    }
+    return false;
+}
+
+bool writeFile(const std::string& path, ImageFormat format, const uint8_t* pixels, int width, int height,
+               std::string& error) {
+    std::vector<uint8_t> encoded;
+    if (!encode(format, pixels, width, height, encoded)) {
+        error = "Cannot encode a " + std::to_string(width) + "x" + std::to_string(height) + " image";
+        return false;
+    }
+
+    static std::atomic<unsigned> tempCounter{0};
+    std::string temporary = path + ".tmp" + std::to_string(tempCounter++);
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        error = "Cannot open " + temporary + " for writing";
+        return false;
+    }
+    bool written = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    written = std::fclose(file) == 0 && written;
+
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(temporary, path, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(temporary, ec);
+        error = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace ImageEncoder
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ImageFormat {
+    Png,  // RGBA8, deflate with fixed Huffman codes
+    Qoi,  // "Quite OK Image" RGBA, fast lossless
+    Raw   // Tightly packed RGBA8 rows, top to bottom
+};
+
+// Encoders for captured frames. Input is RGBA8 with rows ordered bottom to top,
+// as GL reads them back; every format is written top to bottom.
+namespace ImageEncoder {
+    // Pick a format from the file extension (.png, .qoi, anything else is raw)
+    ImageFormat formatFromPath(const std::string& path);
+    const char* getExtension(ImageFormat format);
+
+    bool encode(ImageFormat format, const uint8_t* pixels, int width, int height, std::vector<uint8_t>& out);
+
+    // Encode and write to path (via a temp file, so readers never see a partial image)
+    bool writeFile(const std::string& path, ImageFormat format, const uint8_t* pixels, int width, int height,
+                   std::string& error);
+}
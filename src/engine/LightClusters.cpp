@@ -0,0 +1,267 @@
+#include "LightClusters.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float Infinity = std::numeric_limits<float>::infinity();
+
+// Contributions below this fraction of a light's peak are treated as zero
+const float CutoffFraction = 1.0f / 256.0f;
+
+float maxChannel(const std::vector<float>& color, float fallback) {
+    if (color.size() < 3) return fallback;
+    return std::max(color[0], std::max(color[1], color[2]));
+}
+
+} // namespace
+
+LightClusters::LightClusters() : sliceScale(0.0f), stampValue(0) {
+    setFrustum(ViewFrustum());
+    clusterCounts.assign(ClusterCount, 0);
+    clusterOffsets.assign(ClusterCount, 0);
+}
+
+void LightClusters::setFrustum(const ViewFrustum& newFrustum) {
+    frustum = newFrustum;
+    sliceScale = Slices / std::log(frustum.farPlane / frustum.nearPlane);
+
+    clusterMin.resize(ClusterCount * 3);
+    clusterMax.resize(ClusterCount * 3);
+    clusterSphere.resize(ClusterCount * 4);
+    float tileWidth = (frustum.right - frustum.left) / TilesX;
+    float tileHeight = (frustum.top - frustum.bottom) / TilesY;
+    for (int slice = 0; slice < Slices; slice++) {
+        float d0 = frustum.nearPlane * std::pow(frustum.farPlane / frustum.nearPlane, float(slice) / Slices);
+        float d1 = frustum.nearPlane * std::pow(frustum.farPlane / frustum.nearPlane, float(slice + 1) / Slices);
+        for (int ty = 0; ty < TilesY; ty++) {
+            for (int tx = 0; tx < TilesX; tx++) {
+                int cluster = (slice * TilesY + ty) * TilesX + tx;
+                // Tile edges are planes through the eye, so the extremes lie on the slice's depth bounds
+                float x0 = frustum.left + tx * tileWidth, x1 = x0 + tileWidth;
+                float y0 = frustum.bottom + ty * tileHeight, y1 = y0 + tileHeight;
+                float* mn = &clusterMin[cluster * 3];
+                float* mx = &clusterMax[cluster * 3];
+                mn[0] = std::min(x0 * d0, x0 * d1) / frustum.nearPlane;
+                mx[0] = std::max(x1 * d0, x1 * d1) / frustum.nearPlane;
+                mn[1] = std::min(y0 * d0, y0 * d1) / frustum.nearPlane;
+                mx[1] = std::max(y1 * d0, y1 * d1) / frustum.nearPlane;
+                mn[2] = -d1;
+                mx[2] = -d0;
+
+                float* sphere = &clusterSphere[cluster * 4];
+                float radiusSq = 0.0f;
+                for (int i = 0; i < 3; i++) {
+                    sphere[i] = (mn[i] + mx[i]) * 0.5f;
+                    float half = (mx[i] - mn[i]) * 0.5f;
+                    radiusSq += half * half;
+                }
+                sphere[3] = std::sqrt(radiusSq);
+            }
+        }
+    }
+}
+
+int LightClusters::sliceOf(float depth) const {
+    int slice = static_cast<int>(std::floor(std::log(depth / frustum.nearPlane) * sliceScale));
+    return std::min(std::max(slice, 0), Slices - 1);
+}
+
+bool LightClusters::clusterRange(const float center[3], float radius, int lo[3], int hi[3]) const {
+    float depthMin = -center[2] - radius;
+    float depthMax = -center[2] + radius;
+    if (depthMax < frustum.nearPlane || depthMin > frustum.farPlane) return false;
+    depthMin = std::max(depthMin, frustum.nearPlane);
+    depthMax = std::min(depthMax, frustum.farPlane);
+    lo[2] = sliceOf(depthMin);
+    hi[2] = sliceOf(depthMax);
+
+    // x / depth over the sphere's box is extreme at its corners
+    const float extentMin[2] = {frustum.left, frustum.bottom};
+    const float extentMax[2] = {frustum.right, frustum.top};
+    const int tiles[2] = {TilesX, TilesY};
+    for (int axis = 0; axis < 2; axis++) {
+        float a = center[axis] - radius, b = center[axis] + radius;
+        float projMin = std::min(std::min(a / depthMin, a / depthMax), std::min(b / depthMin, b / depthMax));
+        float projMax = std::max(std::max(a / depthMin, a / depthMax), std::max(b / depthMin, b / depthMax));
+        projMin *= frustum.nearPlane;
+        projMax *= frustum.nearPlane;
+        if (projMax < extentMin[axis] || projMin > extentMax[axis]) return false;
+        float scale = tiles[axis] / (extentMax[axis] - extentMin[axis]);
+        lo[axis] = std::max(0, static_cast<int>(std::floor((projMin - extentMin[axis]) * scale)));
+        hi[axis] = std::min(tiles[axis] - 1, static_cast<int>(std::floor((projMax - extentMin[axis]) * scale)));
+    }
+    return true;
+}
+
+bool LightClusters::sphereTouchesCluster(const float center[3], float radius, int cluster) const {
+    const float* mn = &clusterMin[cluster * 3];
+    const float* mx = &clusterMax[cluster * 3];
+    float distanceSq = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float v = std::min(std::max(center[i], mn[i]), mx[i]) - center[i];
+        distanceSq += v * v;
+    }
+    return distanceSq <= radius * radius;
+}
+
+bool LightClusters::coneTouchesCluster(const Shape& shape, int cluster) const {
+    // Cone against the cluster's bounding sphere
+    const float* sphere = &clusterSphere[cluster * 4];
+    float v[3] = {sphere[0] - shape.position[0], sphere[1] - shape.position[1], sphere[2] - shape.position[2]};
+    float lengthSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    float along = v[0] * shape.direction[0] + v[1] * shape.direction[1] + v[2] * shape.direction[2];
+    float across = std::sqrt(std::max(lengthSq - along * along, 0.0f));
+    float distanceToCone = shape.cosCutoff * across - along * shape.sinCutoff;
+    return distanceToCone <= sphere[3] && along <= sphere[3] + shape.range && along >= -sphere[3];
+}
+
+void LightClusters::build(const std::vector<LightProperties>& lights, const std::vector<bool>& active) {
+    shapes.resize(lights.size());
+    globalLights.clear();
+    pairs.clear();
+    stats = Stats();
+
+    for (size_t index = 0; index < lights.size(); index++) {
+        if (!active[index]) continue;
+        const LightProperties& light = lights[index];
+        Shape& shape = shapes[index];
+        stats.lights++;
+
+        shape.intensity = std::max(maxChannel(light.diffuse, 1.0f), maxChannel(light.specular, 0.0f));
+        shape.attenuation[0] = light.constantAttenuation >= 0.0f ? light.constantAttenuation : 1.0f;
+        shape.attenuation[1] = light.linearAttenuation >= 0.0f ? light.linearAttenuation : 0.0f;
+        shape.attenuation[2] = light.quadraticAttenuation >= 0.0f ? light.quadraticAttenuation : 0.0f;
+
+        // Distance where intensity / (c + l d + q d^2) falls to the cutoff
+        float c = shape.attenuation[0] - shape.intensity / CutoffFraction;
+        float l = shape.attenuation[1], q = shape.attenuation[2];
+        if (c >= 0.0f) shape.range = 0.0f;
+        else if (q > 0.0f) shape.range = (-l + std::sqrt(l * l - 4.0f * q * c)) / (2.0f * q);
+        else if (l > 0.0f) shape.range = -c / l;
+        else shape.range = Infinity;
+
+        // Missing position is GL's default directional light along +z
+        bool directional = light.position.size() < 3 || (light.position.size() == 4 && light.position[3] == 0.0f);
+        for (int i = 0; i < 3; i++) {
+            shape.position[i] = light.position.size() >= 3 ? light.position[i] : 0.0f;
+        }
+
+        shape.spot = !directional && light.spotCutoff >= 0.0f && light.spotCutoff < 180.0f;
+        float direction[3] = {0.0f, 0.0f, -1.0f};
+        if (light.spotDirection.size() >= 3) {
+            std::copy(light.spotDirection.begin(), light.spotDirection.begin() + 3, direction);
+        }
+        float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+        for (int i = 0; i < 3; i++) {
+            shape.direction[i] = length > 0.0f ? direction[i] / length : (i == 2 ? -1.0f : 0.0f);
+        }
+        float cutoff = (shape.spot ? light.spotCutoff : 180.0f) * 3.14159265f / 180.0f;
+        shape.cosCutoff = std::cos(cutoff);
+        shape.sinCutoff = std::sin(cutoff);
+
+        shape.global = directional || shape.range == Infinity;
+        if (shape.global) {
+            globalLights.push_back(static_cast<uint32_t>(index));
+            continue;
+        }
+        if (shape.range <= 0.0f) continue;
+
+        int lo[3], hi[3];
+        if (!clusterRange(shape.position, shape.range, lo, hi)) continue;
+        for (int slice = lo[2]; slice <= hi[2]; slice++) {
+            for (int ty = lo[1]; ty <= hi[1]; ty++) {
+                for (int tx = lo[0]; tx <= hi[0]; tx++) {
+                    int cluster = (slice * TilesY + ty) * TilesX + tx;
+                    if (!sphereTouchesCluster(shape.position, shape.range, cluster)) continue;
+                    if (shape.spot && !coneTouchesCluster(shape, cluster)) continue;
+                    pairs.push_back((static_cast<uint64_t>(cluster) << 32) | index);
+                }
+            }
+        }
+    }
+    stats.globalLights = globalLights.size();
+
+    // Counting sort of the pairs by cluster, keeping light order within each cluster
+    std::fill(clusterCounts.begin(), clusterCounts.end(), 0);
+    for (uint64_t pair : pairs) {
+        clusterCounts[pair >> 32]++;
+    }
+    uint32_t offset = 0;
+    for (int cluster = 0; cluster < ClusterCount; cluster++) {
+        clusterOffsets[cluster] = offset;
+        offset += clusterCounts[cluster];
+        if (clusterCounts[cluster] > 0) stats.occupiedClusters++;
+        stats.maxPerCluster = std::max<size_t>(stats.maxPerCluster, clusterCounts[cluster]);
+    }
+    lightIndices.resize(pairs.size());
+    clusterCursor.assign(clusterOffsets.begin(), clusterOffsets.end());
+    for (uint64_t pair : pairs) {
+        lightIndices[clusterCursor[pair >> 32]++] = static_cast<uint32_t>(pair);
+    }
+    lightStamp.assign(lights.size(), 0);
+    stampValue = 0;
+    stats.references = pairs.size();
+}
+
+float LightClusters::score(const Shape& shape, const float center[3], float radius) const {
+    if (shape.global) {
+        return shape.intensity / std::max(shape.attenuation[0], CutoffFraction);
+    }
+    float d[3] = {center[0] - shape.position[0], center[1] - shape.position[1], center[2] - shape.position[2]};
+    float distance = std::max(std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) - radius, 0.0f);
+    return shape.intensity /
+           (shape.attenuation[0] + shape.attenuation[1] * distance + shape.attenuation[2] * distance * distance);
+}
+
+void LightClusters::selectLights(const CFrame& cframe, const Bounds& bounds, size_t maxLights,
+                                 std::vector<uint32_t>& out) {
+    // World-space bounding sphere
+    float local[3], radiusSq = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        local[i] = (bounds.min[i] + bounds.max[i]) * 0.5f;
+        float half = (bounds.max[i] - bounds.min[i]) * 0.5f;
+        radiusSq += half * half;
+    }
+    float radius = std::sqrt(radiusSq);
+    float center[3];
+    cframe.transformPoint(local, center);
+
+    if (++stampValue == 0) {
+        std::fill(lightStamp.begin(), lightStamp.end(), 0);
+        stampValue = 1;
+    }
+    candidates.clear();
+    for (uint32_t light : globalLights) {
+        candidates.push_back({score(shapes[light], center, radius), light});
+    }
+
+    int lo[3], hi[3];
+    if (clusterRange(center, radius, lo, hi)) {
+        for (int slice = lo[2]; slice <= hi[2]; slice++) {
+            for (int ty = lo[1]; ty <= hi[1]; ty++) {
+                for (int tx = lo[0]; tx <= hi[0]; tx++) {
+                    int cluster = (slice * TilesY + ty) * TilesX + tx;
+                    if (clusterCounts[cluster] == 0 || !sphereTouchesCluster(center, radius, cluster)) continue;
+                    const uint32_t* lights = lightIndices.data() + clusterOffsets[cluster];
+                    for (uint32_t i = 0; i < clusterCounts[cluster]; i++) {
+                        uint32_t light = lights[i];
+                        if (lightStamp[light] == stampValue) continue;
+                        lightStamp[light] = stampValue;
+                        candidates.push_back({score(shapes[light], center, radius), light});
+                    }
+                }
+            }
+        }
+    }
+
+    size_t count = std::min(maxLights, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+                          return a.first > b.first;
+                      });
+    for (size_t i = 0; i < count; i++) {
+        out.push_back(candidates[i].second);
+    }
+}
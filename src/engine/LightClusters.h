@@ -0,0 +1,88 @@
+#pragma once
+
+#include "IRenderer.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Assigns lights to a 3D grid of clusters over the view frustum, so per-object light
+// selection only looks at lights that can reach the clusters an object overlaps.
+// The grid is regular in x/y (screen tiles) and exponential in depth.
+class LightClusters {
+public:
+    static const int TilesX = 16;
+    static const int TilesY = 16;
+    static const int Slices = 24;
+    static const int ClusterCount = TilesX * TilesY * Slices;
+
+    struct Stats {
+        size_t lights = 0;            // Active lights
+        size_t globalLights = 0;      // Directional or unattenuated, affecting every cluster
+        size_t occupiedClusters = 0;  // Clusters with at least one local light
+        size_t references = 0;        // Total (cluster, light) pairs
+        size_t maxPerCluster = 0;
+    };
+
+    LightClusters();
+
+    void setFrustum(const ViewFrustum& frustum);
+    const ViewFrustum& getFrustum() const { return frustum; }
+
+    // Rebuild the cluster lists. Lights with active[i] == false are skipped.
+    void build(const std::vector<LightProperties>& lights, const std::vector<bool>& active);
+
+    // Append up to maxLights indices of the lights that most affect an object with the
+    // given local bounds and world transform, strongest first
+    void selectLights(const CFrame& cframe, const Bounds& bounds, size_t maxLights, std::vector<uint32_t>& out);
+
+    // Lights affecting one cluster (local lights only; see getGlobalLights)
+    const uint32_t* getClusterLights(int cluster, uint32_t& count) const {
+        count = clusterCounts[cluster];
+        return lightIndices.data() + clusterOffsets[cluster];
+    }
+    const std::vector<uint32_t>& getGlobalLights() const { return globalLights; }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Culling shape derived from a light's properties
+    struct Shape {
+        float position[3];
+        float range;          // Distance where the light drops below 1/256 of its peak
+        float direction[3];   // Normalized spot direction
+        float cosCutoff;
+        float sinCutoff;
+        bool spot;
+        bool global;          // Directional or unattenuated
+        float intensity;      // Brightest diffuse/specular channel
+        float attenuation[3]; // Constant, linear, quadratic
+    };
+
+    // Cluster ranges overlapped by a view-space sphere; false if it misses the frustum
+    bool clusterRange(const float center[3], float radius, int lo[3], int hi[3]) const;
+    int sliceOf(float depth) const;
+    bool sphereTouchesCluster(const float center[3], float radius, int cluster) const;
+    bool coneTouchesCluster(const Shape& shape, int cluster) const;
+    float score(const Shape& shape, const float center[3], float radius) const;
+
+    ViewFrustum frustum;
+    float sliceScale;  // Slices / log(far / near)
+
+    // Per-cluster view-space bounds and bounding spheres, rebuilt when the frustum changes
+    std::vector<float> clusterMin, clusterMax;  // 3 floats per cluster
+    std::vector<float> clusterSphere;           // center xyz + radius per cluster
+
+    std::vector<Shape> shapes;               // Parallel to the light list
+    std::vector<uint32_t> globalLights;
+    std::vector<uint32_t> clusterCounts;     // Lights per cluster
+    std::vector<uint32_t> clusterOffsets;    // Start of each cluster's run in lightIndices
+    std::vector<uint32_t> lightIndices;
+    std::vector<uint64_t> pairs;             // Scratch: cluster << 32 | light
+    std::vector<uint32_t> clusterCursor;     // Scratch for the counting sort
+
+    std::vector<uint32_t> lightStamp;        // Dedup for selectLights
+    uint32_t stampValue;
+    std::vector<std::pair<float, uint32_t>> candidates;
+
+    Stats stats;
+};
@@ -1,31 +1,503 @@
 #include "Luau3D.h"
+#include "CommandBuffer.h"
+#include "LuauBinding.h"
+#include "MeshBuilder.h"
+#include "MeshLoader.h"
 #include "lua.h"
 #include "lualib.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <cmath>
 #include <chrono>
+#include <cstring>
 
-// Global instance pointer for Lua functions
-static Luau3D* g_luau3d = nullptr;
+// Read an optional vertex format from the "format" field of the table at tableIndex.
+// Accepts a built-in layout name or an array of attribute descriptions.
+// Returns false (leaving layout untouched) if the field is absent.
+static bool readVertexLayout(lua_State* L, int tableIndex, VertexLayout& layout) {
+    lua_getfield(L, tableIndex, "format");
+    if (lua_isstring(L, -1)) {
+        const char* name = lua_tostring(L, -1);
+        if (!VertexLayout::fromName(name, layout)) {
+            luaL_error(L, "Unknown vertex format '%s'", name);
+        }
+        lua_pop(L, 1);
+        return true;
+    }
+    if (!lua_istable(L, -1)) {
+        lua_pop(L, 1);
+        return false;
+    }
+
+    static const char* attributeNames[] = {"position", "color", "normal", "joints", "weights"};
+    static const char* typeNames[] = {"f32", "f16", "unorm8", "snorm8", "int2_10_10_10"};
+
+    VertexLayout custom;
+    custom.clear();
+    int count = lua_objlen(L, -1);
+    for (int i = 1; i <= count; i++) {
+        lua_rawgeti(L, -1, i);
+        luaL_checktype(L, -1, LUA_TTABLE);
+
+        VertexAttributeDesc desc = {VertexAttribute::Position, VertexComponentType::Float32, 3, false, 0};
+        bool found = false;
+
+        lua_getfield(L, -1, "attribute");
+        const char* attribute = lua_tostring(L, -1);
+        for (int a = 0; attribute && a < 5; a++) {
+            if (strcmp(attribute, attributeNames[a]) == 0) {
+                desc.attribute = static_cast<VertexAttribute>(a);
+                found = true;
+            }
+        }
+        lua_pop(L, 1);
+        if (!found) {
+            luaL_error(L, "Vertex format entry %d has an unknown attribute", i);
+        }
+
+        found = false;
+        lua_getfield(L, -1, "type");
+        const char* type = lua_tostring(L, -1);
+        for (int t = 0; type && t < 5; t++) {
+            if (strcmp(type, typeNames[t]) == 0) {
+                desc.type = static_cast<VertexComponentType>(t);
+                found = true;
+            }
+        }
+        lua_pop(L, 1);
+        if (!found) {
+            luaL_error(L, "Vertex format entry %d has an unknown type", i);
+        }
+
+        lua_getfield(L, -1, "components");
+        desc.components = static_cast<uint8_t>(lua_isnumber(L, -1) ? lua_tointeger(L, -1) : 3);
+        lua_pop(L, 1);
+
+        lua_getfield(L, -1, "normalized");
+        desc.normalized = lua_toboolean(L, -1) != 0;
+        lua_pop(L, 1);
+
+        lua_getfield(L, -1, "offset");
+        desc.offset = static_cast<uint16_t>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+
+        if (!custom.addAttribute(desc)) {
+            luaL_error(L, "Vertex format entry %d is invalid", i);
+        }
+        lua_pop(L, 1); // Pop attribute table
+    }
+
+    lua_getfield(L, -1, "stride");
+    if (lua_isnumber(L, -1)) {
+        custom.setStride(static_cast<uint32_t>(lua_tointeger(L, -1)));
+    }
+    lua_pop(L, 1);
+
+    if (!custom.find(VertexAttribute::Position)) {
+        luaL_error(L, "Vertex format must contain a position attribute");
+    }
+    std::string error;
+    if (!custom.validate(error)) {
+        luaL_error(L, "Invalid vertex format: %s", error.c_str());
+    }
+    lua_pop(L, 1); // Pop format table
+    layout = custom;
+    return true;
+}
+
+// Registry names of the userdata metatables
+static const char* MeshMetatable = "luau3d.Mesh";
+static const char* ModelMetatable = "luau3d.Model";
+
+// The userdata block at index if its metatable is the one registered under name
+static void* toObject(lua_State* L, int index, const char* name) {
+    void* block = lua_touserdata(L, index);
+    if (!block || lua_islightuserdata(L, index) || !lua_getmetatable(L, index)) {
+        return nullptr;
+    }
+    luaL_getmetatable(L, name);
+    bool matches = lua_rawequal(L, -1, -2) != 0;
+    lua_pop(L, 2);
+    return matches ? block : nullptr;
+}
+
+// Push the metatable registered under name, creating it on first use. __handle returns
+// the number a userdata stands for, so traces can record it.
+static void pushObjectMetatable(lua_State* L, const char* name, const char* typeName, lua_CFunction handle) {
+    if (luaL_newmetatable(L, name)) {
+        lua_pushstring(L, typeName);
+        lua_setfield(L, -2, "__type");
+        lua_pushcfunction(L, handle, "__handle");
+        lua_setfield(L, -2, "__handle");
+        lua_setreadonly(L, -1, 1);
+    }
+}
+
+static int meshObjectHandle(lua_State* L) {
+    auto* object = static_cast<ScriptObjects::MeshObject*>(toObject(L, 1, MeshMetatable));
+    if (!object) return 0;
+    lua_pushinteger(L, object->objects->isCurrent(*object) ? static_cast<lua_Integer>(object->handle) : -1);
+    return 1;
+}
+
+static void destroyMeshObject(void* block) {
+    auto* object = static_cast<ScriptObjects::MeshObject*>(block);
+    if (object->objects->isCurrent(*object)) {
+        object->objects->releaseMesh(object->handle);
+    }
+    object->~MeshObject();
+}
+
+// Push a Mesh userdata that releases handle when it is collected
+static void pushMeshObject(lua_State* L, Luau3D* instance, size_t handle) {
+    void* block = lua_newuserdatadtor(L, sizeof(ScriptObjects::MeshObject), destroyMeshObject);
+    std::shared_ptr<ScriptObjects> objects = instance->getScriptObjects();
+    uint32_t generation = objects->meshGenerations[handle];
+    new (block) ScriptObjects::MeshObject{static_cast<uint32_t>(handle), generation, std::move(objects)};
+    pushObjectMetatable(L, MeshMetatable, "Mesh", meshObjectHandle);
+    lua_setmetatable(L, -2);
+}
+
+// Read a mesh argument, a Mesh userdata or a plain handle, without validating it.
+// Userdata whose handle was released read as -1.
+static int toMeshHandle(lua_State* L, int index) {
+    if (auto* object = static_cast<ScriptObjects::MeshObject*>(toObject(L, index, MeshMetatable))) {
+        return object->objects->isCurrent(*object) ? static_cast<int>(object->handle) : -1;
+    }
+    return luaL_checkinteger(L, index);
+}
+
+// Resolve a mesh argument, raising a Lua error if it is invalid
+static std::shared_ptr<Mesh> checkMesh(lua_State* L, Luau3D* instance, int index) {
+    int handle = toMeshHandle(L, index);
+    std::shared_ptr<Mesh> mesh = handle >= 0 ? instance->getMesh(static_cast<size_t>(handle)) : nullptr;
+    if (!mesh) {
+        luaL_error(L, "Invalid mesh handle %d", handle);
+    }
+    return mesh;
+}
+
+// Read an optional number field from the table at tableIndex
+static float getNumberField(lua_State* L, int tableIndex, const char* field, float defaultValue) {
+    lua_getfield(L, tableIndex, field);
+    float result = lua_isnumber(L, -1) ? static_cast<float>(lua_tonumber(L, -1)) : defaultValue;
+    lua_pop(L, 1);
+    return result;
+}
+
+// Read an optional boolean field from the table at tableIndex
+static bool getBooleanField(lua_State* L, int tableIndex, const char* field, bool defaultValue) {
+    lua_getfield(L, tableIndex, field);
+    bool result = lua_isboolean(L, -1) ? lua_toboolean(L, -1) != 0 : defaultValue;
+    lua_pop(L, 1);
+    return result;
+}
+
+// Convert a segment count, raising a Lua error above MeshBuilder::MaxSegments
+static int checkSegments(lua_State* L, float value, const char* field) {
+    if (!(value <= MeshBuilder::MaxSegments)) {
+        luaL_error(L, "'%s' must be at most %d", field, MeshBuilder::MaxSegments);
+        return 0;
+    }
+    return static_cast<int>(std::max(value, 0.0f));
+}
+
+// Read up to count numbers from an optional array field into out
+static void getArrayField(lua_State* L, int tableIndex, const char* field, float* out, int count) {
+    lua_getfield(L, tableIndex, field);
+    if (lua_istable(L, -1)) {
+        for (int i = 0; i < count; i++) {
+            lua_rawgeti(L, -1, i + 1);
+            if (lua_isnumber(L, -1)) {
+                out[i] = static_cast<float>(lua_tonumber(L, -1));
+            }
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+}
+
+// Read the {x, y, z} array argument at index
+static void checkVector3(lua_State* L, int index, float out[3]) {
+    luaL_checktype(L, index, LUA_TTABLE);
+    for (int i = 0; i < 3; i++) {
+        lua_rawgeti(L, index, i + 1);
+        out[i] = static_cast<float>(luaL_checknumber(L, -1));
+        lua_pop(L, 1);
+    }
+}
+
+// Make the optional options argument at index a table, substituting an empty one
+static void checkOptionsTable(lua_State* L, int index) {
+    if (lua_isnoneornil(L, index)) {
+        lua_settop(L, index - 1);
+        lua_newtable(L);
+    }
+    luaL_checktype(L, index, LUA_TTABLE);
+}
+
+// Read generator options shared by all mesh builders from the table at tableIndex
+static void readMeshBuildOptions(lua_State* L, int tableIndex, MeshBuildOptions& options) {
+    options.smooth = getBooleanField(L, tableIndex, "smooth", true);
+    readVertexLayout(L, tableIndex, options.layout);
+
+    VertexColorFunction& color = options.color;
+    lua_getfield(L, tableIndex, "color");
+    if (lua_isstring(L, -1)) {
+        const char* mode = lua_tostring(L, -1);
+        if (strcmp(mode, "normal") == 0) {
+            color.mode = VertexColorFunction::Mode::Normal;
+        } else if (strcmp(mode, "position") == 0) {
+            color.mode = VertexColorFunction::Mode::Position;
+        } else {
+            luaL_error(L, "Unknown color function '%s'", mode);
+        }
+    } else if (lua_istable(L, -1)) {
+        int colorIndex = lua_gettop(L);
+        lua_getfield(L, colorIndex, "from");
+        bool gradient = lua_istable(L, -1);
+        lua_pop(L, 1);
+        if (gradient) {
+            color.mode = VertexColorFunction::Mode::Gradient;
+            getArrayField(L, colorIndex, "from", color.colorA, 3);
+            getArrayField(L, colorIndex, "to", color.colorB, 3);
+            lua_getfield(L, colorIndex, "axis");
+            const char* axis = lua_isstring(L, -1) ? lua_tostring(L, -1) : "y";
+            color.axis = axis[0] == 'x' ? 0 : (axis[0] == 'z' ? 2 : 1);
+            lua_pop(L, 1);
+        } else {
+            color.mode = VertexColorFunction::Mode::Constant;
+            for (int i = 0; i < 3; i++) {
+                lua_rawgeti(L, colorIndex, i + 1);
+                color.colorA[i] = static_cast<float>(lua_tonumber(L, -1));
+                lua_pop(L, 1);
+            }
+        }
+    }
+    lua_pop(L, 1);
+}
+
+// Report a finished mesh load and its throughput
+static void logMeshLoad(const std::string& path, const MeshLoadResult& result) {
+    if (!result.mesh) {
+        std::cerr << "Failed to load mesh " << path << ": " << result.error << std::endl;
+        return;
+    }
+    double megabytes = result.sourceBytes / (1024.0 * 1024.0);
+    std::cout << "Loaded mesh " << path << (result.mapped ? " (mapped)" : "") << ": "
+              << megabytes << " MB in " << result.seconds * 1000.0 << " ms ("
+              << (result.seconds > 0.0 ? megabytes / result.seconds : 0.0) << " MB/s)" << std::endl;
+    const MeshOptimizer::Report& optimization = result.optimization;
+    if (optimization.optimized) {
+        std::cout << "  Optimized: ACMR " << optimization.before.acmr << " -> " << optimization.after.acmr
+                  << ", ATVR " << optimization.before.atvr << " -> " << optimization.after.atvr;
+        if (optimization.droppedVertices > 0) {
+            std::cout << ", " << optimization.droppedVertices << " unused vertices dropped";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Read the position/look/up/right vectors of the CFrame table at tableIndex
+static void readCFrame(lua_State* L, int tableIndex, CFrame& cframe) {
+    getArrayField(L, tableIndex, "position", cframe.position, 3);
+    getArrayField(L, tableIndex, "look", cframe.look, 3);
+    getArrayField(L, tableIndex, "up", cframe.up, 3);
+    getArrayField(L, tableIndex, "right", cframe.right, 3);
+}
+
+// Push a CFrame as a table of position/look/up/right vectors
+static void pushCFrame(lua_State* L, const CFrame& cframe) {
+    auto pushVector = [L](const char* field, const float* vec) {
+        lua_createtable(L, 3, 0);
+        for (int i = 0; i < 3; i++) {
+            lua_pushnumber(L, vec[i]);
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_setfield(L, -2, field);
+    };
+    lua_createtable(L, 0, 4);
+    pushVector("position", cframe.position);
+    pushVector("look", cframe.look);
+    pushVector("up", cframe.up);
+    pushVector("right", cframe.right);
+}
+
+static int modelObjectHandle(lua_State* L) {
+    auto* object = static_cast<ScriptObjects::ModelObject*>(toObject(L, 1, ModelMetatable));
+    if (!object || object->row == ScriptObjects::NoRow) return 0;
+    lua_pushinteger(L, static_cast<lua_Integer>(object->row));
+    return 1;
+}
+
+static void destroyModelObject(void* block) {
+    auto* object = static_cast<ScriptObjects::ModelObject*>(block);
+    if (object->row != ScriptObjects::NoRow) {
+        object->objects->modelObjects[object->row] = nullptr;
+        object->objects->collectedRows.push_back(object->row);
+    }
+    object->~ModelObject();
+}
+
+// Push a Model userdata that removes the model at row when it is collected
+static void pushModelObject(lua_State* L, Luau3D* instance, size_t row) {
+    const std::shared_ptr<ScriptObjects>& objects = instance->getScriptObjects();
+    void* block = lua_newuserdatadtor(L, sizeof(ScriptObjects::ModelObject), destroyModelObject);
+    auto* object = new (block) ScriptObjects::ModelObject{static_cast<uint32_t>(row), objects};
+    objects->modelObjects[row] = object;
+    pushObjectMetatable(L, ModelMetatable, "Model", modelObjectHandle);
+    lua_setmetatable(L, -2);
+}
+
+// Read a model argument, a Model userdata or a plain index, without range checking it
+static int toModelIndex(lua_State* L, int index) {
+    if (auto* object = static_cast<ScriptObjects::ModelObject*>(toObject(L, index, ModelMetatable))) {
+        if (object->row == ScriptObjects::NoRow) {
+            luaL_error(L, "Model was removed");
+        }
+        return static_cast<int>(object->row);
+    }
+    return luaL_checkinteger(L, index);
+}
+
+// Resolve a model argument, raising a Lua error if it is out of range
+static size_t checkModel(lua_State* L, Luau3D* instance, int index) {
+    int model = toModelIndex(L, index);
+    if (model < 0 || static_cast<size_t>(model) >= instance->getModelCount()) {
+        luaL_error(L, "Invalid model index %d", model);
+    }
+    return static_cast<size_t>(model);
+}
+
+// Resolve a skeleton handle argument, raising a Lua error if it is invalid
+static std::shared_ptr<Skeleton> checkSkeleton(lua_State* L, Luau3D* instance, int index) {
+    int handle = luaL_checkinteger(L, index);
+    std::shared_ptr<Skeleton> skeleton = handle >= 0 ? instance->getSkeleton(static_cast<size_t>(handle)) : nullptr;
+    if (!skeleton) {
+        luaL_error(L, "Invalid skeleton handle %d", handle);
+    }
+    return skeleton;
+}
+
+// Resolve an animation clip handle argument, raising a Lua error if it is invalid
+static std::shared_ptr<AnimationClip> checkAnimationClip(lua_State* L, Luau3D* instance, int index) {
+    int handle = luaL_checkinteger(L, index);
+    std::shared_ptr<AnimationClip> clip = handle >= 0 ? instance->getAnimationClip(static_cast<size_t>(handle)) : nullptr;
+    if (!clip) {
+        luaL_error(L, "Invalid animation clip handle %d", handle);
+    }
+    return clip;
+}
+
+// Read an optional array of numbers in field of the table at tableIndex
+static void getNumberArrayField(lua_State* L, int tableIndex, const char* field, std::vector<float>& out) {
+    out.clear();
+    lua_getfield(L, tableIndex, field);
+    if (lua_istable(L, -1)) {
+        int count = lua_objlen(L, -1);
+        out.reserve(count);
+        for (int i = 1; i <= count; i++) {
+            lua_rawgeti(L, -1, i);
+            out.push_back(static_cast<float>(lua_tonumber(L, -1)));
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+}
+
+// Resolve a component name argument, raising a Lua error if it was never defined
+static int checkComponent(lua_State* L, ModelStore& models, int index) {
+    const char* name = luaL_checkstring(L, index);
+    int id = models.findComponent(name);
+    if (id < 0) {
+        luaL_error(L, "Unknown component '%s'", name);
+    }
+    return id;
+}
+
+// Read the component mask of an optional array of component names in field of the table at tableIndex
+static uint64_t readComponentMask(lua_State* L, ModelStore& models, int tableIndex, const char* field) {
+    uint64_t mask = 0;
+    lua_getfield(L, tableIndex, field);
+    if (lua_istable(L, -1)) {
+        int count = lua_objlen(L, -1);
+        for (int i = 1; i <= count; i++) {
+            lua_rawgeti(L, -1, i);
+            mask |= uint64_t(1) << checkComponent(L, models, lua_gettop(L));
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+    return mask;
+}
+
+// Register a generated mesh and push a Mesh userdata for it
+static int pushNewMesh(lua_State* L, Luau3D* instance, std::shared_ptr<Mesh> mesh) {
+    if (!mesh) {
+        luaL_error(L, "Failed to generate mesh");
+        return 0;
+    }
+    pushMeshObject(L, instance, instance->addMesh(std::move(mesh)));
+    return 1;
+}
 
-Luau3D::Luau3D(IGUI* gui, IRenderer* renderer) : gui(gui), renderer(renderer), beforeRenderCallbackRef(LUA_NOREF) {
-    g_luau3d = this;
+Luau3D::Luau3D(IGUI* gui, IRenderer* renderer, ThreadPool* threadPool)
+    : gui(gui), renderer(renderer), lightsDirty(false), objects(std::make_shared<ScriptObjects>()),
+      threadPool(threadPool), yieldSequence(0), capture(threadPool),
+      occlusionCuller(threadPool), occlusionEnabled(true), damageEnabled(true), skinner(threadPool),
+      tweenCallbackRef(LUA_NOREF), collisions(threadPool), collisionCallbackRef(LUA_NOREF), raycaster(threadPool),
+      particles(threadPool), beforeRenderCallbackRef(LUA_NOREF), fixedDeltaTime(0.0) {
     lastDeltaTime = std::chrono::steady_clock::now();
+    lastTweenTime = lastDeltaTime;
+    lastParticleTime = lastDeltaTime;
 }
 
 Luau3D::~Luau3D() {
-    if (g_luau3d == this) {
-        g_luau3d = nullptr;
-    }
+    // Userdata collected after this (lua_close) must not queue rows for removal
+    objects->clearRows();
 }
 
 Luau3D* Luau3D::getInstance(lua_State* L) {
-    if (!g_luau3d) {
+    Luau3D* instance = static_cast<Luau3D*>(LuauBinding::getModule(L));
+    if (!instance) {
         luaL_error(L, "Luau3D instance not initialized");
         return nullptr;
     }
-    return g_luau3d;
+    return instance;
+}
+
+int Luau3D::yieldForWork(lua_State* L, std::function<void()> work, std::function<int(lua_State*)> resume) {
+    if (!lua_isyieldable(L)) {
+        luaL_error(L, "Async functions must be called from a coroutine");
+        return 0;
+    }
+
+    // Pin the coroutine in the registry until it is resumed
+    lua_pushthread(L);
+    int threadRef = lua_ref(L, -1);
+    lua_pop(L, 1);
+
+    // Tag this yield so a stale completion cannot resume a later, unrelated yield
+    void* token = reinterpret_cast<void*>(++yieldSequence);
+    lua_setthreaddata(L, token);
+
+    threadPool->submit(std::move(work), [L, threadRef, token, resume]() {
+        if (lua_status(L) != LUA_YIELD || lua_getthreaddata(L) != token) {
+            // The coroutine was closed or resumed by the script in the meantime
+            lua_unref(L, threadRef);
+            return;
+        }
+        lua_setthreaddata(L, nullptr);
+        int resultCount = resume(L);
+        int status = lua_resume(L, nullptr, resultCount);
+        if (status != LUA_OK && status != LUA_YIELD) {
+            std::cerr << "Error in resumed coroutine: " << lua_tostring(L, -1) << std::endl;
+            lua_pop(L, 1);
+        }
+        lua_unref(L, threadRef);
+    });
+    return lua_yield(L, 0);
 }
 
 int Luau3D::setClearColor(lua_State* L) {
@@ -38,6 +510,7 @@ int Luau3D::setClearColor(lua_State* L) {
     float a = static_cast<float>(lua_tonumber(L, 4));
     
     instance->renderer->setClearColor(r, g, b, a);
+    instance->damage.invalidate();
     return 0;
 }
 
@@ -45,6 +518,11 @@ int Luau3D::getDeltaTime(lua_State* L) {
     Luau3D* instance = getInstance(L);
     if (!instance) return 0;
     
+    if (instance->fixedDeltaTime > 0.0) {
+        lua_pushnumber(L, instance->fixedDeltaTime);
+        return 1;
+    }
+
     auto now = std::chrono::steady_clock::now();
     auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - instance->lastDeltaTime);
     instance->lastDeltaTime = now;
@@ -65,14 +543,63 @@ int Luau3D::isRunning(lua_State* L) {
 int Luau3D::present(lua_State* L) {
     Luau3D* instance = getInstance(L);
     if (!instance) return 0;
-    
-    instance->gui->pumpMessages();
-    instance->renderer->beginFrame();
-    instance->renderer->clear();
-    instance->callBeforeRenderCallback(L);
-    instance->renderer->render(instance->models);
-    instance->renderer->endFrame();
-    
+
+    instance->presentFrame(L);
+    return 0;
+}
+
+void Luau3D::presentFrame(lua_State* L) {
+    gui->pumpMessages();
+    collectScriptObjects();
+    // Swap in meshes and resume coroutines finished by background work, as one batch
+    // per frame, before anything draws
+    threadPool->runCompletions();
+    callBeforeRenderCallback(L);
+    advanceTweens(L);
+    sceneGraph.update(models);
+    skinner.update(models, dirtyMeshes);
+    advanceParticles();
+    updateTerrains();
+    updateCollisions(L);
+    models.collectDrawItems(drawItems);
+    cullTerrains();
+    cullOccluded();
+
+    // Changed lights shade everything, and captures need a complete frame
+    if (!damageEnabled || lightsDirty || capture.wantsFrame()) {
+        damage.invalidate();
+    }
+    if (!damage.update(models, drawItems, renderer->getBufferAge())) {
+        return;  // Nothing changed; the window already shows this frame
+    }
+    assignLights();
+
+    flushMeshUpdates();
+    renderer->setDamage(damage.getRects());
+    renderer->beginFrame();
+    renderer->clear();
+    renderer->render(drawItems);
+    capture.captureFrame(renderer);
+    renderer->endFrame();
+}
+
+int Luau3D::submit(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    luaL_checktype(L, 1, LUA_TBUFFER);
+    size_t size = 0;
+    const uint8_t* data = static_cast<const uint8_t*>(lua_tobuffer(L, 1, &size));
+    lua_Integer count = luaL_checkinteger(L, 2);
+    if (count < 0) {
+        luaL_error(L, "Command count must not be negative");
+        return 0;
+    }
+    std::string error;
+    if (!instance->applyCommands(data, size, static_cast<size_t>(count), error)) {
+        luaL_error(L, "%s", error.c_str());
+        return 0;
+    }
     return 0;
 }
 
@@ -83,20 +610,29 @@ int Luau3D::addModel(lua_State* L) {
     // Get the model properties table
     luaL_checktype(L, 1, LUA_TTABLE);
     
-    // Get vertices
-    lua_getfield(L, 1, "vertices");
-    luaL_checktype(L, -1, LUA_TTABLE);
-    int len = lua_objlen(L, -1);
-    
+    // Get geometry: a mesh handle, or a vertex array
+    std::shared_ptr<Mesh> mesh;
+    lua_getfield(L, 1, "mesh");
+    if (!lua_isnil(L, -1)) {
+        mesh = checkMesh(L, instance, -1);
+    }
+    lua_pop(L, 1);
+
     std::vector<float> vertices;
-    vertices.reserve(len);
-    
-    for (int i = 1; i <= len; i++) {
-        lua_rawgeti(L, -1, i);
-        vertices.push_back(static_cast<float>(lua_tonumber(L, -1)));
-        lua_pop(L, 1);
+    if (!mesh) {
+        lua_getfield(L, 1, "vertices");
+        luaL_checktype(L, -1, LUA_TTABLE);
+        int len = lua_objlen(L, -1);
+        
+        vertices.reserve(len);
+        
+        for (int i = 1; i <= len; i++) {
+            lua_rawgeti(L, -1, i);
+            vertices.push_back(static_cast<float>(lua_tonumber(L, -1)));
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1); // Pop vertices table
     }
-    lua_pop(L, 1); // Pop vertices table
     
     // Get visibility (optional)
     bool visible = true;
@@ -106,41 +642,77 @@ int Luau3D::addModel(lua_State* L) {
     }
     lua_pop(L, 1);
     
-    // Get CFrame (optional)
+    // Get CFrame (optional), relative to the parent model if there is one
     CFrame cframe;
     lua_getfield(L, 1, "cframe");
     if (lua_istable(L, -1)) {
-        // Helper function to get vector from table field
-        auto getVector = [L](const char* field, float* vec) {
-            lua_getfield(L, -1, field);
-            if (lua_istable(L, -1)) {
-                for (int i = 0; i < 3; i++) {
-                    lua_rawgeti(L, -1, i + 1);
-                    vec[i] = static_cast<float>(lua_tonumber(L, -1));
-                    lua_pop(L, 1);
-                }
-            }
-            lua_pop(L, 1);
-        };
-        
-        getVector("position", cframe.position);
-        getVector("look", cframe.look);
-        getVector("up", cframe.up);
-        getVector("right", cframe.right);
+        readCFrame(L, lua_gettop(L), cframe);
     }
     lua_pop(L, 1);
+
+    if (!mesh) {
+        // Get vertex format (optional)
+        VertexLayout layout;
+        readVertexLayout(L, 1, layout);
+        mesh = instance->geometry.intern(vertices, layout);
+    }
     
+    // Get parent model (optional)
+    int parent = -1;
+    lua_getfield(L, 1, "parent");
+    if (!lua_isnil(L, -1)) {
+        parent = static_cast<int>(checkModel(L, instance, -1));
+    }
+    lua_pop(L, 1);
+
+    // Get occluder flag (optional)
+    lua_getfield(L, 1, "occluder");
+    bool occluder = lua_toboolean(L, -1) != 0;
+    lua_pop(L, 1);
+
     // Add the model and return its index
-    size_t index = instance->addModel(vertices, visible, cframe);
+    size_t index = instance->addModel(mesh, visible, cframe);
+    if (parent >= 0) {
+        instance->setModelParent(index, parent, false);
+    }
+    if (occluder) {
+        instance->setModelOccluder(index, true);
+    }
     lua_pushinteger(L, static_cast<lua_Integer>(index));
     return 1;
 }
 
+int Luau3D::createModel(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    // Same properties as addModel; the userdata removes the model when it is collected
+    addModel(L);
+    size_t index = static_cast<size_t>(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    pushModelObject(L, instance, index);
+    return 1;
+}
+
+int Luau3D::getModelIndex(lua_State* L) {
+    auto* object = static_cast<ScriptObjects::ModelObject*>(toObject(L, 1, ModelMetatable));
+    if (!object) {
+        luaL_typeerror(L, 1, "Model");
+        return 0;
+    }
+    if (object->row == ScriptObjects::NoRow) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, static_cast<lua_Integer>(object->row));
+    }
+    return 1;
+}
+
 int Luau3D::removeModel(lua_State* L) {
     Luau3D* instance = getInstance(L);
     if (!instance) return 0;
     
-    size_t index = static_cast<size_t>(luaL_checkinteger(L, 1));
+    size_t index = static_cast<size_t>(toModelIndex(L, 1));
     instance->removeModel(index);
     return 0;
 }
@@ -157,7 +729,7 @@ int Luau3D::setModelVisible(lua_State* L) {
     Luau3D* instance = getInstance(L);
     if (!instance) return 0;
     
-    size_t index = static_cast<size_t>(luaL_checkinteger(L, 1));
+    size_t index = static_cast<size_t>(toModelIndex(L, 1));
     bool visible = lua_toboolean(L, 2) != 0;
     instance->setModelVisible(index, visible);
     return 0;
@@ -168,23 +740,33 @@ int Luau3D::updateModel(lua_State* L) {
     if (!instance) return 0;
     
     // Get model index
-    size_t index = static_cast<size_t>(luaL_checkinteger(L, 1));
+    size_t index = static_cast<size_t>(toModelIndex(L, 1));
     
     // Get the model properties table
     luaL_checktype(L, 2, LUA_TTABLE);
     
-    // Get vertices
-    lua_getfield(L, 2, "vertices");
-    luaL_checktype(L, -1, LUA_TTABLE);
-    int len = lua_objlen(L, -1);
-    
+    // Get geometry (optional): a mesh handle, or a vertex array
+    std::shared_ptr<Mesh> mesh;
+    lua_getfield(L, 2, "mesh");
+    if (!lua_isnil(L, -1)) {
+        mesh = checkMesh(L, instance, -1);
+    }
+    lua_pop(L, 1);
+
     std::vector<float> vertices;
-    vertices.reserve(len);
-    
-    for (int i = 1; i <= len; i++) {
-        lua_rawgeti(L, -1, i);
-        vertices.push_back(static_cast<float>(lua_tonumber(L, -1)));
-        lua_pop(L, 1);
+    bool hasVertices = false;
+    lua_getfield(L, 2, "vertices");
+    if (!mesh && lua_istable(L, -1)) {
+        int len = lua_objlen(L, -1);
+        
+        vertices.reserve(len);
+        
+        for (int i = 1; i <= len; i++) {
+            lua_rawgeti(L, -1, i);
+            vertices.push_back(static_cast<float>(lua_tonumber(L, -1)));
+            lua_pop(L, 1);
+        }
+        hasVertices = true;
     }
     lua_pop(L, 1); // Pop vertices table
     
@@ -196,49 +778,544 @@ int Luau3D::updateModel(lua_State* L) {
     }
     lua_pop(L, 1);
     
-    // Get CFrame (optional)
+    // Get CFrame (optional), relative to the parent model if there is one
     CFrame cframe;
     lua_getfield(L, 2, "cframe");
     if (lua_istable(L, -1)) {
-        // Helper function to get vector from table field
-        auto getVector = [L](const char* field, float* vec) {
-            lua_getfield(L, -1, field);
-            if (lua_istable(L, -1)) {
-                for (int i = 0; i < 3; i++) {
-                    lua_rawgeti(L, -1, i + 1);
-                    vec[i] = static_cast<float>(lua_tonumber(L, -1));
-                    lua_pop(L, 1);
-                }
-            }
-            lua_pop(L, 1);
-        };
-        
-        getVector("position", cframe.position);
-        getVector("look", cframe.look);
-        getVector("up", cframe.up);
-        getVector("right", cframe.right);
+        readCFrame(L, lua_gettop(L), cframe);
+    }
+    lua_pop(L, 1);
+
+    // Update the model; geometry is kept when neither mesh nor vertices are given
+    if (hasVertices) {
+        // Get vertex format (optional, defaults to the model's current format)
+        VertexLayout layout;
+        if (index < instance->models.size() && instance->models.getMesh(index)) {
+            layout = instance->models.getMesh(index)->layout;
+        }
+        readVertexLayout(L, 2, layout);
+        instance->updateModel(index, vertices, visible, cframe, layout);
+    } else {
+        instance->updateModel(index, mesh, visible, cframe);
+    }
+
+    // Get occluder flag (optional, unchanged when absent)
+    lua_getfield(L, 2, "occluder");
+    if (lua_isboolean(L, -1)) {
+        instance->setModelOccluder(index, lua_toboolean(L, -1) != 0);
     }
     lua_pop(L, 1);
-    
-    // Update the model
-    instance->updateModel(index, vertices, visible, cframe);
     return 0;
 }
 
-int Luau3D::setLight(lua_State* L) {
+int Luau3D::updateModelVertices(lua_State* L) {
     Luau3D* instance = getInstance(L);
     if (!instance) return 0;
-    
-    // Get light number (1-8)
-    int lightNum = luaL_checkinteger(L, 1) - 1;
-    if (lightNum < 0 || lightNum > 7) {
-        luaL_error(L, "Light number must be between 1 and 8");
+
+    size_t index = checkModel(L, instance, 1);
+    lua_Integer offset = luaL_checkinteger(L, 2);
+    const Mesh* mesh = instance->models.getMesh(index).get();
+    if (!mesh || offset < 0) {
+        luaL_error(L, "Model %d has no vertex %d", static_cast<int>(index), static_cast<int>(offset));
         return 0;
     }
+
+    // Source floats come from a buffer of f32 values as-is, or from an array
+    const size_t floatsPerVertex = mesh->layout.getSourceFloatsPerVertex();
+    const float* source = nullptr;
+    size_t floatCount = 0;
+    if (lua_isbuffer(L, 3)) {
+        size_t bufferSize = 0;
+        source = static_cast<const float*>(lua_tobuffer(L, 3, &bufferSize));
+        floatCount = bufferSize / sizeof(float);
+    } else {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        floatCount = lua_objlen(L, 3);
+        std::vector<float>& scratch = instance->vertexScratch;
+        scratch.resize(floatCount);
+        for (size_t i = 0; i < floatCount; i++) {
+            lua_rawgeti(L, 3, static_cast<int>(i + 1));
+            scratch[i] = static_cast<float>(lua_tonumber(L, -1));
+            lua_pop(L, 1);
+        }
+        source = scratch.data();
+    }
+    if (floatCount == 0 || floatCount % floatsPerVertex != 0) {
+        luaL_error(L, "Vertex data must hold a multiple of %d numbers", static_cast<int>(floatsPerVertex));
+        return 0;
+    }
+
+    size_t count = floatCount / floatsPerVertex;
+    if (!instance->updateModelVertices(index, static_cast<size_t>(offset), source, count)) {
+        luaL_error(L, "Vertices %d to %d are outside model %d's %d vertices", static_cast<int>(offset),
+                   static_cast<int>(offset + count - 1), static_cast<int>(index), static_cast<int>(mesh->vertexCount));
+        return 0;
+    }
+    return 0;
+}
+
+int Luau3D::setModelParent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    int parent = lua_isnoneornil(L, 2) ? -1 : static_cast<int>(checkModel(L, instance, 2));
+    bool keepWorld = lua_toboolean(L, 3) != 0;
+    if (!instance->setModelParent(index, parent, keepWorld)) {
+        luaL_error(L, "Cannot parent model %d to %d: it would create a cycle", static_cast<int>(index), parent);
+        return 0;
+    }
+    return 0;
+}
+
+int Luau3D::getModelParent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    int parent = instance->sceneGraph.getParent(checkModel(L, instance, 1));
+    if (parent < 0) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, parent);
+    }
+    return 1;
+}
+
+int Luau3D::setModelCFrame(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    CFrame cframe;
+    readCFrame(L, 2, cframe);
+    instance->setModelCFrame(index, cframe);
+    return 0;
+}
+
+int Luau3D::getModelWorldCFrame(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    pushCFrame(L, instance->getModelWorldCFrame(checkModel(L, instance, 1)));
+    return 1;
+}
+
+int Luau3D::defineComponent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const char* name = luaL_checkstring(L, 1);
+    const char* typeName = luaL_optstring(L, 2, "number");
+    ComponentType type;
+    if (strcmp(typeName, "number") == 0) {
+        type = ComponentType::Number;
+    } else if (strcmp(typeName, "vector") == 0) {
+        type = ComponentType::Vector;
+    } else if (strcmp(typeName, "tag") == 0) {
+        type = ComponentType::Tag;
+    } else {
+        luaL_error(L, "Unknown component type '%s'", typeName);
+        return 0;
+    }
+
+    if (instance->models.defineComponent(name, type) < 0) {
+        luaL_error(L, "Cannot define component '%s': name used with another type, or too many components", name);
+    }
+    return 0;
+}
+
+int Luau3D::setComponent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    int id = checkComponent(L, instance->models, 2);
+    float value[3] = {0.0f, 0.0f, 0.0f};
+    switch (instance->models.getComponentType(id)) {
+        case ComponentType::Number:
+            value[0] = static_cast<float>(luaL_checknumber(L, 3));
+            break;
+        case ComponentType::Vector:
+            luaL_checktype(L, 3, LUA_TTABLE);
+            for (int i = 0; i < 3; i++) {
+                lua_rawgeti(L, 3, i + 1);
+                value[i] = static_cast<float>(lua_tonumber(L, -1));
+                lua_pop(L, 1);
+            }
+            break;
+        case ComponentType::Tag:
+            break;
+    }
+    instance->models.setComponent(index, id, value);
+    return 0;
+}
+
+int Luau3D::getComponent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    int id = checkComponent(L, instance->models, 2);
+    const float* value = instance->models.getComponent(index, id);
+    if (!value) {
+        lua_pushnil(L);
+        return 1;
+    }
+    switch (instance->models.getComponentType(id)) {
+        case ComponentType::Number:
+            lua_pushnumber(L, value[0]);
+            break;
+        case ComponentType::Vector:
+            lua_createtable(L, 3, 0);
+            for (int i = 0; i < 3; i++) {
+                lua_pushnumber(L, value[i]);
+                lua_rawseti(L, -2, i + 1);
+            }
+            break;
+        case ComponentType::Tag:
+            lua_pushboolean(L, 1);
+            break;
+    }
+    return 1;
+}
+
+int Luau3D::removeComponent(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    instance->models.removeComponent(index, checkComponent(L, instance->models, 2));
+    return 0;
+}
+
+// Collect the rows matching the query table at index (plus extraRequired) into out
+static const std::vector<uint32_t>& runQuery(lua_State* L, ModelStore& models, int index,
+                                             uint64_t extraRequired, std::vector<uint32_t>& out) {
+    luaL_checktype(L, index, LUA_TTABLE);
+    uint64_t required = readComponentMask(L, models, index, "with") | extraRequired;
+    uint64_t excluded = readComponentMask(L, models, index, "without");
+    out.clear();
+    models.query(required, excluded, out);
+    return out;
+}
+
+int Luau3D::queryModels(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const std::vector<uint32_t>& rows = runQuery(L, instance->models, 1, 0, instance->queryRows);
+    lua_createtable(L, static_cast<int>(rows.size()), 0);
+    for (size_t i = 0; i < rows.size(); i++) {
+        lua_pushinteger(L, rows[i]);
+        lua_rawseti(L, -2, static_cast<int>(i + 1));
+    }
+    return 1;
+}
+
+int Luau3D::translateModels(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    int id = checkComponent(L, instance->models, 2);
+    if (instance->models.getComponentType(id) != ComponentType::Vector) {
+        luaL_error(L, "translateModels needs a vector component");
+        return 0;
+    }
+    float scale = static_cast<float>(luaL_optnumber(L, 3, 1.0));
+
+    // Offset each matching model's local position by its component value times scale
+    const std::vector<uint32_t>& rows = runQuery(L, instance->models, 1, uint64_t(1) << id, instance->queryRows);
+    for (uint32_t row : rows) {
+        const float* offset = instance->models.getComponent(row, id);
+        CFrame cframe = instance->sceneGraph.getLocalCFrame(row);
+        for (int i = 0; i < 3; i++) {
+            cframe.position[i] += offset[i] * scale;
+        }
+        instance->sceneGraph.setLocalCFrame(row, cframe);
+    }
+    return 0;
+}
+
+int Luau3D::setModelsVisible(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    bool visible = lua_toboolean(L, 2) != 0;
+    const std::vector<uint32_t>& rows = runQuery(L, instance->models, 1, 0, instance->queryRows);
+    for (uint32_t row : rows) {
+        instance->sceneGraph.setVisible(row, visible);
+    }
+    return 0;
+}
+
+int Luau3D::createBoxMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    float size[3] = {1.0f, 1.0f, 1.0f};
+    getArrayField(L, 1, "size", size, 3);
+
+    return pushNewMesh(L, instance, MeshBuilder::box(size[0], size[1], size[2], options));
+}
+
+int Luau3D::createSphereMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    float radius = getNumberField(L, 1, "radius", 0.5f);
+    int segments = checkSegments(L, getNumberField(L, 1, "segments", 24), "segments");
+    int rings = checkSegments(L, getNumberField(L, 1, "rings", 16), "rings");
+
+    return pushNewMesh(L, instance, MeshBuilder::uvSphere(radius, segments, rings, options));
+}
+
+int Luau3D::createIcosphereMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    float radius = getNumberField(L, 1, "radius", 0.5f);
+    int subdivisions = checkSegments(L, getNumberField(L, 1, "subdivisions", 2), "subdivisions");
+
+    return pushNewMesh(L, instance, MeshBuilder::icosphere(radius, subdivisions, options));
+}
+
+int Luau3D::createCylinderMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    float radius = getNumberField(L, 1, "radius", 0.5f);
+    float height = getNumberField(L, 1, "height", 1.0f);
+    int segments = checkSegments(L, getNumberField(L, 1, "segments", 24), "segments");
+    bool capped = getBooleanField(L, 1, "capped", true);
+
+    return pushNewMesh(L, instance, MeshBuilder::cylinder(radius, height, segments, capped, options));
+}
+
+int Luau3D::createPlaneMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    float size[2] = {1.0f, 1.0f};
+    float segments[2] = {1.0f, 1.0f};
+    getArrayField(L, 1, "size", size, 2);
+    getArrayField(L, 1, "segments", segments, 2);
+
+    return pushNewMesh(L, instance, MeshBuilder::plane(size[0], size[1],
+        checkSegments(L, segments[0], "segments"), checkSegments(L, segments[1], "segments"), options));
+}
+
+int Luau3D::createHeightfieldMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+
+    // Heights are read straight out of a buffer of f32 samples. Luau buffer data is
+    // 8-byte aligned, as updateModel and the command buffers also rely on; the options
+    // table keeps the buffer alive after the pop.
+    lua_getfield(L, 1, "heights");
+    size_t bufferSize = 0;
+    const float* heights = static_cast<const float*>(lua_tobuffer(L, -1, &bufferSize));
+    lua_pop(L, 1);
+    if (!heights) {
+        luaL_error(L, "Expected a buffer of f32 samples in 'heights'");
+        return 0;
+    }
+
+    int columns = static_cast<int>(getNumberField(L, 1, "columns", 0));
+    int rows = static_cast<int>(getNumberField(L, 1, "rows", 0));
+    if (columns < 2 || rows < 2 || static_cast<size_t>(columns) * rows * sizeof(float) > bufferSize) {
+        luaL_error(L, "Heightfield needs at least 2x2 samples and a buffer of columns * rows f32 values");
+        return 0;
+    }
+
+    float size[2] = {1.0f, 1.0f};
+    getArrayField(L, 1, "size", size, 2);
+    float heightScale = getNumberField(L, 1, "heightScale", 1.0f);
+
+    return pushNewMesh(L, instance, MeshBuilder::heightfield(heights, columns, rows,
+        size[0], size[1], heightScale, options));
+}
+
+int Luau3D::releaseMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkMesh(L, instance, 1);
+    instance->releaseMesh(static_cast<size_t>(toMeshHandle(L, 1)));
+    return 0;
+}
+
+int Luau3D::loadMesh(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const char* path = luaL_checkstring(L, 1);
+    checkOptionsTable(L, 2);
+    VertexLayout layout;
+    bool hasLayout = readVertexLayout(L, 2, layout);
+
+    pushMeshObject(L, instance, instance->loadMesh(path, hasLayout ? &layout : nullptr));
+    return 1;
+}
+
+int Luau3D::loadMeshAsync(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    std::string path = luaL_checkstring(L, 1);
+    checkOptionsTable(L, 2);
+    VertexLayout layout;
+    bool hasLayout = readVertexLayout(L, 2, layout);
+
+    auto result = std::make_shared<MeshLoadResult>();
+    return instance->yieldForWork(L,
+        [result, path, layout, hasLayout]() {
+            *result = MeshLoader::load(path, hasLayout ? &layout : nullptr);
+        },
+        [instance, result, path](lua_State* co) -> int {
+            logMeshLoad(path, *result);
+            if (!result->mesh) {
+                lua_pushnil(co);
+                lua_pushstring(co, result->error.c_str());
+                return 2;
+            }
+            pushMeshObject(co, instance, instance->addMesh(result->mesh));
+            return 1;
+        });
+}
+
+int Luau3D::getMeshStatus(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    int handle = toMeshHandle(L, 1);
+    if (handle < 0 || static_cast<size_t>(handle) >= instance->objects->meshes.size()) {
+        luaL_error(L, "Invalid mesh handle %d", handle);
+        return 0;
+    }
+    switch (instance->getMeshStatus(static_cast<size_t>(handle))) {
+        case MeshStatus::Loading: lua_pushstring(L, "loading"); break;
+        case MeshStatus::Failed: lua_pushstring(L, "failed"); break;
+        default: lua_pushstring(L, "ready"); break;
+    }
+    return 1;
+}
+
+int Luau3D::getGeometryStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const GeometryCache::Stats& stats = instance->geometry.getStats();
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, static_cast<double>(stats.meshes));
+    lua_setfield(L, -2, "meshes");
+    lua_pushnumber(L, static_cast<double>(stats.meshBytes));
+    lua_setfield(L, -2, "meshBytes");
+    lua_pushnumber(L, static_cast<double>(stats.lookups));
+    lua_setfield(L, -2, "lookups");
+    lua_pushnumber(L, static_cast<double>(stats.hits));
+    lua_setfield(L, -2, "hits");
+    lua_pushnumber(L, static_cast<double>(stats.dedupedBytes));
+    lua_setfield(L, -2, "dedupedBytes");
+    lua_pushnumber(L, static_cast<double>(stats.hitBytesTotal));
+    lua_setfield(L, -2, "hitBytesTotal");
+    return 1;
+}
+
+int Luau3D::captureFrame(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    instance->capture.requestFrame(luaL_checkstring(L, 1));
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::startCapture(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const char* prefix = luaL_checkstring(L, 1);
+    checkOptionsTable(L, 2);
+    ImageFormat format = ImageFormat::Png;
+    lua_getfield(L, 2, "format");
+    if (!lua_isnil(L, -1)) {
+        std::string name = luaL_checkstring(L, -1);
+        if (name == "png") format = ImageFormat::Png;
+        else if (name == "qoi") format = ImageFormat::Qoi;
+        else if (name == "raw") format = ImageFormat::Raw;
+        else luaL_error(L, "Unknown image format '%s'", name.c_str());
+    }
+    lua_pop(L, 1);
+
+    instance->capture.startContinuous(prefix, format);
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::stopCapture(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    instance->capture.stopContinuous();
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::getCaptureStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    FrameCapture::Stats stats = instance->capture.getStats();
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, static_cast<double>(stats.captured));
+    lua_setfield(L, -2, "captured");
+    lua_pushnumber(L, static_cast<double>(stats.dropped));
+    lua_setfield(L, -2, "dropped");
+    lua_pushnumber(L, static_cast<double>(stats.written));
+    lua_setfield(L, -2, "written");
+    lua_pushnumber(L, static_cast<double>(stats.failed));
+    lua_setfield(L, -2, "failed");
+    lua_pushnumber(L, static_cast<double>(stats.bytesWritten));
+    lua_setfield(L, -2, "bytesWritten");
+    lua_pushnumber(L, stats.encodeSeconds);
+    lua_setfield(L, -2, "encodeSeconds");
+    return 1;
+}
+
+int Luau3D::setLight(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+    
+    // Get light number (1-based, up to MaxLights)
+    int lightNum = luaL_checkinteger(L, 1) - 1;
+    if (lightNum < 0 || static_cast<size_t>(lightNum) >= MaxLights) {
+        luaL_error(L, "Light number must be between 1 and %d", static_cast<int>(MaxLights));
+        return 0;
+    }
+    
+    // Check properties table
+    luaL_checktype(L, 2, LUA_TTABLE);
     
-    // Check properties table
-    luaL_checktype(L, 2, LUA_TTABLE);
-    
     LightProperties properties;
     
     // Helper function to get float array from table field
@@ -254,34 +1331,765 @@ int Luau3D::setLight(lua_State* L) {
                 lua_pop(L, 1);
             }
         }
-        lua_pop(L, 1);
-        return result;
-    };
-    
-    // Helper function to get single float from table field
-    auto getFloat = [L](const char* field, float defaultVal) -> float {
-        lua_getfield(L, 2, field);
-        float result = lua_isnumber(L, -1) ? static_cast<float>(lua_tonumber(L, -1)) : defaultVal;
-        lua_pop(L, 1);
-        return result;
-    };
-    
-    // Get light properties
-    properties.position = getFloatArray("position");
-    properties.ambient = getFloatArray("ambient");
-    properties.diffuse = getFloatArray("diffuse");
-    properties.specular = getFloatArray("specular");
-    properties.spotDirection = getFloatArray("spotDirection");
-    properties.spotExponent = getFloat("spotExponent", -1.0f);
-    properties.spotCutoff = getFloat("spotCutoff", -1.0f);
-    properties.constantAttenuation = getFloat("constantAttenuation", -1.0f);
-    properties.linearAttenuation = getFloat("linearAttenuation", -1.0f);
-    properties.quadraticAttenuation = getFloat("quadraticAttenuation", -1.0f);
-    
-    // Set the light properties
-    instance->renderer->setLight(lightNum, properties);
-    
-    lua_pushboolean(L, 1);
+        lua_pop(L, 1);
+        return result;
+    };
+    
+    // Helper function to get single float from table field
+    auto getFloat = [L](const char* field, float defaultVal) -> float {
+        lua_getfield(L, 2, field);
+        float result = lua_isnumber(L, -1) ? static_cast<float>(lua_tonumber(L, -1)) : defaultVal;
+        lua_pop(L, 1);
+        return result;
+    };
+    
+    // Get light properties
+    properties.position = getFloatArray("position");
+    properties.ambient = getFloatArray("ambient");
+    properties.diffuse = getFloatArray("diffuse");
+    properties.specular = getFloatArray("specular");
+    properties.spotDirection = getFloatArray("spotDirection");
+    properties.spotExponent = getFloat("spotExponent", -1.0f);
+    properties.spotCutoff = getFloat("spotCutoff", -1.0f);
+    properties.constantAttenuation = getFloat("constantAttenuation", -1.0f);
+    properties.linearAttenuation = getFloat("linearAttenuation", -1.0f);
+    properties.quadraticAttenuation = getFloat("quadraticAttenuation", -1.0f);
+    
+    // Set the light properties
+    instance->setLight(static_cast<size_t>(lightNum), properties);
+    
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::removeLight(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    int lightNum = luaL_checkinteger(L, 1) - 1;
+    if (lightNum < 0) {
+        luaL_error(L, "Light number must be at least 1");
+        return 0;
+    }
+    instance->removeLight(static_cast<size_t>(lightNum));
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::clearLights(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    instance->clearLights();
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Luau3D::getLightStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const LightClusters::Stats& stats = instance->lightClusters.getStats();
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, static_cast<double>(stats.lights));
+    lua_setfield(L, -2, "lights");
+    lua_pushnumber(L, static_cast<double>(stats.globalLights));
+    lua_setfield(L, -2, "globalLights");
+    lua_pushnumber(L, static_cast<double>(stats.occupiedClusters));
+    lua_setfield(L, -2, "occupiedClusters");
+    lua_pushnumber(L, static_cast<double>(LightClusters::ClusterCount));
+    lua_setfield(L, -2, "clusters");
+    lua_pushnumber(L, stats.occupiedClusters > 0 ? static_cast<double>(stats.references) / stats.occupiedClusters : 0.0);
+    lua_setfield(L, -2, "averagePerCluster");
+    lua_pushnumber(L, static_cast<double>(stats.maxPerCluster));
+    lua_setfield(L, -2, "maxPerCluster");
+    return 1;
+}
+
+int Luau3D::setModelOccluder(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    instance->setModelOccluder(index, lua_toboolean(L, 2) != 0);
+    return 0;
+}
+
+int Luau3D::setOcclusionCulling(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    instance->setOcclusionCulling(lua_toboolean(L, 1) != 0);
+    return 0;
+}
+
+int Luau3D::getOcclusionStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const OcclusionCuller::Stats& stats = instance->occlusionCuller.getStats();
+    lua_createtable(L, 0, 5);
+    lua_pushnumber(L, static_cast<double>(stats.occluders));
+    lua_setfield(L, -2, "occluders");
+    lua_pushnumber(L, static_cast<double>(stats.triangles));
+    lua_setfield(L, -2, "triangles");
+    lua_pushnumber(L, static_cast<double>(stats.tested));
+    lua_setfield(L, -2, "tested");
+    lua_pushnumber(L, static_cast<double>(stats.occluded));
+    lua_setfield(L, -2, "occluded");
+    lua_pushnumber(L, stats.milliseconds);
+    lua_setfield(L, -2, "milliseconds");
+    return 1;
+}
+
+int Luau3D::setDamageTracking(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    instance->setDamageTracking(lua_toboolean(L, 1) != 0);
+    return 0;
+}
+
+int Luau3D::getDamageStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const DamageTracker::Stats& stats = instance->damage.getStats();
+    lua_createtable(L, 0, 6);
+    lua_pushboolean(L, stats.skipped);
+    lua_setfield(L, -2, "skipped");
+    lua_pushnumber(L, stats.damagedPercent);
+    lua_setfield(L, -2, "damagedPercent");
+    lua_pushnumber(L, static_cast<double>(stats.damagedTiles));
+    lua_setfield(L, -2, "damagedTiles");
+    lua_pushnumber(L, static_cast<double>(stats.changedModels));
+    lua_setfield(L, -2, "changedModels");
+    lua_pushnumber(L, static_cast<double>(stats.drawnItems));
+    lua_setfield(L, -2, "drawnItems");
+    lua_pushnumber(L, static_cast<double>(stats.skippedItems));
+    lua_setfield(L, -2, "skippedItems");
+    return 1;
+}
+
+int Luau3D::createSkeleton(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+    auto skeleton = std::make_shared<Skeleton>();
+    std::vector<float> parents;
+    getNumberArrayField(L, 1, "parents", parents);
+    for (float parent : parents) {
+        skeleton->parents.push_back(static_cast<int>(parent));
+    }
+
+    // Bind pose (optional): local transform per joint, identity when omitted
+    skeleton->bindPose.resize(parents.size());
+    lua_getfield(L, 1, "bindPose");
+    if (lua_istable(L, -1)) {
+        int bindIndex = lua_gettop(L);
+        for (size_t i = 0; i < parents.size(); i++) {
+            lua_rawgeti(L, bindIndex, static_cast<int>(i) + 1);
+            if (lua_istable(L, -1)) {
+                int jointIndex = lua_gettop(L);
+                JointPose& pose = skeleton->bindPose[i];
+                getArrayField(L, jointIndex, "translation", pose.translation, 3);
+                getArrayField(L, jointIndex, "rotation", pose.rotation, 4);
+                getArrayField(L, jointIndex, "scale", pose.scale, 3);
+            }
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+
+    std::string error;
+    if (!skeleton->finalize(error)) {
+        luaL_error(L, "createSkeleton: %s", error.c_str());
+        return 0;
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(instance->addSkeleton(std::move(skeleton))));
+    return 1;
+}
+
+int Luau3D::createAnimationClip(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    std::shared_ptr<Skeleton> skeleton = checkSkeleton(L, instance, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    float duration = getNumberField(L, 2, "duration", 0.0f);
+
+    std::vector<JointTrack> tracks;
+    lua_getfield(L, 2, "tracks");
+    luaL_checktype(L, -1, LUA_TTABLE);
+    int tracksIndex = lua_gettop(L);
+    int count = lua_objlen(L, tracksIndex);
+    tracks.resize(count);
+    for (int i = 0; i < count; i++) {
+        lua_rawgeti(L, tracksIndex, i + 1);
+        luaL_checktype(L, -1, LUA_TTABLE);
+        int trackIndex = lua_gettop(L);
+        JointTrack& track = tracks[i];
+        track.joint = static_cast<int>(getNumberField(L, trackIndex, "joint", -1.0f));
+        getNumberArrayField(L, trackIndex, "times", track.times);
+        getNumberArrayField(L, trackIndex, "translations", track.translations);
+        getNumberArrayField(L, trackIndex, "rotations", track.rotations);
+        getNumberArrayField(L, trackIndex, "scales", track.scales);
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
+    auto clip = std::make_shared<AnimationClip>();
+    std::string error;
+    if (!clip->build(*skeleton, duration, tracks, error)) {
+        luaL_error(L, "createAnimationClip: %s", error.c_str());
+        return 0;
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(instance->addAnimationClip(std::move(clip))));
+    return 1;
+}
+
+int Luau3D::setModelSkeleton(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    std::shared_ptr<Skeleton> skeleton = lua_isnoneornil(L, 2) ? nullptr : checkSkeleton(L, instance, 2);
+    std::string error;
+    if (!instance->setModelSkeleton(index, std::move(skeleton), error)) {
+        luaL_error(L, "setModelSkeleton: %s", error.c_str());
+    }
+    return 0;
+}
+
+int Luau3D::setModelAnimation(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    if (!instance->skinner.hasSkeleton(index)) {
+        luaL_error(L, "setModelAnimation: model %d has no skeleton", static_cast<int>(index));
+    }
+    luaL_checktype(L, 2, LUA_TTABLE);
+    std::vector<Skinner::Layer> layers(lua_objlen(L, 2));
+    for (size_t i = 0; i < layers.size(); i++) {
+        lua_rawgeti(L, 2, static_cast<int>(i) + 1);
+        luaL_checktype(L, -1, LUA_TTABLE);
+        int layerIndex = lua_gettop(L);
+        lua_getfield(L, layerIndex, "clip");
+        layers[i].clip = checkAnimationClip(L, instance, lua_gettop(L));
+        lua_pop(L, 1);
+        layers[i].time = getNumberField(L, layerIndex, "time", 0.0f);
+        layers[i].weight = getNumberField(L, layerIndex, "weight", 1.0f);
+        layers[i].loop = getBooleanField(L, layerIndex, "loop", true);
+        if (layers[i].clip->getJointCount() != instance->skinner.getJointCount(index)) {
+            luaL_error(L, "setModelAnimation: clip %d was built for a different skeleton", static_cast<int>(i) + 1);
+        }
+        lua_pop(L, 1);
+    }
+
+    instance->setModelAnimation(index, std::move(layers));
+    return 0;
+}
+
+int Luau3D::getAnimationStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const Skinner::Stats& stats = instance->skinner.getStats();
+    lua_createtable(L, 0, 5);
+    lua_pushnumber(L, static_cast<double>(stats.models));
+    lua_setfield(L, -2, "models");
+    lua_pushnumber(L, static_cast<double>(stats.vertices));
+    lua_setfield(L, -2, "vertices");
+    lua_pushnumber(L, static_cast<double>(stats.joints));
+    lua_setfield(L, -2, "joints");
+    lua_pushnumber(L, stats.sampleMilliseconds);
+    lua_setfield(L, -2, "sampleMilliseconds");
+    lua_pushnumber(L, stats.skinMilliseconds);
+    lua_setfield(L, -2, "skinMilliseconds");
+    return 1;
+}
+
+int Luau3D::tween(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    float duration = static_cast<float>(luaL_checknumber(L, 3));
+
+    Easing easing = Easing::Linear;
+    if (!lua_isnoneornil(L, 4)) {
+        const char* name = luaL_checkstring(L, 4);
+        if (!easingFromName(name, easing)) {
+            luaL_error(L, "Unknown easing '%s'", name);
+        }
+    }
+
+    // Loop (optional): true repeats, or "repeat" / "pingpong"
+    TweenLoop loop = TweenLoop::Once;
+    if (lua_isboolean(L, 5)) {
+        loop = lua_toboolean(L, 5) ? TweenLoop::Repeat : TweenLoop::Once;
+    } else if (!lua_isnoneornil(L, 5)) {
+        std::string name = luaL_checkstring(L, 5);
+        if (name == "repeat") {
+            loop = TweenLoop::Repeat;
+        } else if (name == "pingpong") {
+            loop = TweenLoop::PingPong;
+        } else if (name != "once") {
+            luaL_error(L, "Unknown tween loop '%s'", name.c_str());
+        }
+    }
+
+    // Fields the target omits keep their current value
+    CFrame target = instance->sceneGraph.getLocalCFrame(index);
+    readCFrame(L, 2, target);
+    lua_pushinteger(L, static_cast<lua_Integer>(instance->tweenModel(index, target, duration, easing, loop)));
+    return 1;
+}
+
+int Luau3D::cancelTween(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    lua_pushboolean(L, instance->cancelTween(static_cast<uint32_t>(luaL_checkinteger(L, 1))));
+    return 1;
+}
+
+int Luau3D::registerTweenCallback(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    if (instance->tweenCallbackRef != LUA_NOREF) {
+        lua_unref(L, instance->tweenCallbackRef);
+        instance->tweenCallbackRef = LUA_NOREF;
+    }
+    // nil unregisters
+    if (lua_isnoneornil(L, 1)) {
+        return 0;
+    }
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    lua_pushvalue(L, 1);
+    instance->tweenCallbackRef = lua_ref(L, -1);
+    lua_pop(L, 1);
+    return 0;
+}
+
+int Luau3D::getTweenStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const TweenSystem::Stats& stats = instance->tweens.getStats();
+    lua_createtable(L, 0, 3);
+    lua_pushnumber(L, static_cast<double>(stats.tweens));
+    lua_setfield(L, -2, "tweens");
+    lua_pushnumber(L, static_cast<double>(stats.completed));
+    lua_setfield(L, -2, "completed");
+    lua_pushnumber(L, stats.microseconds);
+    lua_setfield(L, -2, "microseconds");
+    return 1;
+}
+
+int Luau3D::setModelCollider(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    // Shape: "aabb", "sphere", "box" or "mesh"; nil removes the collider
+    CollisionWorld::Collider collider;
+    if (!lua_isnoneornil(L, 2)) {
+        std::string name = luaL_checkstring(L, 2);
+        if (name == "aabb") {
+            collider.shape = CollisionWorld::Shape::Aabb;
+        } else if (name == "sphere") {
+            collider.shape = CollisionWorld::Shape::Sphere;
+        } else if (name == "box") {
+            collider.shape = CollisionWorld::Shape::Box;
+        } else if (name == "mesh") {
+            collider.shape = CollisionWorld::Shape::Mesh;
+        } else {
+            luaL_error(L, "Unknown collider shape '%s'", name.c_str());
+        }
+    }
+
+    // Options (optional): { group = bits, mask = bits }, read as doubles to keep all 32 bits
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        lua_getfield(L, 3, "group");
+        if (!lua_isnil(L, -1)) {
+            collider.group = static_cast<uint32_t>(luaL_checknumber(L, -1));
+        }
+        lua_getfield(L, 3, "mask");
+        if (!lua_isnil(L, -1)) {
+            collider.mask = static_cast<uint32_t>(luaL_checknumber(L, -1));
+        }
+        lua_pop(L, 2);
+    }
+    instance->setModelCollider(index, collider);
+    return 0;
+}
+
+int Luau3D::registerCollisionCallback(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    if (instance->collisionCallbackRef != LUA_NOREF) {
+        lua_unref(L, instance->collisionCallbackRef);
+        instance->collisionCallbackRef = LUA_NOREF;
+    }
+    // nil unregisters
+    if (lua_isnoneornil(L, 1)) {
+        return 0;
+    }
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    lua_pushvalue(L, 1);
+    instance->collisionCallbackRef = lua_ref(L, -1);
+    lua_pop(L, 1);
+    return 0;
+}
+
+int Luau3D::getCollisionStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const CollisionWorld::Stats& stats = instance->collisions.getStats();
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, static_cast<double>(stats.colliders));
+    lua_setfield(L, -2, "colliders");
+    lua_pushnumber(L, static_cast<double>(stats.candidates));
+    lua_setfield(L, -2, "candidates");
+    lua_pushnumber(L, static_cast<double>(stats.contacts));
+    lua_setfield(L, -2, "contacts");
+    lua_pushnumber(L, static_cast<double>(stats.began));
+    lua_setfield(L, -2, "began");
+    lua_pushnumber(L, static_cast<double>(stats.ended));
+    lua_setfield(L, -2, "ended");
+    lua_pushnumber(L, stats.milliseconds);
+    lua_setfield(L, -2, "milliseconds");
+    return 1;
+}
+
+int Luau3D::raycastTriangles(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    float origin[3], direction[3];
+    checkVector3(L, 1, origin);
+    checkVector3(L, 2, direction);
+    float maxDistance = static_cast<float>(luaL_optnumber(L, 3, 1e30));
+    RaycastHit hit;
+    if (!instance->raycastTriangles(origin, direction, maxDistance, hit)) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, static_cast<lua_Integer>(hit.row));
+    lua_setfield(L, -2, "model");
+    lua_pushinteger(L, static_cast<lua_Integer>(hit.triangle));
+    lua_setfield(L, -2, "triangle");
+    lua_pushnumber(L, hit.u);
+    lua_setfield(L, -2, "u");
+    lua_pushnumber(L, hit.v);
+    lua_setfield(L, -2, "v");
+    lua_pushnumber(L, hit.distance);
+    lua_setfield(L, -2, "distance");
+    return 1;
+}
+
+int Luau3D::raycastTrianglesMany(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    // Rays as six numbers each (origin, direction), from a buffer of f32 values or an array
+    const float* rays = nullptr;
+    size_t floatCount = 0;
+    if (lua_isbuffer(L, 1)) {
+        size_t bufferSize = 0;
+        rays = static_cast<const float*>(lua_tobuffer(L, 1, &bufferSize));
+        floatCount = bufferSize / sizeof(float);
+    } else {
+        luaL_checktype(L, 1, LUA_TTABLE);
+        floatCount = lua_objlen(L, 1);
+        std::vector<float>& scratch = instance->vertexScratch;
+        scratch.resize(floatCount);
+        for (size_t i = 0; i < floatCount; i++) {
+            lua_rawgeti(L, 1, static_cast<int>(i + 1));
+            scratch[i] = static_cast<float>(lua_tonumber(L, -1));
+            lua_pop(L, 1);
+        }
+        rays = scratch.data();
+    }
+    if (floatCount % 6 != 0) {
+        luaL_error(L, "Ray data must hold a multiple of 6 numbers");
+        return 0;
+    }
+    float maxDistance = static_cast<float>(luaL_optnumber(L, 2, 1e30));
+
+    // Five numbers per ray: model (-1 on a miss), triangle, u, v, distance
+    std::vector<RaycastHit>& hits = instance->raycastHits;
+    instance->raycastTriangles(rays, floatCount / 6, maxDistance, hits);
+    lua_createtable(L, static_cast<int>(hits.size() * 5), 0);
+    int slot = 1;
+    for (const RaycastHit& hit : hits) {
+        bool found = hit.row != RaycastHit::NoRow;
+        lua_pushinteger(L, found ? static_cast<lua_Integer>(hit.row) : -1);
+        lua_rawseti(L, -2, slot++);
+        lua_pushinteger(L, static_cast<lua_Integer>(hit.triangle));
+        lua_rawseti(L, -2, slot++);
+        lua_pushnumber(L, hit.u);
+        lua_rawseti(L, -2, slot++);
+        lua_pushnumber(L, hit.v);
+        lua_rawseti(L, -2, slot++);
+        lua_pushnumber(L, hit.distance);
+        lua_rawseti(L, -2, slot++);
+    }
+    return 1;
+}
+
+int Luau3D::getRaycastStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const Raycaster::Stats& stats = instance->raycaster.getStats();
+    lua_createtable(L, 0, 7);
+    lua_pushnumber(L, static_cast<double>(stats.meshes));
+    lua_setfield(L, -2, "meshes");
+    lua_pushnumber(L, static_cast<double>(stats.meshBytes));
+    lua_setfield(L, -2, "meshBytes");
+    lua_pushnumber(L, static_cast<double>(stats.instances));
+    lua_setfield(L, -2, "instances");
+    lua_pushnumber(L, static_cast<double>(stats.meshBuilds));
+    lua_setfield(L, -2, "meshBuilds");
+    lua_pushnumber(L, static_cast<double>(stats.meshRefits));
+    lua_setfield(L, -2, "meshRefits");
+    lua_pushboolean(L, stats.instancesRebuilt);
+    lua_setfield(L, -2, "instancesRebuilt");
+    lua_pushnumber(L, stats.updateMilliseconds);
+    lua_setfield(L, -2, "updateMilliseconds");
+    return 1;
+}
+
+// Read an optional field that is a number or a {min, max} array; a number sets both
+static void getRangeField(lua_State* L, int tableIndex, const char* field, float range[2]) {
+    lua_getfield(L, tableIndex, field);
+    if (lua_isnumber(L, -1)) {
+        range[0] = range[1] = static_cast<float>(lua_tonumber(L, -1));
+    }
+    lua_pop(L, 1);
+    getArrayField(L, tableIndex, field, range, 2);
+}
+
+int Luau3D::createParticleEmitter(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    checkOptionsTable(L, 1);
+    EmitterSettings settings;
+    settings.rate = std::max(getNumberField(L, 1, "rate", settings.rate), 0.0f);
+    lua_getfield(L, 1, "maxParticles");
+    if (!lua_isnil(L, -1)) {
+        double maxParticles = luaL_checknumber(L, -1);
+        if (maxParticles < 0.0 || maxParticles > 16777216.0) {
+            luaL_error(L, "maxParticles must be between 0 and 16777216");
+        }
+        settings.maxParticles = static_cast<uint32_t>(maxParticles);
+    }
+    lua_pop(L, 1);
+    getRangeField(L, 1, "lifetime", settings.lifetime);
+    getRangeField(L, 1, "speed", settings.speed);
+    getArrayField(L, 1, "direction", settings.direction, 3);
+    settings.spread = getNumberField(L, 1, "spread", settings.spread);
+    settings.radius = getNumberField(L, 1, "radius", settings.radius);
+    getArrayField(L, 1, "gravity", settings.gravity, 3);
+    settings.drag = std::max(getNumberField(L, 1, "drag", settings.drag), 0.0f);
+    getRangeField(L, 1, "size", settings.size);
+    getArrayField(L, 1, "colorStart", settings.colorStart, 4);
+    getArrayField(L, 1, "colorEnd", settings.colorEnd, 4);
+    lua_getfield(L, 1, "seed");
+    if (!lua_isnil(L, -1)) {
+        settings.seed = static_cast<uint32_t>(luaL_checknumber(L, -1));
+    }
+    lua_pop(L, 1);
+    if (settings.lifetime[0] <= 0.0f || settings.lifetime[1] <= 0.0f) {
+        luaL_error(L, "Particle lifetime must be positive");
+    }
+
+    bool visible = getBooleanField(L, 1, "visible", true);
+    CFrame cframe;
+    lua_getfield(L, 1, "cframe");
+    if (lua_istable(L, -1)) {
+        readCFrame(L, lua_gettop(L), cframe);
+    }
+    lua_pop(L, 1);
+    int parent = -1;
+    lua_getfield(L, 1, "parent");
+    if (!lua_isnil(L, -1)) {
+        parent = static_cast<int>(checkModel(L, instance, -1));
+    }
+    lua_pop(L, 1);
+
+    size_t index = instance->addParticleEmitter(settings, visible, cframe);
+    if (parent >= 0) {
+        instance->setModelParent(index, parent, false);
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(index));
+    return 1;
+}
+
+int Luau3D::setParticleEmitting(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    if (!instance->setParticleEmitting(index, lua_toboolean(L, 2) != 0)) {
+        luaL_error(L, "Model %d is not a particle emitter", static_cast<int>(index));
+    }
+    return 0;
+}
+
+int Luau3D::emitParticles(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    size_t index = checkModel(L, instance, 1);
+    double count = luaL_checknumber(L, 2);
+    if (count < 0.0) {
+        luaL_error(L, "Particle count must not be negative");
+    }
+    // Spawned with the next frame, up to the emitter's maxParticles
+    if (!instance->emitParticles(index, static_cast<uint32_t>(std::min(count, 4294967295.0)))) {
+        luaL_error(L, "Model %d is not a particle emitter", static_cast<int>(index));
+    }
+    return 0;
+}
+
+int Luau3D::getParticleStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const ParticleSystem::Stats& stats = instance->particles.getStats();
+    lua_createtable(L, 0, 5);
+    lua_pushnumber(L, static_cast<double>(stats.emitters));
+    lua_setfield(L, -2, "emitters");
+    lua_pushnumber(L, static_cast<double>(stats.particles));
+    lua_setfield(L, -2, "particles");
+    lua_pushnumber(L, static_cast<double>(stats.emitted));
+    lua_setfield(L, -2, "emitted");
+    lua_pushnumber(L, static_cast<double>(stats.expired));
+    lua_setfield(L, -2, "expired");
+    lua_pushnumber(L, stats.milliseconds);
+    lua_setfield(L, -2, "milliseconds");
+    return 1;
+}
+
+int Luau3D::createTerrain(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+    TerrainSettings settings;
+    lua_getfield(L, 1, "path");
+    settings.path = luaL_checkstring(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, 1, "heightFormat");
+    if (!lua_isnil(L, -1)) {
+        std::string name = luaL_checkstring(L, -1);
+        if (name == "r8") {
+            settings.format = HeightFormat::R8;
+        } else if (name == "r16") {
+            settings.format = HeightFormat::R16;
+        } else if (name == "f32") {
+            settings.format = HeightFormat::F32;
+        } else {
+            luaL_error(L, "Unknown height format '%s'", name.c_str());
+        }
+    }
+    lua_pop(L, 1);
+    settings.columns = static_cast<int>(getNumberField(L, 1, "columns", 0));
+    settings.rows = static_cast<int>(getNumberField(L, 1, "rows", 0));
+    settings.cellSize = getNumberField(L, 1, "cellSize", settings.cellSize);
+    settings.heightScale = getNumberField(L, 1, "heightScale", settings.heightScale);
+    settings.chunkSize = static_cast<int>(getNumberField(L, 1, "chunkSize", static_cast<float>(settings.chunkSize)));
+    settings.lodLevels = static_cast<int>(getNumberField(L, 1, "lodLevels", static_cast<float>(settings.lodLevels)));
+    settings.lodDistance = getNumberField(L, 1, "lodDistance", settings.lodDistance);
+    settings.viewDistance = getNumberField(L, 1, "viewDistance", settings.viewDistance);
+    settings.skirtDepth = getNumberField(L, 1, "skirtDepth", settings.skirtDepth);
+    // Read as a double, budgets can pass 2^24 bytes
+    lua_getfield(L, 1, "memoryBudget");
+    if (!lua_isnil(L, -1)) {
+        settings.memoryBudget = static_cast<size_t>(std::max(luaL_checknumber(L, -1), 0.0));
+    }
+    lua_pop(L, 1);
+    // Vertex format and coloring, as for the mesh builders
+    MeshBuildOptions options;
+    readMeshBuildOptions(L, 1, options);
+    settings.layout = options.layout;
+    settings.color = options.color;
+
+    bool visible = getBooleanField(L, 1, "visible", true);
+    CFrame cframe;
+    lua_getfield(L, 1, "cframe");
+    if (lua_istable(L, -1)) {
+        readCFrame(L, lua_gettop(L), cframe);
+    }
+    lua_pop(L, 1);
+
+    size_t index = 0;
+    std::string error;
+    if (!instance->addTerrain(settings, visible, cframe, index, error)) {
+        luaL_error(L, "%s", error.c_str());
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(index));
+    return 1;
+}
+
+// Terrain whose root is the model argument at index
+static const Terrain* checkTerrain(lua_State* L, Luau3D* instance, int index) {
+    size_t model = checkModel(L, instance, index);
+    const Terrain* terrain = instance->getTerrain(model);
+    if (!terrain) {
+        luaL_error(L, "Model %d is not a terrain", static_cast<int>(model));
+    }
+    return terrain;
+}
+
+int Luau3D::getTerrainHeight(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const Terrain* terrain = checkTerrain(L, instance, 1);
+    float x = static_cast<float>(luaL_checknumber(L, 2));
+    float z = static_cast<float>(luaL_checknumber(L, 3));
+    float height = 0.0f;
+    if (!terrain->getHeight(x, z, height)) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushnumber(L, height);
+    return 1;
+}
+
+int Luau3D::getTerrainStats(lua_State* L) {
+    Luau3D* instance = getInstance(L);
+    if (!instance) return 0;
+
+    const Terrain::Stats& stats = checkTerrain(L, instance, 1)->getStats();
+    lua_createtable(L, 0, 7);
+    lua_pushnumber(L, static_cast<double>(stats.chunks));
+    lua_setfield(L, -2, "chunks");
+    lua_pushnumber(L, static_cast<double>(stats.resident));
+    lua_setfield(L, -2, "resident");
+    lua_pushnumber(L, static_cast<double>(stats.residentBytes));
+    lua_setfield(L, -2, "residentBytes");
+    lua_pushnumber(L, static_cast<double>(stats.pending));
+    lua_setfield(L, -2, "pending");
+    lua_pushnumber(L, static_cast<double>(stats.requested));
+    lua_setfield(L, -2, "requested");
+    lua_pushnumber(L, static_cast<double>(stats.evicted));
+    lua_setfield(L, -2, "evicted");
+    lua_pushnumber(L, static_cast<double>(stats.submitted));
+    lua_setfield(L, -2, "submitted");
     return 1;
 }
 
@@ -312,6 +2120,183 @@ int Luau3D::registerBeforeRenderCallback(lua_State* L) {
     return 1;
 }
 
+bool Luau3D::setLight(size_t index, const LightProperties& properties) {
+    if (index >= MaxLights) {
+        return false;
+    }
+    if (index >= lights.size()) {
+        lights.resize(index + 1);
+        lightActive.resize(index + 1, false);
+    }
+    lights[index] = properties;
+    lightActive[index] = true;
+    lightsDirty = true;
+    return true;
+}
+
+void Luau3D::removeLight(size_t index) {
+    if (index < lights.size() && lightActive[index]) {
+        lightActive[index] = false;
+        lightsDirty = true;
+    }
+}
+
+void Luau3D::clearLights() {
+    lights.clear();
+    lightActive.clear();
+    lightsDirty = true;
+}
+
+void Luau3D::setModelOccluder(size_t index, bool occluder) {
+    if (index < models.size()) {
+        models.setOccluder(index, occluder);
+    }
+}
+
+void Luau3D::setDamageTracking(bool enabled) {
+    damageEnabled = enabled;
+    damage.invalidate();
+}
+
+size_t Luau3D::addSkeleton(std::shared_ptr<Skeleton> skeleton) {
+    skeletons.push_back(std::move(skeleton));
+    return skeletons.size() - 1;
+}
+
+std::shared_ptr<Skeleton> Luau3D::getSkeleton(size_t handle) const {
+    return handle < skeletons.size() ? skeletons[handle] : nullptr;
+}
+
+size_t Luau3D::addAnimationClip(std::shared_ptr<AnimationClip> clip) {
+    animationClips.push_back(std::move(clip));
+    return animationClips.size() - 1;
+}
+
+std::shared_ptr<AnimationClip> Luau3D::getAnimationClip(size_t handle) const {
+    return handle < animationClips.size() ? animationClips[handle] : nullptr;
+}
+
+bool Luau3D::setModelSkeleton(size_t index, std::shared_ptr<Skeleton> skeleton, std::string& error) {
+    return skinner.setSkeleton(models, index, std::move(skeleton), error);
+}
+
+bool Luau3D::setModelAnimation(size_t index, std::vector<Skinner::Layer> layers) {
+    return skinner.setLayers(index, std::move(layers));
+}
+
+uint32_t Luau3D::tweenModel(size_t index, const CFrame& target, float duration, Easing easing, TweenLoop loop) {
+    return tweens.start(index, sceneGraph.getLocalCFrame(index), target, duration, easing, loop);
+}
+
+void Luau3D::advanceTweens(lua_State* L) {
+    // Same step as getDeltaTime, measured separately so scripts polling it don't interfere
+    auto now = std::chrono::steady_clock::now();
+    double seconds = fixedDeltaTime > 0.0 ? fixedDeltaTime : std::chrono::duration<double>(now - lastTweenTime).count();
+    lastTweenTime = now;
+    if (tweens.size() == 0) {
+        return;
+    }
+    tweens.update(static_cast<float>(seconds), sceneGraph);
+
+    // One call per frame with every completed tween
+    const std::vector<uint32_t>& completed = tweens.getCompleted();
+    if (completed.empty() || tweenCallbackRef == LUA_NOREF) {
+        return;
+    }
+    const std::vector<uint32_t>& rows = tweens.getCompletedRows();
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tweenCallbackRef);
+    lua_createtable(L, static_cast<int>(completed.size()), 0);
+    lua_createtable(L, static_cast<int>(rows.size()), 0);
+    for (size_t i = 0; i < completed.size(); i++) {
+        lua_pushinteger(L, static_cast<lua_Integer>(completed[i]));
+        lua_rawseti(L, -3, static_cast<int>(i) + 1);
+        lua_pushinteger(L, static_cast<lua_Integer>(rows[i]));
+        lua_rawseti(L, -2, static_cast<int>(i) + 1);
+    }
+    if (lua_pcall(L, 2, 0, 0) != 0) {
+        std::cerr << "Error in tween callback: " << lua_tostring(L, -1) << std::endl;
+        lua_pop(L, 1);
+    }
+}
+
+void Luau3D::advanceParticles() {
+    // Same step as getDeltaTime, measured separately like the tweens'
+    auto now = std::chrono::steady_clock::now();
+    double seconds = fixedDeltaTime > 0.0 ? fixedDeltaTime : std::chrono::duration<double>(now - lastParticleTime).count();
+    lastParticleTime = now;
+    particles.update(static_cast<float>(seconds), models);
+}
+
+void Luau3D::updateTerrains() {
+    for (auto& terrain : terrains) {
+        terrain->update(models);
+    }
+}
+
+void Luau3D::updateCollisions(lua_State* L) {
+    collisions.update(models);
+
+    // One call per frame with every pair whose contact began, stayed or ended
+    const std::vector<uint32_t>& began = collisions.getBegan();
+    const std::vector<uint32_t>& stayed = collisions.getStayed();
+    const std::vector<uint32_t>& ended = collisions.getEnded();
+    if ((began.empty() && stayed.empty() && ended.empty()) || collisionCallbackRef == LUA_NOREF) {
+        return;
+    }
+    lua_rawgeti(L, LUA_REGISTRYINDEX, collisionCallbackRef);
+    for (const std::vector<uint32_t>* pairs : {&began, &stayed, &ended}) {
+        lua_createtable(L, static_cast<int>(pairs->size()), 0);
+        for (size_t i = 0; i < pairs->size(); i++) {
+            lua_pushinteger(L, static_cast<lua_Integer>((*pairs)[i]));
+            lua_rawseti(L, -2, static_cast<int>(i) + 1);
+        }
+    }
+    if (lua_pcall(L, 3, 0, 0) != 0) {
+        std::cerr << "Error in collision callback: " << lua_tostring(L, -1) << std::endl;
+        lua_pop(L, 1);
+    }
+}
+
+void Luau3D::cullOccluded() {
+    if (!occlusionEnabled) {
+        return;
+    }
+    models.collectOccluders(occluderRows);
+    occlusionCuller.cull(models, occluderRows, drawItems);
+}
+
+void Luau3D::cullTerrains() {
+    for (auto& terrain : terrains) {
+        terrain->cull(models, drawItems);
+    }
+}
+
+void Luau3D::assignLights() {
+    // Lights only move when scripts set them, so the clusters are rebuilt on change only
+    if (lightsDirty) {
+        renderer->setLights(lights);
+        lightClusters.build(lights, lightActive);
+        lightsDirty = false;
+    }
+    if (lightClusters.getStats().lights == 0) {
+        return;
+    }
+
+    itemLights.clear();
+    for (DrawItem& item : drawItems) {
+        size_t start = itemLights.size();
+        lightClusters.selectLights(item.cframe, models.getBounds(item.model), MaxLightsPerItem, itemLights);
+        item.lightCount = static_cast<uint32_t>(itemLights.size() - start);
+    }
+
+    // Point the items into the list once it has stopped growing
+    const uint32_t* next = itemLights.data();
+    for (DrawItem& item : drawItems) {
+        item.lights = next;
+        next += item.lightCount;
+    }
+}
+
 void Luau3D::callBeforeRenderCallback(lua_State* L) {
     if (beforeRenderCallbackRef != LUA_NOREF) {
         lua_rawgeti(L, LUA_REGISTRYINDEX, beforeRenderCallbackRef);
@@ -323,37 +2308,423 @@ void Luau3D::callBeforeRenderCallback(lua_State* L) {
 }
 
 // Model management implementation
-size_t Luau3D::addModel(const std::vector<float>& vertices, bool visible, const CFrame& cframe) {
-    Model model;
-    model.vertices = vertices;
-    model.visible = visible;
-    model.cframe = cframe;
-    models.push_back(model);
-    return models.size() - 1;
+// Pack script-side floats into a mesh's vertex storage, reusing its allocation
+static void packMeshVertices(Mesh& mesh, const std::vector<float>& vertices, const VertexLayout& layout) {
+    mesh.markReplaced();
+    mesh.mapping.reset();
+    mesh.layout = layout;
+    mesh.vertexCount = vertices.size() / layout.getSourceFloatsPerVertex();
+    mesh.vertices.resize(mesh.vertexCount * layout.getStride());
+    mesh.indices.clear();
+    packVertices(layout, vertices.data(), mesh.vertexCount, mesh.vertices.data());
+}
+
+size_t Luau3D::addModel(const std::vector<float>& vertices, bool visible, const CFrame& cframe, const VertexLayout& layout) {
+    return addModel(geometry.intern(vertices, layout), visible, cframe);
+}
+
+size_t Luau3D::addModel(std::shared_ptr<Mesh> mesh, bool visible, const CFrame& cframe) {
+    sceneGraph.addNode(cframe, visible);
+    objects->addRow();
+    return models.add(std::move(mesh), visible, cframe);
+}
+
+size_t Luau3D::addParticleEmitter(const EmitterSettings& settings, bool visible, const CFrame& cframe) {
+    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+    size_t index = addModel(mesh, visible, cframe);
+    particles.addEmitter(index, std::move(mesh), settings);
+    return index;
+}
+
+bool Luau3D::addTerrain(const TerrainSettings& settings, bool visible, const CFrame& cframe, size_t& index,
+                        std::string& error) {
+    std::unique_ptr<Terrain> terrain(new Terrain(threadPool));
+    if (!terrain->open(settings, error)) {
+        return false;
+    }
+    // Chunks start empty and get geometry as they stream in
+    index = addModel(std::make_shared<Mesh>(), visible, cframe);
+    terrain->setRootRow(index);
+    for (size_t chunk = 0; chunk < terrain->getChunkCount(); chunk++) {
+        size_t row = addModel(std::make_shared<Mesh>(), true, terrain->getChunkCFrame(chunk));
+        setModelParent(row, static_cast<int>(index), false);
+        terrain->setChunkRow(chunk, row);
+    }
+    terrains.push_back(std::move(terrain));
+    return true;
+}
+
+const Terrain* Luau3D::getTerrain(size_t index) const {
+    for (const auto& terrain : terrains) {
+        if (terrain->getRootRow() == index) return terrain.get();
+    }
+    return nullptr;
 }
 
 void Luau3D::removeModel(size_t index) {
+    // A terrain's root takes its chunks along, removed from the last row down
+    for (size_t t = 0; t < terrains.size(); t++) {
+        if (terrains[t]->getRootRow() != index) continue;
+        std::vector<uint32_t> rows;
+        terrains[t]->getChunkRows(rows);
+        terrains.erase(terrains.begin() + t);
+        rows.push_back(static_cast<uint32_t>(index));
+        std::sort(rows.begin(), rows.end(), std::greater<uint32_t>());
+        for (uint32_t row : rows) {
+            removeModel(row);
+        }
+        return;
+    }
     if (index < models.size()) {
-        models.erase(models.begin() + index);
+        // Children are re-attached with their current world transform
+        sceneGraph.update(models);
+        sceneGraph.removeNode(index);
+        objects->retire(models.getMesh(index));
+        objects->removeRow(index);
+        models.remove(index);
+        damage.removeRow(index);
+        skinner.removeRow(index);
+        tweens.removeRow(index);
+        collisions.removeRow(index);
+        particles.removeRow(index);
+        for (auto& terrain : terrains) {
+            terrain->removeRow(index);
+        }
     }
 }
 
 void Luau3D::clearModels() {
+    for (size_t i = 0; i < models.size(); i++) {
+        objects->retire(models.getMesh(i));
+    }
+    objects->clearRows();
     models.clear();
+    sceneGraph.clear();
+    damage.clear();
+    skinner.clear();
+    tweens.clear();
+    collisions.clear();
+    raycaster.clear();
+    particles.clear();
+    terrains.clear();
 }
 
 void Luau3D::setModelVisible(size_t index, bool visible) {
     if (index < models.size()) {
-        models[index].visible = visible;
+        sceneGraph.setVisible(index, visible);
+    }
+}
+
+bool Luau3D::setModelParent(size_t index, int parent, bool keepWorld) {
+    if (index >= models.size()) return false;
+    if (keepWorld) {
+        sceneGraph.update(models);
+    }
+    return sceneGraph.setParent(index, parent, keepWorld);
+}
+
+void Luau3D::setModelCFrame(size_t index, const CFrame& cframe) {
+    if (index < models.size()) {
+        sceneGraph.setLocalCFrame(index, cframe);
+    }
+}
+
+bool Luau3D::raycastTriangles(const float origin[3], const float direction[3], float maxDistance, RaycastHit& hit) {
+    sceneGraph.update(models);
+    raycaster.update(models);
+    return raycaster.raycast(origin, direction, maxDistance, hit);
+}
+
+void Luau3D::raycastTriangles(const float* rays, size_t count, float maxDistance, std::vector<RaycastHit>& hits) {
+    sceneGraph.update(models);
+    raycaster.update(models);
+    raycaster.raycastMany(rays, count, maxDistance, hits);
+}
+
+CFrame Luau3D::getModelWorldCFrame(size_t index) {
+    if (index >= models.size()) return CFrame();
+    sceneGraph.update(models);
+    return sceneGraph.getWorldCFrame(index);
+}
+
+void Luau3D::updateModel(size_t index, const std::vector<float>& vertices, bool visible, const CFrame& cframe, const VertexLayout& layout) {
+    if (index < models.size()) {
+        const std::shared_ptr<Mesh>& mesh = models.getMesh(index);
+        if (mesh && mesh.use_count() == 1) {
+            // Private geometry: repack in place
+            packMeshVertices(*mesh, vertices, layout);
+            models.refreshBounds(mesh.get());
+        } else {
+            // Never write through a mesh other models or handles can see
+            objects->retire(mesh);
+            models.setMesh(index, geometry.intern(vertices, layout));
+        }
+        sceneGraph.setVisible(index, visible);
+        sceneGraph.setLocalCFrame(index, cframe);
     }
 }
 
-void Luau3D::updateModel(size_t index, const std::vector<float>& vertices, bool visible, const CFrame& cframe) {
+void Luau3D::updateModel(size_t index, std::shared_ptr<Mesh> mesh, bool visible, const CFrame& cframe) {
     if (index < models.size()) {
-        models[index].vertices = vertices;
-        models[index].visible = visible;
-        models[index].cframe = cframe;
+        if (mesh) {
+            objects->retire(models.getMesh(index));
+            models.setMesh(index, std::move(mesh));
+        }
+        sceneGraph.setVisible(index, visible);
+        sceneGraph.setLocalCFrame(index, cframe);
+    }
+}
+
+bool Luau3D::updateModelVertices(size_t index, size_t offset, const float* source, size_t count) {
+    if (index >= models.size() || !models.getMesh(index)) {
+        return false;
+    }
+    const Mesh& current = *models.getMesh(index);
+    if (offset > current.vertexCount || count > current.vertexCount - offset) {
+        return false;
+    }
+    if (models.getMesh(index).use_count() > 1) {
+        // Never write through a mesh other models or handles can see
+        auto copy = std::make_shared<Mesh>(current);
+        copy->markReplaced();
+        objects->retire(models.getMesh(index));
+        models.setMesh(index, std::move(copy));
+    }
+
+    Mesh& mesh = *models.getMesh(index);
+    mesh.makeWritable();
+    const size_t stride = mesh.layout.getStride();
+    packVertices(mesh.layout, source, count, mesh.vertices.data() + offset * stride);
+    if (mesh.dirtyRanges.empty()) {
+        dirtyMeshes.push_back(models.getMesh(index));
+    }
+    mesh.markDirty(offset, count);
+    // Bounds only grow here; they are recomputed when the geometry is replaced
+    models.expandBounds(index, mesh.computeBounds(offset, count));
+    return true;
+}
+
+bool Luau3D::applyCommands(const uint8_t* data, size_t size, size_t count, std::string& error) {
+    size_t offset = 0;
+    size_t command = 0;
+    // Copy the next fieldCount fields out of the buffer, failing at its end
+    auto read = [&](void* out, size_t fieldCount) {
+        if (fieldCount > (size - offset) / 4) {
+            error = "Command " + std::to_string(command) + " is cut off at byte " + std::to_string(offset);
+            return false;
+        }
+        memcpy(out, data + offset, fieldCount * 4);
+        offset += fieldCount * 4;
+        return true;
+    };
+    auto checkRow = [&](uint32_t row) {
+        if (row >= models.size()) {
+            error = "Command " + std::to_string(command) + ": model " + std::to_string(row) + " does not exist";
+            return false;
+        }
+        return true;
+    };
+
+    for (; command < count; command++) {
+        uint32_t op = 0;
+        if (!read(&op, 1)) return false;
+        switch (static_cast<CommandOp>(op)) {
+            case CommandOp::SetModelVisible: {
+                uint32_t fields[2];
+                if (!read(fields, 2) || !checkRow(fields[0])) return false;
+                sceneGraph.setVisible(fields[0], fields[1] != 0);
+                break;
+            }
+            case CommandOp::SetModelCFrame: {
+                uint32_t row = 0;
+                CFrame cframe;
+                if (!read(&row, 1) || !read(cframe.position, 3) || !read(cframe.look, 3) || !read(cframe.up, 3) ||
+                    !read(cframe.right, 3) || !checkRow(row)) {
+                    return false;
+                }
+                sceneGraph.setLocalCFrame(row, cframe);
+                break;
+            }
+            case CommandOp::SetModelPosition: {
+                uint32_t row = 0;
+                float position[3];
+                if (!read(&row, 1) || !read(position, 3) || !checkRow(row)) return false;
+                CFrame cframe = sceneGraph.getLocalCFrame(row);
+                memcpy(cframe.position, position, sizeof(position));
+                sceneGraph.setLocalCFrame(row, cframe);
+                break;
+            }
+            case CommandOp::SetClearColor: {
+                float color[4];
+                if (!read(color, 4)) return false;
+                renderer->setClearColor(color[0], color[1], color[2], color[3]);
+                damage.invalidate();
+                break;
+            }
+            case CommandOp::SetLight: {
+                uint32_t fields[2];
+                float values[LightFloats];
+                if (!read(fields, 2) || !read(values, LightFloats)) return false;
+                if (fields[0] == 0 || fields[0] > MaxLights) {
+                    error = "Command " + std::to_string(command) + ": light number must be between 1 and " +
+                            std::to_string(MaxLights);
+                    return false;
+                }
+                LightProperties properties;
+                uint32_t set = fields[1];
+                if (set & LightPosition) properties.position.assign(values, values + (set & LightPositionW ? 4 : 3));
+                if (set & LightAmbient) properties.ambient.assign(values + 4, values + 8);
+                if (set & LightDiffuse) properties.diffuse.assign(values + 8, values + 12);
+                if (set & LightSpecular) properties.specular.assign(values + 12, values + 16);
+                if (set & LightSpotDirection) properties.spotDirection.assign(values + 16, values + 19);
+                properties.spotExponent = values[19];
+                properties.spotCutoff = values[20];
+                properties.constantAttenuation = values[21];
+                properties.linearAttenuation = values[22];
+                properties.quadraticAttenuation = values[23];
+                setLight(fields[0] - 1, properties);
+                break;
+            }
+            case CommandOp::RemoveLight: {
+                uint32_t light = 0;
+                if (!read(&light, 1)) return false;
+                if (light > 0) {
+                    removeLight(light - 1);
+                }
+                break;
+            }
+            case CommandOp::UpdateModelVertices: {
+                uint32_t fields[3];
+                if (!read(fields, 3) || !checkRow(fields[0])) return false;
+                const Mesh* mesh = models.getMesh(fields[0]).get();
+                size_t floatsPerVertex = mesh ? mesh->layout.getSourceFloatsPerVertex() : 0;
+                if (!mesh || fields[2] % floatsPerVertex != 0 || fields[2] > (size - offset) / 4) {
+                    error = "Command " + std::to_string(command) + ": bad vertex data for model " + std::to_string(fields[0]);
+                    return false;
+                }
+                // Fields are 4-byte aligned in the buffer, so the floats are read in place
+                const float* source = reinterpret_cast<const float*>(data + offset);
+                offset += fields[2] * 4;
+                size_t vertexCount = fields[2] / floatsPerVertex;
+                if (vertexCount > 0 && !updateModelVertices(fields[0], fields[1], source, vertexCount)) {
+                    error = "Command " + std::to_string(command) + ": vertices outside model " + std::to_string(fields[0]);
+                    return false;
+                }
+                break;
+            }
+            default:
+                error = "Command " + std::to_string(command) + " has unknown opcode " + std::to_string(op);
+                return false;
+        }
+    }
+    return true;
+}
+
+void Luau3D::flushMeshUpdates() {
+    meshUpdates.clear();
+    meshUpdateRanges.clear();
+    for (const std::shared_ptr<Mesh>& mesh : dirtyMeshes) {
+        // Replaced since, or listed twice
+        if (mesh->dirtyRanges.empty()) continue;
+        mesh->coalesceDirtyRanges();
+        meshUpdates.push_back({mesh.get(), nullptr, mesh->dirtyRanges.size()});
+        meshUpdateRanges.insert(meshUpdateRanges.end(), mesh->dirtyRanges.begin(), mesh->dirtyRanges.end());
+        mesh->dirtyRanges.clear();
+    }
+    if (meshUpdates.empty()) {
+        dirtyMeshes.clear();
+        return;
+    }
+
+    // Point the updates into the list once it has stopped growing
+    const VertexRange* next = meshUpdateRanges.data();
+    for (MeshUpdate& update : meshUpdates) {
+        update.ranges = next;
+        next += update.rangeCount;
+    }
+    renderer->updateMeshes(meshUpdates);
+    dirtyMeshes.clear();
+}
+
+void Luau3D::collectScriptObjects() {
+    // Collected rows were kept current by removeRow; remove from the last row down
+    if (!objects->collectedRows.empty()) {
+        std::vector<uint32_t> rows;
+        rows.swap(objects->collectedRows);
+        std::sort(rows.begin(), rows.end(), std::greater<uint32_t>());
+        for (uint32_t row : rows) {
+            removeModel(row);
+        }
+    }
+
+    // A mesh whose only references are in the released list is gone once it is
+    // cleared; let the renderer drop its copies first
+    std::vector<std::shared_ptr<Mesh>>& released = objects->released;
+    if (released.empty()) return;
+    std::sort(released.begin(), released.end());
+    releasedMeshes.clear();
+    for (size_t i = 0; i < released.size();) {
+        size_t end = i + 1;
+        while (end < released.size() && released[end] == released[i]) end++;
+        if (released[i].use_count() == static_cast<long>(end - i)) {
+            releasedMeshes.push_back(released[i].get());
+        }
+        i = end;
+    }
+    if (!releasedMeshes.empty()) {
+        renderer->releaseMeshes(releasedMeshes);
+    }
+    released.clear();
+}
+
+// Mesh management implementation
+size_t Luau3D::addMesh(std::shared_ptr<Mesh> mesh) {
+    size_t handle = objects->addMesh(std::move(mesh));
+    if (handle >= meshStatus.size()) {
+        meshStatus.resize(handle + 1);
     }
+    meshStatus[handle] = MeshStatus::Ready;
+    return handle;
+}
+
+std::shared_ptr<Mesh> Luau3D::getMesh(size_t handle) const {
+    return handle < objects->meshes.size() ? objects->meshes[handle] : nullptr;
+}
+
+void Luau3D::releaseMesh(size_t handle) {
+    objects->releaseMesh(handle);
+}
+
+size_t Luau3D::loadMesh(const std::string& path, const VertexLayout* layout) {
+    // Models may reference the placeholder right away; the loaded geometry is moved
+    // into it on the main thread so every reference sees the result
+    auto placeholder = std::make_shared<Mesh>();
+    size_t handle = addMesh(placeholder);
+    meshStatus[handle] = MeshStatus::Loading;
+
+    auto result = std::make_shared<MeshLoadResult>();
+    std::shared_ptr<VertexLayout> requested = layout ? std::make_shared<VertexLayout>(*layout) : nullptr;
+    threadPool->submit(
+        [result, path, requested]() {
+            *result = MeshLoader::load(path, requested.get());
+        },
+        [this, result, placeholder, handle, path]() {
+            bool released = handle >= objects->meshes.size() || objects->meshes[handle] != placeholder;
+            logMeshLoad(path, *result);
+            if (!result->mesh) {
+                if (!released) meshStatus[handle] = MeshStatus::Failed;
+                return;
+            }
+
+            *placeholder = std::move(*result->mesh);
+            models.refreshBounds(placeholder.get());
+            if (!released) meshStatus[handle] = MeshStatus::Ready;
+        });
+    return handle;
+}
+
+Luau3D::MeshStatus Luau3D::getMeshStatus(size_t handle) const {
+    return handle < meshStatus.size() ? meshStatus[handle] : MeshStatus::Failed;
 }
 
 static LuauExport Luau3dExports[] = {
@@ -361,12 +2732,72 @@ static LuauExport Luau3dExports[] = {
     {"getDeltaTime", Luau3D::getDeltaTime},
     {"isRunning", Luau3D::isRunning},
     {"addModel", Luau3D::addModel},
+    {"createModel", Luau3D::createModel},
+    {"getModelIndex", Luau3D::getModelIndex},
     {"removeModel", Luau3D::removeModel},
     {"clearModels", Luau3D::clearModels},
     {"setModelVisible", Luau3D::setModelVisible},
     {"updateModel", Luau3D::updateModel},
+    {"updateModelVertices", Luau3D::updateModelVertices},
+    {"setModelParent", Luau3D::setModelParent},
+    {"getModelParent", Luau3D::getModelParent},
+    {"setModelCFrame", Luau3D::setModelCFrame},
+    {"getModelWorldCFrame", Luau3D::getModelWorldCFrame},
+    {"defineComponent", Luau3D::defineComponent},
+    {"setComponent", Luau3D::setComponent},
+    {"getComponent", Luau3D::getComponent},
+    {"removeComponent", Luau3D::removeComponent},
+    {"queryModels", Luau3D::queryModels},
+    {"translateModels", Luau3D::translateModels},
+    {"setModelsVisible", Luau3D::setModelsVisible},
+    {"setModelOccluder", Luau3D::setModelOccluder},
+    {"setOcclusionCulling", Luau3D::setOcclusionCulling},
+    {"getOcclusionStats", Luau3D::getOcclusionStats},
+    {"setDamageTracking", Luau3D::setDamageTracking},
+    {"getDamageStats", Luau3D::getDamageStats},
+    {"createSkeleton", Luau3D::createSkeleton},
+    {"createAnimationClip", Luau3D::createAnimationClip},
+    {"setModelSkeleton", Luau3D::setModelSkeleton},
+    {"setModelAnimation", Luau3D::setModelAnimation},
+    {"getAnimationStats", Luau3D::getAnimationStats},
+    {"tween", Luau3D::tween},
+    {"cancelTween", Luau3D::cancelTween},
+    {"registerTweenCallback", Luau3D::registerTweenCallback},
+    {"getTweenStats", Luau3D::getTweenStats},
+    {"setModelCollider", Luau3D::setModelCollider},
+    {"registerCollisionCallback", Luau3D::registerCollisionCallback},
+    {"getCollisionStats", Luau3D::getCollisionStats},
+    {"raycastTriangles", Luau3D::raycastTriangles},
+    {"raycastTrianglesMany", Luau3D::raycastTrianglesMany},
+    {"getRaycastStats", Luau3D::getRaycastStats},
+    {"createParticleEmitter", Luau3D::createParticleEmitter},
+    {"setParticleEmitting", Luau3D::setParticleEmitting},
+    {"emitParticles", Luau3D::emitParticles},
+    {"getParticleStats", Luau3D::getParticleStats},
+    {"createTerrain", Luau3D::createTerrain},
+    {"getTerrainHeight", Luau3D::getTerrainHeight},
+    {"getTerrainStats", Luau3D::getTerrainStats},
     {"setLight", Luau3D::setLight},
+    {"removeLight", Luau3D::removeLight},
+    {"submit", Luau3D::submit},
+    {"clearLights", Luau3D::clearLights},
+    {"getLightStats", Luau3D::getLightStats},
     {"registerBeforeRenderCallback", Luau3D::registerBeforeRenderCallback},
+    {"createBoxMesh", Luau3D::createBoxMesh},
+    {"createSphereMesh", Luau3D::createSphereMesh},
+    {"createIcosphereMesh", Luau3D::createIcosphereMesh},
+    {"createCylinderMesh", Luau3D::createCylinderMesh},
+    {"createPlaneMesh", Luau3D::createPlaneMesh},
+    {"createHeightfieldMesh", Luau3D::createHeightfieldMesh},
+    {"releaseMesh", Luau3D::releaseMesh},
+    {"loadMesh", Luau3D::loadMesh},
+    {"getMeshStatus", Luau3D::getMeshStatus},
+    {"getGeometryStats", Luau3D::getGeometryStats},
+    {"loadMeshAsync", Luau3D::loadMeshAsync},
+    {"captureFrame", Luau3D::captureFrame},
+    {"startCapture", Luau3D::startCapture},
+    {"stopCapture", Luau3D::stopCapture},
+    {"getCaptureStats", Luau3D::getCaptureStats},
     {nullptr, nullptr}
 };
 
@@ -3,13 +3,31 @@
 #include "ILuauModule.h"
 #include "IRenderer.h"
 #include "IGUI.h"
+#include "ThreadPool.h"
+#include "SceneGraph.h"
+#include "FrameCapture.h"
+#include "LightClusters.h"
+#include "OcclusionCuller.h"
+#include "DamageTracker.h"
+#include "Skinning.h"
+#include "TweenSystem.h"
+#include "CollisionWorld.h"
+#include "Raycaster.h"
+#include "ParticleSystem.h"
+#include "Terrain.h"
+#include "ScriptObjects.h"
+#include "GeometryCache.h"
 #include "lua.h"
 #include <vector>
+#include <memory>
 #include <chrono>
+#include <string>
+#include <cstdint>
+#include <functional>
 
 class Luau3D : public ILuauModule {
 public:
-    Luau3D(IGUI* gui, IRenderer* renderer);
+    Luau3D(IGUI* gui, IRenderer* renderer, ThreadPool* threadPool);
     ~Luau3D();
 
     // ILuauModule implementation
@@ -22,30 +40,267 @@ public:
     static int isRunning(lua_State* L);
     static int present(lua_State* L);
     static int addModel(lua_State* L);
+    static int createModel(lua_State* L);
+    static int getModelIndex(lua_State* L);
     static int removeModel(lua_State* L);
     static int clearModels(lua_State* L);
     static int setModelVisible(lua_State* L);
     static int updateModel(lua_State* L);
+    static int updateModelVertices(lua_State* L);
+    static int setModelParent(lua_State* L);
+    static int getModelParent(lua_State* L);
+    static int setModelCFrame(lua_State* L);
+    static int getModelWorldCFrame(lua_State* L);
+    static int defineComponent(lua_State* L);
+    static int setComponent(lua_State* L);
+    static int getComponent(lua_State* L);
+    static int removeComponent(lua_State* L);
+    static int queryModels(lua_State* L);
+    static int translateModels(lua_State* L);
+    static int setModelsVisible(lua_State* L);
+    static int setModelOccluder(lua_State* L);
+    static int setOcclusionCulling(lua_State* L);
+    static int getOcclusionStats(lua_State* L);
+    static int setDamageTracking(lua_State* L);
+    static int getDamageStats(lua_State* L);
+    static int createSkeleton(lua_State* L);
+    static int createAnimationClip(lua_State* L);
+    static int setModelSkeleton(lua_State* L);
+    static int setModelAnimation(lua_State* L);
+    static int getAnimationStats(lua_State* L);
+    static int tween(lua_State* L);
+    static int cancelTween(lua_State* L);
+    static int registerTweenCallback(lua_State* L);
+    static int getTweenStats(lua_State* L);
+    static int setModelCollider(lua_State* L);
+    static int registerCollisionCallback(lua_State* L);
+    static int getCollisionStats(lua_State* L);
+    static int raycastTriangles(lua_State* L);
+    static int raycastTrianglesMany(lua_State* L);
+    static int getRaycastStats(lua_State* L);
+    static int createParticleEmitter(lua_State* L);
+    static int setParticleEmitting(lua_State* L);
+    static int emitParticles(lua_State* L);
+    static int getParticleStats(lua_State* L);
+    static int createTerrain(lua_State* L);
+    static int getTerrainHeight(lua_State* L);
+    static int getTerrainStats(lua_State* L);
     static int setLight(lua_State* L);
+    static int removeLight(lua_State* L);
+    static int submit(lua_State* L);
+    static int clearLights(lua_State* L);
+    static int getLightStats(lua_State* L);
     static int registerBeforeRenderCallback(lua_State* L);
+    static int createBoxMesh(lua_State* L);
+    static int createSphereMesh(lua_State* L);
+    static int createIcosphereMesh(lua_State* L);
+    static int createCylinderMesh(lua_State* L);
+    static int createPlaneMesh(lua_State* L);
+    static int createHeightfieldMesh(lua_State* L);
+    static int releaseMesh(lua_State* L);
+    static int loadMesh(lua_State* L);
+    static int getMeshStatus(lua_State* L);
+    static int getGeometryStats(lua_State* L);
+    static int loadMeshAsync(lua_State* L);
+    static int captureFrame(lua_State* L);
+    static int startCapture(lua_State* L);
+    static int stopCapture(lua_State* L);
+    static int getCaptureStats(lua_State* L);
 
-    // Helper to get the Luau3D instance from Lua state
+    // Instance a binding was registered with, from the calling closure's upvalue
     static Luau3D* getInstance(lua_State* L);
 
-    // Model management
-    size_t addModel(const std::vector<float>& vertices, bool visible = true, const CFrame& cframe = CFrame());
+    // Run one frame: the body of present(), for callers outside Luau
+    void presentFrame(lua_State* L);
+
+    // Suspend the calling coroutine while work runs on a worker thread. Once it finishes,
+    // resume runs on the main thread during present() and pushes the values the
+    // coroutine resumes with. Use as the return value of a binding. Each yield stores
+    // a fresh token as the coroutine's thread data, and a completion only resumes the
+    // coroutine while its token is still there.
+    int yieldForWork(lua_State* L, std::function<void()> work, std::function<int(lua_State*)> resume);
+
+    // Mesh management; handles stay valid until released, then are reused
+    size_t addMesh(std::shared_ptr<Mesh> mesh);
+    std::shared_ptr<Mesh> getMesh(size_t handle) const;
+    void releaseMesh(size_t handle);
+
+    // State shared with the Mesh and Model userdata handed to scripts
+    const std::shared_ptr<ScriptObjects>& getScriptObjects() const { return objects; }
+
+    // Load a mesh file on a worker thread. Returns a handle immediately; its mesh stays
+    // empty (and draws nothing) until the load completes in a later present().
+    size_t loadMesh(const std::string& path, const VertexLayout* layout);
+    enum class MeshStatus { Ready, Loading, Failed };
+    MeshStatus getMeshStatus(size_t handle) const;
+
+    // Model management. Models built from vertex arrays share the mesh of identical
+    // earlier arrays (see GeometryCache).
+    size_t addModel(const std::vector<float>& vertices, bool visible = true, const CFrame& cframe = CFrame(),
+                    const VertexLayout& layout = VertexLayout());
+    size_t addModel(std::shared_ptr<Mesh> mesh, bool visible = true, const CFrame& cframe = CFrame());
     void removeModel(size_t index);
     void clearModels();
     void setModelVisible(size_t index, bool visible);
-    void updateModel(size_t index, const std::vector<float>& vertices, bool visible, const CFrame& cframe);
+    void updateModel(size_t index, const std::vector<float>& vertices, bool visible, const CFrame& cframe,
+                     const VertexLayout& layout = VertexLayout());
+    // A null mesh keeps the model's current geometry
+    void updateModel(size_t index, std::shared_ptr<Mesh> mesh, bool visible, const CFrame& cframe);
+    // Overwrite count vertices of a model's geometry starting at vertex offset, from
+    // script-side floats (see VertexLayout::getSourceFloatsPerVertex). Geometry shared
+    // with other models or handles is copied first. Renderers receive the written ranges,
+    // coalesced, with the next frame. Returns false when the range is outside the mesh.
+    bool updateModelVertices(size_t index, size_t offset, const float* source, size_t count);
+    size_t getModelCount() const { return models.size(); }
+
+    // Apply count commands from a command buffer (see CommandBuffer.h). Stops at the first
+    // malformed command, after applying the ones before it, and returns false with error.
+    bool applyCommands(const uint8_t* data, size_t size, size_t count, std::string& error);
+
+    ModelStore& getModels() { return models; }
+    FrameCapture& getCapture() { return capture; }
+
+    // Hierarchy: cframes passed to addModel/updateModel/setModelCFrame are relative to
+    // the parent. Parent -1 detaches. Returns false if the parent would create a cycle.
+    bool setModelParent(size_t index, int parent, bool keepWorld);
+    void setModelCFrame(size_t index, const CFrame& cframe);
+    CFrame getModelWorldCFrame(size_t index);
+
+    // Lights. Up to MaxLights can be set; each frame every draw item gets the strongest
+    // MaxLightsPerItem lights reaching the clusters it overlaps.
+    static const size_t MaxLightsPerItem = 8;
+    static constexpr size_t MaxLights = 4096;
+    // False (and nothing changes) when index is MaxLights or more
+    bool setLight(size_t index, const LightProperties& properties);
+    void removeLight(size_t index);
+    void clearLights();
+    const LightClusters& getLightClusters() const { return lightClusters; }
+
+    // Occlusion culling. Occluder models are rasterized each frame and the models
+    // hidden behind them are not drawn. Enabled by default; costs nothing without occluders.
+    void setModelOccluder(size_t index, bool occluder);
+    void setOcclusionCulling(bool enabled) { occlusionEnabled = enabled; }
+    const OcclusionCuller& getOcclusionCuller() const { return occlusionCuller; }
+
+    // Damage tracking. Only the screen tiles under models that changed are redrawn, and
+    // frames where nothing changed are skipped. Enabled by default; disabling redraws
+    // every frame in full.
+    void setDamageTracking(bool enabled);
+    const DamageTracker& getDamageTracker() const { return damage; }
+
+    // Skeletal animation. Skeletons and clips are referenced by handle; a model given a
+    // skeleton (its mesh needs joints and weights) is skinned on worker threads in
+    // present() whenever its clip layers are set.
+    size_t addSkeleton(std::shared_ptr<Skeleton> skeleton);
+    std::shared_ptr<Skeleton> getSkeleton(size_t handle) const;
+    size_t addAnimationClip(std::shared_ptr<AnimationClip> clip);
+    std::shared_ptr<AnimationClip> getAnimationClip(size_t handle) const;
+    // Null detaches, restoring the bind-pose mesh
+    bool setModelSkeleton(size_t index, std::shared_ptr<Skeleton> skeleton, std::string& error);
+    bool setModelAnimation(size_t index, std::vector<Skinner::Layer> layers);
+    const Skinner& getSkinner() const { return skinner; }
+
+    // Tweens move a model's local cframe to a target natively, advanced once per frame in
+    // present(). Starting a tween replaces the model's running one.
+    uint32_t tweenModel(size_t index, const CFrame& target, float duration, Easing easing, TweenLoop loop);
+    bool cancelTween(uint32_t id) { return tweens.cancel(id); }
+    const TweenSystem& getTweens() const { return tweens; }
+
+    // Colliders are tested against each other once per frame in present(), after
+    // transforms settle; contact changes go to the collision callback.
+    void setModelCollider(size_t index, const CollisionWorld::Collider& collider) { collisions.setCollider(index, collider); }
+    const CollisionWorld& getCollisions() const { return collisions; }
+
+    // Exact ray queries against the triangles of visible models. Mesh BVHs are built the
+    // first time a query sees the mesh; the call brings everything up to date first.
+    bool raycastTriangles(const float origin[3], const float direction[3], float maxDistance, RaycastHit& hit);
+    void raycastTriangles(const float* rays, size_t count, float maxDistance, std::vector<RaycastHit>& hits);
+    const Raycaster& getRaycaster() const { return raycaster; }
+
+    // Particle emitters are models whose mesh is rewritten with one quad per particle in
+    // present(), on worker threads. Particles live in the emitter model's space, so they
+    // follow it when it moves.
+    size_t addParticleEmitter(const EmitterSettings& settings, bool visible = true, const CFrame& cframe = CFrame());
+    bool setParticleEmitting(size_t index, bool emitting) { return particles.setEmitting(index, emitting); }
+    bool emitParticles(size_t index, uint32_t count) { return particles.burst(index, count); }
+    const ParticleSystem& getParticles() const { return particles; }
+
+    // Streaming heightmap terrain. A terrain is a root model with one child model per
+    // chunk; chunk meshes are built on worker threads at a level of detail picked by
+    // distance, within the terrain's memory budget. Removing the root removes the chunks.
+    // Returns false with error when the heightmap cannot be used.
+    bool addTerrain(const TerrainSettings& settings, bool visible, const CFrame& cframe, size_t& index, std::string& error);
+    // Terrain whose root is the model, or null
+    const Terrain* getTerrain(size_t index) const;
+
+    // Make getDeltaTime return a constant step instead of wall-clock time; 0 restores wall clock
+    void setFixedDeltaTime(double seconds) { fixedDeltaTime = seconds; }
 
     // Call the beforeRender callback if registered
     void callBeforeRenderCallback(lua_State* L);
+    // Advance tweens by the frame step and report the completed ones to the tween callback
+    void advanceTweens(lua_State* L);
+    // Advance particle emitters by the frame step
+    void advanceParticles();
+    // Stream terrain chunks for the current eye position
+    void updateTerrains();
+    // Find this frame's contacts and report began, stayed and ended pairs to the collision callback
+    void updateCollisions(lua_State* L);
 
 private:
+    // Remove models whose userdata was collected and free the copies of meshes nothing
+    // uses any more
+    void collectScriptObjects();
+    // Hand the vertex ranges written since the last frame to the renderer
+    void flushMeshUpdates();
+    // Drop this frame's draw items hidden behind occluders
+    void cullOccluded();
+    // Drop this frame's draw items of terrain chunks out of range or view
+    void cullTerrains();
+    // Fill in the lights of this frame's draw items
+    void assignLights();
+
     IGUI* gui;
     IRenderer* renderer;
-    std::vector<Model> models;
+    ModelStore models;              // World-space columns the renderer draws from
+    SceneGraph sceneGraph;          // Local transforms and parenting, parallel to models
+    std::vector<DrawItem> drawItems;   // Rebuilt every frame, reused to avoid allocation
+    std::vector<uint32_t> queryRows;   // Scratch for query bindings
+    std::vector<float> vertexScratch;  // Scratch for vertex tables
+    std::vector<std::shared_ptr<Mesh>> dirtyMeshes;  // Meshes with dirty ranges
+    std::vector<MeshUpdate> meshUpdates;      // Rebuilt every frame
+    std::vector<VertexRange> meshUpdateRanges;
+    std::vector<LightProperties> lights;
+    std::vector<bool> lightActive;     // Parallel to lights; removed lights leave a gap
+    bool lightsDirty;                  // Lights changed since the clusters were built
+    LightClusters lightClusters;
+    std::vector<uint32_t> itemLights;  // Light lists of drawItems, rebuilt every frame
+    std::shared_ptr<ScriptObjects> objects;  // Owns the meshes by handle
+    std::vector<MeshStatus> meshStatus;  // Parallel to objects->meshes
+    std::vector<const Mesh*> releasedMeshes;  // Scratch for collectScriptObjects
+    GeometryCache geometry;         // Shares meshes built from identical vertex arrays
+    ThreadPool* threadPool;
+    uintptr_t yieldSequence;        // Last token handed out by yieldForWork
+    FrameCapture capture;           // Encodes on threadPool; declared after it
+    OcclusionCuller occlusionCuller;   // Rasterizes on threadPool
+    bool occlusionEnabled;
+    std::vector<uint32_t> occluderRows;  // Scratch for occlusion culling
+    DamageTracker damage;
+    bool damageEnabled;
+    std::vector<std::shared_ptr<Skeleton>> skeletons;
+    std::vector<std::shared_ptr<AnimationClip>> animationClips;
+    Skinner skinner;                // Skins on threadPool
+    TweenSystem tweens;
+    int tweenCallbackRef;
+    std::chrono::steady_clock::time_point lastTweenTime;
+    CollisionWorld collisions;      // Sweeps on threadPool
+    int collisionCallbackRef;
+    Raycaster raycaster;            // Traces batches on threadPool
+    std::vector<RaycastHit> raycastHits;  // Scratch for raycastTrianglesMany
+    ParticleSystem particles;       // Simulates on threadPool
+    std::chrono::steady_clock::time_point lastParticleTime;
+    std::vector<std::unique_ptr<Terrain>> terrains;  // Build chunks on threadPool
     int beforeRenderCallbackRef;
     std::chrono::steady_clock::time_point lastDeltaTime;
+    double fixedDeltaTime;  // Seconds per frame when > 0
 };
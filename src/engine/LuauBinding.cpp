@@ -3,13 +3,14 @@
 #include "lualib.h"
 #include "luaconf.h"
 #include "luacode.h"
+#include "Trace.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
 #include <filesystem>
 
-LuauBinding::LuauBinding() : L(nullptr) {
+LuauBinding::LuauBinding() : L(nullptr), recorder(nullptr) {
 }
 
 LuauBinding::~LuauBinding() {
@@ -171,12 +172,37 @@ bool LuauBinding::loadModule(const std::string& modulePath) {
     }
 }
 
-void LuauBinding::makeTableForInternalModule(lua_State* L, const LuauExport exports[])
+// Records the call, then forwards to the wrapped export. The module stays the first
+// upvalue so the export finds it as usual.
+// Upvalues: module, recorder, function id, original function.
+static int recordedCall(lua_State* L) {
+    TraceRecorder* recorder = static_cast<TraceRecorder*>(lua_touserdata(L, lua_upvalueindex(2)));
+    int functionId = static_cast<int>(lua_tointeger(L, lua_upvalueindex(3)));
+    recorder->recordCall(functionId, L);
+    lua_CFunction function = lua_tocfunction(L, lua_upvalueindex(4));
+    return function(L);
+}
+
+ILuauModule* LuauBinding::getModule(lua_State* L) {
+    return static_cast<ILuauModule*>(lua_touserdata(L, lua_upvalueindex(1)));
+}
+
+void LuauBinding::makeTableForInternalModule(lua_State* L, ILuauModule* module)
 {
-    lua_createtable(L, 0, sizeof(exports) / sizeof(exports[0]));
+    const std::string name = module->getModuleName();
+    const LuauExport* exports = module->getExports();
+    lua_createtable(L, 0, 0);
     for (int i = 0; exports[i].name != nullptr; i++)
     {
-        lua_pushcfunction(L, exports[i].func, exports[i].name);
+        lua_pushlightuserdata(L, module);
+        if (recorder) {
+            lua_pushlightuserdata(L, recorder);
+            lua_pushinteger(L, recorder->registerFunction(name, exports[i].name));
+            lua_pushcfunction(L, exports[i].func, exports[i].name);
+            lua_pushcclosure(L, recordedCall, exports[i].name, 4);
+        } else {
+            lua_pushcclosure(L, exports[i].func, exports[i].name, 1);
+        }
         lua_setfield(L, -2, exports[i].name);
     }
     lua_setreadonly(L, -1, 1);
@@ -188,8 +214,9 @@ void LuauBinding::registerBindings() {
     lua_setglobal(L, "require");
 }
 
-void LuauBinding::registerInternalModule(const std::string& name, const LuauExport exports[]) {
-    makeTableForInternalModule(L, exports);
+void LuauBinding::registerInternalModule(ILuauModule* module) {
+    makeTableForInternalModule(L, module);
     int ref = lua_ref(L, -1);
-    moduleCache[name] = ref;
+    lua_pop(L, 1);
+    moduleCache[module->getModuleName()] = ref;
 } 
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "lualib.h"
 #include "ILuauModule.h"
 
+class TraceRecorder;
+
 class LuauBinding {
 public:
     LuauBinding();
@@ -30,11 +32,19 @@ public:
     // Load a module (internal or external)
     bool loadModule(const std::string& modulePath);
 
-    // Register internal module exports
-    void registerInternalModule(const std::string& name, const LuauExport exports[]);
+    // Register a module's exports under its module name
+    void registerInternalModule(ILuauModule* module);
+
+    // Make a table of a module's exports. Each export is a closure whose first upvalue is
+    // the module, so exports find their instance without any global state (see getModule).
+    void makeTableForInternalModule(lua_State *L, ILuauModule* module);
+
+    // Module of the export being called, null outside module exports
+    static ILuauModule* getModule(lua_State* L);
 
-    // Make a table for internal module exports
-    void makeTableForInternalModule(lua_State *L, const LuauExport exports[]);
+    // Record every call into modules registered from now on (null stops wrapping new modules)
+    void setRecorder(TraceRecorder* traceRecorder) { recorder = traceRecorder; }
+    TraceRecorder* getRecorder() const { return recorder; }
 
     // Get the Lua state
     lua_State* getLuaState() const { return L; }
@@ -43,4 +53,5 @@ private:
     lua_State* L;
     std::string currentScriptPath;
     std::unordered_map<std::string, int> moduleCache; // Cache of loaded modules by path
+    TraceRecorder* recorder;
 }; 
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../IRenderer.h"
 #include "../IGUI.h"
 #include <iostream>
+#include <unordered_map>
 
 class GLRenderer : public IRenderer {
 public:
@@ -29,11 +30,25 @@ public:
     int getHeight() const override { return height; }
 
     // Light management
-    void setLight(int lightNum, const LightProperties& properties) override;
+    void setLights(const std::vector<LightProperties>& lights) override;
     void enableLighting(bool enable) override;
 
+    // Patch the GPU copies of meshes rewritten in place
+    void updateMeshes(const std::vector<MeshUpdate>& updates) override;
+    void releaseMeshes(const std::vector<const Mesh*>& meshes) override;
+
     // Render all visible models
-    void render(const std::vector<Model>& models) override;
+    void render(const std::vector<DrawItem>& items) override;
+
+    // flushBuffer leaves the back buffer undefined, so every drawn frame is a full redraw;
+    // unchanged frames are still skipped
+    int getBufferAge() const override { return 0; }
+    void setDamage(const std::vector<ScreenRect>& rects) override {}
+
+    // Read back the back buffer through a ring of pixel pack buffers. While reads come
+    // every frame, this returns the frame rendered ReadbackRing - 1 frames earlier
+    // without waiting on the GPU; otherwise it waits for the current frame.
+    bool readPixels(std::vector<uint8_t>& pixels, int& width, int& height) override;
 
 private:
     float clearColor[4];
@@ -43,9 +58,32 @@ private:
     void* glContext; // (NSOpenGLContext*)
     void* glView;    // (NSOpenGLView*)
 
+    // GPU copy of a mesh, uploaded when first drawn or replaced and patched by updateMeshes
+    struct GpuMesh {
+        unsigned int vbo = 0, ebo = 0;
+        uint64_t revision = 0;
+        uint64_t lastFrame = 0;  // Copies not drawn for a while are freed
+    };
+    GpuMesh& getGpuMesh(const Mesh& mesh);
+    void evictGpuMeshes();
+    std::unordered_map<const Mesh*, GpuMesh> gpuMeshes;
+    uint64_t frameCounter;
+
+    // Pixel pack buffer readPixels started a transfer into
+    struct Readback {
+        unsigned int pbo = 0;
+        int width = 0, height = 0;
+        bool filled = false;
+        uint64_t frame = 0;  // frameCounter when filled
+    };
+    static constexpr int ReadbackRing = 3;
+    Readback readbacks[ReadbackRing];
+    int readbackNext;
+    bool mapReadback(Readback& readback, std::vector<uint8_t>& pixels, int& width, int& height);
+
     // Modern OpenGL
     unsigned int shaderProgram;
-    unsigned int vao, vbo;
+    unsigned int vao;
     int uMVP; // uniform location for MVP matrix
     bool glInited;
     void ensureGLObjects();
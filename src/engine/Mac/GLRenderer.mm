@@ -5,6 +5,19 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstring>
+
+// Map an engine vertex component type to its GL equivalent
+static GLenum toGLType(VertexComponentType type) {
+    switch (type) {
+        case VertexComponentType::Float32: return GL_FLOAT;
+        case VertexComponentType::Float16: return GL_HALF_FLOAT;
+        case VertexComponentType::UNorm8: return GL_UNSIGNED_BYTE;
+        case VertexComponentType::SNorm8: return GL_BYTE;
+        case VertexComponentType::Int2_10_10_10: return GL_INT_2_10_10_10_REV;
+    }
+    return GL_FLOAT;
+}
 
 static const char* vertexShaderSrc = R"(
 #version 150
@@ -29,7 +42,7 @@ void main() {
 
 GLRenderer::GLRenderer(IGUI* gui)
     : gui(gui), glContext(nullptr), glView(nullptr), width(800), height(600),
-      shaderProgram(0), vao(0), vbo(0), uMVP(-1), glInited(false) {
+      frameCounter(0), readbackNext(0), shaderProgram(0), vao(0), uMVP(-1), glInited(false) {
     clearColor[0] = clearColor[1] = clearColor[2] = 0.0f;
     clearColor[3] = 1.0f;
     std::cout << "[Mac] GLRenderer constructed" << std::endl;
@@ -59,10 +72,18 @@ void GLRenderer::ensureGLObjects() {
 }
 
 void GLRenderer::destroyGLObjects() {
-    if (vbo) glDeleteBuffers(1, &vbo);
+    for (auto& entry : gpuMeshes) {
+        glDeleteBuffers(1, &entry.second.vbo);
+        glDeleteBuffers(1, &entry.second.ebo);
+    }
+    gpuMeshes.clear();
+    for (Readback& readback : readbacks) {
+        if (readback.pbo) glDeleteBuffers(1, &readback.pbo);
+        readback = Readback();
+    }
     if (vao) glDeleteVertexArrays(1, &vao);
     if (shaderProgram) glDeleteProgram(shaderProgram);
-    vbo = vao = shaderProgram = 0;
+    vao = shaderProgram = 0;
     glInited = false;
 }
 
@@ -109,7 +130,69 @@ void GLRenderer::setupShaders() {
 
 void GLRenderer::setupBuffers() {
     glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
+}
+
+GLRenderer::GpuMesh& GLRenderer::getGpuMesh(const Mesh& mesh) {
+    GpuMesh& gpu = gpuMeshes[&mesh];
+    gpu.lastFrame = frameCounter;
+    if (!gpu.vbo) {
+        glGenBuffers(1, &gpu.vbo);
+        glGenBuffers(1, &gpu.ebo);
+    }
+    // New, replaced, or a new mesh at a freed mesh's address
+    if (gpu.revision != mesh.revision) {
+        glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.getVertexDataSize(), mesh.getVertexData(), GL_DYNAMIC_DRAW);
+        if (mesh.isIndexed()) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexCount() * sizeof(uint32_t),
+                         mesh.getIndexData(), GL_STATIC_DRAW);
+        }
+        gpu.revision = mesh.revision;
+    }
+    return gpu;
+}
+
+void GLRenderer::releaseMeshes(const std::vector<const Mesh*>& meshes) {
+    for (const Mesh* mesh : meshes) {
+        auto it = gpuMeshes.find(mesh);
+        if (it == gpuMeshes.end()) continue;
+        glDeleteBuffers(1, &it->second.vbo);
+        glDeleteBuffers(1, &it->second.ebo);
+        gpuMeshes.erase(it);
+    }
+}
+
+void GLRenderer::evictGpuMeshes() {
+    // Only meshes the engine releases are reported, so copies of meshes not drawn for a
+    // few seconds go too
+    const uint64_t MaxIdleFrames = 300;
+    for (auto it = gpuMeshes.begin(); it != gpuMeshes.end();) {
+        if (frameCounter - it->second.lastFrame > MaxIdleFrames) {
+            glDeleteBuffers(1, &it->second.vbo);
+            glDeleteBuffers(1, &it->second.ebo);
+            it = gpuMeshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void GLRenderer::updateMeshes(const std::vector<MeshUpdate>& updates) {
+    ensureGLObjects();
+    for (const MeshUpdate& update : updates) {
+        auto it = gpuMeshes.find(update.mesh);
+        // Meshes without a current copy are uploaded whole when next drawn
+        if (it == gpuMeshes.end() || it->second.revision != update.mesh->revision) continue;
+
+        const size_t stride = update.mesh->layout.getStride();
+        const uint8_t* data = update.mesh->getVertexData();
+        glBindBuffer(GL_ARRAY_BUFFER, it->second.vbo);
+        for (size_t i = 0; i < update.rangeCount; i++) {
+            const VertexRange& range = update.ranges[i];
+            glBufferSubData(GL_ARRAY_BUFFER, range.first * stride, range.count * stride, data + range.first * stride);
+        }
+    }
 }
 
 void GLRenderer::setMVP(const float* mvp) {
@@ -202,15 +285,15 @@ void GLRenderer::setClearColor(float r, float g, float b, float a) {
     clearColor[3] = a;
 }
 
-void GLRenderer::setLight(int lightNum, const LightProperties& properties) {
-    std::cout << "[Mac] Set light " << lightNum << std::endl;
+void GLRenderer::setLights(const std::vector<LightProperties>& lights) {
+    std::cout << "[Mac] Set " << lights.size() << " lights" << std::endl;
 }
 
 void GLRenderer::enableLighting(bool enable) {
     std::cout << "[Mac] " << (enable ? "Enable" : "Disable") << " lighting" << std::endl;
 }
 
-void GLRenderer::render(const std::vector<Model>& models) {
+void GLRenderer::render(const std::vector<DrawItem>& items) {
     ensureGLObjects();
     glGetError(); // Clear any previous errors
     
@@ -220,25 +303,36 @@ void GLRenderer::render(const std::vector<Model>& models) {
     
     glUseProgram(shaderProgram);
     glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    frameCounter++;
     
     // Set up vertex attributes
     glEnableVertexAttribArray(0); // Position
     glEnableVertexAttribArray(1); // Color
     
-    const int stride = 6 * sizeof(float);
-    
     // Now try to draw the models
-    for (const auto& model : models) {
-        if (!model.visible || model.vertices.empty()) continue;
+    for (const DrawItem& item : items) {
+        const Mesh& mesh = *item.mesh;
         
-        // Upload model data to GPU
-        glBufferData(GL_ARRAY_BUFFER, model.vertices.size() * sizeof(float), 
-                     model.vertices.data(), GL_DYNAMIC_DRAW);
+        // The packed model data lives on the GPU as-is, uploaded once per revision.
+        // The element binding is part of the VAO state.
+        const GpuMesh& gpu = getGpuMesh(mesh);
+        glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.ebo);
         
-        // Set up vertex attributes for model
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        // Set up vertex attributes for model straight from its layout
+        const GLsizei stride = static_cast<GLsizei>(mesh.layout.getStride());
+        const VertexAttributeDesc* position = mesh.layout.find(VertexAttribute::Position);
+        const VertexAttributeDesc* color = mesh.layout.find(VertexAttribute::Color);
+        glVertexAttribPointer(0, position->components, toGLType(position->type),
+                              position->normalized ? GL_TRUE : GL_FALSE, stride, (void*)(uintptr_t)position->offset);
+        if (color) {
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, color->components, toGLType(color->type),
+                                  color->normalized ? GL_TRUE : GL_FALSE, stride, (void*)(uintptr_t)color->offset);
+        } else {
+            glDisableVertexAttribArray(1);
+            glVertexAttrib3f(1, 1.0f, 1.0f, 1.0f);
+        }
         
         // Use projection matrix
         float projectionMatrix[16] = {
@@ -250,8 +344,11 @@ void GLRenderer::render(const std::vector<Model>& models) {
         setMVP(projectionMatrix);
         
         // Draw model
-        int vertexCount = model.vertices.size() / 6;
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        if (!mesh.isIndexed()) {
+            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh.vertexCount));
+        } else {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.getIndexCount()), GL_UNSIGNED_INT, (void*)0);
+        }
     }
     
     // Clean up
@@ -259,4 +356,64 @@ void GLRenderer::render(const std::vector<Model>& models) {
     glDisableVertexAttribArray(1);
     glBindVertexArray(0);
     glUseProgram(0);
-} 
\ No newline at end of file
+    evictGpuMeshes();
+} 
+bool GLRenderer::readPixels(std::vector<uint8_t>& pixels, int& width, int& height) {
+    // Errors left by earlier calls must not fail this read
+    glGetError();
+
+    // Read the area the viewport covers
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) {
+        return false;
+    }
+
+    // Start this frame's transfer; glReadPixels into a bound pack buffer returns at once
+    Readback& current = readbacks[readbackNext];
+    readbackNext = (readbackNext + 1) % ReadbackRing;
+    if (!current.pbo) glGenBuffers(1, &current.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, current.pbo);
+    if (current.width != viewport[2] || current.height != viewport[3]) {
+        current.width = viewport[2];
+        current.height = viewport[3];
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(current.width) * current.height * 4, nullptr,
+                     GL_STREAM_READ);
+    }
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, current.width, current.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        current.filled = false;
+        return false;
+    }
+    current.filled = true;
+    current.frame = frameCounter;
+
+    // The oldest buffer in the ring finished transferring while later frames rendered.
+    // Use it when it holds a recent frame; after a gap in the reads it is stale, so wait
+    // for the current frame instead.
+    Readback& oldest = readbacks[readbackNext];
+    if (&oldest != &current && oldest.filled && frameCounter - oldest.frame < ReadbackRing) {
+        return mapReadback(oldest, pixels, width, height);
+    }
+    return mapReadback(current, pixels, width, height);
+}
+
+bool GLRenderer::mapReadback(Readback& readback, std::vector<uint8_t>& pixels, int& width, int& height) {
+    // Each frame is handed out once
+    readback.filled = false;
+    width = readback.width;
+    height = readback.height;
+    size_t size = static_cast<size_t>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    if (data) {
+        pixels.resize(size);
+        memcpy(pixels.data(), data, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return data != nullptr && glGetError() == GL_NO_ERROR;
+}
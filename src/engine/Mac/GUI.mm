@@ -1,10 +1,8 @@
 #include "GUI.h"
+#include "../Trace.h"
 #import <Cocoa/Cocoa.h>
 #include <iostream>
 
-// Initialize global instance pointer
-static GUI* g_gui = nullptr;
-
 // Objective-C++ delegate for window events
 @interface MacWindowDelegate : NSObject <NSWindowDelegate>
 @property (nonatomic, assign) void* userData;
@@ -50,12 +48,10 @@ static void MacCloseCallback(void* userData) {
 
 GUI::GUI(LuauBinding* luauBinding)
     : luauBinding(luauBinding), width(800), height(600), windowOpen(false), window(nullptr), delegate(nullptr) {
-    g_gui = this;
     std::cout << "[Mac] GUI constructed" << std::endl;
 }
 
 GUI::~GUI() {
-    g_gui = nullptr;
     if (window) {
         NSWindow* win = (NSWindow*)window;
         [win orderOut:nil];
@@ -139,11 +135,12 @@ void GUI::onWindowClosed() {
 }
 
 GUI* GUI::getInstance(lua_State* L) {
-    if (!g_gui) {
+    GUI* instance = static_cast<GUI*>(LuauBinding::getModule(L));
+    if (!instance) {
         luaL_error(L, "GUI instance not initialized");
         return nullptr;
     }
-    return g_gui;
+    return instance;
 }
 
 // Register a keyboard callback from Lua
@@ -183,6 +180,10 @@ void GUI::handleKeyEvent(const std::string& key, const std::string& action) {
     lua_State* L = luauBinding->getLuaState();
     if (!L) return;
 
+    if (TraceRecorder* recorder = luauBinding->getRecorder()) {
+        recorder->recordKeyEvent(key, action);
+    }
+
     // Call each registered callback
     for (int ref : keyboardCallbacks) {
         lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
@@ -0,0 +1,53 @@
+#include "Mesh.h"
+#include <algorithm>
+#include <atomic>
+
+uint64_t nextMeshRevision() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
+void Mesh::makeWritable() {
+    if (!mapping) {
+        return;
+    }
+    vertices.assign(mappedVertices, mappedVertices + getVertexDataSize());
+    indices.assign(mappedIndices, mappedIndices + mappedIndexCount);
+    mapping.reset();
+    mappedVertices = nullptr;
+    mappedIndices = nullptr;
+    mappedIndexCount = 0;
+}
+
+void Mesh::coalesceDirtyRanges() {
+    if (dirtyRanges.size() < 2) {
+        return;
+    }
+    std::sort(dirtyRanges.begin(), dirtyRanges.end(),
+              [](const VertexRange& a, const VertexRange& b) { return a.first < b.first; });
+    size_t merged = 0;
+    for (size_t i = 1; i < dirtyRanges.size(); i++) {
+        VertexRange& last = dirtyRanges[merged];
+        const VertexRange& next = dirtyRanges[i];
+        if (next.first <= last.first + last.count) {
+            last.count = std::max(last.first + last.count, next.first + next.count) - last.first;
+        } else {
+            dirtyRanges[++merged] = next;
+        }
+    }
+    dirtyRanges.resize(merged + 1);
+}
+
+Bounds Mesh::computeBounds(size_t first, size_t count) const {
+    Bounds bounds;
+    const uint8_t* data = getVertexData();
+    for (size_t i = first; i < first + count && i < vertexCount; i++) {
+        float position[4];
+        unpackAttribute(layout, data, i, VertexAttribute::Position, position);
+        for (int axis = 0; axis < 3; axis++) {
+            if (i == first || position[axis] < bounds.min[axis]) bounds.min[axis] = position[axis];
+            if (i == first || position[axis] > bounds.max[axis]) bounds.max[axis] = position[axis];
+        }
+    }
+    return bounds;
+}
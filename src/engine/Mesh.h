@@ -0,0 +1,75 @@
+#pragma once
+
+#include "VertexFormat.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Axis-aligned box in object space
+struct Bounds {
+    float min[3] = {0.0f, 0.0f, 0.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// Run of vertices [first, first + count)
+struct VertexRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+// Unique value for Mesh::revision, safe to call from any thread
+uint64_t nextMeshRevision();
+
+// Packed triangle geometry, shareable between models.
+// Storage is either owned (vertices/indices) or borrowed read-only from a
+// memory-mapped mesh file; use the accessors to read either kind.
+struct Mesh {
+    VertexLayout layout;            // Describes how each vertex is packed
+    size_t vertexCount = 0;
+    std::vector<uint8_t> vertices;  // Owned packed vertex data, layout.getStride() bytes per vertex
+    std::vector<uint32_t> indices;  // Owned triangle list indices; empty means non-indexed
+
+    // Borrowed storage, valid while mapping is alive
+    std::shared_ptr<MappedFile> mapping;
+    const uint8_t* mappedVertices = nullptr;
+    const uint32_t* mappedIndices = nullptr;
+    size_t mappedIndexCount = 0;
+
+    const uint8_t* getVertexData() const { return mapping ? mappedVertices : vertices.data(); }
+    size_t getVertexDataSize() const { return vertexCount * layout.getStride(); }
+    const uint32_t* getIndexData() const { return mapping ? mappedIndices : indices.data(); }
+    size_t getIndexCount() const { return mapping ? mappedIndexCount : indices.size(); }
+    bool isIndexed() const { return getIndexCount() > 0; }
+
+    // Change tracking for renderers that keep their own copy of the geometry. revision
+    // changes whenever the geometry is replaced as a whole; dirtyRanges lists vertices
+    // rewritten in place since the renderer was last handed the mesh.
+    uint64_t revision = nextMeshRevision();
+    std::vector<VertexRange> dirtyRanges;
+    // Counts in-place writes, for caches that outlive the renderer's dirty ranges
+    uint64_t edits = 0;
+    // Regenerated every frame (particle quads); skipped by caches such as the raycaster's
+    bool transient = false;
+
+    // Copy borrowed storage into owned storage so the mesh can be modified
+    void makeWritable();
+
+    // Record an in-place write of count vertices starting at first
+    void markDirty(size_t first, size_t count) {
+        dirtyRanges.push_back({static_cast<uint32_t>(first), static_cast<uint32_t>(count)});
+        edits++;
+    }
+    // Record a wholesale replacement; pending ranges are covered by it
+    void markReplaced() {
+        revision = nextMeshRevision();
+        dirtyRanges.clear();
+    }
+    // Sort dirtyRanges and merge the ones that overlap or touch
+    void coalesceDirtyRanges();
+
+    // Bounds of the vertex positions (empty meshes give a zero box)
+    Bounds computeBounds() const { return computeBounds(0, vertexCount); }
+    // Bounds of count vertices starting at first
+    Bounds computeBounds(size_t first, size_t count) const;
+};
@@ -0,0 +1,396 @@
+#include "MeshBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+const float Pi = 3.14159265358979323846f;
+
+// Intermediate indexed geometry before colors are evaluated and vertices packed
+struct Geometry {
+    std::vector<float> positions;  // xyz
+    std::vector<float> normals;    // xyz
+    std::vector<uint32_t> indices;
+
+    uint32_t addVertex(float x, float y, float z, float nx, float ny, float nz) {
+        positions.insert(positions.end(), {x, y, z});
+        normals.insert(normals.end(), {nx, ny, nz});
+        return static_cast<uint32_t>(positions.size() / 3 - 1);
+    }
+
+    void addTriangle(uint32_t a, uint32_t b, uint32_t c) {
+        indices.insert(indices.end(), {a, b, c});
+    }
+
+    size_t vertexCount() const { return positions.size() / 3; }
+};
+
+void normalize(float* v) {
+    float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (len > 0.0f) {
+        v[0] /= len;
+        v[1] /= len;
+        v[2] /= len;
+    }
+}
+
+// Split shared vertices so every triangle gets its own face normal
+Geometry makeFlat(const Geometry& smooth) {
+    Geometry flat;
+    flat.positions.reserve(smooth.indices.size() * 3);
+    flat.normals.reserve(smooth.indices.size() * 3);
+
+    for (size_t t = 0; t + 2 < smooth.indices.size(); t += 3) {
+        const float* p0 = &smooth.positions[smooth.indices[t] * 3];
+        const float* p1 = &smooth.positions[smooth.indices[t + 1] * 3];
+        const float* p2 = &smooth.positions[smooth.indices[t + 2] * 3];
+
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3] = {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0],
+        };
+        normalize(n);
+
+        flat.addVertex(p0[0], p0[1], p0[2], n[0], n[1], n[2]);
+        flat.addVertex(p1[0], p1[1], p1[2], n[0], n[1], n[2]);
+        flat.addVertex(p2[0], p2[1], p2[2], n[0], n[1], n[2]);
+    }
+    // Every vertex is used exactly once, so the mesh is drawn non-indexed
+    return flat;
+}
+
+// Evaluate colors and pack the geometry into the requested layout
+std::shared_ptr<Mesh> finish(const Geometry& smooth, const MeshBuildOptions& options) {
+    Geometry flat;
+    const Geometry* source = &smooth;
+    if (!options.smooth) {
+        flat = makeFlat(smooth);
+        source = &flat;
+    }
+
+    const size_t count = source->vertexCount();
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            float v = source->positions[i * 3 + c];
+            boundsMin[c] = i == 0 ? v : std::min(boundsMin[c], v);
+            boundsMax[c] = i == 0 ? v : std::max(boundsMax[c], v);
+        }
+    }
+
+    const int floatsPerVertex = options.layout.getSourceFloatsPerVertex();
+    const int normalOffset = options.layout.getSourceOffset(VertexAttribute::Normal);
+    std::vector<float> interleaved(count * floatsPerVertex);
+    for (size_t i = 0; i < count; i++) {
+        const float* p = &source->positions[i * 3];
+        const float* n = &source->normals[i * 3];
+        float* out = &interleaved[i * floatsPerVertex];
+        out[0] = p[0];
+        out[1] = p[1];
+        out[2] = p[2];
+        MeshBuilder::evaluateColor(options.color, p, n, boundsMin, boundsMax, out + 3);
+        if (normalOffset >= 0) {
+            out[normalOffset] = n[0];
+            out[normalOffset + 1] = n[1];
+            out[normalOffset + 2] = n[2];
+        }
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->layout = options.layout;
+    mesh->vertexCount = count;
+    mesh->vertices.resize(count * options.layout.getStride());
+    packVertices(options.layout, interleaved.data(), count, mesh->vertices.data());
+    if (options.smooth) {
+        mesh->indices = smooth.indices;
+    }
+    return mesh;
+}
+
+} // namespace
+
+namespace MeshBuilder {
+
+void evaluateColor(const VertexColorFunction& color, const float* position, const float* normal,
+                   const float* boundsMin, const float* boundsMax, float* out) {
+    auto remap = [&](int axis) {
+        float extent = boundsMax[axis] - boundsMin[axis];
+        return extent > 0.0f ? (position[axis] - boundsMin[axis]) / extent : 0.5f;
+    };
+
+    switch (color.mode) {
+        case VertexColorFunction::Mode::Constant:
+            out[0] = color.colorA[0];
+            out[1] = color.colorA[1];
+            out[2] = color.colorA[2];
+            break;
+        case VertexColorFunction::Mode::Normal:
+            out[0] = normal[0] * 0.5f + 0.5f;
+            out[1] = normal[1] * 0.5f + 0.5f;
+            out[2] = normal[2] * 0.5f + 0.5f;
+            break;
+        case VertexColorFunction::Mode::Position:
+            out[0] = remap(0);
+            out[1] = remap(1);
+            out[2] = remap(2);
+            break;
+        case VertexColorFunction::Mode::Gradient: {
+            float t = remap(color.axis);
+            for (int c = 0; c < 3; c++) {
+                out[c] = color.colorA[c] + (color.colorB[c] - color.colorA[c]) * t;
+            }
+            break;
+        }
+    }
+}
+
+std::shared_ptr<Mesh> box(float sizeX, float sizeY, float sizeZ, const MeshBuildOptions& options) {
+    const float hx = sizeX * 0.5f, hy = sizeY * 0.5f, hz = sizeZ * 0.5f;
+
+    // Each face: normal, then two in-plane axes chosen so u x v points along the normal
+    struct Face { float n[3], u[3], v[3]; };
+    static const Face faces[6] = {
+        {{ 1, 0, 0}, { 0, 0,-1}, { 0, 1, 0}},
+        {{-1, 0, 0}, { 0, 0, 1}, { 0, 1, 0}},
+        {{ 0, 1, 0}, { 1, 0, 0}, { 0, 0,-1}},
+        {{ 0,-1, 0}, { 1, 0, 0}, { 0, 0, 1}},
+        {{ 0, 0, 1}, { 1, 0, 0}, { 0, 1, 0}},
+        {{ 0, 0,-1}, {-1, 0, 0}, { 0, 1, 0}},
+    };
+    static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+    Geometry geometry;
+    for (const Face& face : faces) {
+        uint32_t base = static_cast<uint32_t>(geometry.vertexCount());
+        for (const auto& corner : corners) {
+            float p[3];
+            for (int c = 0; c < 3; c++) {
+                p[c] = face.n[c] + face.u[c] * corner[0] + face.v[c] * corner[1];
+            }
+            float n[3] = {face.n[0], face.n[1], face.n[2]};
+            if (options.smooth) {
+                // Corner normals average the three adjoining faces
+                n[0] = p[0];
+                n[1] = p[1];
+                n[2] = p[2];
+                normalize(n);
+            }
+            geometry.addVertex(p[0] * hx, p[1] * hy, p[2] * hz, n[0], n[1], n[2]);
+        }
+        geometry.addTriangle(base, base + 1, base + 2);
+        geometry.addTriangle(base, base + 2, base + 3);
+    }
+    return finish(geometry, options);
+}
+
+std::shared_ptr<Mesh> uvSphere(float radius, int segments, int rings, const MeshBuildOptions& options) {
+    segments = std::min(std::max(segments, 3), MaxSegments);
+    rings = std::min(std::max(rings, 2), MaxSegments);
+
+    Geometry geometry;
+    for (int r = 0; r <= rings; r++) {
+        float theta = Pi * r / rings;
+        for (int s = 0; s <= segments; s++) {
+            float phi = 2.0f * Pi * s / segments;
+            float nx = std::sin(theta) * std::cos(phi);
+            float ny = std::cos(theta);
+            float nz = std::sin(theta) * std::sin(phi);
+            geometry.addVertex(nx * radius, ny * radius, nz * radius, nx, ny, nz);
+        }
+    }
+
+    const uint32_t columns = segments + 1;
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            uint32_t a = r * columns + s;
+            uint32_t b = a + 1;
+            uint32_t c = a + columns;
+            uint32_t d = c + 1;
+            // Skip the degenerate triangles that collapse into the poles
+            if (r != 0) geometry.addTriangle(a, b, c);
+            if (r != rings - 1) geometry.addTriangle(b, d, c);
+        }
+    }
+    return finish(geometry, options);
+}
+
+std::shared_ptr<Mesh> icosphere(float radius, int subdivisions, const MeshBuildOptions& options) {
+    subdivisions = std::min(std::max(subdivisions, 0), 8);
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+    Geometry geometry;
+    auto addUnit = [&](float x, float y, float z) {
+        float n[3] = {x, y, z};
+        normalize(n);
+        return geometry.addVertex(n[0] * radius, n[1] * radius, n[2] * radius, n[0], n[1], n[2]);
+    };
+
+    addUnit(-1, t, 0); addUnit(1, t, 0); addUnit(-1, -t, 0); addUnit(1, -t, 0);
+    addUnit(0, -1, t); addUnit(0, 1, t); addUnit(0, -1, -t); addUnit(0, 1, -t);
+    addUnit(t, 0, -1); addUnit(t, 0, 1); addUnit(-t, 0, -1); addUnit(-t, 0, 1);
+
+    geometry.indices = {
+        0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+        1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+        3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+        4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1,
+    };
+
+    for (int level = 0; level < subdivisions; level++) {
+        std::unordered_map<uint64_t, uint32_t> midpoints;
+        auto midpoint = [&](uint32_t a, uint32_t b) {
+            uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) {
+                return it->second;
+            }
+            const float* pa = &geometry.normals[a * 3];
+            const float* pb = &geometry.normals[b * 3];
+            uint32_t index = addUnit(pa[0] + pb[0], pa[1] + pb[1], pa[2] + pb[2]);
+            midpoints.emplace(key, index);
+            return index;
+        };
+
+        std::vector<uint32_t> previous;
+        previous.swap(geometry.indices);
+        geometry.indices.reserve(previous.size() * 4);
+        for (size_t i = 0; i < previous.size(); i += 3) {
+            uint32_t v0 = previous[i], v1 = previous[i + 1], v2 = previous[i + 2];
+            uint32_t a = midpoint(v0, v1);
+            uint32_t b = midpoint(v1, v2);
+            uint32_t c = midpoint(v2, v0);
+            geometry.addTriangle(v0, a, c);
+            geometry.addTriangle(v1, b, a);
+            geometry.addTriangle(v2, c, b);
+            geometry.addTriangle(a, b, c);
+        }
+    }
+    return finish(geometry, options);
+}
+
+std::shared_ptr<Mesh> cylinder(float radius, float height, int segments, bool capped, const MeshBuildOptions& options) {
+    segments = std::min(std::max(segments, 3), MaxSegments);
+    const float halfHeight = height * 0.5f;
+
+    Geometry geometry;
+    for (int row = 0; row < 2; row++) {
+        float y = row == 0 ? halfHeight : -halfHeight;
+        for (int s = 0; s <= segments; s++) {
+            float phi = 2.0f * Pi * s / segments;
+            float nx = std::cos(phi);
+            float nz = std::sin(phi);
+            geometry.addVertex(nx * radius, y, nz * radius, nx, 0.0f, nz);
+        }
+    }
+
+    const uint32_t columns = segments + 1;
+    for (int s = 0; s < segments; s++) {
+        uint32_t a = s;
+        uint32_t b = a + 1;
+        uint32_t c = a + columns;
+        uint32_t d = c + 1;
+        geometry.addTriangle(a, b, c);
+        geometry.addTriangle(b, d, c);
+    }
+
+    if (capped) {
+        for (int cap = 0; cap < 2; cap++) {
+            float ny = cap == 0 ? 1.0f : -1.0f;
+            float y = halfHeight * ny;
+            uint32_t center = geometry.addVertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f);
+            uint32_t rim = static_cast<uint32_t>(geometry.vertexCount());
+            for (int s = 0; s <= segments; s++) {
+                float phi = 2.0f * Pi * s / segments;
+                geometry.addVertex(std::cos(phi) * radius, y, std::sin(phi) * radius, 0.0f, ny, 0.0f);
+            }
+            for (int s = 0; s < segments; s++) {
+                if (cap == 0) {
+                    geometry.addTriangle(center, rim + s + 1, rim + s);
+                } else {
+                    geometry.addTriangle(center, rim + s, rim + s + 1);
+                }
+            }
+        }
+    }
+    return finish(geometry, options);
+}
+
+std::shared_ptr<Mesh> plane(float sizeX, float sizeZ, int segmentsX, int segmentsZ, const MeshBuildOptions& options) {
+    segmentsX = std::min(std::max(segmentsX, 1), MaxSegments);
+    segmentsZ = std::min(std::max(segmentsZ, 1), MaxSegments);
+
+    Geometry geometry;
+    for (int j = 0; j <= segmentsZ; j++) {
+        float z = (static_cast<float>(j) / segmentsZ - 0.5f) * sizeZ;
+        for (int i = 0; i <= segmentsX; i++) {
+            float x = (static_cast<float>(i) / segmentsX - 0.5f) * sizeX;
+            geometry.addVertex(x, 0.0f, z, 0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    const uint32_t columns = segmentsX + 1;
+    for (int j = 0; j < segmentsZ; j++) {
+        for (int i = 0; i < segmentsX; i++) {
+            uint32_t a = j * columns + i;
+            uint32_t b = a + 1;
+            uint32_t c = a + columns;
+            uint32_t d = c + 1;
+            geometry.addTriangle(a, c, b);
+            geometry.addTriangle(b, c, d);
+        }
+    }
+    return finish(geometry, options);
+}
+
+std::shared_ptr<Mesh> heightfield(const float* heights, int columns, int rows, float sizeX, float sizeZ,
+                                  float heightScale, const MeshBuildOptions& options) {
+    if (columns < 2 || rows < 2) {
+        return nullptr;
+    }
+
+    const float cellX = sizeX / (columns - 1);
+    const float cellZ = sizeZ / (rows - 1);
+    auto sample = [&](int i, int j) {
+        i = std::min(std::max(i, 0), columns - 1);
+        j = std::min(std::max(j, 0), rows - 1);
+        return heights[j * columns + i] * heightScale;
+    };
+
+    Geometry geometry;
+    geometry.positions.reserve(static_cast<size_t>(columns) * rows * 3);
+    geometry.normals.reserve(static_cast<size_t>(columns) * rows * 3);
+    for (int j = 0; j < rows; j++) {
+        float z = (static_cast<float>(j) / (rows - 1) - 0.5f) * sizeZ;
+        for (int i = 0; i < columns; i++) {
+            float x = (static_cast<float>(i) / (columns - 1) - 0.5f) * sizeX;
+            // Central differences for the surface normal
+            float n[3] = {
+                (sample(i - 1, j) - sample(i + 1, j)) * cellZ,
+                2.0f * cellX * cellZ,
+                (sample(i, j - 1) - sample(i, j + 1)) * cellX,
+            };
+            normalize(n);
+            geometry.addVertex(x, sample(i, j), z, n[0], n[1], n[2]);
+        }
+    }
+
+    geometry.indices.reserve(static_cast<size_t>(columns - 1) * (rows - 1) * 6);
+    for (int j = 0; j < rows - 1; j++) {
+        for (int i = 0; i < columns - 1; i++) {
+            uint32_t a = j * columns + i;
+            uint32_t b = a + 1;
+            uint32_t c = a + columns;
+            uint32_t d = c + 1;
+            geometry.addTriangle(a, c, b);
+            geometry.addTriangle(b, c, d);
+        }
+    }
+    return finish(geometry, options);
+}
+
+} // namespace MeshBuilder
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "IRenderer.h"
+#include <memory>
+
+// How generated vertices are colored
+struct VertexColorFunction {
+    enum class Mode {
+        Constant,  // colorA everywhere
+        Normal,    // normal remapped from [-1, 1] to [0, 1]
+        Position,  // position remapped across the mesh bounds
+        Gradient,  // colorA to colorB along an axis across the mesh bounds
+    };
+
+    Mode mode = Mode::Constant;
+    float colorA[3] = {1.0f, 1.0f, 1.0f};
+    float colorB[3] = {1.0f, 1.0f, 1.0f};
+    int axis = 1;  // Gradient axis (0 = x, 1 = y, 2 = z)
+};
+
+// Options shared by all generators
+struct MeshBuildOptions {
+    bool smooth = true;  // Shared vertices with averaged normals, otherwise per-face normals
+    VertexColorFunction color;
+    VertexLayout layout;
+};
+
+// Native procedural geometry. All meshes are centered on the origin and wound
+// counter-clockwise when seen from outside.
+namespace MeshBuilder {
+    // Segment and ring counts are clamped to this
+    const int MaxSegments = 1024;
+
+    std::shared_ptr<Mesh> box(float sizeX, float sizeY, float sizeZ, const MeshBuildOptions& options);
+    std::shared_ptr<Mesh> uvSphere(float radius, int segments, int rings, const MeshBuildOptions& options);
+    std::shared_ptr<Mesh> icosphere(float radius, int subdivisions, const MeshBuildOptions& options);
+    std::shared_ptr<Mesh> cylinder(float radius, float height, int segments, bool capped, const MeshBuildOptions& options);
+    // Grid in the XZ plane facing +Y
+    std::shared_ptr<Mesh> plane(float sizeX, float sizeZ, int segmentsX, int segmentsZ, const MeshBuildOptions& options);
+    // Grid of columns x rows height samples (row-major) spanning sizeX by sizeZ
+    std::shared_ptr<Mesh> heightfield(const float* heights, int columns, int rows, float sizeX, float sizeZ,
+                                      float heightScale, const MeshBuildOptions& options);
+
+    // Color of one vertex; Position and Gradient remap across boundsMin..boundsMax
+    void evaluateColor(const VertexColorFunction& color, const float* position, const float* normal,
+                       const float* boundsMin, const float* boundsMax, float* out);
+}
@@ -0,0 +1,523 @@
+#include "MeshBvh.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const int Bins = 16;
+// Deeper than this, nodes split at the median so the traversal stack can't overflow
+const int MaxSahDepth = 48;
+const int StackSize = 128;
+const float Infinity = std::numeric_limits<float>::infinity();
+
+struct Box {
+    float min[3] = {Infinity, Infinity, Infinity};
+    float max[3] = {-Infinity, -Infinity, -Infinity};
+
+    void grow(const float* low, const float* high) {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], low[i]);
+            max[i] = std::max(max[i], high[i]);
+        }
+    }
+    // A primitive box: min x, y, z then max x, y, z
+    void grow(const float* box) { grow(box, box + 3); }
+    void growPoint(const float* point) {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], point[i]);
+            max[i] = std::max(max[i], point[i]);
+        }
+    }
+    // Half the surface area
+    float area() const {
+        float d[3];
+        for (int i = 0; i < 3; i++) d[i] = std::max(0.0f, max[i] - min[i]);
+        return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+    }
+};
+
+// Box with a padding lane, so growing it is one SIMD min and max
+struct alignas(16) Box4 {
+    float min[4] = {Infinity, Infinity, Infinity, 0.0f};
+    float max[4] = {-Infinity, -Infinity, -Infinity, 0.0f};
+
+    void grow(const Box4& other) {
+#if defined(L3D_SSE2)
+        _mm_store_ps(min, _mm_min_ps(_mm_load_ps(min), _mm_load_ps(other.min)));
+        _mm_store_ps(max, _mm_max_ps(_mm_load_ps(max), _mm_load_ps(other.max)));
+#elif defined(L3D_NEON)
+        vst1q_f32(min, vminq_f32(vld1q_f32(min), vld1q_f32(other.min)));
+        vst1q_f32(max, vmaxq_f32(vld1q_f32(max), vld1q_f32(other.max)));
+#else
+        for (int i = 0; i < 4; i++) {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+#endif
+    }
+    float area() const {
+        float d[3];
+        for (int i = 0; i < 3; i++) d[i] = std::max(0.0f, max[i] - min[i]);
+        return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+    }
+};
+
+inline float centroid(const float* box, int axis) {
+    return (box[axis] + box[3 + axis]) * 0.5f;
+}
+
+// Object-space positions of every vertex, three floats each
+void readPositions(const Mesh& mesh, std::vector<float>& positions) {
+    positions.assign(mesh.vertexCount * 3, 0.0f);
+    const VertexAttributeDesc* position = mesh.layout.find(VertexAttribute::Position);
+    if (!position) return;
+    const uint8_t* data = mesh.getVertexData();
+    size_t stride = mesh.layout.getStride();
+    for (size_t vertex = 0; vertex < mesh.vertexCount; vertex++) {
+        if (position->type == VertexComponentType::Float32) {
+            std::memcpy(&positions[vertex * 3], data + vertex * stride + position->offset, 3 * sizeof(float));
+        } else {
+            float values[4];
+            unpackAttribute(mesh.layout, data, vertex, VertexAttribute::Position, values);
+            std::memcpy(&positions[vertex * 3], values, 3 * sizeof(float));
+        }
+    }
+}
+
+size_t countTriangles(const Mesh& mesh) {
+    return mesh.isIndexed() ? mesh.getIndexCount() / 3 : mesh.vertexCount / 3;
+}
+
+// Corner positions of a triangle; out-of-range indices collapse to the origin
+void readTriangle(const Mesh& mesh, const std::vector<float>& positions, size_t triangle, float v[3][3]) {
+    const uint32_t* indices = mesh.getIndexData();
+    for (int k = 0; k < 3; k++) {
+        size_t vertex = mesh.isIndexed() ? indices[triangle * 3 + k] : triangle * 3 + k;
+        for (int c = 0; c < 3; c++) {
+            v[k][c] = vertex < mesh.vertexCount ? positions[vertex * 3 + c] : 0.0f;
+        }
+    }
+}
+
+#if defined(L3D_SSE2)
+typedef __m128 Lane4;
+inline Lane4 load4(const float* p) { return _mm_loadu_ps(p); }
+inline Lane4 splat4(float value) { return _mm_set1_ps(value); }
+inline Lane4 add4(Lane4 a, Lane4 b) { return _mm_add_ps(a, b); }
+inline Lane4 sub4(Lane4 a, Lane4 b) { return _mm_sub_ps(a, b); }
+inline Lane4 mul4(Lane4 a, Lane4 b) { return _mm_mul_ps(a, b); }
+inline Lane4 div4(Lane4 a, Lane4 b) { return _mm_div_ps(a, b); }
+inline Lane4 and4(Lane4 a, Lane4 b) { return _mm_and_ps(a, b); }
+inline Lane4 greaterEqual4(Lane4 a, Lane4 b) { return _mm_cmpge_ps(a, b); }
+inline Lane4 greater4(Lane4 a, Lane4 b) { return _mm_cmpgt_ps(a, b); }
+inline Lane4 abs4(Lane4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+// mask ? a : b
+inline Lane4 select4(Lane4 mask, Lane4 a, Lane4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline void store4(float* p, Lane4 a) { _mm_storeu_ps(p, a); }
+#define L3D_BVH_LANES 1
+#elif defined(L3D_NEON)
+typedef float32x4_t Lane4;
+inline Lane4 load4(const float* p) { return vld1q_f32(p); }
+inline Lane4 splat4(float value) { return vdupq_n_f32(value); }
+inline Lane4 add4(Lane4 a, Lane4 b) { return vaddq_f32(a, b); }
+inline Lane4 sub4(Lane4 a, Lane4 b) { return vsubq_f32(a, b); }
+inline Lane4 mul4(Lane4 a, Lane4 b) { return vmulq_f32(a, b); }
+inline Lane4 div4(Lane4 a, Lane4 b) { return vdivq_f32(a, b); }
+inline Lane4 and4(Lane4 a, Lane4 b) {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline Lane4 greaterEqual4(Lane4 a, Lane4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+inline Lane4 greater4(Lane4 a, Lane4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+inline Lane4 abs4(Lane4 a) { return vabsq_f32(a); }
+inline Lane4 select4(Lane4 mask, Lane4 a, Lane4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+inline void store4(float* p, Lane4 a) { vst1q_f32(p, a); }
+#define L3D_BVH_LANES 1
+#endif
+
+} // namespace
+
+void buildBvh(const float* boxes, size_t count, uint32_t maxLeaf, std::vector<BvhNode>& nodes,
+              std::vector<uint32_t>& order) {
+    nodes.clear();
+    order.resize(count);
+    for (size_t i = 0; i < count; i++) order[i] = static_cast<uint32_t>(i);
+    if (count == 0) return;
+    maxLeaf = std::max(maxLeaf, 1u);
+
+    // Boxes padded to four lanes, with the centroid in the spare lanes' place alongside
+    std::vector<Box4> padded(count);
+    std::vector<float> centers(count * 3);
+    for (size_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            padded[i].min[axis] = boxes[i * 6 + axis];
+            padded[i].max[axis] = boxes[i * 6 + 3 + axis];
+            centers[i * 3 + axis] = centroid(boxes + i * 6, axis);
+        }
+        padded[i].min[3] = padded[i].max[3] = 0.0f;
+    }
+
+    nodes.reserve(count / maxLeaf * 2 + 1);
+    nodes.push_back({{0.0f, 0.0f, 0.0f}, 0, {0.0f, 0.0f, 0.0f}, static_cast<uint32_t>(count)});
+    struct Task {
+        uint32_t node;
+        int depth;
+    };
+    std::vector<Task> tasks = {{0, 0}};
+    while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        uint32_t first = nodes[task.node].first, primitives = nodes[task.node].count;
+        uint32_t* begin = order.data() + first;
+        uint32_t* end = begin + primitives;
+
+        Box4 bounds;
+        Box centroids;
+        for (const uint32_t* it = begin; it != end; it++) {
+            bounds.grow(padded[*it]);
+            centroids.growPoint(&centers[*it * 3]);
+        }
+        BvhNode& node = nodes[task.node];
+        std::memcpy(node.min, bounds.min, sizeof(node.min));
+        std::memcpy(node.max, bounds.max, sizeof(node.max));
+        if (primitives <= maxLeaf) continue;
+
+        float scale[3];
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = centroids.max[axis] - centroids.min[axis];
+            scale[axis] = extent > 0.0f ? Bins / extent : 0.0f;
+        }
+        auto binOf = [&](uint32_t primitive, int axis) {
+            return std::min(Bins - 1, static_cast<int>((centers[primitive * 3 + axis] - centroids.min[axis]) * scale[axis]));
+        };
+
+        // Cheapest split between bins along any axis, by surface area heuristic. The
+        // centroids are binned along all three axes in one pass.
+        int bestAxis = -1, bestSplit = 0;
+        float bestCost = Infinity;
+        if (task.depth < MaxSahDepth) {
+            Box4 binBounds[3][Bins];
+            uint32_t binCounts[3][Bins] = {};
+            for (const uint32_t* it = begin; it != end; it++) {
+                const Box4& box = padded[*it];
+                for (int axis = 0; axis < 3; axis++) {
+                    int bin = binOf(*it, axis);
+                    binBounds[axis][bin].grow(box);
+                    binCounts[axis][bin]++;
+                }
+            }
+            for (int axis = 0; axis < 3; axis++) {
+                if (scale[axis] == 0.0f) continue;
+                // Left sides accumulated forwards, right sides backwards
+                float leftCost[Bins];
+                Box4 left;
+                uint32_t leftCount = 0;
+                for (int bin = 0; bin < Bins - 1; bin++) {
+                    left.grow(binBounds[axis][bin]);
+                    leftCount += binCounts[axis][bin];
+                    leftCost[bin] = leftCount ? left.area() * leftCount : 0.0f;
+                }
+                Box4 right;
+                uint32_t rightCount = 0;
+                for (int bin = Bins - 1; bin > 0; bin--) {
+                    right.grow(binBounds[axis][bin]);
+                    rightCount += binCounts[axis][bin];
+                    if (rightCount == 0 || rightCount == primitives) continue;
+                    float cost = leftCost[bin - 1] + right.area() * rightCount;
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = bin;
+                    }
+                }
+            }
+        }
+
+        uint32_t* middle;
+        if (bestAxis >= 0) {
+            middle = std::partition(begin, end, [&](uint32_t primitive) { return binOf(primitive, bestAxis) < bestSplit; });
+        } else {
+            // Coincident centroids or too deep: halve along the widest axis
+            int axis = 0;
+            for (int c = 1; c < 3; c++) {
+                if (centroids.max[c] - centroids.min[c] > centroids.max[axis] - centroids.min[axis]) axis = c;
+            }
+            middle = begin + primitives / 2;
+            std::nth_element(begin, middle, end, [&](uint32_t a, uint32_t b) {
+                return centers[a * 3 + axis] < centers[b * 3 + axis];
+            });
+        }
+
+        uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+        uint32_t child = static_cast<uint32_t>(nodes.size());
+        nodes[task.node].first = child;
+        nodes[task.node].count = 0;
+        nodes.push_back({{0.0f, 0.0f, 0.0f}, first, {0.0f, 0.0f, 0.0f}, leftCount});
+        nodes.push_back({{0.0f, 0.0f, 0.0f}, first + leftCount, {0.0f, 0.0f, 0.0f}, primitives - leftCount});
+        tasks.push_back({child + 1, task.depth + 1});
+        tasks.push_back({child, task.depth + 1});
+    }
+}
+
+void refitBvh(const float* boxes, const std::vector<uint32_t>& order, std::vector<BvhNode>& nodes) {
+    // Children always follow their parent, so walking backwards meets them first
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNode& node = nodes[i];
+        Box bounds;
+        if (node.count != 0) {
+            for (uint32_t j = node.first; j < node.first + node.count; j++) bounds.grow(boxes + order[j] * 6);
+        } else {
+            for (uint32_t child = node.first; child < node.first + 2; child++) {
+                bounds.grow(nodes[child].min, nodes[child].max);
+            }
+        }
+        std::memcpy(node.min, bounds.min, sizeof(node.min));
+        std::memcpy(node.max, bounds.max, sizeof(node.max));
+    }
+}
+
+BvhRay::BvhRay(const float rayOrigin[3], const float rayDirection[3]) {
+    for (int i = 0; i < 3; i++) {
+        origin[i] = rayOrigin[i];
+        direction[i] = rayDirection[i];
+        // Huge instead of infinite, so a zero component never multiplies to NaN
+        float d = rayDirection[i];
+        inverse[i] = std::fabs(d) > 1e-30f ? 1.0f / d : (std::signbit(d) ? -1e30f : 1e30f);
+    }
+    // The fourth lane meets a node's first/count field, which it must zero out
+    origin[3] = direction[3] = inverse[3] = 0.0f;
+}
+
+float intersectBox(const BvhRay& ray, const BvhNode& node, float maxDistance) {
+    float entry, exit;
+#if defined(L3D_SSE2)
+    __m128 origin = _mm_loadu_ps(ray.origin);
+    __m128 inverse = _mm_loadu_ps(ray.inverse);
+    __m128 low = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.min), origin), inverse);
+    __m128 high = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.max), origin), inverse);
+    __m128 near = _mm_min_ps(low, high);
+    __m128 far = _mm_max_ps(low, high);
+    // Replace the padding lane with x before reducing
+    near = _mm_shuffle_ps(near, near, _MM_SHUFFLE(0, 2, 1, 0));
+    far = _mm_shuffle_ps(far, far, _MM_SHUFFLE(0, 2, 1, 0));
+    near = _mm_max_ps(near, _mm_shuffle_ps(near, near, _MM_SHUFFLE(1, 0, 3, 2)));
+    near = _mm_max_ps(near, _mm_shuffle_ps(near, near, _MM_SHUFFLE(2, 3, 0, 1)));
+    far = _mm_min_ps(far, _mm_shuffle_ps(far, far, _MM_SHUFFLE(1, 0, 3, 2)));
+    far = _mm_min_ps(far, _mm_shuffle_ps(far, far, _MM_SHUFFLE(2, 3, 0, 1)));
+    entry = _mm_cvtss_f32(near);
+    exit = _mm_cvtss_f32(far);
+#elif defined(L3D_NEON)
+    float32x4_t origin = vld1q_f32(ray.origin);
+    float32x4_t inverse = vld1q_f32(ray.inverse);
+    float32x4_t low = vmulq_f32(vsubq_f32(vld1q_f32(node.min), origin), inverse);
+    float32x4_t high = vmulq_f32(vsubq_f32(vld1q_f32(node.max), origin), inverse);
+    float32x4_t near = vminq_f32(low, high);
+    float32x4_t far = vmaxq_f32(low, high);
+    near = vsetq_lane_f32(vgetq_lane_f32(near, 0), near, 3);
+    far = vsetq_lane_f32(vgetq_lane_f32(far, 0), far, 3);
+    entry = vmaxvq_f32(near);
+    exit = vminvq_f32(far);
+#else
+    entry = -Infinity;
+    exit = Infinity;
+    for (int i = 0; i < 3; i++) {
+        float low = (node.min[i] - ray.origin[i]) * ray.inverse[i];
+        float high = (node.max[i] - ray.origin[i]) * ray.inverse[i];
+        entry = std::max(entry, std::min(low, high));
+        exit = std::min(exit, std::max(low, high));
+    }
+#endif
+    entry = std::max(entry, 0.0f);
+    return entry <= exit && entry <= maxDistance ? entry : Infinity;
+}
+
+void MeshBvh::build(const Mesh& mesh) {
+    std::vector<float> positions;
+    readPositions(mesh, positions);
+    triangleCount = countTriangles(mesh);
+
+    std::vector<float> boxes(triangleCount * 6);
+    for (size_t t = 0; t < triangleCount; t++) {
+        float v[3][3];
+        readTriangle(mesh, positions, t, v);
+        for (int c = 0; c < 3; c++) {
+            boxes[t * 6 + c] = std::min(v[0][c], std::min(v[1][c], v[2][c]));
+            boxes[t * 6 + 3 + c] = std::max(v[0][c], std::max(v[1][c], v[2][c]));
+        }
+    }
+    std::vector<uint32_t> order;
+    buildBvh(boxes.data(), triangleCount, LeafTriangles, nodes, order);
+
+    // Leaves point at packets from here on
+    packets.clear();
+    packetTriangles.clear();
+    for (BvhNode& node : nodes) {
+        if (node.count == 0) continue;
+        for (uint32_t lane = 0; lane < LeafTriangles; lane++) {
+            packetTriangles.push_back(lane < node.count ? order[node.first + lane] : UINT32_MAX);
+        }
+        node.first = static_cast<uint32_t>(packets.size());
+        packets.emplace_back();
+    }
+    fillLeaves(mesh, positions);
+}
+
+void MeshBvh::refit(const Mesh& mesh) {
+    if (countTriangles(mesh) != triangleCount) {
+        build(mesh);
+        return;
+    }
+    std::vector<float> positions;
+    readPositions(mesh, positions);
+    fillLeaves(mesh, positions);
+}
+
+void MeshBvh::fillLeaves(const Mesh& mesh, const std::vector<float>& positions) {
+    for (BvhNode& node : nodes) {
+        if (node.count == 0) continue;
+        TrianglePacket& packet = packets[node.first];
+        Box bounds;
+        for (uint32_t lane = 0; lane < LeafTriangles; lane++) {
+            float v[3][3] = {};
+            if (lane < node.count) {
+                readTriangle(mesh, positions, packetTriangles[node.first * LeafTriangles + lane], v);
+                for (int k = 0; k < 3; k++) bounds.growPoint(v[k]);
+            }
+            for (int c = 0; c < 3; c++) {
+                packet.v0[c][lane] = v[0][c];
+                packet.edge1[c][lane] = v[1][c] - v[0][c];
+                packet.edge2[c][lane] = v[2][c] - v[0][c];
+            }
+        }
+        std::memcpy(node.min, bounds.min, sizeof(node.min));
+        std::memcpy(node.max, bounds.max, sizeof(node.max));
+    }
+    // Children always follow their parent, so walking backwards meets them first
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNode& node = nodes[i];
+        if (node.count != 0) continue;
+        const BvhNode& left = nodes[node.first];
+        const BvhNode& right = nodes[node.first + 1];
+        for (int c = 0; c < 3; c++) {
+            node.min[c] = std::min(left.min[c], right.min[c]);
+            node.max[c] = std::max(left.max[c], right.max[c]);
+        }
+    }
+}
+
+bool MeshBvh::intersectPacket(uint32_t packetIndex, const BvhRay& ray, TriangleHit& hit) const {
+    // Moller-Trumbore, four triangles at once, double-sided
+    const TrianglePacket& packet = packets[packetIndex];
+    float distances[4], us[4], vs[4];
+#if defined(L3D_BVH_LANES)
+    Lane4 direction[3], v0[3], e1[3], e2[3];
+    for (int c = 0; c < 3; c++) {
+        direction[c] = splat4(ray.direction[c]);
+        v0[c] = load4(packet.v0[c]);
+        e1[c] = load4(packet.edge1[c]);
+        e2[c] = load4(packet.edge2[c]);
+    }
+    // p = direction x e2
+    Lane4 p[3] = {
+        sub4(mul4(direction[1], e2[2]), mul4(direction[2], e2[1])),
+        sub4(mul4(direction[2], e2[0]), mul4(direction[0], e2[2])),
+        sub4(mul4(direction[0], e2[1]), mul4(direction[1], e2[0])),
+    };
+    Lane4 determinant = add4(add4(mul4(e1[0], p[0]), mul4(e1[1], p[1])), mul4(e1[2], p[2]));
+    Lane4 inverse = div4(splat4(1.0f), determinant);
+    Lane4 s[3];
+    for (int c = 0; c < 3; c++) s[c] = sub4(splat4(ray.origin[c]), v0[c]);
+    Lane4 u = mul4(add4(add4(mul4(s[0], p[0]), mul4(s[1], p[1])), mul4(s[2], p[2])), inverse);
+    // q = s x e1
+    Lane4 q[3] = {
+        sub4(mul4(s[1], e1[2]), mul4(s[2], e1[1])),
+        sub4(mul4(s[2], e1[0]), mul4(s[0], e1[2])),
+        sub4(mul4(s[0], e1[1]), mul4(s[1], e1[0])),
+    };
+    Lane4 v = mul4(add4(add4(mul4(direction[0], q[0]), mul4(direction[1], q[1])), mul4(direction[2], q[2])), inverse);
+    Lane4 t = mul4(add4(add4(mul4(e2[0], q[0]), mul4(e2[1], q[1])), mul4(e2[2], q[2])), inverse);
+    Lane4 zero = splat4(0.0f);
+    Lane4 mask = greater4(abs4(determinant), splat4(1e-12f));
+    mask = and4(mask, greaterEqual4(u, zero));
+    mask = and4(mask, greaterEqual4(v, zero));
+    mask = and4(mask, greaterEqual4(splat4(1.0f), add4(u, v)));
+    mask = and4(mask, greaterEqual4(t, zero));
+    store4(distances, select4(mask, t, splat4(Infinity)));
+    store4(us, u);
+    store4(vs, v);
+#else
+    for (int lane = 0; lane < 4; lane++) {
+        float e1[3], e2[3], s[3], p[3], q[3];
+        for (int c = 0; c < 3; c++) {
+            e1[c] = packet.edge1[c][lane];
+            e2[c] = packet.edge2[c][lane];
+            s[c] = ray.origin[c] - packet.v0[c][lane];
+        }
+        p[0] = ray.direction[1] * e2[2] - ray.direction[2] * e2[1];
+        p[1] = ray.direction[2] * e2[0] - ray.direction[0] * e2[2];
+        p[2] = ray.direction[0] * e2[1] - ray.direction[1] * e2[0];
+        float determinant = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        distances[lane] = Infinity;
+        if (!(std::fabs(determinant) > 1e-12f)) continue;
+        float inverse = 1.0f / determinant;
+        us[lane] = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+        q[0] = s[1] * e1[2] - s[2] * e1[1];
+        q[1] = s[2] * e1[0] - s[0] * e1[2];
+        q[2] = s[0] * e1[1] - s[1] * e1[0];
+        vs[lane] = (ray.direction[0] * q[0] + ray.direction[1] * q[1] + ray.direction[2] * q[2]) * inverse;
+        float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse;
+        if (us[lane] >= 0.0f && vs[lane] >= 0.0f && us[lane] + vs[lane] <= 1.0f && t >= 0.0f) {
+            distances[lane] = t;
+        }
+    }
+#endif
+    int best = -1;
+    for (int lane = 0; lane < 4; lane++) {
+        if (distances[lane] < hit.distance) {
+            hit.distance = distances[lane];
+            best = lane;
+        }
+    }
+    if (best < 0) return false;
+    hit.triangle = packetTriangles[packetIndex * LeafTriangles + best];
+    hit.u = us[best];
+    hit.v = vs[best];
+    return true;
+}
+
+bool MeshBvh::intersect(const BvhRay& ray, TriangleHit& hit) const {
+    if (nodes.empty() || intersectBox(ray, nodes[0], hit.distance) == Infinity) return false;
+
+    // Depth first, nearer child first; entries store where the ray enters the node
+    struct Entry {
+        uint32_t node;
+        float distance;
+    };
+    Entry stack[StackSize];
+    int size = 0;
+    stack[size++] = {0, 0.0f};
+    bool found = false;
+    while (size > 0) {
+        Entry entry = stack[--size];
+        if (entry.distance > hit.distance) continue;
+        const BvhNode& node = nodes[entry.node];
+        if (node.count != 0) {
+            found |= intersectPacket(node.first, ray, hit);
+            continue;
+        }
+        float left = intersectBox(ray, nodes[node.first], hit.distance);
+        float right = intersectBox(ray, nodes[node.first + 1], hit.distance);
+        Entry near = {node.first, left}, far = {node.first + 1, right};
+        if (right < left) std::swap(near, far);
+        if (far.distance != Infinity) stack[size++] = far;
+        if (near.distance != Infinity) stack[size++] = near;
+    }
+    return found;
+}
+
+size_t MeshBvh::getMemoryBytes() const {
+    return nodes.size() * sizeof(BvhNode) + packets.size() * sizeof(TrianglePacket) +
+           packetTriangles.size() * sizeof(uint32_t);
+}
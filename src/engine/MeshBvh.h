@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <vector>
+
+// Bounding volume hierarchy node, 32 bytes. Interior nodes (count 0) have their two
+// children at first and first + 1; leaves hold count primitives starting at first.
+struct BvhNode {
+    float min[3];
+    uint32_t first;
+    float max[3];
+    uint32_t count;
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode should stay 32 bytes");
+
+// Build a binned SAH hierarchy over count primitive boxes (six floats each: min x, y, z
+// then max x, y, z). Leaves get at most maxLeaf primitives; order receives the
+// primitive indices in leaf order, so a leaf covers order[first, first + count).
+void buildBvh(const float* boxes, size_t count, uint32_t maxLeaf, std::vector<BvhNode>& nodes,
+              std::vector<uint32_t>& order);
+// Recompute the bounds of a built hierarchy after its primitive boxes moved
+void refitBvh(const float* boxes, const std::vector<uint32_t>& order, std::vector<BvhNode>& nodes);
+
+// Ray prepared for box tests: the inverse direction avoids divisions per node
+struct BvhRay {
+    float origin[4];
+    float direction[4];
+    float inverse[4];
+
+    BvhRay(const float rayOrigin[3], const float rayDirection[3]);
+};
+
+// Distance at which the ray enters the box, clamped to 0 when it starts inside, or
+// infinity when it misses or enters beyond maxDistance
+float intersectBox(const BvhRay& ray, const BvhNode& node, float maxDistance);
+
+// Nearest ray hit on a triangle. u and v weigh the triangle's second and third
+// vertices; the first weighs 1 - u - v.
+struct TriangleHit {
+    uint32_t triangle;
+    float u, v;
+    float distance;
+};
+
+// Triangle-level hierarchy of one mesh, in the mesh's object space. Leaves hold up to
+// four triangles stored as one packet, so each leaf is a single 4-wide SIMD test.
+class MeshBvh {
+public:
+    static const uint32_t LeafTriangles = 4;
+
+    void build(const Mesh& mesh);
+    // Re-read the vertex positions into the existing tree (after vertices were rewritten
+    // in place); the tree stays valid but loosens if triangles moved far
+    void refit(const Mesh& mesh);
+
+    // Nearest hit closer than hit.distance, which the caller sets to the maximum first
+    bool intersect(const BvhRay& ray, TriangleHit& hit) const;
+
+    size_t getTriangleCount() const { return triangleCount; }
+    size_t getNodeCount() const { return nodes.size(); }
+    // Bounds of every triangle; only valid when getNodeCount() > 0
+    const BvhNode& getRoot() const { return nodes[0]; }
+    size_t getMemoryBytes() const;
+
+private:
+    // Four triangles as the first vertex and the two edges leaving it, one lane each.
+    // Unused lanes have zero edges, which never hit.
+    struct TrianglePacket {
+        float v0[3][4];
+        float edge1[3][4];
+        float edge2[3][4];
+    };
+
+    // Read the triangles of every leaf into its packet and bounds, then refit the
+    // interior nodes
+    void fillLeaves(const Mesh& mesh, const std::vector<float>& positions);
+    bool intersectPacket(uint32_t packetIndex, const BvhRay& ray, TriangleHit& hit) const;
+
+    std::vector<BvhNode> nodes;              // Leaves index packets
+    std::vector<TrianglePacket> packets;     // One per leaf
+    std::vector<uint32_t> packetTriangles;   // Mesh triangle of each packet lane
+    size_t triangleCount = 0;
+};
@@ -0,0 +1,194 @@
+#include "MeshFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char Magic[4] = {'L', '3', 'D', 'M'};
+const uint64_t Alignment = 16;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + Alignment - 1) & ~(Alignment - 1);
+}
+
+bool validateHeader(const MeshFileHeader& header, uint64_t fileSize, std::string& error) {
+    if (memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        error = "not a mesh container";
+        return false;
+    }
+    if (header.version != MeshFile::Version || header.headerSize != sizeof(MeshFileHeader)) {
+        error = "unsupported mesh container version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.attributeCount == 0 || header.attributeCount > VertexLayout::MaxAttributes || header.stride == 0) {
+        error = "invalid vertex layout";
+        return false;
+    }
+
+    // Guard every size against overflow before trusting the offsets
+    const uint64_t maxCount = fileSize;
+    if (header.vertexCount > maxCount / header.stride || header.indexCount > maxCount / sizeof(uint32_t)) {
+        error = "vertex or index count exceeds file size";
+        return false;
+    }
+    uint64_t vertexBytes = header.vertexCount * header.stride;
+    uint64_t indexBytes = header.indexCount * sizeof(uint32_t);
+    if (header.vertexOffset % Alignment != 0 || header.indexOffset % Alignment != 0 ||
+        header.vertexOffset < sizeof(MeshFileHeader) ||
+        header.vertexOffset > fileSize || vertexBytes > fileSize - header.vertexOffset ||
+        header.indexOffset > fileSize || indexBytes > fileSize - header.indexOffset) {
+        error = "data ranges exceed file size";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace MeshFile {
+
+bool getLayout(const MeshFileHeader& header, VertexLayout& layout) {
+    VertexLayout result;
+    result.clear();
+    for (uint32_t i = 0; i < header.attributeCount && i < VertexLayout::MaxAttributes; i++) {
+        const MeshFileAttribute& a = header.attributes[i];
+        if (a.attribute > static_cast<uint8_t>(VertexAttribute::Weights) ||
+            a.type > static_cast<uint8_t>(VertexComponentType::Int2_10_10_10)) {
+            return false;
+        }
+        VertexAttributeDesc desc = {
+            static_cast<VertexAttribute>(a.attribute),
+            static_cast<VertexComponentType>(a.type),
+            a.components,
+            a.normalized != 0,
+            a.offset,
+        };
+        if (!result.addAttribute(desc)) {
+            return false;
+        }
+    }
+    if (header.stride < result.getStride() || !result.find(VertexAttribute::Position)) {
+        return false;
+    }
+    result.setStride(header.stride);
+    std::string error;
+    if (!result.validate(error)) {
+        return false;
+    }
+    layout = result;
+    return true;
+}
+
+bool write(const std::string& path, const Mesh& mesh, std::string& error, uint32_t flags) {
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(MeshFileHeader);
+    header.attributeCount = static_cast<uint32_t>(mesh.layout.getAttributeCount());
+    for (int i = 0; i < mesh.layout.getAttributeCount(); i++) {
+        const VertexAttributeDesc& desc = mesh.layout.getAttribute(i);
+        header.attributes[i].attribute = static_cast<uint8_t>(desc.attribute);
+        header.attributes[i].type = static_cast<uint8_t>(desc.type);
+        header.attributes[i].components = desc.components;
+        header.attributes[i].normalized = desc.normalized ? 1 : 0;
+        header.attributes[i].offset = desc.offset;
+    }
+    header.stride = mesh.layout.getStride();
+    header.flags = flags;
+    header.vertexCount = mesh.vertexCount;
+    header.indexCount = mesh.getIndexCount();
+    header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+    header.indexOffset = alignUp(header.vertexOffset + mesh.getVertexDataSize());
+
+    const uint8_t* vertexData = mesh.getVertexData();
+    for (size_t i = 0; i < mesh.vertexCount; i++) {
+        float p[4];
+        unpackAttribute(mesh.layout, vertexData, i, VertexAttribute::Position, p);
+        for (int c = 0; c < 3; c++) {
+            header.boundsMin[c] = i == 0 ? p[c] : std::min(header.boundsMin[c], p[c]);
+            header.boundsMax[c] = i == 0 ? p[c] : std::max(header.boundsMax[c], p[c]);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "cannot open '" + path + "' for writing";
+        return false;
+    }
+
+    static const char padding[Alignment] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(padding, header.vertexOffset - sizeof(header));
+    file.write(reinterpret_cast<const char*>(vertexData), mesh.getVertexDataSize());
+    file.write(padding, header.indexOffset - (header.vertexOffset + mesh.getVertexDataSize()));
+    file.write(reinterpret_cast<const char*>(mesh.getIndexData()), mesh.getIndexCount() * sizeof(uint32_t));
+
+    if (!file.good()) {
+        error = "failed writing '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool readHeader(const std::string& path, MeshFileHeader& header, std::string& error) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "cannot open '" + path + "'";
+        return false;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        error = "file too small";
+        return false;
+    }
+    return validateHeader(header, fileSize, error);
+}
+
+std::shared_ptr<Mesh> map(const std::string& path, std::string& error) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        error = "cannot map '" + path + "'";
+        return nullptr;
+    }
+    if (file->getSize() < sizeof(MeshFileHeader)) {
+        error = "file too small";
+        return nullptr;
+    }
+
+    MeshFileHeader header;
+    memcpy(&header, file->getData(), sizeof(header));
+    if (!validateHeader(header, file->getSize(), error)) {
+        return nullptr;
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    if (!getLayout(header, mesh->layout)) {
+        error = "invalid vertex layout";
+        return nullptr;
+    }
+
+    // Indices are range-checked once so a corrupt file cannot make the GPU read
+    // out of bounds; this also faults the index pages in on the loading thread.
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(file->getData() + header.indexOffset);
+    uint32_t maxIndex = 0;
+    for (uint64_t i = 0; i < header.indexCount; i++) {
+        maxIndex = std::max(maxIndex, indices[i]);
+    }
+    if (header.indexCount > 0 && maxIndex >= header.vertexCount) {
+        error = "index out of range";
+        return nullptr;
+    }
+
+    file->prefetch();
+    mesh->vertexCount = static_cast<size_t>(header.vertexCount);
+    mesh->mappedVertices = file->getData() + header.vertexOffset;
+    mesh->mappedIndices = indices;
+    mesh->mappedIndexCount = static_cast<size_t>(header.indexCount);
+    mesh->mapping = std::move(file);
+    return mesh;
+}
+
+} // namespace MeshFile
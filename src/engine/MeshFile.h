@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Mesh.h"
+#include <memory>
+#include <string>
+
+// Versioned binary mesh container (.l3dmesh), designed to be memory-mapped
+// and handed to the renderer without parsing. Little-endian layout:
+//   MeshFileHeader | vertex data (16-byte aligned) | index data (16-byte aligned)
+
+struct MeshFileAttribute {
+    uint8_t attribute;   // VertexAttribute
+    uint8_t type;        // VertexComponentType
+    uint8_t components;
+    uint8_t normalized;
+    uint16_t offset;
+    uint16_t reserved;
+};
+
+struct MeshFileHeader {
+    char magic[4];           // "L3DM"
+    uint32_t version;        // MeshFile::Version
+    uint32_t headerSize;     // sizeof(MeshFileHeader)
+    uint32_t attributeCount;
+    MeshFileAttribute attributes[VertexLayout::MaxAttributes];
+    uint32_t stride;
+    uint32_t flags;          // MeshFile::Flag* bits
+    uint64_t vertexCount;
+    uint64_t indexCount;     // uint32 triangle list indices, 0 for non-indexed meshes
+    uint64_t vertexOffset;   // From the start of the file
+    uint64_t indexOffset;    // From the start of the file
+    float boundsMin[3];      // Object-space bounds of the positions
+    float boundsMax[3];
+};
+
+static_assert(sizeof(MeshFileHeader) == 128, "MeshFileHeader layout must stay stable");
+
+namespace MeshFile {
+    const uint32_t Version = 2;  // 2: six attribute slots (joints, weights)
+    const char* const Extension = ".l3dmesh";
+
+    // Header flags
+    const uint32_t FlagOptimized = 1 << 0;  // Indices and vertices went through MeshOptimizer
+
+    // Serialize a mesh into the container format
+    bool write(const std::string& path, const Mesh& mesh, std::string& error, uint32_t flags = 0);
+
+    // Read only the header (e.g. to check a cache is compatible)
+    bool readHeader(const std::string& path, MeshFileHeader& header, std::string& error);
+
+    // Map a container and return a mesh that borrows the mapped storage
+    std::shared_ptr<Mesh> map(const std::string& path, std::string& error);
+
+    // Rebuild the vertex layout stored in a header
+    bool getLayout(const MeshFileHeader& header, VertexLayout& layout);
+}
@@ -0,0 +1,864 @@
+#include "MeshImporter.h"
+#include "MappedFile.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// OBJ
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline void skipSpaces(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+}
+
+// Locale-independent float parser, much faster than strtof for OBJ-sized inputs
+bool parseFloat(const char*& p, const char* end, float& out) {
+    skipSpaces(p, end);
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    double value = 0.0;
+    bool digits = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10.0 + (*p++ - '0');
+        digits = true;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if (!digits) {
+        p = start;
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            exponent = exponent * 10 + (*p++ - '0');
+        }
+        value *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+    }
+    out = static_cast<float>(negative ? -value : value);
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, long& out) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p++ - '0');
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+// Resolve a 1-based (or negative, relative) OBJ index
+inline long resolveIndex(long index, size_t count) {
+    return index < 0 ? static_cast<long>(count) + index : index - 1;
+}
+
+// ---------------------------------------------------------------------------
+// Minimal JSON reader for glTF
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* get(const char* key) const {
+        for (const auto& entry : object) {
+            if (entry.first == key) return &entry.second;
+        }
+        return nullptr;
+    }
+    const JsonValue* at(size_t i) const { return i < array.size() ? &array[i] : nullptr; }
+    double getNumber(const char* key, double defaultValue) const {
+        const JsonValue* v = get(key);
+        return v && v->type == Type::Number ? v->number : defaultValue;
+    }
+    bool getBool(const char* key, bool defaultValue) const {
+        const JsonValue* v = get(key);
+        return v && v->type == Type::Bool ? v->boolean : defaultValue;
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* text, size_t size) : p(text), end(text + size), depth(0) {}
+
+    bool parse(JsonValue& out, std::string& error) {
+        if (!parseValue(out)) {
+            error = "invalid JSON";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    }
+
+    bool parseValue(JsonValue& out) {
+        if (++depth > 256) return false;
+        skipWhitespace();
+        if (p >= end) return false;
+        bool ok = false;
+        switch (*p) {
+            case '{': ok = parseObject(out); break;
+            case '[': ok = parseArray(out); break;
+            case '"': out.type = JsonValue::Type::String; ok = parseString(out.string); break;
+            case 't': out.type = JsonValue::Type::Bool; out.boolean = true; ok = literal("true"); break;
+            case 'f': out.type = JsonValue::Type::Bool; out.boolean = false; ok = literal("false"); break;
+            case 'n': out.type = JsonValue::Type::Null; ok = literal("null"); break;
+            default: {
+                float unused;
+                const char* start = p;
+                out.type = JsonValue::Type::Number;
+                ok = parseFloat(p, end, unused);
+                if (ok) out.number = strtod(std::string(start, p).c_str(), nullptr);
+                break;
+            }
+        }
+        depth--;
+        return ok;
+    }
+
+    bool literal(const char* word) {
+        size_t len = strlen(word);
+        if (static_cast<size_t>(end - p) < len || strncmp(p, word, len) != 0) return false;
+        p += len;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        p++; // Opening quote
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                if (++p >= end) return false;
+                switch (*p) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': {
+                        // Only the Basic Latin range matters for glTF keys and URIs
+                        if (end - p < 5) return false;
+                        unsigned code = static_cast<unsigned>(strtoul(std::string(p + 1, p + 5).c_str(), nullptr, 16));
+                        out += code < 0x80 ? static_cast<char>(code) : '?';
+                        p += 4;
+                        break;
+                    }
+                    default: out += *p; break;
+                }
+                p++;
+            } else {
+                out += *p++;
+            }
+        }
+        if (p >= end) return false;
+        p++; // Closing quote
+        return true;
+    }
+
+    bool parseArray(JsonValue& out) {
+        out.type = JsonValue::Type::Array;
+        p++;
+        skipWhitespace();
+        if (p < end && *p == ']') { p++; return true; }
+        for (;;) {
+            out.array.emplace_back();
+            if (!parseValue(out.array.back())) return false;
+            skipWhitespace();
+            if (p >= end) return false;
+            if (*p == ',') { p++; continue; }
+            if (*p == ']') { p++; return true; }
+            return false;
+        }
+    }
+
+    bool parseObject(JsonValue& out) {
+        out.type = JsonValue::Type::Object;
+        p++;
+        skipWhitespace();
+        if (p < end && *p == '}') { p++; return true; }
+        for (;;) {
+            skipWhitespace();
+            if (p >= end || *p != '"') return false;
+            out.object.emplace_back();
+            if (!parseString(out.object.back().first)) return false;
+            skipWhitespace();
+            if (p >= end || *p != ':') return false;
+            p++;
+            if (!parseValue(out.object.back().second)) return false;
+            skipWhitespace();
+            if (p >= end) return false;
+            if (*p == ',') { p++; continue; }
+            if (*p == '}') { p++; return true; }
+            return false;
+        }
+    }
+
+    const char* p;
+    const char* end;
+    int depth;
+};
+
+// ---------------------------------------------------------------------------
+// glTF
+
+const uint32_t GlbMagic = 0x46546C67;      // "glTF"
+const uint32_t GlbChunkJson = 0x4E4F534A;  // "JSON"
+const uint32_t GlbChunkBin = 0x004E4942;   // "BIN\0"
+
+// Largest accessor filled with zeros when it has no buffer view
+const size_t MaxZeroAccessorElements = size_t(1) << 24;
+
+bool readWholeFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    data.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+}
+
+bool decodeBase64(const std::string& text, size_t start, std::vector<uint8_t>& out) {
+    auto decode = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    };
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (size_t i = start; i < text.size() && text[i] != '='; i++) {
+        int value = decode(text[i]);
+        if (value < 0) return false;
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xff));
+        }
+    }
+    return true;
+}
+
+struct GltfDocument {
+    JsonValue json;
+    std::vector<std::vector<uint8_t>> buffers;
+};
+
+// Column-major 4x4 matrix helpers for node transforms
+struct Matrix4 {
+    float m[16];
+    static Matrix4 identity() {
+        Matrix4 r = {};
+        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+        return r;
+    }
+    Matrix4 operator*(const Matrix4& b) const {
+        Matrix4 r = {};
+        for (int c = 0; c < 4; c++)
+            for (int row = 0; row < 4; row++)
+                for (int k = 0; k < 4; k++)
+                    r.m[c * 4 + row] += m[k * 4 + row] * b.m[c * 4 + k];
+        return r;
+    }
+};
+
+Matrix4 nodeMatrix(const JsonValue& node) {
+    Matrix4 result = Matrix4::identity();
+    const JsonValue* matrix = node.get("matrix");
+    if (matrix && matrix->array.size() == 16) {
+        for (int i = 0; i < 16; i++) result.m[i] = static_cast<float>(matrix->array[i].number);
+        return result;
+    }
+
+    float t[3] = {0, 0, 0}, r[4] = {0, 0, 0, 1}, s[3] = {1, 1, 1};
+    auto read = [&](const char* key, float* out, size_t count) {
+        const JsonValue* v = node.get(key);
+        if (v && v->array.size() == count) {
+            for (size_t i = 0; i < count; i++) out[i] = static_cast<float>(v->array[i].number);
+        }
+    };
+    read("translation", t, 3);
+    read("rotation", r, 4);
+    read("scale", s, 3);
+
+    float x = r[0], y = r[1], z = r[2], w = r[3];
+    float rotation[9] = {
+        1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+        2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+        2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y),
+    };
+    for (int c = 0; c < 3; c++) {
+        for (int row = 0; row < 3; row++) {
+            result.m[c * 4 + row] = rotation[c * 3 + row] * s[c];
+        }
+    }
+    result.m[12] = t[0];
+    result.m[13] = t[1];
+    result.m[14] = t[2];
+    return result;
+}
+
+// Read a byte offset, length or count. False for negative, NaN or absurdly large
+// values, which would wrap when converted to size_t.
+bool readSize(const JsonValue& value, const char* key, size_t& out) {
+    double number = value.getNumber(key, 0);
+    if (!(number >= 0.0 && number <= 9007199254740992.0)) return false;
+    out = static_cast<size_t>(number);
+    return true;
+}
+
+// Locate count elements of elementSize bytes, stride apart, inside an accessor's buffer
+// view. Every step is checked without overflow before anything is sized from count.
+bool locateElements(const GltfDocument& doc, const JsonValue& accessor, const JsonValue& view,
+                    size_t count, size_t elementSize, size_t stride, size_t& start, std::string& error) {
+    size_t bufferIndex = 0, viewOffset = 0, viewLength = 0, accessorOffset = 0;
+    if (!readSize(view, "buffer", bufferIndex) || bufferIndex >= doc.buffers.size()) {
+        error = "missing buffer";
+        return false;
+    }
+    size_t bufferSize = doc.buffers[bufferIndex].size();
+    if (!readSize(view, "byteOffset", viewOffset) || !readSize(view, "byteLength", viewLength) ||
+        !readSize(accessor, "byteOffset", accessorOffset) || viewOffset > bufferSize ||
+        viewLength > bufferSize - viewOffset || accessorOffset > viewLength) {
+        error = "buffer view exceeds buffer";
+        return false;
+    }
+    start = viewOffset + accessorOffset;
+    if (count == 0) return true;
+
+    // The last element must end inside the view
+    size_t available = viewLength - accessorOffset;
+    if (elementSize > available || count - 1 > (available - elementSize) / stride) {
+        error = "accessor exceeds buffer";
+        return false;
+    }
+    return true;
+}
+
+// Read accessor elements as floats (normalized integers are mapped to [0, 1])
+bool readAccessor(const GltfDocument& doc, int accessorIndex, int expectedComponents,
+                  std::vector<float>& out, size_t& count, std::string& error) {
+    const JsonValue* accessors = doc.json.get("accessors");
+    const JsonValue* accessor = accessors ? accessors->at(accessorIndex) : nullptr;
+    if (!accessor) {
+        error = "missing accessor";
+        return false;
+    }
+
+    static const std::pair<const char*, int> typeSizes[] = {
+        {"SCALAR", 1}, {"VEC2", 2}, {"VEC3", 3}, {"VEC4", 4},
+    };
+    const JsonValue* type = accessor->get("type");
+    int components = 0;
+    for (const auto& entry : typeSizes) {
+        if (type && type->string == entry.first) components = entry.second;
+    }
+    if (components == 0 || components < expectedComponents) {
+        error = "unsupported accessor type";
+        return false;
+    }
+
+    int componentType = static_cast<int>(accessor->getNumber("componentType", 0));
+    size_t componentSize = 0;
+    switch (componentType) {
+        case 5120: case 5121: componentSize = 1; break;  // BYTE, UNSIGNED_BYTE
+        case 5122: case 5123: componentSize = 2; break;  // SHORT, UNSIGNED_SHORT
+        case 5125: case 5126: componentSize = 4; break;  // UNSIGNED_INT, FLOAT
+        default:
+            error = "unsupported component type";
+            return false;
+    }
+    bool normalized = accessor->getBool("normalized", false) || componentType == 5121 || componentType == 5123;
+
+    if (!readSize(*accessor, "count", count)) {
+        error = "invalid accessor count";
+        return false;
+    }
+
+    const JsonValue* viewIndex = accessor->get("bufferView");
+    if (!viewIndex) {
+        // No buffer view means all zeros (sparse accessors are not supported). Nothing
+        // bounds the count here, so cap it rather than trust the file.
+        if (count > MaxZeroAccessorElements) {
+            error = "accessor without buffer view is too large";
+            return false;
+        }
+        out.assign(count * expectedComponents, 0.0f);
+        return true;
+    }
+    const JsonValue* views = doc.json.get("bufferViews");
+    const JsonValue* view = views ? views->at(static_cast<size_t>(viewIndex->number)) : nullptr;
+    if (!view) {
+        error = "missing buffer view";
+        return false;
+    }
+
+    size_t elementSize = componentSize * components;
+    size_t stride = 0;
+    if (!readSize(*view, "byteStride", stride)) {
+        error = "invalid buffer view stride";
+        return false;
+    }
+    if (stride == 0) stride = elementSize;
+    size_t start = 0;
+    if (!locateElements(doc, *accessor, *view, count, elementSize, stride, start, error)) {
+        return false;
+    }
+
+    const std::vector<uint8_t>& buffer = doc.buffers[static_cast<size_t>(view->getNumber("buffer", 0))];
+    out.resize(count * expectedComponents);
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* element = buffer.data() + start + i * stride;
+        for (int c = 0; c < expectedComponents; c++) {
+            const uint8_t* src = element + c * componentSize;
+            float value = 0.0f;
+            switch (componentType) {
+                case 5120: { int8_t v; memcpy(&v, src, 1); value = normalized ? std::max(v / 127.0f, -1.0f) : v; break; }
+                case 5121: value = normalized ? src[0] / 255.0f : src[0]; break;
+                case 5122: { int16_t v; memcpy(&v, src, 2); value = normalized ? std::max(v / 32767.0f, -1.0f) : v; break; }
+                case 5123: { uint16_t v; memcpy(&v, src, 2); value = normalized ? v / 65535.0f : v; break; }
+                case 5125: { uint32_t v; memcpy(&v, src, 4); value = static_cast<float>(v); break; }
+                case 5126: memcpy(&value, src, 4); break;
+            }
+            out[i * expectedComponents + c] = value;
+        }
+    }
+    return true;
+}
+
+bool readIndices(const GltfDocument& doc, int accessorIndex, std::vector<uint32_t>& out, std::string& error) {
+    const JsonValue* accessors = doc.json.get("accessors");
+    const JsonValue* accessor = accessors ? accessors->at(accessorIndex) : nullptr;
+    if (!accessor) {
+        error = "missing index accessor";
+        return false;
+    }
+    const JsonValue* views = doc.json.get("bufferViews");
+    const JsonValue* viewIndex = accessor->get("bufferView");
+    const JsonValue* view = views && viewIndex ? views->at(static_cast<size_t>(viewIndex->number)) : nullptr;
+    if (!view) {
+        error = "missing index buffer view";
+        return false;
+    }
+
+    int componentType = static_cast<int>(accessor->getNumber("componentType", 0));
+    size_t size = componentType == 5121 ? 1 : componentType == 5123 ? 2 : componentType == 5125 ? 4 : 0;
+    if (size == 0) {
+        error = "unsupported index type";
+        return false;
+    }
+
+    size_t count = 0, start = 0;
+    if (!readSize(*accessor, "count", count)) {
+        error = "invalid index count";
+        return false;
+    }
+    if (!locateElements(doc, *accessor, *view, count, size, size, start, error)) {
+        error = "index " + error;
+        return false;
+    }
+
+    const std::vector<uint8_t>& buffer = doc.buffers[static_cast<size_t>(view->getNumber("buffer", 0))];
+    out.resize(count);
+    const uint8_t* src = buffer.data() + start;
+    for (size_t i = 0; i < count; i++) {
+        if (size == 1) {
+            out[i] = src[i];
+        } else if (size == 2) {
+            uint16_t v;
+            memcpy(&v, src + i * 2, 2);
+            out[i] = v;
+        } else {
+            memcpy(&out[i], src + i * 4, 4);
+        }
+    }
+    return true;
+}
+
+// Append every triangle primitive of a mesh, transformed by world
+bool appendGltfMesh(const GltfDocument& doc, const JsonValue& mesh, const Matrix4& world,
+                    ImportedMesh& out, std::string& error) {
+    const JsonValue* primitives = mesh.get("primitives");
+    if (!primitives) return true;
+
+    // Normals use the inverse transpose; for the rigid/uniform-scale transforms glTF
+    // assets normally carry, the upper 3x3 followed by renormalization is equivalent.
+    for (const JsonValue& primitive : primitives->array) {
+        if (primitive.getNumber("mode", 4) != 4) {
+            continue; // Only triangle lists
+        }
+        const JsonValue* attributes = primitive.get("attributes");
+        const JsonValue* position = attributes ? attributes->get("POSITION") : nullptr;
+        if (!position) continue;
+
+        std::vector<float> positions, normals, colors;
+        size_t count = 0, normalCount = 0, colorCount = 0;
+        if (!readAccessor(doc, static_cast<int>(position->number), 3, positions, count, error)) return false;
+
+        const JsonValue* normal = attributes->get("NORMAL");
+        if (normal && !readAccessor(doc, static_cast<int>(normal->number), 3, normals, normalCount, error)) return false;
+        const JsonValue* color = attributes->get("COLOR_0");
+        if (color && !readAccessor(doc, static_cast<int>(color->number), 3, colors, colorCount, error)) return false;
+
+        // Keep attribute streams aligned across primitives that differ in what they carry
+        const size_t base = out.vertexCount();
+        bool wantNormals = !normals.empty() || !out.normals.empty();
+        bool wantColors = !colors.empty() || !out.colors.empty();
+        if (wantNormals && out.normals.size() < base * 3) out.normals.resize(base * 3, 0.0f);
+        if (wantColors && out.colors.size() < base * 3) out.colors.resize(base * 3, 1.0f);
+
+        for (size_t i = 0; i < count; i++) {
+            const float* p = &positions[i * 3];
+            for (int row = 0; row < 3; row++) {
+                out.positions.push_back(world.m[row] * p[0] + world.m[4 + row] * p[1] + world.m[8 + row] * p[2] + world.m[12 + row]);
+            }
+            if (wantNormals) {
+                float n[3] = {0.0f, 0.0f, 0.0f};
+                if (i < normalCount) {
+                    const float* src = &normals[i * 3];
+                    for (int row = 0; row < 3; row++) {
+                        n[row] = world.m[row] * src[0] + world.m[4 + row] * src[1] + world.m[8 + row] * src[2];
+                    }
+                    float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if (len > 0.0f) { n[0] /= len; n[1] /= len; n[2] /= len; }
+                }
+                out.normals.insert(out.normals.end(), n, n + 3);
+            }
+            if (wantColors) {
+                if (i < colorCount) {
+                    out.colors.insert(out.colors.end(), &colors[i * 3], &colors[i * 3] + 3);
+                } else {
+                    out.colors.insert(out.colors.end(), {1.0f, 1.0f, 1.0f});
+                }
+            }
+        }
+
+        const JsonValue* indices = primitive.get("indices");
+        if (indices) {
+            std::vector<uint32_t> primitiveIndices;
+            if (!readIndices(doc, static_cast<int>(indices->number), primitiveIndices, error)) return false;
+            for (uint32_t index : primitiveIndices) {
+                if (index >= count) {
+                    error = "index out of range";
+                    return false;
+                }
+                out.indices.push_back(static_cast<uint32_t>(base + index));
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                out.indices.push_back(static_cast<uint32_t>(base + i));
+            }
+        }
+    }
+    return true;
+}
+
+bool appendGltfNode(const GltfDocument& doc, size_t nodeIndex, const Matrix4& parent, int depth,
+                    ImportedMesh& out, std::string& error) {
+    const JsonValue* nodes = doc.json.get("nodes");
+    const JsonValue* node = nodes ? nodes->at(nodeIndex) : nullptr;
+    if (!node || depth > 64) {
+        error = "invalid node hierarchy";
+        return false;
+    }
+
+    Matrix4 world = parent * nodeMatrix(*node);
+    const JsonValue* meshIndex = node->get("mesh");
+    if (meshIndex) {
+        const JsonValue* meshes = doc.json.get("meshes");
+        const JsonValue* mesh = meshes ? meshes->at(static_cast<size_t>(meshIndex->number)) : nullptr;
+        if (mesh && !appendGltfMesh(doc, *mesh, world, out, error)) return false;
+    }
+    const JsonValue* children = node->get("children");
+    if (children) {
+        for (const JsonValue& child : children->array) {
+            if (!appendGltfNode(doc, static_cast<size_t>(child.number), world, depth + 1, out, error)) return false;
+        }
+    }
+    return true;
+}
+
+bool hasExtension(const std::string& path, const char* extension) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    for (char& c : ext) c = static_cast<char>(tolower(c));
+    return ext == extension;
+}
+
+} // namespace
+
+namespace MeshImporter {
+
+bool importObj(const char* text, size_t size, ImportedMesh& mesh, std::string& error) {
+    std::vector<float> positions, colors, normals;
+    std::unordered_map<uint64_t, uint32_t> vertexMap;
+    bool hasColors = false;
+
+    const char* p = text;
+    const char* end = text + size;
+    size_t line = 0;
+    std::vector<uint32_t> face;
+
+    while (p < end) {
+        line++;
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+
+        skipSpaces(p, lineEnd);
+        if (p + 1 < lineEnd && p[0] == 'v' && isSpace(p[1])) {
+            p += 2;
+            float v[6] = {0, 0, 0, 1, 1, 1};
+            int read = 0;
+            while (read < 6 && parseFloat(p, lineEnd, v[read])) read++;
+            if (read < 3) {
+                error = "bad vertex on line " + std::to_string(line);
+                return false;
+            }
+            positions.insert(positions.end(), v, v + 3);
+            colors.insert(colors.end(), v + 3, v + 6);
+            hasColors = hasColors || read >= 6;
+        } else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            p += 3;
+            float n[3] = {0, 0, 0};
+            for (float& value : n) parseFloat(p, lineEnd, value);
+            normals.insert(normals.end(), n, n + 3);
+        } else if (p + 1 < lineEnd && p[0] == 'f' && isSpace(p[1])) {
+            p += 2;
+            face.clear();
+            for (;;) {
+                skipSpaces(p, lineEnd);
+                long vi = 0, ni = 0;
+                if (!parseInt(p, lineEnd, vi)) break;
+                if (p < lineEnd && *p == '/') {
+                    p++;
+                    long unused;
+                    parseInt(p, lineEnd, unused); // Texture coordinates are not imported
+                    if (p < lineEnd && *p == '/') {
+                        p++;
+                        parseInt(p, lineEnd, ni);
+                    }
+                }
+                while (p < lineEnd && !isSpace(*p)) p++;
+
+                long v = resolveIndex(vi, positions.size() / 3);
+                long n = ni != 0 ? resolveIndex(ni, normals.size() / 3) : -1;
+                if (v < 0 || static_cast<size_t>(v) >= positions.size() / 3 ||
+                    (ni != 0 && (n < 0 || static_cast<size_t>(n) >= normals.size() / 3))) {
+                    error = "face index out of range on line " + std::to_string(line);
+                    return false;
+                }
+
+                // One output vertex per unique position/normal pair
+                uint64_t key = (static_cast<uint64_t>(v) << 32) | static_cast<uint32_t>(n + 1);
+                auto inserted = vertexMap.emplace(key, static_cast<uint32_t>(mesh.vertexCount()));
+                if (inserted.second) {
+                    mesh.positions.insert(mesh.positions.end(), &positions[v * 3], &positions[v * 3] + 3);
+                    mesh.colors.insert(mesh.colors.end(), &colors[v * 3], &colors[v * 3] + 3);
+                    if (n >= 0) {
+                        mesh.normals.insert(mesh.normals.end(), &normals[n * 3], &normals[n * 3] + 3);
+                    } else {
+                        mesh.normals.insert(mesh.normals.end(), {0.0f, 0.0f, 0.0f});
+                    }
+                }
+                face.push_back(inserted.first->second);
+            }
+            // Fan-triangulate polygons
+            for (size_t i = 2; i < face.size(); i++) {
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+        p = lineEnd + 1;
+    }
+
+    if (!hasColors) mesh.colors.clear();
+    if (normals.empty()) mesh.normals.clear();
+    if (mesh.indices.empty()) {
+        error = "no faces";
+        return false;
+    }
+    return true;
+}
+
+bool importGltf(const std::string& path, ImportedMesh& mesh, std::string& error) {
+    std::vector<uint8_t> file;
+    if (!readWholeFile(path, file)) {
+        error = "cannot read '" + path + "'";
+        return false;
+    }
+
+    GltfDocument doc;
+    const char* jsonText = reinterpret_cast<const char*>(file.data());
+    size_t jsonSize = file.size();
+    std::vector<uint8_t> glbBinary;
+
+    uint32_t magic = 0;
+    if (file.size() >= 12) memcpy(&magic, file.data(), 4);
+    if (magic == GlbMagic) {
+        // Binary container: 12-byte header, then length/type prefixed chunks
+        size_t offset = 12;
+        jsonText = nullptr;
+        while (offset + 8 <= file.size()) {
+            uint32_t chunkLength, chunkType;
+            memcpy(&chunkLength, file.data() + offset, 4);
+            memcpy(&chunkType, file.data() + offset + 4, 4);
+            offset += 8;
+            if (chunkLength > file.size() - offset) {
+                error = "truncated GLB chunk";
+                return false;
+            }
+            if (chunkType == GlbChunkJson && !jsonText) {
+                jsonText = reinterpret_cast<const char*>(file.data() + offset);
+                jsonSize = chunkLength;
+            } else if (chunkType == GlbChunkBin && glbBinary.empty()) {
+                glbBinary.assign(file.data() + offset, file.data() + offset + chunkLength);
+            }
+            offset += (chunkLength + 3) & ~3u;
+        }
+        if (!jsonText) {
+            error = "GLB has no JSON chunk";
+            return false;
+        }
+    }
+
+    JsonParser parser(jsonText, jsonSize);
+    if (!parser.parse(doc.json, error)) {
+        return false;
+    }
+
+    // Resolve buffers: GLB binary chunk, embedded data URIs or files next to the asset
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    const JsonValue* buffers = doc.json.get("buffers");
+    if (buffers) {
+        for (const JsonValue& buffer : buffers->array) {
+            doc.buffers.emplace_back();
+            const JsonValue* uri = buffer.get("uri");
+            if (!uri) {
+                doc.buffers.back() = glbBinary;
+            } else if (uri->string.compare(0, 5, "data:") == 0) {
+                size_t comma = uri->string.find(',');
+                if (comma == std::string::npos || !decodeBase64(uri->string, comma + 1, doc.buffers.back())) {
+                    error = "invalid embedded buffer";
+                    return false;
+                }
+            } else if (!readWholeFile((directory / uri->string).string(), doc.buffers.back())) {
+                error = "cannot read buffer '" + uri->string + "'";
+                return false;
+            }
+        }
+    }
+
+    // Walk the default scene so node transforms are applied; fall back to raw meshes
+    const JsonValue* scenes = doc.json.get("scenes");
+    const JsonValue* scene = scenes ? scenes->at(static_cast<size_t>(doc.json.getNumber("scene", 0))) : nullptr;
+    const JsonValue* roots = scene ? scene->get("nodes") : nullptr;
+    if (roots) {
+        for (const JsonValue& root : roots->array) {
+            if (!appendGltfNode(doc, static_cast<size_t>(root.number), Matrix4::identity(), 0, mesh, error)) {
+                return false;
+            }
+        }
+    } else if (const JsonValue* meshes = doc.json.get("meshes")) {
+        for (const JsonValue& entry : meshes->array) {
+            if (!appendGltfMesh(doc, entry, Matrix4::identity(), mesh, error)) return false;
+        }
+    }
+
+    // Pad attribute streams started by later primitives
+    if (!mesh.normals.empty()) mesh.normals.resize(mesh.positions.size(), 0.0f);
+    if (!mesh.colors.empty()) mesh.colors.resize(mesh.positions.size(), 1.0f);
+
+    if (mesh.indices.empty()) {
+        error = "no triangle primitives";
+        return false;
+    }
+    return true;
+}
+
+bool importFile(const std::string& path, ImportedMesh& mesh, std::string& error) {
+    if (hasExtension(path, ".obj")) {
+        MappedFile file;
+        if (!file.open(path)) {
+            error = "cannot read '" + path + "'";
+            return false;
+        }
+        return importObj(reinterpret_cast<const char*>(file.getData()), file.getSize(), mesh, error);
+    }
+    if (hasExtension(path, ".gltf") || hasExtension(path, ".glb")) {
+        return importGltf(path, mesh, error);
+    }
+    error = "unsupported mesh format '" + std::filesystem::path(path).extension().string() + "'";
+    return false;
+}
+
+std::shared_ptr<Mesh> toMesh(const ImportedMesh& imported, const VertexLayout* layout) {
+    VertexLayout chosen = layout ? *layout
+                                 : (imported.normals.empty() ? VertexLayout::compact() : VertexLayout::compactNormal());
+
+    const size_t count = imported.vertexCount();
+    const int floatsPerVertex = chosen.getSourceFloatsPerVertex();
+    const int normalOffset = chosen.getSourceOffset(VertexAttribute::Normal);
+    std::vector<float> interleaved(count * floatsPerVertex);
+    for (size_t i = 0; i < count; i++) {
+        float* out = &interleaved[i * floatsPerVertex];
+        memcpy(out, &imported.positions[i * 3], 3 * sizeof(float));
+        if (!imported.colors.empty()) {
+            memcpy(out + 3, &imported.colors[i * 3], 3 * sizeof(float));
+        } else {
+            out[3] = out[4] = out[5] = 1.0f;
+        }
+        if (normalOffset >= 0 && !imported.normals.empty()) {
+            memcpy(out + normalOffset, &imported.normals[i * 3], 3 * sizeof(float));
+        }
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->layout = chosen;
+    mesh->vertexCount = count;
+    mesh->vertices.resize(count * chosen.getStride());
+    packVertices(chosen, interleaved.data(), count, mesh->vertices.data());
+    mesh->indices = imported.indices;
+    return mesh;
+}
+
+} // namespace MeshImporter
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Mesh.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Geometry decoded from a source asset, before packing
+struct ImportedMesh {
+    std::vector<float> positions;  // xyz per vertex
+    std::vector<float> colors;     // rgb per vertex, empty if the source has none
+    std::vector<float> normals;    // xyz per vertex, empty if the source has none
+    std::vector<uint32_t> indices; // Triangle list
+
+    size_t vertexCount() const { return positions.size() / 3; }
+};
+
+namespace MeshImporter {
+    // Wavefront OBJ text (v/vn/f, optional "v x y z r g b" vertex colors)
+    bool importObj(const char* text, size_t size, ImportedMesh& mesh, std::string& error);
+
+    // glTF 2.0, either .gltf (JSON with external or embedded buffers) or .glb.
+    // Node transforms of the default scene are baked into the geometry.
+    bool importGltf(const std::string& path, ImportedMesh& mesh, std::string& error);
+
+    // Pick an importer from the file extension
+    bool importFile(const std::string& path, ImportedMesh& mesh, std::string& error);
+
+    // Pack imported geometry. Without a layout, picks compact_normal when the
+    // source has normals and compact otherwise.
+    std::shared_ptr<Mesh> toMesh(const ImportedMesh& imported, const VertexLayout* layout);
+}
@@ -0,0 +1,135 @@
+#include "MeshLoader.h"
+#include "MeshFile.h"
+#include "MeshImporter.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+namespace {
+
+bool isMeshFile(const std::string& path) {
+    std::filesystem::path p(path);
+    return p.extension() == MeshFile::Extension;
+}
+
+// A cache is usable when it is newer than its source, was optimized, and matches the
+// requested layout
+bool isCacheFresh(const std::string& source, const std::string& cache, const VertexLayout* layout) {
+    std::error_code ec;
+    auto sourceTime = std::filesystem::last_write_time(source, ec);
+    if (ec) return false;
+    auto cacheTime = std::filesystem::last_write_time(cache, ec);
+    if (ec || cacheTime < sourceTime) return false;
+
+    MeshFileHeader header;
+    std::string error;
+    VertexLayout cachedLayout;
+    if (!MeshFile::readHeader(cache, header, error) || !MeshFile::getLayout(header, cachedLayout) ||
+        !(header.flags & MeshFile::FlagOptimized)) {
+        return false;
+    }
+    return !layout || cachedLayout == *layout;
+}
+
+size_t fileSize(const std::string& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+} // namespace
+
+namespace MeshLoader {
+
+static MeshLoadResult loadFile(const std::string& path, const VertexLayout* layout) {
+    MeshLoadResult result;
+    auto start = std::chrono::steady_clock::now();
+    auto finish = [&]() -> MeshLoadResult& {
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    };
+
+    std::string mappedPath;
+    if (isMeshFile(path)) {
+        mappedPath = path;
+    } else {
+        std::string cache = path + MeshFile::Extension;
+        if (isCacheFresh(path, cache, layout)) {
+            mappedPath = cache;
+        }
+    }
+
+    if (!mappedPath.empty()) {
+        result.mesh = MeshFile::map(mappedPath, result.error);
+        result.sourceBytes = fileSize(mappedPath);
+        result.mapped = result.mesh != nullptr;
+        // A container in a different layout is repacked rather than rejected
+        if (result.mesh && layout && !(result.mesh->layout == *layout)) {
+            std::vector<float> unpacked;
+            const Mesh& source = *result.mesh;
+            auto converted = std::make_shared<Mesh>();
+            converted->layout = *layout;
+            converted->vertexCount = source.vertexCount;
+            converted->indices.assign(source.getIndexData(), source.getIndexData() + source.getIndexCount());
+            const int floatsPerVertex = layout->getSourceFloatsPerVertex();
+            unpacked.resize(source.vertexCount * floatsPerVertex);
+            for (size_t i = 0; i < source.vertexCount; i++) {
+                float* out = &unpacked[i * floatsPerVertex];
+                for (int a = 0; a < layout->getAttributeCount(); a++) {
+                    VertexAttribute attribute = layout->getAttribute(a).attribute;
+                    float value[4];
+                    if (!unpackAttribute(source.layout, source.getVertexData(), i, attribute, value)) {
+                        // Missing colors are white; everything else is zero
+                        float fill = attribute == VertexAttribute::Color ? 1.0f : 0.0f;
+                        value[0] = value[1] = value[2] = value[3] = fill;
+                    }
+                    float* slot = out + layout->getSourceOffset(attribute);
+                    for (int c = 0; c < getSourceComponents(attribute); c++) {
+                        slot[c] = value[c];
+                    }
+                }
+            }
+            converted->vertices.resize(source.vertexCount * layout->getStride());
+            packVertices(*layout, unpacked.data(), source.vertexCount, converted->vertices.data());
+            result.mesh = converted;
+            result.mapped = false;
+        }
+        return finish();
+    }
+
+    ImportedMesh imported;
+    if (!MeshImporter::importFile(path, imported, result.error)) {
+        return finish();
+    }
+    result.sourceBytes = fileSize(path);
+    std::shared_ptr<Mesh> mesh = MeshImporter::toMesh(imported, layout);
+    MeshOptimizer::optimize(*mesh, &result.optimization);
+
+    // Write the cache through a temporary file so concurrent loads never map a partial file
+    static std::atomic<unsigned> cacheCounter{0};
+    std::string cache = path + MeshFile::Extension;
+    std::string temporary = cache + ".tmp" + std::to_string(cacheCounter++);
+    std::string cacheError;
+    if (MeshFile::write(temporary, *mesh, cacheError, MeshFile::FlagOptimized)) {
+        std::error_code ec;
+        std::filesystem::rename(temporary, cache, ec);
+        if (ec) std::filesystem::remove(temporary, ec);
+    }
+
+    result.mesh = mesh;
+    return finish();
+}
+
+MeshLoadResult load(const std::string& path, const VertexLayout* layout) {
+    // A malformed file can still make an allocation fail; report it like any other
+    // load error instead of letting it escape into the worker thread
+    try {
+        return loadFile(path, layout);
+    } catch (const std::exception& e) {
+        MeshLoadResult result;
+        result.error = std::string("failed to load ") + path + ": " + e.what();
+        return result;
+    }
+}
+
+} // namespace MeshLoader
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include <memory>
+#include <string>
+
+// Outcome of a mesh load, produced on a worker thread
+struct MeshLoadResult {
+    std::shared_ptr<Mesh> mesh;  // Null on failure
+    std::string error;
+    size_t sourceBytes = 0;      // Size of the file that was read
+    double seconds = 0.0;        // Wall time of the load
+    bool mapped = false;         // True when served from a .l3dmesh mapping
+    MeshOptimizer::Report optimization;  // Set when the mesh was imported and optimized
+};
+
+namespace MeshLoader {
+    // Load a mesh from disk. .l3dmesh files are mapped directly. OBJ/glTF files
+    // are imported and converted to a "<path>.l3dmesh" cache next to the source,
+    // which later loads map instead of re-importing while it is up to date.
+    // Imported indexed meshes are optimized (MeshOptimizer) before they are cached.
+    // layout may be null to keep the file's (or the importer's default) layout.
+    // Safe to call from worker threads.
+    MeshLoadResult load(const std::string& path, const VertexLayout* layout);
+}
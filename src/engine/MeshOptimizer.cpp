@@ -0,0 +1,368 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Forsyth's scoring: a larger cache than the one simulated works best in practice
+const int ScoredCacheSize = 32;
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.0f;
+const float ValenceBoostPower = 0.5f;
+const int MaxScoredValence = 64;
+
+struct ScoreTables {
+    float cache[ScoredCacheSize];
+    float valence[MaxScoredValence + 1];
+
+    ScoreTables() {
+        for (int i = 0; i < ScoredCacheSize; i++) {
+            // The last triangle's vertices score the same whatever their order, so an
+            // emitted triangle does not favor one of its edges
+            cache[i] = i < 3 ? LastTriangleScore
+                             : std::pow(1.0f - float(i - 3) / float(ScoredCacheSize - 3), CacheDecayPower);
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i <= MaxScoredValence; i++) {
+            // Favor vertices with few triangles left, to finish them off and free them
+            valence[i] = ValenceBoostScale * std::pow(float(i), -ValenceBoostPower);
+        }
+    }
+};
+
+const ScoreTables& getScoreTables() {
+    static const ScoreTables tables;
+    return tables;
+}
+
+float vertexScore(const ScoreTables& tables, int cachePosition, uint32_t remaining) {
+    if (remaining == 0) return -1.0f;
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    return score + tables.valence[std::min<uint32_t>(remaining, MaxScoredValence)];
+}
+
+// FIFO post-transform cache by insertion time: a vertex stays cached until cacheSize
+// later vertices were inserted. Returns the misses of one triangle.
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, int cacheSize)
+        : timestamps(vertexCount, 0), cacheSize(static_cast<uint32_t>(cacheSize)), now(cacheSize + 1) {}
+
+    int add(uint32_t a, uint32_t b, uint32_t c) { return add(a) + add(b) + add(c); }
+
+    // Forget every cached vertex
+    void flush() { now += cacheSize + 1; }
+
+private:
+    int add(uint32_t vertex) {
+        if (now - timestamps[vertex] <= cacheSize) return 0;
+        timestamps[vertex] = now++;
+        return 1;
+    }
+
+    std::vector<uint32_t> timestamps;
+    uint32_t cacheSize;
+    uint32_t now;
+};
+
+} // namespace
+
+namespace MeshOptimizer {
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize) {
+    VertexCacheStats stats;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    size_t misses = 0, referencedCount = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* triangle = indices + t * 3;
+        misses += cache.add(triangle[0], triangle[1], triangle[2]);
+        for (int corner = 0; corner < 3; corner++) {
+            if (!referenced[triangle[corner]]) {
+                referenced[triangle[corner]] = 1;
+                referencedCount++;
+            }
+        }
+    }
+    stats.acmr = float(misses) / float(triangleCount);
+    stats.atvr = float(misses) / float(referencedCount);
+    return stats;
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    const ScoreTables& tables = getScoreTables();
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles of each vertex; the first remaining[v] entries are the ones not emitted yet
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            adjacency[filled[indices[t * 3 + corner]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    int best = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* triangle = indices + t * 3;
+        triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+        if (triangleScores[t] > triangleScores[best]) best = static_cast<int>(t);
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    uint32_t cache[ScoredCacheSize + 3];
+    uint32_t nextCache[ScoredCacheSize + 3];
+    int cacheCount = 0;
+    size_t cursor = 0;  // First triangle that may not be emitted yet
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (best < 0) {
+            // Nothing in the cache has triangles left: continue with the next unvisited one
+            while (emitted[cursor]) cursor++;
+            best = static_cast<int>(cursor);
+        }
+        const uint32_t* triangle = indices + best * 3;
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = 1;
+
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t vertex = triangle[corner];
+            uint32_t* live = &adjacency[offsets[vertex]];
+            uint32_t count = remaining[vertex];
+            for (uint32_t i = 0; i < count; i++) {
+                if (live[i] == static_cast<uint32_t>(best)) {
+                    live[i] = live[count - 1];
+                    live[count - 1] = static_cast<uint32_t>(best);
+                    remaining[vertex]--;
+                    break;
+                }
+            }
+        }
+
+        // The triangle's vertices move to the front of the cache
+        int nextCount = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t vertex = triangle[corner];
+            if (std::find(nextCache, nextCache + nextCount, vertex) == nextCache + nextCount) {
+                nextCache[nextCount++] = vertex;
+            }
+        }
+        for (int i = 0; i < cacheCount; i++) {
+            uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                nextCache[nextCount++] = vertex;
+            }
+        }
+
+        // Rescore the cached and just-evicted vertices
+        for (int i = 0; i < nextCount; i++) {
+            uint32_t vertex = nextCache[i];
+            float score = vertexScore(tables, i < ScoredCacheSize ? i : -1, remaining[vertex]);
+            float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+            const uint32_t* live = &adjacency[offsets[vertex]];
+            for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                triangleScores[live[j]] += delta;
+            }
+        }
+        cacheCount = std::min(nextCount, ScoredCacheSize);
+        memcpy(cache, nextCache, cacheCount * sizeof(uint32_t));
+
+        // Next, the best triangle around what is still cached
+        best = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheCount; i++) {
+            uint32_t vertex = cache[i];
+            const uint32_t* live = &adjacency[offsets[vertex]];
+            for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                if (triangleScores[live[j]] > bestScore) {
+                    bestScore = triangleScores[live[j]];
+                    best = static_cast<int>(live[j]);
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+                      float threshold) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) return;
+
+    // Hard boundaries: a triangle that misses on all three vertices starts a new patch
+    FifoCache cache(vertexCount, CacheSize);
+    std::vector<uint32_t> hard;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* triangle = indices + t * 3;
+        if (cache.add(triangle[0], triangle[1], triangle[2]) == 3 || t == 0) {
+            hard.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    hard.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Soft boundaries: split a patch wherever the running ACMR since the last split is
+    // within threshold of the patch's own, so the split costs little cache reuse
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); h++) {
+        uint32_t start = hard[h], end = hard[h + 1];
+        cache.flush();
+        int patchMisses = 0;
+        for (uint32_t t = start; t < end; t++) {
+            patchMisses += cache.add(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]);
+        }
+        float target = threshold * float(patchMisses) / float(end - start);
+
+        clusters.push_back(start);
+        cache.flush();
+        int misses = 0, triangles = 0;
+        for (uint32_t t = start; t < end; t++) {
+            misses += cache.add(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]);
+            triangles++;
+            if (float(misses) <= target * float(triangles)) {
+                clusters.push_back(t + 1);
+                cache.flush();
+                misses = triangles = 0;
+            }
+        }
+        // A split at the end is no split, and a tail that never reached the target
+        // joins the cluster before it
+        if (clusters.back() == end || clusters.back() != start) {
+            clusters.pop_back();
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    float center[3] = {0.0f, 0.0f, 0.0f};
+    for (size_t v = 0; v < vertexCount; v++) {
+        for (int c = 0; c < 3; c++) center[c] += positions[v * 3 + c];
+    }
+    for (int c = 0; c < 3; c++) center[c] /= float(vertexCount);
+
+    // Outward-facing clusters first: the dot product of the cluster's area-weighted
+    // normal and its centroid's offset from the mesh center
+    struct ClusterOrder {
+        float key;
+        uint32_t cluster;
+    };
+    std::vector<ClusterOrder> order(clusters.size() - 1);
+    for (size_t k = 0; k + 1 < clusters.size(); k++) {
+        float centroid[3] = {0.0f, 0.0f, 0.0f};
+        float normal[3] = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (uint32_t t = clusters[k]; t < clusters[k + 1]; t++) {
+            const float* p0 = positions + indices[t * 3] * 3;
+            const float* p1 = positions + indices[t * 3 + 1] * 3;
+            const float* p2 = positions + indices[t * 3 + 2] * 3;
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float weight = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int c = 0; c < 3; c++) {
+                centroid[c] += (p0[c] + p1[c] + p2[c]) * (weight / 3.0f);
+                normal[c] += n[c];
+            }
+            area += weight;
+        }
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0.0f;
+        if (area > 0.0f && length > 0.0f) {
+            for (int c = 0; c < 3; c++) {
+                key += (centroid[c] / area - center[c]) * (normal[c] / length);
+            }
+        }
+        order[k] = {key, static_cast<uint32_t>(k)};
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const ClusterOrder& a, const ClusterOrder& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (const ClusterOrder& entry : order) {
+        output.insert(output.end(), indices + clusters[entry.cluster] * 3, indices + clusters[entry.cluster + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+size_t remapVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap) {
+    remap.assign(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t& mapped = remap[indices[i]];
+        if (mapped == UINT32_MAX) {
+            mapped = next++;
+        }
+        indices[i] = mapped;
+    }
+    return next;
+}
+
+bool optimize(Mesh& mesh, Report* report) {
+    if (mesh.mapping || mesh.indices.size() < 3 || mesh.vertexCount == 0) {
+        return false;
+    }
+    // Validate before touching anything, so a rejected mesh is left as it was
+    std::vector<uint32_t>& indices = mesh.indices;
+    const size_t indexCount = indices.size() - indices.size() % 3;
+    for (size_t i = 0; i < indexCount; i++) {
+        if (indices[i] >= mesh.vertexCount) return false;
+    }
+    // A trailing partial triangle is never drawn
+    indices.resize(indexCount);
+
+    Report result;
+    result.before = analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+
+    optimizeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+
+    std::vector<float> positions(mesh.vertexCount * 3);
+    for (size_t v = 0; v < mesh.vertexCount; v++) {
+        float value[4];
+        unpackAttribute(mesh.layout, mesh.vertices.data(), v, VertexAttribute::Position, value);
+        memcpy(&positions[v * 3], value, 3 * sizeof(float));
+    }
+    optimizeOverdraw(indices.data(), indices.size(), positions.data(), mesh.vertexCount);
+
+    std::vector<uint32_t> remap;
+    size_t vertexCount = remapVertexFetch(indices.data(), indices.size(), mesh.vertexCount, remap);
+    const size_t stride = mesh.layout.getStride();
+    std::vector<uint8_t> vertices(vertexCount * stride);
+    for (size_t v = 0; v < mesh.vertexCount; v++) {
+        if (remap[v] != UINT32_MAX) {
+            memcpy(&vertices[remap[v] * stride], &mesh.vertices[v * stride], stride);
+        }
+    }
+    result.droppedVertices = mesh.vertexCount - vertexCount;
+    mesh.vertices.swap(vertices);
+    mesh.vertexCount = vertexCount;
+    mesh.markReplaced();
+
+    result.after = analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+    result.optimized = true;
+    if (report) *report = result;
+    return true;
+}
+
+} // namespace MeshOptimizer
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <vector>
+
+// Reorders indexed triangle lists for the vertex pipeline:
+//  1. Forsyth's linear-speed vertex cache optimization, so consecutive triangles reuse
+//     recently transformed vertices.
+//  2. Overdraw ordering (after Sander et al., "Fast triangle reordering for vertex
+//     locality and reduced overdraw"): the cache-ordered list is split into clusters
+//     wherever that costs little cache reuse, and clusters facing away from the mesh
+//     center are drawn first so they occlude more of what follows.
+//  3. Vertex fetch remapping: vertices are renumbered in first-use order so fetches
+//     walk the vertex buffer forward; unreferenced vertices are dropped.
+// Runs on mesh ingest, on the loading worker thread.
+namespace MeshOptimizer {
+    // FIFO post-transform cache the statistics simulate
+    const int CacheSize = 16;
+
+    // ACMR: vertices transformed per triangle (0.5 is ideal for large grids, 3 is worst).
+    // ATVR: vertices transformed per referenced vertex (1 is ideal).
+    struct VertexCacheStats {
+        float acmr = 0.0f;
+        float atvr = 0.0f;
+    };
+
+    struct Report {
+        bool optimized = false;
+        VertexCacheStats before;
+        VertexCacheStats after;
+        size_t droppedVertices = 0;  // Unreferenced vertices removed by the remap
+    };
+
+    VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                        int cacheSize = CacheSize);
+
+    void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // positions holds xyz per vertex. threshold is how much worse than a cluster's own
+    // ACMR a split may make it (1.05 allows 5%).
+    void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+                          float threshold = 1.05f);
+
+    // Renumber vertices in first-use order. Fills remap (old index to new, UINT32_MAX
+    // for unreferenced vertices) and returns the new vertex count.
+    size_t remapVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+    // All three passes on an indexed mesh with owned storage. Returns false (and leaves
+    // the mesh alone) for non-indexed or memory-mapped meshes.
+    bool optimize(Mesh& mesh, Report* report = nullptr);
+}
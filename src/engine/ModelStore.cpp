@@ -0,0 +1,235 @@
+#include "ModelStore.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline unsigned countTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+void setBit(std::vector<uint64_t>& bits, size_t index, bool value) {
+    uint64_t bit = uint64_t(1) << (index & 63);
+    if (value) {
+        bits[index >> 6] |= bit;
+    } else {
+        bits[index >> 6] &= ~bit;
+    }
+}
+
+// Remove bit index, shifting the bits above it down by one a word at a time
+void eraseBit(std::vector<uint64_t>& bits, size_t index, size_t newSize) {
+    size_t word = index >> 6;
+    uint64_t bit = uint64_t(1) << (index & 63);
+    uint64_t below = bits[word] & (bit - 1);
+    uint64_t above = (bits[word] >> 1) & ~(bit - 1);
+    bits[word] = below | above;
+    for (size_t w = word + 1; w < bits.size(); w++) {
+        bits[w - 1] |= (bits[w] & 1) << 63;
+        bits[w] >>= 1;
+    }
+    bits.resize((newSize + 63) >> 6);
+}
+
+} // namespace
+
+size_t ModelStore::add(std::shared_ptr<Mesh> mesh, bool visible, const CFrame& cframe) {
+    size_t index = meshes.size();
+    bounds.push_back(mesh ? mesh->computeBounds() : Bounds());
+    meshes.push_back(std::move(mesh));
+    cframes.push_back(cframe);
+    archetypes.push_back(0);
+    if ((index >> 6) >= visibility.size()) {
+        visibility.push_back(0);
+        occluders.push_back(0);
+        changed.push_back(0);
+    }
+    setVisible(index, visible);
+    setBit(occluders, index, false);
+    for (size_t id = 0; id < components.size(); id++) {
+        components[id].data.resize(components[id].data.size() + getComponentWidth(static_cast<int>(id)), 0.0f);
+    }
+    return index;
+}
+
+void ModelStore::remove(size_t index) {
+    if (index >= size()) return;
+
+    meshes.erase(meshes.begin() + index);
+    cframes.erase(cframes.begin() + index);
+    bounds.erase(bounds.begin() + index);
+    archetypes.erase(archetypes.begin() + index);
+    for (size_t id = 0; id < components.size(); id++) {
+        int width = getComponentWidth(static_cast<int>(id));
+        std::vector<float>& data = components[id].data;
+        data.erase(data.begin() + index * width, data.begin() + (index + 1) * width);
+    }
+
+    eraseBit(visibility, index, size());
+    eraseBit(occluders, index, size());
+    eraseBit(changed, index, size());
+}
+
+void ModelStore::clear() {
+    meshes.clear();
+    cframes.clear();
+    bounds.clear();
+    visibility.clear();
+    occluders.clear();
+    changed.clear();
+    archetypes.clear();
+    for (Column& column : components) {
+        column.data.clear();
+    }
+}
+
+void ModelStore::setMesh(size_t index, std::shared_ptr<Mesh> mesh) {
+    bounds[index] = mesh ? mesh->computeBounds() : Bounds();
+    meshes[index] = std::move(mesh);
+    setBit(changed, index, true);
+}
+
+void ModelStore::refreshBounds(const Mesh* mesh) {
+    Bounds updated = mesh->computeBounds();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (meshes[i].get() == mesh) {
+            bounds[i] = updated;
+            setBit(changed, i, true);
+        }
+    }
+}
+
+void ModelStore::expandBounds(size_t index, const Bounds& more) {
+    Bounds& current = bounds[index];
+    for (int axis = 0; axis < 3; axis++) {
+        current.min[axis] = std::min(current.min[axis], more.min[axis]);
+        current.max[axis] = std::max(current.max[axis], more.max[axis]);
+    }
+    setBit(changed, index, true);
+}
+
+void ModelStore::setBounds(size_t index, const Bounds& value) {
+    bounds[index] = value;
+    setBit(changed, index, true);
+}
+
+void ModelStore::setVisible(size_t index, bool visible) {
+    setBit(visibility, index, visible);
+    setBit(changed, index, true);
+}
+
+void ModelStore::setOccluder(size_t index, bool occluder) {
+    setBit(occluders, index, occluder);
+}
+
+int ModelStore::defineComponent(const std::string& name, ComponentType type) {
+    int existing = findComponent(name);
+    if (existing >= 0) {
+        return components[existing].type == type ? existing : -1;
+    }
+    if (static_cast<int>(components.size()) >= MaxComponents) {
+        return -1;
+    }
+    components.push_back({name, type, {}});
+    int id = static_cast<int>(components.size()) - 1;
+    components.back().data.assign(size() * getComponentWidth(id), 0.0f);
+    return id;
+}
+
+int ModelStore::findComponent(const std::string& name) const {
+    for (size_t id = 0; id < components.size(); id++) {
+        if (components[id].name == name) {
+            return static_cast<int>(id);
+        }
+    }
+    return -1;
+}
+
+int ModelStore::getComponentWidth(int id) const {
+    switch (components[id].type) {
+        case ComponentType::Number: return 1;
+        case ComponentType::Vector: return 3;
+        default: return 0;
+    }
+}
+
+void ModelStore::setComponent(size_t index, int id, const float* value) {
+    int width = getComponentWidth(id);
+    float* dst = components[id].data.data() + index * width;
+    for (int i = 0; i < width; i++) {
+        dst[i] = value[i];
+    }
+    archetypes[index] |= uint64_t(1) << id;
+}
+
+float* ModelStore::getComponent(size_t index, int id) {
+    if (!hasComponent(index, id)) {
+        return nullptr;
+    }
+    return components[id].data.data() + index * getComponentWidth(id);
+}
+
+void ModelStore::removeComponent(size_t index, int id) {
+    archetypes[index] &= ~(uint64_t(1) << id);
+}
+
+void ModelStore::query(uint64_t required, uint64_t excluded, std::vector<uint32_t>& out) const {
+    const uint64_t* rows = archetypes.data();
+    const size_t count = archetypes.size();
+    for (size_t i = 0; i < count; i++) {
+        if ((rows[i] & required) == required && (rows[i] & excluded) == 0) {
+            out.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+void ModelStore::collectOccluders(std::vector<uint32_t>& out) const {
+    out.clear();
+    for (size_t word = 0; word < occluders.size(); word++) {
+        uint64_t bits = occluders[word] & visibility[word];
+        while (bits) {
+            size_t index = (word << 6) + countTrailingZeros(bits);
+            bits &= bits - 1;
+            const Mesh* mesh = meshes[index].get();
+            if (mesh && mesh->vertexCount > 0) {
+                out.push_back(static_cast<uint32_t>(index));
+            }
+        }
+    }
+}
+
+void ModelStore::collectChanged(std::vector<uint32_t>& out) {
+    out.clear();
+    for (size_t word = 0; word < changed.size(); word++) {
+        uint64_t bits = changed[word];
+        while (bits) {
+            out.push_back(static_cast<uint32_t>((word << 6) + countTrailingZeros(bits)));
+            bits &= bits - 1;
+        }
+        changed[word] = 0;
+    }
+}
+
+void ModelStore::collectDrawItems(std::vector<DrawItem>& out) const {
+    out.clear();
+    // Walk the set bits of the visibility words, skipping hidden rows 64 at a time
+    for (size_t word = 0; word < visibility.size(); word++) {
+        uint64_t bits = visibility[word];
+        while (bits) {
+            size_t index = (word << 6) + countTrailingZeros(bits);
+            bits &= bits - 1;
+            const Mesh* mesh = meshes[index].get();
+            if (mesh && mesh->vertexCount > 0) {
+                out.push_back({mesh, cframes[index], static_cast<uint32_t>(index)});
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "IRenderer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Value kinds a script-defined component can hold
+enum class ComponentType {
+    Number,  // One float
+    Vector,  // Three floats
+    Tag,     // No data, presence only
+};
+
+// Model state stored as dense columns, one row per model (rows match model indices).
+// Built-in columns hold the world transform, mesh reference, mesh bounds and a
+// visibility bitset. Scripts define extra typed components; each row's set of
+// components (its archetype) is a bitmask, so queries and bulk updates are
+// linear scans over packed arrays.
+class ModelStore {
+public:
+    static const int MaxComponents = 64;
+
+    size_t add(std::shared_ptr<Mesh> mesh, bool visible, const CFrame& cframe);
+    // Rows above index shift down by one
+    void remove(size_t index);
+    void clear();
+    size_t size() const { return meshes.size(); }
+
+    const std::shared_ptr<Mesh>& getMesh(size_t index) const { return meshes[index]; }
+    void setMesh(size_t index, std::shared_ptr<Mesh> mesh);
+    // Recompute cached bounds of every row using mesh (after its contents changed)
+    void refreshBounds(const Mesh* mesh);
+    const Bounds& getBounds(size_t index) const { return bounds[index]; }
+    // Grow a row's cached bounds to include more (after some of its vertices moved)
+    void expandBounds(size_t index, const Bounds& more);
+    // Replace a row's cached bounds (after its vertices were rewritten, e.g. by skinning)
+    void setBounds(size_t index, const Bounds& value);
+
+    const CFrame& getCFrame(size_t index) const { return cframes[index]; }
+    void setCFrame(size_t index, const CFrame& cframe) {
+        cframes[index] = cframe;
+        changed[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+
+    bool isVisible(size_t index) const { return (visibility[index >> 6] >> (index & 63)) & 1; }
+    void setVisible(size_t index, bool visible);
+
+    // Occluders are rasterized for occlusion culling, which hides the models behind them
+    bool isOccluder(size_t index) const { return (occluders[index >> 6] >> (index & 63)) & 1; }
+    void setOccluder(size_t index, bool occluder);
+
+    // Components. defineComponent returns the existing id when the name and type match,
+    // or -1 when the name is taken by another type or no ids are left.
+    int defineComponent(const std::string& name, ComponentType type);
+    int findComponent(const std::string& name) const;
+    ComponentType getComponentType(int id) const { return components[id].type; }
+    int getComponentWidth(int id) const;
+
+    bool hasComponent(size_t index, int id) const { return (archetypes[index] >> id) & 1; }
+    // value holds getComponentWidth(id) floats (ignored for tags)
+    void setComponent(size_t index, int id, const float* value);
+    // Null when the row lacks the component
+    float* getComponent(size_t index, int id);
+    void removeComponent(size_t index, int id);
+    uint64_t getArchetype(size_t index) const { return archetypes[index]; }
+
+    // Append the rows whose archetype has every bit of required and none of excluded
+    void query(uint64_t required, uint64_t excluded, std::vector<uint32_t>& out) const;
+
+    // Rebuild the packed list of visible rows that have geometry
+    void collectDrawItems(std::vector<DrawItem>& out) const;
+    // Rebuild the list of visible occluder rows that have geometry
+    void collectOccluders(std::vector<uint32_t>& out) const;
+
+    // Rows whose transform, geometry or visibility was set since the last call (or were
+    // added); the set is cleared
+    void collectChanged(std::vector<uint32_t>& out);
+
+private:
+    struct Column {
+        std::string name;
+        ComponentType type;
+        std::vector<float> data;  // width floats per row
+    };
+
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::vector<CFrame> cframes;
+    std::vector<Bounds> bounds;
+    std::vector<uint64_t> visibility;  // One bit per row
+    std::vector<uint64_t> occluders;   // One bit per row
+    std::vector<uint64_t> changed;     // One bit per row, see collectChanged
+    std::vector<uint64_t> archetypes;  // Component bitmask per row
+    std::vector<Column> components;
+};
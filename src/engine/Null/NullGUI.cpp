@@ -0,0 +1,85 @@
+#include "NullGUI.h"
+#include "lua.h"
+#include "lualib.h"
+#include "../Trace.h"
+#include <iostream>
+
+NullGUI::NullGUI(LuauBinding* luauBinding) : luauBinding(luauBinding), width(0), height(0), windowOpen(true) {}
+
+NullGUI::~NullGUI() {}
+
+bool NullGUI::initialize(const std::string& /*windowTitle*/, int width, int height) {
+    this->width = width;
+    this->height = height;
+    return true;
+}
+
+NullGUI* NullGUI::getInstance(lua_State* L) {
+    NullGUI* instance = static_cast<NullGUI*>(LuauBinding::getModule(L));
+    if (!instance) {
+        luaL_error(L, "GUI instance not initialized");
+        return nullptr;
+    }
+    return instance;
+}
+
+// Register a keyboard callback from Lua
+static int registerKeyboardCallback(lua_State* L) {
+    NullGUI* instance = NullGUI::getInstance(L);
+    if (!instance) return 0;
+
+    if (!lua_isfunction(L, 1)) {
+        luaL_error(L, "Expected function as first argument");
+        return 0;
+    }
+
+    // Store the callback function in the registry
+    lua_pushvalue(L, 1);
+    int ref = lua_ref(L, -1);
+    lua_pop(L, 1);
+
+    if (ref == LUA_NOREF) {
+        luaL_error(L, "Failed to create reference to callback function");
+        return 0;
+    }
+
+    instance->registerKeyboardCallback(ref);
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+void NullGUI::registerKeyboardCallback(int callbackRef) {
+    keyboardCallbacks.push_back(callbackRef);
+}
+
+void NullGUI::handleKeyEvent(const std::string& key, const std::string& action) {
+    lua_State* L = luauBinding->getLuaState();
+    if (!L) return;
+
+    if (TraceRecorder* recorder = luauBinding->getRecorder()) {
+        recorder->recordKeyEvent(key, action);
+    }
+
+    // Call each registered callback
+    for (int ref : keyboardCallbacks) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+        lua_pushstring(L, key.c_str());
+        lua_pushstring(L, action.c_str());
+
+        if (lua_pcall(L, 2, 0, 0) != 0) {
+            std::cerr << "Error in keyboard callback: " << lua_tostring(L, -1) << std::endl;
+            lua_pop(L, 1);
+        }
+    }
+}
+
+// Define exports array
+static LuauExport NullGuiExports[] = {
+    {"registerKeyboardCallback", registerKeyboardCallback},
+    {nullptr, nullptr}
+};
+
+const LuauExport* NullGUI::getExports() const {
+    return NullGuiExports;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../ILuauModule.h"
+#include "../IGUI.h"
+#include "../LuauBinding.h"
+#include "lua.h"
+
+// GUI without a window, for headless runs. Exposes the same gui.luau module so
+// scripts run unchanged; key events only arrive from trace replay.
+class NullGUI : public IGUI {
+public:
+    NullGUI(LuauBinding* luauBinding);
+    ~NullGUI();
+
+    // Initialize the GUI
+    bool initialize(const std::string& windowTitle, int width, int height) override;
+
+    // The "window" stays open until close() is called
+    bool isWindowOpen() const override { return windowOpen; }
+    void pumpMessages() override {}
+    void close() { windowOpen = false; }
+
+    // ILuauModule implementation
+    const char* getModuleName() const override { return "gui.luau"; }
+    const LuauExport* getExports() const override;
+
+    // Instance a binding was registered with, from the calling closure's upvalue
+    static NullGUI* getInstance(lua_State* L);
+
+    // Keyboard callback handling
+    void registerKeyboardCallback(int callbackRef);
+    void handleKeyEvent(const std::string& key, const std::string& action) override;
+
+    WindowInfo getWindowInfo() const override {
+        WindowInfo info;
+        info.handle = nullptr;
+        info.context = nullptr;
+        info.width = width;
+        info.height = height;
+        return info;
+    }
+
+private:
+    LuauBinding* luauBinding;
+    int width;
+    int height;
+    bool windowOpen;
+    std::vector<int> keyboardCallbacks;  // References to Lua callback functions
+};
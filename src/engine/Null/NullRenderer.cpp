@@ -0,0 +1,74 @@
+#include "NullRenderer.h"
+#include <iostream>
+
+NullRenderer::NullRenderer(IGUI* gui) : gui(gui), clearColor{0, 0, 0, 255}, width(0), height(0) {}
+
+bool NullRenderer::initialize() {
+    WindowInfo info = gui->getWindowInfo();
+    width = info.width;
+    height = info.height;
+    stats = Stats();
+    return true;
+}
+
+void NullRenderer::setClearColor(float r, float g, float b, float a) {
+    const float color[4] = {r, g, b, a};
+    for (int i = 0; i < 4; i++) {
+        float c = color[i] < 0.0f ? 0.0f : (color[i] > 1.0f ? 1.0f : color[i]);
+        clearColor[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+    }
+}
+
+bool NullRenderer::readPixels(std::vector<uint8_t>& pixels, int& width, int& height) {
+    width = this->width;
+    height = this->height;
+    pixels.resize(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i] = clearColor[0];
+        pixels[i + 1] = clearColor[1];
+        pixels[i + 2] = clearColor[2];
+        pixels[i + 3] = clearColor[3];
+    }
+    return width > 0 && height > 0;
+}
+
+void NullRenderer::render(const std::vector<DrawItem>& items) {
+    for (const DrawItem& item : items) {
+        const Mesh& mesh = *item.mesh;
+        size_t submitted = mesh.isIndexed() ? mesh.getIndexCount() : mesh.vertexCount;
+        stats.drawCalls++;
+        stats.lightBindings += item.lightCount;
+        stats.vertices += submitted;
+        stats.triangles += submitted / 3;
+    }
+}
+
+void NullRenderer::updateMeshes(const std::vector<MeshUpdate>& updates) {
+    for (const MeshUpdate& update : updates) {
+        for (size_t i = 0; i < update.rangeCount; i++) {
+            stats.uploadRanges++;
+            stats.uploadBytes += static_cast<uint64_t>(update.ranges[i].count) * update.mesh->layout.getStride();
+        }
+    }
+}
+
+void NullRenderer::report(double seconds) const {
+    double frames = stats.frames > 0 ? static_cast<double>(stats.frames) : 1.0;
+    std::cout << "Frames: " << stats.frames << " in " << seconds << " s ("
+              << (seconds > 0.0 ? stats.frames / seconds : 0.0) << " frames/s)" << std::endl;
+    std::cout << "Per frame: " << stats.drawCalls / frames << " draws, "
+              << stats.triangles / frames << " triangles, " << stats.vertices / frames << " vertices, "
+              << (stats.drawCalls > 0 ? static_cast<double>(stats.lightBindings) / stats.drawCalls : 0.0)
+              << " lights per draw" << std::endl;
+    if (stats.uploadRanges > 0) {
+        std::cout << "Vertex updates: " << stats.uploadRanges << " ranges, " << stats.uploadBytes << " bytes" << std::endl;
+    }
+    if (stats.releasedMeshes > 0) {
+        std::cout << "Meshes released: " << stats.releasedMeshes << std::endl;
+    }
+    if (seconds > 0.0) {
+        std::cout << "Per second: " << stats.drawCalls / seconds << " draws, "
+                  << stats.triangles / seconds / 1e6 << " M triangles, "
+                  << stats.vertices / seconds / 1e6 << " M vertices" << std::endl;
+    }
+}
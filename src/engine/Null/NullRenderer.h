@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include "../IRenderer.h"
+#include "../IGUI.h"
+
+// Renderer that draws nothing and counts what would have been submitted
+class NullRenderer : public IRenderer {
+public:
+    // Totals since initialize
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t drawCalls = 0;
+        uint64_t triangles = 0;
+        uint64_t vertices = 0;
+        uint64_t lightBindings = 0;  // Sum of the lights per draw call
+        uint64_t uploadRanges = 0;   // Vertex ranges a GPU backend would patch
+        uint64_t uploadBytes = 0;
+        uint64_t releasedMeshes = 0; // Meshes whose GPU copies a backend would free
+    };
+
+    NullRenderer(IGUI* gui);
+
+    bool initialize() override;
+    void beginFrame() override {}
+    void endFrame() override { stats.frames++; }
+    void clear() override {}
+    void setClearColor(float r, float g, float b, float a) override;
+
+    int getWidth() const override { return width; }
+    int getHeight() const override { return height; }
+
+    void setLights(const std::vector<LightProperties>& /*lights*/) override {}
+    void enableLighting(bool /*enable*/) override {}
+
+    // Count the ranges and bytes a GPU backend would upload
+    void updateMeshes(const std::vector<MeshUpdate>& updates) override;
+    void releaseMeshes(const std::vector<const Mesh*>& meshes) override { stats.releasedMeshes += meshes.size(); }
+
+    // Count the draw calls, triangles and vertices the items would submit
+    void render(const std::vector<DrawItem>& items) override;
+
+    // Nothing is presented, so the buffer always holds the last frame
+    int getBufferAge() const override { return 1; }
+    void setDamage(const std::vector<ScreenRect>& /*rects*/) override {}
+
+    // A frame filled with the clear color, so capture works headless
+    bool readPixels(std::vector<uint8_t>& pixels, int& width, int& height) override;
+
+    const Stats& getStats() const { return stats; }
+
+    // Print per-frame and per-second submission rates for a run of the given length
+    void report(double seconds) const;
+
+private:
+    IGUI* gui;
+    uint8_t clearColor[4];
+    int width;
+    int height;
+    Stats stats;
+};
@@ -0,0 +1,246 @@
+#include "OcclusionCuller.h"
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Items tested per parallel task
+const size_t TestBatch = 256;
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(ThreadPool* threadPool)
+    : threadPool(threadPool), totalOccluded(0), frames(0) {
+    for (int w = Width, h = Height; w > 0 && h > 0; w >>= 1, h >>= 1) {
+        levels.emplace_back(static_cast<size_t>(w) * h, 0.0f);
+    }
+}
+
+void OcclusionCuller::setupTriangles(const ModelStore& models, const std::vector<uint32_t>& occluders) {
+    triangles.clear();
+    for (uint32_t row : occluders) {
+        const Mesh& mesh = *models.getMesh(row);
+        const CFrame& cframe = models.getCFrame(row);
+        const uint8_t* data = mesh.getVertexData();
+
+        projected.resize(mesh.vertexCount * 4);
+        for (size_t v = 0; v < mesh.vertexCount; v++) {
+            float local[4], world[3];
+            unpackAttribute(mesh.layout, data, v, VertexAttribute::Position, local);
+            cframe.transformPoint(local, world);
+            float* out = &projected[v * 4];
+            out[3] = frustum.project(world, out[0], out[1], out[2]) ? 1.0f : 0.0f;
+            out[0] *= Width;
+            out[1] *= Height;
+        }
+
+        const uint32_t* indices = mesh.getIndexData();
+        size_t corners = mesh.isIndexed() ? mesh.getIndexCount() : mesh.vertexCount;
+        for (size_t t = 0; t + 2 < corners; t += 3) {
+            const float* p[3];
+            bool valid = true;
+            for (int i = 0; i < 3; i++) {
+                size_t vertex = indices && mesh.isIndexed() ? indices[t + i] : t + i;
+                p[i] = &projected[vertex * 4];
+                valid = valid && p[i][3] != 0.0f;
+            }
+            // Triangles crossing the near plane are skipped; leaving out occluders is always safe
+            if (!valid) continue;
+
+            float area = (p[1][0] - p[0][0]) * (p[2][1] - p[0][1]) - (p[2][0] - p[0][0]) * (p[1][1] - p[0][1]);
+            if (std::fabs(area) < 1e-6f) continue;
+            if (area < 0.0f) {
+                std::swap(p[1], p[2]);
+                area = -area;
+            }
+
+            ScreenTriangle tri;
+            float minX = std::min(p[0][0], std::min(p[1][0], p[2][0]));
+            float maxX = std::max(p[0][0], std::max(p[1][0], p[2][0]));
+            float minY = std::min(p[0][1], std::min(p[1][1], p[2][1]));
+            float maxY = std::max(p[0][1], std::max(p[1][1], p[2][1]));
+            tri.minX = std::max(0, static_cast<int>(std::floor(minX)));
+            tri.maxX = std::min(Width - 1, static_cast<int>(std::ceil(maxX)));
+            tri.minY = std::max(0, static_cast<int>(std::floor(minY)));
+            tri.maxY = std::min(Height - 1, static_cast<int>(std::ceil(maxY)));
+            if (tri.minX > tri.maxX || tri.minY > tri.maxY) continue;
+
+            // Edge i is positive on the inside, opposite vertex i
+            for (int i = 0; i < 3; i++) {
+                const float* a = p[(i + 1) % 3];
+                const float* b = p[(i + 2) % 3];
+                tri.edgeA[i] = a[1] - b[1];
+                tri.edgeB[i] = b[0] - a[0];
+                tri.edgeC[i] = a[0] * b[1] - a[1] * b[0];
+            }
+            // 1/depth is linear in screen space; interpolate it with barycentric weights
+            float weightA[3], weightB[3], weightC[3];
+            for (int i = 0; i < 3; i++) {
+                weightA[i] = tri.edgeA[i] / area;
+                weightB[i] = tri.edgeB[i] / area;
+                weightC[i] = tri.edgeC[i] / area;
+            }
+            tri.depthA = weightA[0] * p[0][2] + weightA[1] * p[1][2] + weightA[2] * p[2][2];
+            tri.depthB = weightB[0] * p[0][2] + weightB[1] * p[1][2] + weightB[2] * p[2][2];
+            tri.depthC = weightC[0] * p[0][2] + weightC[1] * p[1][2] + weightC[2] * p[2][2];
+
+            // Rasterize conservatively, since the buffer claims whole texels are hidden.
+            // Pulling each edge in by half a texel makes the center test pass only for
+            // texels entirely inside the triangle, and lowering the plane by half a texel
+            // gives the farthest depth over the texel instead of its center depth.
+            for (int i = 0; i < 3; i++) {
+                tri.edgeC[i] -= 0.5f * (std::fabs(tri.edgeA[i]) + std::fabs(tri.edgeB[i]));
+            }
+            tri.depthC -= 0.5f * (std::fabs(tri.depthA) + std::fabs(tri.depthB));
+            triangles.push_back(tri);
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeBand(int band) {
+    const int rowsPerBand = Height / Bands;
+    const int bandMinY = band * rowsPerBand;
+    const int bandMaxY = bandMinY + rowsPerBand - 1;
+    float* depth = levels[0].data();
+    std::fill(depth + bandMinY * Width, depth + (bandMaxY + 1) * Width, 0.0f);
+
+    for (const ScreenTriangle& tri : triangles) {
+        int minY = std::max(tri.minY, bandMinY);
+        int maxY = std::min(tri.maxY, bandMaxY);
+        for (int y = minY; y <= maxY; y++) {
+            float centerY = y + 0.5f;
+            float rowEdge[3];
+            for (int i = 0; i < 3; i++) {
+                rowEdge[i] = tri.edgeB[i] * centerY + tri.edgeC[i];
+            }
+            float rowDepth = tri.depthB * centerY + tri.depthC;
+            float* row = depth + y * Width;
+
+            // Keep the nearest occluder: the largest 1/depth
+            int x = tri.minX & ~3;
+#if defined(L3D_SSE2)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            for (; x <= tri.maxX; x += 4) {
+                __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[0]), centerX), _mm_set1_ps(rowEdge[0])), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[1]), centerX), _mm_set1_ps(rowEdge[1])), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[2]), centerX), _mm_set1_ps(rowEdge[2])), zero));
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.depthA), centerX), _mm_set1_ps(rowDepth));
+                __m128 current = _mm_loadu_ps(row + x);
+                _mm_storeu_ps(row + x, _mm_max_ps(current, _mm_and_ps(inside, z)));
+            }
+#elif defined(L3D_NEON)
+            const float32x4_t offsets = {0.5f, 1.5f, 2.5f, 3.5f};
+            for (; x <= tri.maxX; x += 4) {
+                float32x4_t centerX = vaddq_f32(vdupq_n_f32(static_cast<float>(x)), offsets);
+                uint32x4_t inside = vcgeq_f32(vmlaq_n_f32(vdupq_n_f32(rowEdge[0]), centerX, tri.edgeA[0]), vdupq_n_f32(0.0f));
+                inside = vandq_u32(inside, vcgeq_f32(vmlaq_n_f32(vdupq_n_f32(rowEdge[1]), centerX, tri.edgeA[1]), vdupq_n_f32(0.0f)));
+                inside = vandq_u32(inside, vcgeq_f32(vmlaq_n_f32(vdupq_n_f32(rowEdge[2]), centerX, tri.edgeA[2]), vdupq_n_f32(0.0f)));
+                float32x4_t z = vmlaq_n_f32(vdupq_n_f32(rowDepth), centerX, tri.depthA);
+                float32x4_t masked = vreinterpretq_f32_u32(vandq_u32(inside, vreinterpretq_u32_f32(z)));
+                vst1q_f32(row + x, vmaxq_f32(vld1q_f32(row + x), masked));
+            }
+#else
+            for (; x <= tri.maxX; x++) {
+                float centerX = x + 0.5f;
+                if (tri.edgeA[0] * centerX + rowEdge[0] >= 0.0f &&
+                    tri.edgeA[1] * centerX + rowEdge[1] >= 0.0f &&
+                    tri.edgeA[2] * centerX + rowEdge[2] >= 0.0f) {
+                    row[x] = std::max(row[x], tri.depthA * centerX + rowDepth);
+                }
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid() {
+    // Each texel keeps the farthest (smallest 1/depth) of the four below it
+    for (size_t level = 1; level < levels.size(); level++) {
+        const std::vector<float>& below = levels[level - 1];
+        std::vector<float>& above = levels[level];
+        int width = Width >> level, height = Height >> level;
+        int belowWidth = width * 2;
+        for (int y = 0; y < height; y++) {
+            const float* row0 = &below[(y * 2) * belowWidth];
+            const float* row1 = row0 + belowWidth;
+            for (int x = 0; x < width; x++) {
+                above[y * width + x] = std::min(std::min(row0[x * 2], row0[x * 2 + 1]),
+                                                std::min(row1[x * 2], row1[x * 2 + 1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isOccluded(const DrawItem& item, const Bounds& bounds) const {
+    // Boxes reaching past the near plane are always drawn
+    ScreenRect rect;
+    float nearest;  // Largest 1/depth of the box
+    if (!frustum.projectBounds(item.cframe, bounds, rect, nearest)) return false;
+    float minX = rect.minX * Width, maxX = rect.maxX * Width;
+    float minY = rect.minY * Height, maxY = rect.maxY * Height;
+
+    // Off-screen boxes are left to the renderer's clipping
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int x1 = std::min(Width - 1, static_cast<int>(std::floor(maxX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int y1 = std::min(Height - 1, static_cast<int>(std::floor(maxY)));
+    if (x0 > x1 || y0 > y1) return false;
+
+    // Coarsest useful level: the rectangle spans at most 2x2 texels
+    int level = 0;
+    while (level + 1 < static_cast<int>(levels.size()) && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+        level++;
+    }
+    for (int y = y0 >> level; y <= y1 >> level; y++) {
+        for (int x = x0 >> level; x <= x1 >> level; x++) {
+            if (nearest >= getDepth(level, x, y)) return false;
+        }
+    }
+    return true;
+}
+
+void OcclusionCuller::cull(const ModelStore& models, const std::vector<uint32_t>& occluders,
+                           std::vector<DrawItem>& items) {
+    auto start = std::chrono::steady_clock::now();
+    stats = Stats();
+    stats.occluders = occluders.size();
+    frames++;
+    if (occluders.empty() || items.empty()) {
+        return;
+    }
+
+    setupTriangles(models, occluders);
+    stats.triangles = triangles.size();
+    threadPool->parallelFor(Bands, [this](size_t band) { rasterizeBand(static_cast<int>(band)); });
+    buildPyramid();
+
+    occludedFlags.assign(items.size(), 0);
+    size_t batches = (items.size() + TestBatch - 1) / TestBatch;
+    threadPool->parallelFor(batches, [this, &models, &items](size_t batch) {
+        size_t end = std::min(items.size(), (batch + 1) * TestBatch);
+        for (size_t i = batch * TestBatch; i < end; i++) {
+            const DrawItem& item = items[i];
+            if (!models.isOccluder(item.model)) {
+                occludedFlags[i] = isOccluded(item, models.getBounds(item.model)) ? 1 : 0;
+            }
+        }
+    });
+
+    // Compact in place, keeping draw order
+    size_t kept = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        if (!occludedFlags[i]) {
+            items[kept++] = items[i];
+        }
+    }
+    stats.tested = items.size();
+    stats.occluded = items.size() - kept;
+    totalOccluded += stats.occluded;
+    items.resize(kept);
+
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
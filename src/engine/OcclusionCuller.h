@@ -0,0 +1,72 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Software occlusion culling. Occluder meshes are conservatively rasterized into a
+// low-resolution buffer of 1/depth (only fully covered texels, each at the farthest
+// depth it covers; bands of rows in parallel, 4 pixels at a time with SIMD), which is
+// reduced into a pyramid holding the farthest occluder depth of each region. Each draw
+// item's screen-space bounds are then tested against the pyramid level where they span
+// at most 2x2 texels, and items entirely behind the occluders are dropped.
+class OcclusionCuller {
+public:
+    static const int Width = 128;
+    static const int Height = 128;
+    static const int Bands = 8;  // Row bands rasterized in parallel
+
+    struct Stats {
+        size_t occluders = 0;
+        size_t triangles = 0;  // Occluder triangles rasterized
+        size_t tested = 0;     // Draw items tested
+        size_t occluded = 0;   // Draw items dropped
+        double milliseconds = 0.0;
+    };
+
+    explicit OcclusionCuller(ThreadPool* threadPool);
+
+    void setFrustum(const ViewFrustum& frustum) { this->frustum = frustum; }
+
+    // Drop the items hidden behind the given occluder rows. Occluders are never dropped.
+    void cull(const ModelStore& models, const std::vector<uint32_t>& occluders, std::vector<DrawItem>& items);
+
+    // Stats of the last cull
+    const Stats& getStats() const { return stats; }
+    // Totals over every cull, for per-frame averages
+    uint64_t getTotalOccluded() const { return totalOccluded; }
+    uint64_t getFrames() const { return frames; }
+
+    // 1/depth of the farthest occluder covering a texel of a pyramid level (0 = nothing)
+    float getDepth(int level, int x, int y) const { return levels[level][y * (Width >> level) + x]; }
+    int getLevelCount() const { return static_cast<int>(levels.size()); }
+
+private:
+    // Triangle in pixel space with edge functions and a 1/depth plane, all evaluated
+    // as a * x + b * y + c at pixel centers. The edges are pulled in and the plane pushed
+    // back by half a texel, so a pixel passes only when fully covered and gets the
+    // farthest depth it covers.
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        int minX, maxX, minY, maxY;
+    };
+
+    void setupTriangles(const ModelStore& models, const std::vector<uint32_t>& occluders);
+    void rasterizeBand(int band);
+    void buildPyramid();
+    bool isOccluded(const DrawItem& item, const Bounds& bounds) const;
+
+    ThreadPool* threadPool;
+    ViewFrustum frustum;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<float> projected;      // Scratch: x, y, 1/depth, valid per occluder vertex
+    std::vector<std::vector<float>> levels;  // Level 0 is the depth buffer
+    std::vector<uint8_t> occludedFlags;      // Parallel to the items being culled
+
+    Stats stats;
+    uint64_t totalOccluded;
+    uint64_t frames;
+};
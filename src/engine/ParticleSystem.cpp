@@ -0,0 +1,474 @@
+#include "ParticleSystem.h"
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const float Pi = 3.14159265f;
+
+uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Uniform in [0, 1)
+float randomUnit(uint32_t& state) {
+    return static_cast<float>(nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+float randomRange(uint32_t& state, const float range[2]) {
+    return range[0] + (range[1] - range[0]) * randomUnit(state);
+}
+
+} // namespace
+
+ParticleSystem::ParticleSystem(ThreadPool* threadPool) : threadPool(threadPool) {
+}
+
+VertexLayout ParticleSystem::getLayout() {
+    VertexLayout layout;
+    layout.clear();
+    layout.addAttribute({VertexAttribute::Position, VertexComponentType::Float32, 3, false, 0});
+    layout.addAttribute({VertexAttribute::Color, VertexComponentType::UNorm8, 4, true, 12});
+    return layout;
+}
+
+void ParticleSystem::addEmitter(size_t row, std::shared_ptr<Mesh> mesh, const EmitterSettings& settings) {
+    if (rowEmitters.size() <= row) {
+        rowEmitters.resize(row + 1, -1);
+    }
+    std::unique_ptr<Emitter> emitter(new Emitter());
+    emitter->row = row;
+    emitter->mesh = std::move(mesh);
+    emitter->mesh->layout = getLayout();
+    emitter->mesh->transient = true;
+    emitter->settings = settings;
+    // xorshift never leaves zero
+    emitter->random = settings.seed != 0 ? settings.seed : 1;
+
+    // Keep the cone direction unit length; a zero direction points up
+    float* direction = emitter->settings.direction;
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length > 0.0f) {
+        for (int c = 0; c < 3; c++) direction[c] /= length;
+    } else {
+        direction[0] = 0.0f; direction[1] = 1.0f; direction[2] = 0.0f;
+    }
+
+    if (rowEmitters[row] >= 0) {
+        emitters[rowEmitters[row]] = std::move(emitter);
+    } else {
+        rowEmitters[row] = static_cast<int32_t>(emitters.size());
+        emitters.push_back(std::move(emitter));
+    }
+}
+
+bool ParticleSystem::setEmitting(size_t row, bool emitting) {
+    if (!isEmitter(row)) {
+        return false;
+    }
+    emitters[rowEmitters[row]]->emitting = emitting;
+    return true;
+}
+
+bool ParticleSystem::burst(size_t row, uint32_t count) {
+    if (!isEmitter(row)) {
+        return false;
+    }
+    Emitter& emitter = *emitters[rowEmitters[row]];
+    emitter.bursts = static_cast<uint32_t>(std::min<uint64_t>(uint64_t(emitter.bursts) + count, emitter.settings.maxParticles));
+    return true;
+}
+
+void ParticleSystem::removeRow(size_t index) {
+    if (index < rowEmitters.size() && rowEmitters[index] >= 0) {
+        // Move the last emitter into the freed slot
+        size_t slot = static_cast<size_t>(rowEmitters[index]);
+        if (slot != emitters.size() - 1) {
+            emitters[slot] = std::move(emitters.back());
+            rowEmitters[emitters[slot]->row] = static_cast<int32_t>(slot);
+        }
+        emitters.pop_back();
+    }
+    if (index < rowEmitters.size()) {
+        rowEmitters.erase(rowEmitters.begin() + index);
+    }
+    for (auto& emitter : emitters) {
+        if (emitter->row > index) emitter->row--;
+    }
+}
+
+void ParticleSystem::clear() {
+    emitters.clear();
+    rowEmitters.clear();
+    blocks.clear();
+    emitterBlocks.clear();
+    stats = Stats();
+}
+
+void ParticleSystem::update(float seconds, ModelStore& models) {
+    auto start = std::chrono::steady_clock::now();
+    seconds = std::max(seconds, 0.0f);
+
+    // Frame constants in each emitter's space. The rotation rows are right, up and -look,
+    // so a world vector w becomes right * w.x + up * w.y - look * w.z; the camera looks
+    // down world -z, so its axes in emitter space are just the rows right and up.
+    for (auto& emitter : emitters) {
+        const CFrame& cframe = models.getCFrame(emitter->row);
+        const float* gravity = emitter->settings.gravity;
+        for (int c = 0; c < 3; c++) {
+            emitter->gravity[c] = cframe.right[c] * gravity[0] + cframe.up[c] * gravity[1] - cframe.look[c] * gravity[2];
+            emitter->right[c] = cframe.right[c];
+            emitter->up[c] = cframe.up[c];
+        }
+        // Velocity decays by a factor of e^-drag per second
+        emitter->damping = std::exp(-emitter->settings.drag * seconds);
+        emitter->emitted = 0;
+        emitter->expired = 0;
+    }
+
+    // Integrate and compact the existing particles in fixed-size blocks
+    splitBlocks();
+    threadPool->parallelFor(blocks.size(), [this, seconds](size_t b) {
+        simulate(*emitters[blocks[b].emitter], blocks[b], seconds);
+    });
+
+    // Per emitter: close the gaps, spawn, and size the mesh for the quads
+    threadPool->parallelFor(emitters.size(), [this, seconds](size_t e) {
+        Emitter& emitter = *emitters[e];
+        closeGaps(emitter, emitterBlocks[e], emitterBlocks[e + 1]);
+        emit(emitter, seconds);
+
+        Mesh& mesh = *emitter.mesh;
+        mesh.vertexCount = emitter.count * 4;
+        mesh.vertices.resize(mesh.vertexCount * mesh.layout.getStride());
+        // Every quad has the same two triangles; only new quads need their indices
+        size_t quads = mesh.indices.size() / 6;
+        mesh.indices.resize(emitter.count * 6);
+        for (size_t q = quads; q < emitter.count; q++) {
+            uint32_t* index = &mesh.indices[q * 6];
+            uint32_t base = static_cast<uint32_t>(q * 4);
+            index[0] = base; index[1] = base + 1; index[2] = base + 2;
+            index[3] = base; index[4] = base + 2; index[5] = base + 3;
+        }
+    });
+
+    // Write the quads of the surviving and new particles
+    splitBlocks();
+    threadPool->parallelFor(blocks.size(), [this](size_t b) {
+        writeQuads(*emitters[blocks[b].emitter], blocks[b]);
+    });
+
+    stats = Stats();
+    stats.emitters = emitters.size();
+    for (size_t e = 0; e < emitters.size(); e++) {
+        Emitter& emitter = *emitters[e];
+        Bounds bounds;
+        for (size_t b = emitterBlocks[e]; b < emitterBlocks[e + 1]; b++) {
+            for (int c = 0; c < 3; c++) {
+                bounds.min[c] = b == emitterBlocks[e] ? blocks[b].bounds.min[c] : std::min(bounds.min[c], blocks[b].bounds.min[c]);
+                bounds.max[c] = b == emitterBlocks[e] ? blocks[b].bounds.max[c] : std::max(bounds.max[c], blocks[b].bounds.max[c]);
+            }
+        }
+        stats.particles += emitter.count;
+        stats.emitted += emitter.emitted;
+        stats.expired += emitter.expired;
+        // Idle emitters leave their model unchanged, so damage tracking can skip it; a
+        // row given another mesh keeps that mesh's bounds
+        if ((emitter.count == 0 && emitter.expired == 0) || models.getMesh(emitter.row) != emitter.mesh) {
+            continue;
+        }
+        emitter.mesh->markReplaced();
+        models.setBounds(emitter.row, bounds);
+    }
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::splitBlocks() {
+    blocks.clear();
+    emitterBlocks.resize(emitters.size() + 1);
+    for (size_t e = 0; e < emitters.size(); e++) {
+        emitterBlocks[e] = blocks.size();
+        size_t count = emitters[e]->count;
+        for (size_t first = 0; first < count; first += BlockParticles) {
+            uint32_t size = static_cast<uint32_t>(std::min(BlockParticles, count - first));
+            blocks.push_back({static_cast<uint32_t>(e), static_cast<uint32_t>(first), size, size, Bounds()});
+        }
+    }
+    emitterBlocks[emitters.size()] = blocks.size();
+}
+
+void ParticleSystem::simulate(Emitter& emitter, Block& block, float seconds) {
+    float* px = emitter.lanes[PositionX].data() + block.first;
+    float* py = emitter.lanes[PositionY].data() + block.first;
+    float* pz = emitter.lanes[PositionZ].data() + block.first;
+    float* vx = emitter.lanes[VelocityX].data() + block.first;
+    float* vy = emitter.lanes[VelocityY].data() + block.first;
+    float* vz = emitter.lanes[VelocityZ].data() + block.first;
+    float* age = emitter.lanes[Age].data() + block.first;
+    const float* gravity = emitter.gravity;
+    const float damping = emitter.damping;
+    const size_t count = block.count;
+
+    // v = (v + g * dt) * damping; p += v * dt; age += dt
+    size_t i = 0;
+#if defined(L3D_AVX2)
+    {
+        const __m256 dt = _mm256_set1_ps(seconds), damp = _mm256_set1_ps(damping);
+        const __m256 gx = _mm256_set1_ps(gravity[0] * seconds);
+        const __m256 gy = _mm256_set1_ps(gravity[1] * seconds);
+        const __m256 gz = _mm256_set1_ps(gravity[2] * seconds);
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vx + i), gx), damp);
+            __m256 y = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vy + i), gy), damp);
+            __m256 z = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vz + i), gz), damp);
+            _mm256_storeu_ps(vx + i, x);
+            _mm256_storeu_ps(vy + i, y);
+            _mm256_storeu_ps(vz + i, z);
+#if defined(L3D_FMA)
+            _mm256_storeu_ps(px + i, _mm256_fmadd_ps(x, dt, _mm256_loadu_ps(px + i)));
+            _mm256_storeu_ps(py + i, _mm256_fmadd_ps(y, dt, _mm256_loadu_ps(py + i)));
+            _mm256_storeu_ps(pz + i, _mm256_fmadd_ps(z, dt, _mm256_loadu_ps(pz + i)));
+#else
+            _mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(x, dt)));
+            _mm256_storeu_ps(py + i, _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(y, dt)));
+            _mm256_storeu_ps(pz + i, _mm256_add_ps(_mm256_loadu_ps(pz + i), _mm256_mul_ps(z, dt)));
+#endif
+            _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), dt));
+        }
+    }
+#elif defined(L3D_SSE2)
+    {
+        const __m128 dt = _mm_set1_ps(seconds), damp = _mm_set1_ps(damping);
+        const __m128 gx = _mm_set1_ps(gravity[0] * seconds);
+        const __m128 gy = _mm_set1_ps(gravity[1] * seconds);
+        const __m128 gz = _mm_set1_ps(gravity[2] * seconds);
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), gx), damp);
+            __m128 y = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), gy), damp);
+            __m128 z = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vz + i), gz), damp);
+            _mm_storeu_ps(vx + i, x);
+            _mm_storeu_ps(vy + i, y);
+            _mm_storeu_ps(vz + i, z);
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, dt)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, dt)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, dt)));
+            _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt));
+        }
+    }
+#elif defined(L3D_NEON)
+    {
+        const float32x4_t dt = vdupq_n_f32(seconds), damp = vdupq_n_f32(damping);
+        const float32x4_t gx = vdupq_n_f32(gravity[0] * seconds);
+        const float32x4_t gy = vdupq_n_f32(gravity[1] * seconds);
+        const float32x4_t gz = vdupq_n_f32(gravity[2] * seconds);
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t x = vmulq_f32(vaddq_f32(vld1q_f32(vx + i), gx), damp);
+            float32x4_t y = vmulq_f32(vaddq_f32(vld1q_f32(vy + i), gy), damp);
+            float32x4_t z = vmulq_f32(vaddq_f32(vld1q_f32(vz + i), gz), damp);
+            vst1q_f32(vx + i, x);
+            vst1q_f32(vy + i, y);
+            vst1q_f32(vz + i, z);
+            vst1q_f32(px + i, vfmaq_f32(vld1q_f32(px + i), x, dt));
+            vst1q_f32(py + i, vfmaq_f32(vld1q_f32(py + i), y, dt));
+            vst1q_f32(pz + i, vfmaq_f32(vld1q_f32(pz + i), z, dt));
+            vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), dt));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        vx[i] = (vx[i] + gravity[0] * seconds) * damping;
+        vy[i] = (vy[i] + gravity[1] * seconds) * damping;
+        vz[i] = (vz[i] + gravity[2] * seconds) * damping;
+        px[i] += vx[i] * seconds;
+        py[i] += vy[i] * seconds;
+        pz[i] += vz[i] * seconds;
+        age[i] += seconds;
+    }
+
+    // Expired particles take the block's last survivor in their place
+    const float* inverseLife = emitter.lanes[InverseLife].data() + block.first;
+    uint32_t alive = block.count;
+    for (uint32_t p = 0; p < alive;) {
+        if (age[p] * inverseLife[p] < 1.0f) {
+            p++;
+            continue;
+        }
+        alive--;
+        for (int lane = 0; lane < LaneCount; lane++) {
+            float* values = emitter.lanes[lane].data() + block.first;
+            values[p] = values[alive];
+        }
+    }
+    block.alive = alive;
+}
+
+void ParticleSystem::closeGaps(Emitter& emitter, size_t first, size_t end) {
+    if (first == end) {
+        return;
+    }
+    // Fill the gaps of the front blocks with survivors taken from the back, so only as
+    // many particles move as expired
+    size_t back = end - 1;
+    for (size_t f = first; f < back; f++) {
+        Block& block = blocks[f];
+        while (block.alive < block.count && f < back) {
+            Block& tail = blocks[back];
+            if (tail.alive == 0) {
+                back--;
+                continue;
+            }
+            tail.alive--;
+            size_t from = tail.first + tail.alive, to = block.first + block.alive;
+            for (int lane = 0; lane < LaneCount; lane++) {
+                emitter.lanes[lane][to] = emitter.lanes[lane][from];
+            }
+            block.alive++;
+        }
+    }
+    size_t count = blocks[back].first + blocks[back].alive;
+    emitter.expired = emitter.count - count;
+    emitter.count = count;
+}
+
+void ParticleSystem::emit(Emitter& emitter, float seconds) {
+    const EmitterSettings& settings = emitter.settings;
+    size_t spawn = emitter.bursts;
+    emitter.bursts = 0;
+    if (emitter.emitting) {
+        float wanted = settings.rate * seconds + emitter.carry;
+        float whole = std::floor(wanted);
+        emitter.carry = wanted - whole;
+        spawn += static_cast<size_t>(whole);
+    }
+    spawn = std::min(spawn, settings.maxParticles > emitter.count ? settings.maxParticles - emitter.count : 0);
+    size_t first = emitter.count;
+    emitter.count += spawn;
+    emitter.emitted = spawn;
+    for (int lane = 0; lane < LaneCount; lane++) {
+        emitter.lanes[lane].resize(emitter.count);
+    }
+    if (spawn == 0) {
+        return;
+    }
+
+    // Two axes perpendicular to the cone's direction
+    const float* d = settings.direction;
+    float side[3];
+    if (std::fabs(d[0]) < 0.9f) {
+        side[0] = 0.0f; side[1] = d[2]; side[2] = -d[1];  // d x (1, 0, 0)
+    } else {
+        side[0] = -d[2]; side[1] = 0.0f; side[2] = d[0];  // d x (0, 1, 0)
+    }
+    float length = std::sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+    for (int c = 0; c < 3; c++) side[c] /= length;
+    float other[3] = {d[1] * side[2] - d[2] * side[1], d[2] * side[0] - d[0] * side[2], d[0] * side[1] - d[1] * side[0]};
+
+    // Uniform over the spherical cap of the cone
+    const float minCos = std::cos(std::min(std::max(settings.spread, 0.0f), Pi));
+    uint32_t& random = emitter.random;
+    for (size_t i = first; i < emitter.count; i++) {
+        float cosTheta = 1.0f - randomUnit(random) * (1.0f - minCos);
+        float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        float phi = 2.0f * Pi * randomUnit(random);
+        float a = sinTheta * std::cos(phi), b = sinTheta * std::sin(phi);
+        float speed = randomRange(random, settings.speed);
+
+        float offset[3] = {0.0f, 0.0f, 0.0f};
+        if (settings.radius > 0.0f) {
+            float lengthSq;
+            do {
+                for (int c = 0; c < 3; c++) offset[c] = randomUnit(random) * 2.0f - 1.0f;
+                lengthSq = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2];
+            } while (lengthSq > 1.0f);
+        }
+        for (int c = 0; c < 3; c++) {
+            emitter.lanes[PositionX + c][i] = offset[c] * settings.radius;
+            emitter.lanes[VelocityX + c][i] = (side[c] * a + other[c] * b + d[c] * cosTheta) * speed;
+        }
+        emitter.lanes[Age][i] = 0.0f;
+        emitter.lanes[InverseLife][i] = 1.0f / std::max(randomRange(random, settings.lifetime), 1e-4f);
+    }
+}
+
+void ParticleSystem::writeQuads(const Emitter& emitter, Block& block) {
+    const EmitterSettings& settings = emitter.settings;
+    // Vertices are the 16-byte getLayout() format
+    struct QuadVertex {
+        float position[3];
+        uint32_t color;
+    };
+    QuadVertex* out = reinterpret_cast<QuadVertex*>(emitter.mesh->vertices.data()) + size_t(block.first) * 4;
+    const float* px = emitter.lanes[PositionX].data() + block.first;
+    const float* py = emitter.lanes[PositionY].data() + block.first;
+    const float* pz = emitter.lanes[PositionZ].data() + block.first;
+    const float* age = emitter.lanes[Age].data() + block.first;
+    const float* inverseLife = emitter.lanes[InverseLife].data() + block.first;
+
+    // Corner offsets for a unit quad: -right - up, +right - up, +right + up, -right + up
+    float corners[4][3];
+    for (int c = 0; c < 3; c++) {
+        corners[0][c] = (-emitter.right[c] - emitter.up[c]) * 0.5f;
+        corners[1][c] = (emitter.right[c] - emitter.up[c]) * 0.5f;
+        corners[2][c] = (emitter.right[c] + emitter.up[c]) * 0.5f;
+        corners[3][c] = (-emitter.right[c] + emitter.up[c]) * 0.5f;
+    }
+    // Colors lerp in 0-255 space
+    float colorStart[4], colorDelta[4];
+    for (int c = 0; c < 4; c++) {
+        float from = std::min(std::max(settings.colorStart[c], 0.0f), 1.0f);
+        float to = std::min(std::max(settings.colorEnd[c], 0.0f), 1.0f);
+        colorStart[c] = from * 255.0f + 0.5f;
+        colorDelta[c] = (to - from) * 255.0f;
+    }
+    const float sizeDelta = settings.size[1] - settings.size[0];
+
+    const float big = std::numeric_limits<float>::max();
+    float low[3] = {big, big, big}, high[3] = {-big, -big, -big};
+    // Sizes and packed colors for a chunk of particles first, in loops that vectorize,
+    // then the vertex writes
+    const uint32_t Chunk = 256;
+    float sizes[Chunk];
+    uint32_t colors[Chunk];
+    float maxSize = 0.0f;
+    for (uint32_t first = 0; first < block.count; first += Chunk) {
+        const uint32_t count = std::min(Chunk, block.count - first);
+        for (uint32_t i = 0; i < count; i++) {
+            float life = std::min(age[first + i] * inverseLife[first + i], 1.0f);
+            sizes[i] = settings.size[0] + sizeDelta * life;
+            maxSize = std::max(maxSize, std::fabs(sizes[i]));
+            uint32_t r = static_cast<uint32_t>(colorStart[0] + colorDelta[0] * life);
+            uint32_t g = static_cast<uint32_t>(colorStart[1] + colorDelta[1] * life);
+            uint32_t b = static_cast<uint32_t>(colorStart[2] + colorDelta[2] * life);
+            uint32_t a = static_cast<uint32_t>(colorStart[3] + colorDelta[3] * life);
+            // Bytes r, g, b, a in memory order (little-endian)
+            colors[i] = r | (g << 8) | (b << 16) | (a << 24);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const float x = px[first + i], y = py[first + i], z = pz[first + i];
+            const float size = sizes[i];
+            for (int k = 0; k < 4; k++) {
+                out[k].position[0] = x + corners[k][0] * size;
+                out[k].position[1] = y + corners[k][1] * size;
+                out[k].position[2] = z + corners[k][2] * size;
+                out[k].color = colors[i];
+            }
+            out += 4;
+            low[0] = std::min(low[0], x); high[0] = std::max(high[0], x);
+            low[1] = std::min(low[1], y); high[1] = std::max(high[1], y);
+            low[2] = std::min(low[2], z); high[2] = std::max(high[2], z);
+        }
+    }
+    // A quad reaches at most half its diagonal from its center
+    float pad = maxSize * 0.7072f;
+    for (int c = 0; c < 3; c++) {
+        block.bounds.min[c] = low[c] - pad;
+        block.bounds.max[c] = high[c] + pad;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// How an emitter spawns and animates its particles. Vectors are in the emitter model's
+// space, except gravity, which is in world space.
+struct EmitterSettings {
+    float rate = 100.0f;              // Particles per second while emitting
+    uint32_t maxParticles = 10000;    // Alive at once; emission stops at the limit
+    float lifetime[2] = {1.0f, 1.0f}; // Seconds, random between min and max
+    float speed[2] = {1.0f, 1.0f};
+    float direction[3] = {0.0f, 1.0f, 0.0f};
+    float spread = 0.5f;              // Cone half angle around direction, radians
+    float radius = 0.0f;              // Particles spawn inside this sphere
+    float gravity[3] = {0.0f, -9.8f, 0.0f};
+    float drag = 0.0f;                // Fraction of velocity lost per second
+    float size[2] = {0.1f, 0.1f};     // Quad width at birth and at death
+    float colorStart[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float colorEnd[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+    uint32_t seed = 1;
+};
+
+// Native particle emitters. Each emitter is a model whose mesh the system rewrites every
+// frame with one camera-facing quad per particle, so all of an emitter's particles draw
+// as a single item. Particles are kept as packed columns per emitter (position,
+// velocity, age, inverse lifetime); each frame emitters spawn on the thread pool, then
+// fixed-size blocks of particles are integrated with SIMD, compacted and turned into
+// quads in parallel.
+class ParticleSystem {
+public:
+    static constexpr size_t BlockParticles = 16384;  // Particles per parallel job
+
+    struct Stats {
+        size_t emitters = 0;
+        size_t particles = 0;  // Alive after the last update
+        size_t emitted = 0;    // In the last update
+        size_t expired = 0;
+        double milliseconds = 0.0;
+    };
+
+    explicit ParticleSystem(ThreadPool* threadPool);
+
+    // Make a row an emitter drawing into mesh, which must be the row's mesh
+    void addEmitter(size_t row, std::shared_ptr<Mesh> mesh, const EmitterSettings& settings);
+    bool isEmitter(size_t row) const { return row < rowEmitters.size() && rowEmitters[row] >= 0; }
+    // Pause or resume continuous emission; false when the row is no emitter
+    bool setEmitting(size_t row, bool emitting);
+    // Spawn count particles at once on the next update
+    bool burst(size_t row, uint32_t count);
+
+    // Keep the rows parallel to the model rows; a removed row's emitter is dropped
+    void removeRow(size_t index);
+    void clear();
+
+    // Advance every emitter by seconds and rewrite its mesh and bounds. Rows must have
+    // their world transforms up to date.
+    void update(float seconds, ModelStore& models);
+
+    const Stats& getStats() const { return stats; }
+
+    // Layout of emitter meshes: f32x3 position, unorm8x4 color (16 bytes)
+    static VertexLayout getLayout();
+
+private:
+    // Float columns, one entry per particle
+    enum Lane {
+        PositionX, PositionY, PositionZ,
+        VelocityX, VelocityY, VelocityZ,
+        Age,
+        InverseLife,
+        LaneCount
+    };
+
+    struct Emitter {
+        size_t row;
+        std::shared_ptr<Mesh> mesh;
+        EmitterSettings settings;
+        bool emitting = true;
+        float carry = 0.0f;       // Fraction of a particle left over from the last emission
+        uint32_t bursts = 0;      // Requested by burst, spawned next update
+        uint32_t random;          // xorshift32 state
+        size_t count = 0;         // Alive particles
+        size_t emitted = 0;       // In the last update
+        size_t expired = 0;
+        std::vector<float> lanes[LaneCount];
+        // Frame constants, in the emitter's space
+        float gravity[3];
+        float right[3], up[3];    // Camera axes for the quads
+        float damping;
+    };
+
+    // Range of one emitter's particles, processed as one job
+    struct Block {
+        uint32_t emitter;
+        uint32_t first;
+        uint32_t count;
+        uint32_t alive;  // Survivors, moved to the front of the block
+        Bounds bounds;   // Of the block's quads
+    };
+
+    // Cut every emitter's particles into blocks
+    void splitBlocks();
+    // Integrate, then drop expired particles by moving survivors to the block's front
+    void simulate(Emitter& emitter, Block& block, float seconds);
+    // Close the gaps compaction left between an emitter's blocks (blocks [first, end))
+    void closeGaps(Emitter& emitter, size_t first, size_t end);
+    void emit(Emitter& emitter, float seconds);
+    void writeQuads(const Emitter& emitter, Block& block);
+
+    ThreadPool* threadPool;
+    std::vector<std::unique_ptr<Emitter>> emitters;
+    std::vector<int32_t> rowEmitters;  // Emitter per model row, -1 for none
+    // Scratch, rebuilt every update. An emitter's blocks are consecutive, from
+    // emitterBlocks[emitter] up to emitterBlocks[emitter + 1].
+    std::vector<Block> blocks;
+    std::vector<size_t> emitterBlocks;
+    Stats stats;
+};
@@ -0,0 +1,225 @@
+#include "Raycaster.h"
+#include "SceneGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const float Infinity = std::numeric_limits<float>::infinity();
+
+// Direction in the space of cframe's rotation (no translation)
+void rotate(const CFrame& cframe, const float direction[3], float out[3]) {
+    const float zero[3] = {0.0f, 0.0f, 0.0f};
+    float moved[3], origin[3];
+    cframe.transformPoint(direction, moved);
+    cframe.transformPoint(zero, origin);
+    for (int i = 0; i < 3; i++) out[i] = moved[i] - origin[i];
+}
+
+} // namespace
+
+Raycaster::Raycaster(ThreadPool* threadPool) : threadPool(threadPool), refits(0) {
+}
+
+void Raycaster::update(const ModelStore& models) {
+    auto start = std::chrono::steady_clock::now();
+    stats.meshBuilds = 0;
+    stats.meshRefits = 0;
+    stats.instancesRebuilt = false;
+
+    // Forget meshes nothing holds any more; a new mesh may reuse an address, so
+    // instances look their entries up again
+    bool forgot = false;
+    for (auto it = meshCache.begin(); it != meshCache.end();) {
+        forgot |= it->second.mesh.expired();
+        it = it->second.mesh.expired() ? meshCache.erase(it) : std::next(it);
+    }
+    if (forgot) {
+        for (Instance& instance : instances) instance.entry = nullptr;
+    }
+
+    // Visible rows with geometry; the top level is rebuilt when that set changes and
+    // refit when instances move
+    bool rebuild = refits >= RefitsPerRebuild;
+    size_t count = 0;
+    for (size_t row = 0; row < models.size(); row++) {
+        const std::shared_ptr<Mesh>& mesh = models.getMesh(row);
+        if (!mesh || mesh->vertexCount == 0 || mesh->transient || !models.isVisible(row)) continue;
+        if (count == instances.size()) {
+            instances.push_back({});
+        }
+        Instance& instance = instances[count++];
+        instance.moved = false;
+        if (instance.row != row || instance.mesh != mesh.get() || !instance.entry) {
+            instance.row = static_cast<uint32_t>(row);
+            instance.mesh = mesh.get();
+            instance.entry = &meshCache[mesh.get()];
+            if (instance.entry->mesh.lock() != mesh) {
+                instance.entry->mesh = mesh;
+                instance.entry->bvh.reset();
+            }
+            instance.moved = true;
+            rebuild = true;
+        }
+
+        // Mesh BVHs are (re)built below, in parallel
+        MeshEntry& entry = *instance.entry;
+        if (!entry.queued && (!entry.bvh || entry.revision != mesh->revision || entry.edits != mesh->edits)) {
+            entry.queued = true;
+            pending.push_back(&entry);
+            (!entry.bvh || entry.revision != mesh->revision ? stats.meshBuilds : stats.meshRefits)++;
+        }
+        instance.moved |= entry.queued;
+
+        const CFrame& cframe = models.getCFrame(row);
+        if (std::memcmp(&instance.cframe, &cframe, sizeof(CFrame)) != 0) {
+            instance.cframe = cframe;
+            instance.inverse = invertCFrame(cframe);
+            instance.moved = true;
+        }
+    }
+    if (count != instances.size()) {
+        instances.resize(count);
+        rebuild = true;
+    }
+
+    threadPool->parallelFor(pending.size(), [this](size_t i) {
+        MeshEntry& entry = *pending[i];
+        std::shared_ptr<Mesh> mesh = entry.mesh.lock();
+        // Replaced geometry gets a new tree; rewritten vertices keep the old one's shape
+        if (!entry.bvh || entry.revision != mesh->revision) {
+            entry.bvh.reset(new MeshBvh());
+            entry.bvh->build(*mesh);
+        } else {
+            entry.bvh->refit(*mesh);
+        }
+        entry.revision = mesh->revision;
+        entry.edits = mesh->edits;
+        entry.queued = false;
+    });
+    pending.clear();
+
+    // World bounds of each moved model: its mesh BVH's root box, turned by its cframe
+    bool moved = false;
+    instanceBoxes.resize(instances.size() * 6);
+    for (size_t i = 0; i < instances.size(); i++) {
+        Instance& instance = instances[i];
+        if (!instance.moved) continue;
+        moved = true;
+        instance.bvh = instance.entry->bvh.get();
+        float* box = &instanceBoxes[i * 6];
+        if (instance.bvh->getNodeCount() == 0) {
+            // No triangles: a point at the model, which rays enter but never hit
+            for (int c = 0; c < 3; c++) box[c] = box[3 + c] = instance.cframe.position[c];
+            continue;
+        }
+        const BvhNode& root = instance.bvh->getRoot();
+        const CFrame& cframe = instance.cframe;
+        float center[3], half[3], worldCenter[3];
+        for (int c = 0; c < 3; c++) {
+            center[c] = (root.min[c] + root.max[c]) * 0.5f;
+            half[c] = (root.max[c] - root.min[c]) * 0.5f;
+        }
+        cframe.transformPoint(center, worldCenter);
+        // Rotation rows are right, up and -look; the sign doesn't change the extent
+        const float* rows[3] = {cframe.right, cframe.up, cframe.look};
+        for (int r = 0; r < 3; r++) {
+            float extent = std::fabs(rows[r][0]) * half[0] + std::fabs(rows[r][1]) * half[1] +
+                           std::fabs(rows[r][2]) * half[2];
+            box[r] = worldCenter[r] - extent;
+            box[3 + r] = worldCenter[r] + extent;
+        }
+    }
+
+    if (rebuild) {
+        buildBvh(instanceBoxes.data(), instances.size(), 1, nodes, instanceOrder);
+        refits = 0;
+        stats.instancesRebuilt = true;
+    } else if (moved) {
+        refitBvh(instanceBoxes.data(), instanceOrder, nodes);
+        refits++;
+    }
+
+    stats.meshes = meshCache.size();
+    stats.meshBytes = 0;
+    for (const auto& cached : meshCache) {
+        if (cached.second.bvh) stats.meshBytes += cached.second.bvh->getMemoryBytes();
+    }
+    stats.instances = instances.size();
+    stats.updateMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Raycaster::raycast(const float origin[3], const float direction[3], float maxDistance, RaycastHit& hit) const {
+    hit = RaycastHit();
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (nodes.empty() || !(length > 0.0f)) return false;
+    float unit[3] = {direction[0] / length, direction[1] / length, direction[2] / length};
+    BvhRay ray(origin, unit);
+    float best = maxDistance;
+    if (intersectBox(ray, nodes[0], best) == Infinity) return false;
+
+    // Same traversal as MeshBvh::intersect, with models at the leaves
+    struct Entry {
+        uint32_t node;
+        float distance;
+    };
+    Entry stack[128];
+    int size = 0;
+    stack[size++] = {0, 0.0f};
+    while (size > 0) {
+        Entry entry = stack[--size];
+        if (entry.distance > best) continue;
+        const BvhNode& node = nodes[entry.node];
+        if (node.count != 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const Instance& instance = instances[instanceOrder[i]];
+                // Rigid transforms keep distances, so the local hit distance is the world one
+                float localOrigin[3], localDirection[3];
+                instance.inverse.transformPoint(origin, localOrigin);
+                rotate(instance.inverse, unit, localDirection);
+                TriangleHit triangleHit;
+                triangleHit.distance = best;
+                if (instance.bvh->intersect(BvhRay(localOrigin, localDirection), triangleHit)) {
+                    best = triangleHit.distance;
+                    hit.row = instance.row;
+                    hit.triangle = triangleHit.triangle;
+                    hit.u = triangleHit.u;
+                    hit.v = triangleHit.v;
+                    hit.distance = triangleHit.distance;
+                }
+            }
+            continue;
+        }
+        float left = intersectBox(ray, nodes[node.first], best);
+        float right = intersectBox(ray, nodes[node.first + 1], best);
+        Entry near = {node.first, left}, far = {node.first + 1, right};
+        if (right < left) std::swap(near, far);
+        if (far.distance != Infinity) stack[size++] = far;
+        if (near.distance != Infinity) stack[size++] = near;
+    }
+    return hit.row != RaycastHit::NoRow;
+}
+
+void Raycaster::raycastMany(const float* rays, size_t count, float maxDistance, std::vector<RaycastHit>& hits) const {
+    hits.resize(count);
+    size_t batches = (count + RaysPerBatch - 1) / RaysPerBatch;
+    threadPool->parallelFor(batches, [this, rays, count, maxDistance, &hits](size_t batch) {
+        size_t end = std::min(count, (batch + 1) * RaysPerBatch);
+        for (size_t i = batch * RaysPerBatch; i < end; i++) {
+            raycast(rays + i * 6, rays + i * 6 + 3, maxDistance, hits[i]);
+        }
+    });
+}
+
+void Raycaster::clear() {
+    meshCache.clear();
+    instances.clear();
+    instanceBoxes.clear();
+    nodes.clear();
+    instanceOrder.clear();
+    refits = 0;
+    stats = Stats();
+}
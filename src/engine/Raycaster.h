@@ -0,0 +1,86 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "MeshBvh.h"
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Nearest triangle a ray hits. u and v weigh the triangle's second and third vertices.
+struct RaycastHit {
+    static const uint32_t NoRow = UINT32_MAX;
+
+    uint32_t row = NoRow;  // Model row, NoRow on a miss
+    uint32_t triangle = 0;
+    float u = 0.0f, v = 0.0f;
+    float distance = 0.0f;  // World units along the ray
+};
+
+// Exact ray queries against the triangles of visible models. Each mesh gets an
+// object-space triangle BVH the first time it is in the scene during an update; the
+// BVH is refit when the mesh's vertices are rewritten in place and rebuilt when the
+// mesh is replaced. A top-level BVH over the models' world bounds finds the models a
+// ray reaches, and rays enter each model's mesh BVH through its inverse transform.
+class Raycaster {
+public:
+    struct Stats {
+        size_t meshes = 0;       // Mesh BVHs kept
+        size_t meshBytes = 0;
+        size_t instances = 0;    // Models in the top-level BVH
+        size_t meshBuilds = 0;   // In the last update
+        size_t meshRefits = 0;
+        bool instancesRebuilt = false;
+        double updateMilliseconds = 0.0;
+    };
+
+    // The top-level BVH is refit while models only move, and rebuilt after this many refits
+    static const int RefitsPerRebuild = 32;
+    static const size_t RaysPerBatch = 256;  // Rays per parallel job in raycastMany
+
+    explicit Raycaster(ThreadPool* threadPool);
+
+    // Bring the BVHs up to date with the models' meshes, world transforms and visibility;
+    // call before querying whenever the models may have changed
+    void update(const ModelStore& models);
+
+    // Nearest hit within maxDistance. direction need not be unit length.
+    bool raycast(const float origin[3], const float direction[3], float maxDistance, RaycastHit& hit) const;
+    // rays holds count rays as six floats each (origin, then direction); traced in
+    // parallel into hits, with row NoRow for misses
+    void raycastMany(const float* rays, size_t count, float maxDistance, std::vector<RaycastHit>& hits) const;
+
+    void clear();
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct MeshEntry {
+        std::weak_ptr<Mesh> mesh;
+        uint64_t revision = 0;
+        uint64_t edits = 0;
+        std::unique_ptr<MeshBvh> bvh;
+        bool queued = false;  // In pending
+    };
+
+    struct Instance {
+        uint32_t row = UINT32_MAX;
+        const Mesh* mesh = nullptr;
+        MeshEntry* entry = nullptr;
+        const MeshBvh* bvh = nullptr;
+        CFrame cframe;
+        CFrame inverse;  // World to object space
+        bool moved = false;  // Needs its world box recomputed this update
+    };
+
+    ThreadPool* threadPool;
+    std::unordered_map<const Mesh*, MeshEntry> meshCache;
+    std::vector<Instance> instances;   // Visible rows with geometry
+    std::vector<float> instanceBoxes;  // World bounds, six floats per instance
+    std::vector<BvhNode> nodes;        // Top level; leaves index instanceOrder
+    std::vector<uint32_t> instanceOrder;
+    int refits;
+    std::vector<MeshEntry*> pending;   // Scratch for update
+    Stats stats;
+};
@@ -0,0 +1,209 @@
+#include "SceneGraph.h"
+
+namespace {
+
+// The renderer treats a CFrame as the rotation whose rows are right, up and -look
+void toRows(const CFrame& cframe, float rows[3][3]) {
+    for (int i = 0; i < 3; i++) {
+        rows[0][i] = cframe.right[i];
+        rows[1][i] = cframe.up[i];
+        rows[2][i] = -cframe.look[i];
+    }
+}
+
+void fromRows(const float rows[3][3], CFrame& cframe) {
+    for (int i = 0; i < 3; i++) {
+        cframe.right[i] = rows[0][i];
+        cframe.up[i] = rows[1][i];
+        cframe.look[i] = -rows[2][i];
+    }
+}
+
+} // namespace
+
+CFrame composeCFrame(const CFrame& parent, const CFrame& child) {
+    float p[3][3], c[3][3], r[3][3];
+    toRows(parent, p);
+    toRows(child, c);
+
+    CFrame result;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[i][j] = p[i][0] * c[0][j] + p[i][1] * c[1][j] + p[i][2] * c[2][j];
+        }
+        result.position[i] = parent.position[i] + p[i][0] * child.position[0] +
+                             p[i][1] * child.position[1] + p[i][2] * child.position[2];
+    }
+    fromRows(r, result);
+    return result;
+}
+
+CFrame invertCFrame(const CFrame& cframe) {
+    float m[3][3], t[3][3];
+    toRows(cframe, m);
+
+    CFrame result;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            t[i][j] = m[j][i];
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        result.position[i] = -(t[i][0] * cframe.position[0] + t[i][1] * cframe.position[1] +
+                               t[i][2] * cframe.position[2]);
+    }
+    fromRows(t, result);
+    return result;
+}
+
+SceneGraph::SceneGraph() : updatePass(0), orderDirty(false), anyDirty(false) {}
+
+size_t SceneGraph::addNode(const CFrame& local, bool visible) {
+    nodes.push_back({-1, local, visible, true});
+
+    // New roots go at the end of the order, which keeps it valid without a rebuild
+    size_t index = nodes.size() - 1;
+    slotOf.push_back(static_cast<uint32_t>(order.size()));
+    order.push_back({static_cast<uint32_t>(index), -1});
+    world.push_back(local);
+    worldVisible.push_back(visible);
+    slotUpdated.push_back(0);
+    anyDirty = true;
+    return index;
+}
+
+void SceneGraph::removeNode(size_t index) {
+    if (index >= nodes.size()) return;
+
+    int parent = nodes[index].parent;
+    CFrame parentInverse = parent >= 0 ? invertCFrame(getWorldCFrame(parent)) : CFrame();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].parent == static_cast<int>(index)) {
+            nodes[i].parent = parent;
+            nodes[i].local = composeCFrame(parentInverse, getWorldCFrame(i));
+        }
+    }
+
+    nodes.erase(nodes.begin() + index);
+    for (Node& node : nodes) {
+        if (node.parent > static_cast<int>(index)) node.parent--;
+    }
+    orderDirty = true;
+    anyDirty = true;
+}
+
+void SceneGraph::clear() {
+    nodes.clear();
+    order.clear();
+    slotOf.clear();
+    world.clear();
+    worldVisible.clear();
+    slotUpdated.clear();
+    orderDirty = false;
+    anyDirty = false;
+}
+
+bool SceneGraph::setParent(size_t index, int parent, bool keepWorld) {
+    if (index >= nodes.size() || parent >= static_cast<int>(nodes.size())) return false;
+    if (nodes[index].parent == parent) return true;
+
+    // Walk up from the new parent; reaching the node means it would parent itself
+    for (int ancestor = parent; ancestor >= 0; ancestor = nodes[ancestor].parent) {
+        if (ancestor == static_cast<int>(index)) return false;
+    }
+
+    if (keepWorld) {
+        const CFrame& current = getWorldCFrame(index);
+        nodes[index].local = parent >= 0 ? composeCFrame(invertCFrame(getWorldCFrame(parent)), current) : current;
+    }
+    nodes[index].parent = parent;
+    markDirty(index);
+    orderDirty = true;
+    return true;
+}
+
+void SceneGraph::setLocalCFrame(size_t index, const CFrame& local) {
+    if (index >= nodes.size()) return;
+    nodes[index].local = local;
+    markDirty(index);
+}
+
+void SceneGraph::setVisible(size_t index, bool visible) {
+    if (index >= nodes.size()) return;
+    nodes[index].visible = visible;
+    markDirty(index);
+}
+
+void SceneGraph::markDirty(size_t index) {
+    nodes[index].dirty = true;
+    anyDirty = true;
+}
+
+void SceneGraph::rebuildOrder() {
+    // Breadth-first from the roots so every parent lands before its children
+    std::vector<std::vector<uint32_t>> children(nodes.size());
+    std::vector<uint32_t> queue;
+    queue.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].parent < 0) {
+            queue.push_back(static_cast<uint32_t>(i));
+        } else {
+            children[nodes[i].parent].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        const std::vector<uint32_t>& next = children[queue[head]];
+        queue.insert(queue.end(), next.begin(), next.end());
+    }
+
+    slotOf.assign(nodes.size(), 0);
+    order.clear();
+    for (uint32_t node : queue) {
+        slotOf[node] = static_cast<uint32_t>(order.size());
+        int parent = nodes[node].parent;
+        order.push_back({node, parent >= 0 ? static_cast<int32_t>(slotOf[parent]) : -1});
+    }
+
+    // Slots moved, so every cached world transform is recomputed
+    world.assign(nodes.size(), CFrame());
+    worldVisible.assign(nodes.size(), 0);
+    slotUpdated.assign(nodes.size(), 0);
+    for (Node& node : nodes) {
+        node.dirty = true;
+    }
+    orderDirty = false;
+    anyDirty = true;
+}
+
+void SceneGraph::update(ModelStore& models) {
+    if (orderDirty) {
+        rebuildOrder();
+    }
+    if (!anyDirty) {
+        return;
+    }
+
+    // A slot recomputed in this pass forces its children to recompute too
+    updatePass++;
+    const size_t count = order.size() < models.size() ? order.size() : models.size();
+    for (size_t slot = 0; slot < count; slot++) {
+        const Slot& entry = order[slot];
+        Node& node = nodes[entry.node];
+        bool parentUpdated = entry.parentSlot >= 0 && slotUpdated[entry.parentSlot] == updatePass;
+        if (!node.dirty && !parentUpdated) continue;
+
+        if (entry.parentSlot >= 0) {
+            world[slot] = composeCFrame(world[entry.parentSlot], node.local);
+            worldVisible[slot] = node.visible && worldVisible[entry.parentSlot];
+        } else {
+            world[slot] = node.local;
+            worldVisible[slot] = node.visible;
+        }
+        node.dirty = false;
+        slotUpdated[slot] = updatePass;
+
+        models.setCFrame(entry.node, world[slot]);
+        models.setVisible(entry.node, worldVisible[slot] != 0);
+    }
+    anyDirty = false;
+}
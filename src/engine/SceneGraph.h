@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ModelStore.h"
+#include <cstdint>
+#include <vector>
+
+// Compose two transforms: the result maps local space of child through parent
+CFrame composeCFrame(const CFrame& parent, const CFrame& child);
+
+// Inverse of a rigid transform (orthonormal basis)
+CFrame invertCFrame(const CFrame& cframe);
+
+// Parent/child hierarchy over models. Node indices match model indices.
+// Each node holds a local transform and visibility; world transforms and effective
+// visibility are recomputed lazily by update(), only for dirty subtrees, walking a
+// flat array sorted so parents always precede their children.
+class SceneGraph {
+public:
+    SceneGraph();
+
+    size_t addNode(const CFrame& local, bool visible);
+    // Children of the removed node move to its parent, keeping their world transform.
+    // Indices above the removed node shift down by one, matching model removal.
+    // World transforms must be current (call update() first).
+    void removeNode(size_t index);
+    void clear();
+    size_t size() const { return nodes.size(); }
+
+    // Parent -1 makes the node a root. With keepWorld the local transform is adjusted
+    // so the node stays where it is (world transforms must be current).
+    // Returns false if the parent is invalid or would create a cycle.
+    bool setParent(size_t index, int parent, bool keepWorld);
+    int getParent(size_t index) const { return nodes[index].parent; }
+
+    void setLocalCFrame(size_t index, const CFrame& local);
+    const CFrame& getLocalCFrame(size_t index) const { return nodes[index].local; }
+
+    // Hiding a node hides its whole subtree
+    void setVisible(size_t index, bool visible);
+    bool isVisible(size_t index) const { return nodes[index].visible; }
+
+    // Recompute dirty subtrees and write world transforms and effective visibility
+    // into the matching model rows
+    void update(ModelStore& models);
+
+    // World transform as of the last update()
+    const CFrame& getWorldCFrame(size_t index) const { return world[slotOf[index]]; }
+
+private:
+    struct Node {
+        int parent;
+        CFrame local;
+        bool visible;
+        bool dirty;
+    };
+
+    // Entry of the topologically sorted array
+    struct Slot {
+        uint32_t node;
+        int32_t parentSlot;  // -1 for roots
+    };
+
+    void markDirty(size_t index);
+    void rebuildOrder();
+
+    std::vector<Node> nodes;
+    std::vector<Slot> order;
+    std::vector<uint32_t> slotOf;      // Node index to slot
+    std::vector<CFrame> world;         // By slot
+    std::vector<uint8_t> worldVisible; // By slot
+    std::vector<uint32_t> slotUpdated; // By slot, last update() pass that recomputed it
+    uint32_t updatePass;
+    bool orderDirty;
+    bool anyDirty;
+};
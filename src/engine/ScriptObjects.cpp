@@ -0,0 +1,60 @@
+#include "ScriptObjects.h"
+#include <algorithm>
+
+size_t ScriptObjects::addMesh(std::shared_ptr<Mesh> mesh) {
+    if (!freeHandles.empty()) {
+        size_t handle = freeHandles.back();
+        freeHandles.pop_back();
+        meshes[handle] = std::move(mesh);
+        return handle;
+    }
+    meshes.push_back(std::move(mesh));
+    meshGenerations.push_back(0);
+    return meshes.size() - 1;
+}
+
+void ScriptObjects::releaseMesh(size_t handle) {
+    // Models keep their own reference to the geometry
+    if (handle < meshes.size() && meshes[handle]) {
+        released.push_back(std::move(meshes[handle]));
+        meshes[handle] = nullptr;
+        meshGenerations[handle]++;
+        freeHandles.push_back(static_cast<uint32_t>(handle));
+    }
+}
+
+void ScriptObjects::retire(std::shared_ptr<Mesh> mesh) {
+    if (mesh) {
+        released.push_back(std::move(mesh));
+    }
+}
+
+void ScriptObjects::removeRow(size_t index) {
+    if (index >= modelObjects.size()) return;
+    if (modelObjects[index]) {
+        modelObjects[index]->row = NoRow;
+    }
+    modelObjects.erase(modelObjects.begin() + index);
+    for (size_t row = index; row < modelObjects.size(); row++) {
+        if (modelObjects[row]) {
+            modelObjects[row]->row = static_cast<uint32_t>(row);
+        }
+    }
+
+    // Collected models waiting for removal shift down with their rows
+    collectedRows.erase(std::remove(collectedRows.begin(), collectedRows.end(), static_cast<uint32_t>(index)),
+                        collectedRows.end());
+    for (uint32_t& row : collectedRows) {
+        if (row > index) row--;
+    }
+}
+
+void ScriptObjects::clearRows() {
+    for (ModelObject* object : modelObjects) {
+        if (object) {
+            object->row = NoRow;
+        }
+    }
+    modelObjects.clear();
+    collectedRows.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Ownership behind the Mesh and Model userdata scripts hold. The engine and every
+// userdata share it, so a destructor that runs after the engine is gone (lua_close)
+// stays safe. Destructors run in the middle of garbage collection, so they only record
+// what was let go; the engine acts on it at the start of the next frame.
+struct ScriptObjects {
+    static const uint32_t NoRow = UINT32_MAX;
+
+    // Userdata blocks
+    struct MeshObject {
+        uint32_t handle;
+        uint32_t generation;  // Of the handle when created; stale once released
+        std::shared_ptr<ScriptObjects> objects;
+    };
+    struct ModelObject {
+        uint32_t row;  // NoRow once the model is removed
+        std::shared_ptr<ScriptObjects> objects;
+    };
+
+    std::vector<std::shared_ptr<Mesh>> meshes;    // By handle; null once released
+    std::vector<uint32_t> meshGenerations;        // Per handle, bumped on release
+    std::vector<uint32_t> freeHandles;            // Released handles, reused first
+    std::vector<std::shared_ptr<Mesh>> released;  // References let go since the last frame
+    std::vector<ModelObject*> modelObjects;       // Per model row, null for plain models
+    std::vector<uint32_t> collectedRows;          // Models whose userdata was collected
+
+    // Store a mesh under a released handle if there is one, otherwise a new one
+    size_t addMesh(std::shared_ptr<Mesh> mesh);
+    // Drop a handle's reference; the geometry goes once nothing else uses it. The
+    // handle may then be reused, so Mesh userdata holding it go stale.
+    void releaseMesh(size_t handle);
+    // False for userdata whose handle was released, and may now hold another mesh
+    bool isCurrent(const MeshObject& object) const {
+        return object.handle < meshGenerations.size() && meshGenerations[object.handle] == object.generation;
+    }
+    // Hand a reference the engine is dropping over, so its copies can be freed
+    void retire(std::shared_ptr<Mesh> mesh);
+
+    // Keep modelObjects parallel to the model rows. A removed row's userdata stays
+    // valid but refers to no model.
+    void addRow() { modelObjects.push_back(nullptr); }
+    void removeRow(size_t index);
+    void clearRows();
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+// Compile-time SIMD feature detection shared by the engine's hot loops.
+// Every SIMD path must keep a scalar fallback for targets without these.
+
+#if defined(__AVX2__)
+#define L3D_AVX2 1
+#endif
+
+#if defined(__FMA__)
+#define L3D_FMA 1
+#endif
+
+// MSVC has no F16C macro but enables it with /arch:AVX2; GCC and Clang need -mf16c
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define L3D_F16C 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define L3D_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(L3D_AVX2) || defined(L3D_F16C) || defined(L3D_FMA)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define L3D_NEON 1
+#include <arm_neon.h>
+#endif
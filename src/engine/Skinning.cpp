@@ -0,0 +1,328 @@
+#include "Skinning.h"
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Weighted sum of a vertex's four joint matrices
+inline void blendMatrices(const JointMatrix* matrices, const uint8_t* joints, const float* weights, float out[12]) {
+#if defined(L3D_AVX2)
+    // Rows 0-1 in one 8-wide register, row 2 in a 4-wide one
+    __m256 top = _mm256_setzero_ps();
+    __m128 bottom = _mm_setzero_ps();
+    for (int k = 0; k < 4; k++) {
+        const float* m = matrices[joints[k]].m;
+        __m256 w8 = _mm256_set1_ps(weights[k]);
+        __m128 w4 = _mm256_castps256_ps128(w8);
+#if defined(L3D_FMA)
+        top = _mm256_fmadd_ps(w8, _mm256_loadu_ps(m), top);
+        bottom = _mm_fmadd_ps(w4, _mm_loadu_ps(m + 8), bottom);
+#else
+        top = _mm256_add_ps(top, _mm256_mul_ps(w8, _mm256_loadu_ps(m)));
+        bottom = _mm_add_ps(bottom, _mm_mul_ps(w4, _mm_loadu_ps(m + 8)));
+#endif
+    }
+    _mm256_storeu_ps(out, top);
+    _mm_storeu_ps(out + 8, bottom);
+#elif defined(L3D_SSE2)
+    __m128 row0 = _mm_setzero_ps(), row1 = _mm_setzero_ps(), row2 = _mm_setzero_ps();
+    for (int k = 0; k < 4; k++) {
+        const float* m = matrices[joints[k]].m;
+        __m128 w = _mm_set1_ps(weights[k]);
+        row0 = _mm_add_ps(row0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+        row1 = _mm_add_ps(row1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+        row2 = _mm_add_ps(row2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+    }
+    _mm_storeu_ps(out, row0);
+    _mm_storeu_ps(out + 4, row1);
+    _mm_storeu_ps(out + 8, row2);
+#elif defined(L3D_NEON)
+    float32x4_t row0 = vdupq_n_f32(0.0f), row1 = row0, row2 = row0;
+    for (int k = 0; k < 4; k++) {
+        const float* m = matrices[joints[k]].m;
+        row0 = vmlaq_n_f32(row0, vld1q_f32(m), weights[k]);
+        row1 = vmlaq_n_f32(row1, vld1q_f32(m + 4), weights[k]);
+        row2 = vmlaq_n_f32(row2, vld1q_f32(m + 8), weights[k]);
+    }
+    vst1q_f32(out, row0);
+    vst1q_f32(out + 4, row1);
+    vst1q_f32(out + 8, row2);
+#else
+    for (int i = 0; i < 12; i++) out[i] = 0.0f;
+    for (int k = 0; k < 4; k++) {
+        const float* m = matrices[joints[k]].m;
+        for (int i = 0; i < 12; i++) out[i] += weights[k] * m[i];
+    }
+#endif
+}
+
+} // namespace
+
+bool SkinData::build(const Mesh& mesh, size_t jointCount, std::string& error) {
+    const VertexLayout& layout = mesh.layout;
+    if (!layout.find(VertexAttribute::Position) || !layout.find(VertexAttribute::Joints) ||
+        !layout.find(VertexAttribute::Weights)) {
+        error = "mesh vertex format needs position, joints and weights";
+        return false;
+    }
+    bool hasNormals = layout.find(VertexAttribute::Normal) != nullptr;
+    vertexCount = mesh.vertexCount;
+    positions.resize(vertexCount * 3);
+    normals.resize(hasNormals ? vertexCount * 3 : 0);
+    joints.resize(vertexCount * 4);
+    weights.resize(vertexCount * 4);
+
+    const uint8_t* data = mesh.getVertexData();
+    for (size_t v = 0; v < vertexCount; v++) {
+        float values[4];
+        unpackAttribute(layout, data, v, VertexAttribute::Position, values);
+        std::memcpy(&positions[v * 3], values, 3 * sizeof(float));
+        if (hasNormals) {
+            unpackAttribute(layout, data, v, VertexAttribute::Normal, values);
+            std::memcpy(&normals[v * 3], values, 3 * sizeof(float));
+        }
+
+        float jointValues[4], weightValues[4];
+        unpackAttribute(layout, data, v, VertexAttribute::Joints, jointValues);
+        unpackAttribute(layout, data, v, VertexAttribute::Weights, weightValues);
+        float total = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            weightValues[k] = std::max(0.0f, weightValues[k]);
+            total += weightValues[k];
+        }
+        for (int k = 0; k < 4; k++) {
+            int joint = static_cast<int>(jointValues[k] + 0.5f);
+            if (joint < 0 || static_cast<size_t>(joint) >= jointCount) {
+                // Unweighted influences may hold anything; point them at the root
+                if (weightValues[k] > 0.0f) {
+                    error = "vertex " + std::to_string(v) + " references joint " + std::to_string(joint) +
+                            " but the skeleton has " + std::to_string(jointCount);
+                    return false;
+                }
+                joint = 0;
+            }
+            joints[v * 4 + k] = static_cast<uint8_t>(joint);
+            // Unweighted vertices follow their first joint
+            weights[v * 4 + k] = total > 0.0f ? weightValues[k] / total : (k == 0 ? 1.0f : 0.0f);
+        }
+    }
+    return true;
+}
+
+void skinVertices(const SkinData& skin, const JointMatrix* matrices, size_t first, size_t count,
+                  Mesh& target, Bounds& bounds) {
+    const VertexLayout& layout = target.layout;
+    const VertexAttributeDesc* positionDesc = layout.find(VertexAttribute::Position);
+    const VertexAttributeDesc* normalDesc = skin.normals.empty() ? nullptr : layout.find(VertexAttribute::Normal);
+    const bool floatPositions = positionDesc->type == VertexComponentType::Float32 && positionDesc->components == 3;
+    const uint32_t stride = layout.getStride();
+
+    for (int axis = 0; axis < 3; axis++) {
+        bounds.min[axis] = 1e30f;
+        bounds.max[axis] = -1e30f;
+    }
+
+    uint8_t* vertex = target.vertices.data() + first * stride;
+    for (size_t v = first; v < first + count; v++, vertex += stride) {
+        float m[12];
+        blendMatrices(matrices, &skin.joints[v * 4], &skin.weights[v * 4], m);
+
+        const float* p = &skin.positions[v * 3];
+        float position[4] = {
+            m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3],
+            m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7],
+            m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11],
+            1.0f,
+        };
+        if (floatPositions) {
+            std::memcpy(vertex + positionDesc->offset, position, 3 * sizeof(float));
+        } else {
+            packAttribute(*positionDesc, position, vertex + positionDesc->offset);
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            bounds.min[axis] = std::min(bounds.min[axis], position[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], position[axis]);
+        }
+
+        if (normalDesc) {
+            // The blended matrix's rotation part; exact for rigid and uniformly scaled joints
+            const float* n = &skin.normals[v * 3];
+            float normal[4] = {
+                m[0] * n[0] + m[1] * n[1] + m[2] * n[2],
+                m[4] * n[0] + m[5] * n[1] + m[6] * n[2],
+                m[8] * n[0] + m[9] * n[1] + m[10] * n[2],
+                0.0f,
+            };
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 1e-12f) {
+                for (int c = 0; c < 3; c++) normal[c] /= length;
+            }
+            packAttribute(*normalDesc, normal, vertex + normalDesc->offset);
+        }
+    }
+    if (count == 0) {
+        bounds = Bounds();
+    }
+}
+
+Skinner::Skinner(ThreadPool* threadPool) : threadPool(threadPool) {
+}
+
+bool Skinner::attach(ModelStore& models, size_t row, Row& state, const std::shared_ptr<Mesh>& mesh, std::string& error) {
+    if (!mesh || !state.skin.build(*mesh, state.skeleton->getJointCount(), error)) {
+        if (!mesh) error = "model has no mesh";
+        return false;
+    }
+    // The model draws from a writable copy; the bind mesh may be shared or mapped
+    auto skinned = std::make_shared<Mesh>(*mesh);
+    skinned->makeWritable();
+    skinned->markReplaced();
+    state.bindMesh = mesh;
+    state.skinned = skinned;
+    state.dirty = true;
+    models.setMesh(row, std::move(skinned));
+    return true;
+}
+
+bool Skinner::setSkeleton(ModelStore& models, size_t row, std::shared_ptr<const Skeleton> skeleton, std::string& error) {
+    if (row >= models.size()) {
+        error = "invalid model";
+        return false;
+    }
+    if (rows.size() < models.size()) {
+        rows.resize(models.size());
+    }
+
+    std::unique_ptr<Row>& state = rows[row];
+    std::shared_ptr<Mesh> bindMesh = models.getMesh(row);
+    if (state && state->skinned.lock() == bindMesh) {
+        bindMesh = state->bindMesh;
+    }
+    if (!skeleton) {
+        if (state) {
+            models.setMesh(row, bindMesh);
+            state.reset();
+        }
+        return true;
+    }
+
+    auto next = std::make_unique<Row>();
+    next->skeleton = std::move(skeleton);
+    if (state) {
+        next->layers = std::move(state->layers);
+    }
+    if (!attach(models, row, *next, bindMesh, error)) {
+        return false;
+    }
+    state = std::move(next);
+    return true;
+}
+
+bool Skinner::setLayers(size_t row, std::vector<Layer> layers) {
+    if (!hasSkeleton(row)) return false;
+    Row& state = *rows[row];
+    state.layers = std::move(layers);
+    state.dirty = true;
+    return true;
+}
+
+void Skinner::removeRow(size_t index) {
+    if (index < rows.size()) {
+        rows.erase(rows.begin() + index);
+    }
+}
+
+void Skinner::clear() {
+    rows.clear();
+}
+
+void Skinner::update(ModelStore& models, std::vector<std::shared_ptr<Mesh>>& dirtyMeshes) {
+    stats = Stats();
+    if (rows.size() > models.size()) {
+        rows.resize(models.size());
+    }
+
+    dirtyRows.clear();
+    for (size_t row = 0; row < rows.size(); row++) {
+        if (!rows[row]) continue;
+        Row& state = *rows[row];
+        const std::shared_ptr<Mesh>& current = models.getMesh(row);
+        if (state.skinned.lock() != current) {
+            // New geometry from the script becomes the bind pose
+            std::string error;
+            if (!attach(models, row, state, current, error)) {
+                std::cerr << "Skinning: model " << row << " no longer animated: " << error << std::endl;
+                rows[row].reset();
+                continue;
+            }
+        }
+        if (state.dirty) {
+            dirtyRows.push_back(static_cast<uint32_t>(row));
+        }
+    }
+    if (dirtyRows.empty()) return;
+
+    // Sample and blend the clips of each row, then build its joint matrices
+    auto start = std::chrono::steady_clock::now();
+    threadPool->parallelFor(dirtyRows.size(), [this](size_t i) {
+        Row& state = *rows[dirtyRows[i]];
+        state.clipLayers.clear();
+        for (const Layer& layer : state.layers) {
+            state.clipLayers.push_back({layer.clip.get(), layer.time, layer.weight, layer.loop});
+        }
+        Animation::blend(*state.skeleton, state.clipLayers.data(), state.clipLayers.size(), state.sampled, state.pose);
+        Animation::computeSkinMatrices(*state.skeleton, state.pose, state.matrices);
+    });
+    auto sampled = std::chrono::steady_clock::now();
+
+    // Skin in fixed-size vertex blocks so large and small meshes balance across workers
+    blocks.clear();
+    for (uint32_t row : dirtyRows) {
+        const Row& state = *rows[row];
+        for (size_t first = 0; first < state.skin.vertexCount; first += BlockVertices) {
+            size_t count = std::min(BlockVertices, state.skin.vertexCount - first);
+            blocks.push_back({row, static_cast<uint32_t>(first), static_cast<uint32_t>(count), Bounds()});
+        }
+        stats.vertices += state.skin.vertexCount;
+        stats.joints += state.matrices.size();
+    }
+    threadPool->parallelFor(blocks.size(), [this, &models](size_t i) {
+        Block& block = blocks[i];
+        const Row& state = *rows[block.row];
+        skinVertices(state.skin, state.matrices.data(), block.first, block.count,
+                     *models.getMesh(block.row), block.bounds);
+    });
+
+    // Blocks of a row are contiguous; merge their bounds
+    for (size_t i = 0; i < blocks.size();) {
+        uint32_t row = blocks[i].row;
+        Bounds bounds = blocks[i].bounds;
+        for (i++; i < blocks.size() && blocks[i].row == row; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                bounds.min[axis] = std::min(bounds.min[axis], blocks[i].bounds.min[axis]);
+                bounds.max[axis] = std::max(bounds.max[axis], blocks[i].bounds.max[axis]);
+            }
+        }
+        models.setBounds(row, bounds);
+    }
+    for (uint32_t row : dirtyRows) {
+        Row& state = *rows[row];
+        const std::shared_ptr<Mesh>& mesh = models.getMesh(row);
+        if (state.skin.vertexCount > 0) {
+            if (mesh->dirtyRanges.empty()) {
+                dirtyMeshes.push_back(mesh);
+            }
+            mesh->markDirty(0, state.skin.vertexCount);
+        }
+        state.dirty = false;
+    }
+
+    stats.models = dirtyRows.size();
+    auto end = std::chrono::steady_clock::now();
+    stats.sampleMilliseconds = std::chrono::duration<double, std::milli>(sampled - start).count();
+    stats.skinMilliseconds = std::chrono::duration<double, std::milli>(end - sampled).count();
+}
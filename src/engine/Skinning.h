@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Animation.h"
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Bind-pose vertex data of a skinned mesh, unpacked once so skinning reads plain floats
+struct SkinData {
+    size_t vertexCount = 0;
+    std::vector<float> positions;  // 3 per vertex
+    std::vector<float> normals;    // 3 per vertex, empty when the mesh has none
+    std::vector<uint8_t> joints;   // 4 per vertex
+    std::vector<float> weights;    // 4 per vertex, summing to 1
+
+    // Unpack a mesh whose layout has joints and weights; joint indices must be below jointCount
+    bool build(const Mesh& mesh, size_t jointCount, std::string& error);
+};
+
+// Linear blend skinning of vertices [first, first + count) into target, which must have
+// the skin's vertex count. Positions and normals are rewritten; bounds receives the
+// skinned positions' box. Uses AVX2/FMA or SSE2 when the build enables them.
+void skinVertices(const SkinData& skin, const JointMatrix* matrices, size_t first, size_t count,
+                  Mesh& target, Bounds& bounds);
+
+// Skeletal animation of models. Each animated model keeps its bind-pose mesh and draws
+// from a private copy that skinning rewrites. Scripts set clip layers (clip, time,
+// weight); each frame the models whose layers changed are sampled, blended and skinned
+// in vertex blocks across the thread pool. Giving an animated model new geometry makes
+// that the bind pose; vertex writes to the drawn copy last until it is next skinned.
+class Skinner {
+public:
+    static constexpr size_t BlockVertices = 2048;  // Vertices per parallel skinning job
+
+    struct Stats {
+        size_t models = 0;    // Models skinned in the last update
+        size_t vertices = 0;  // Vertices skinned
+        size_t joints = 0;    // Joint matrices computed
+        double sampleMilliseconds = 0.0;
+        double skinMilliseconds = 0.0;
+    };
+
+    explicit Skinner(ThreadPool* threadPool);
+
+    // Animate a row with skeleton, using its current mesh as the bind pose. Null detaches
+    // and restores the bind-pose mesh.
+    bool setSkeleton(ModelStore& models, size_t row, std::shared_ptr<const Skeleton> skeleton, std::string& error);
+    bool hasSkeleton(size_t row) const { return row < rows.size() && rows[row]; }
+    // Joints of a row's skeleton, 0 without one
+    size_t getJointCount(size_t row) const { return hasSkeleton(row) ? rows[row]->skeleton->getJointCount() : 0; }
+
+    // Replace a row's clip layers; skinned on the next update
+    struct Layer {
+        std::shared_ptr<const AnimationClip> clip;
+        float time = 0.0f;
+        float weight = 1.0f;
+        bool loop = true;
+    };
+    bool setLayers(size_t row, std::vector<Layer> layers);
+
+    // Keep the rows parallel to the model rows
+    void removeRow(size_t index);
+    void clear();
+
+    // Skin the rows whose layers changed. Meshes with rewritten vertices are appended
+    // to dirtyMeshes (see Luau3D::flushMeshUpdates).
+    void update(ModelStore& models, std::vector<std::shared_ptr<Mesh>>& dirtyMeshes);
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Row {
+        std::shared_ptr<const Skeleton> skeleton;
+        std::shared_ptr<Mesh> bindMesh;   // What the script assigned
+        // What the model draws; not owned, so the model's row stays its only user
+        std::weak_ptr<Mesh> skinned;
+        SkinData skin;
+        std::vector<Layer> layers;
+        std::vector<AnimationLayer> clipLayers;  // Scratch
+        std::vector<JointPose> pose;             // Scratch
+        std::vector<JointPose> sampled;          // Scratch
+        std::vector<JointMatrix> matrices;
+        bool dirty = true;
+    };
+
+    struct Block {
+        uint32_t row;
+        uint32_t first;
+        uint32_t count;
+        Bounds bounds;
+    };
+
+    // Rebuild a row's skin from mesh; false when it cannot be skinned by the skeleton
+    bool attach(ModelStore& models, size_t row, Row& state, const std::shared_ptr<Mesh>& mesh, std::string& error);
+
+    ThreadPool* threadPool;
+    std::vector<std::unique_ptr<Row>> rows;  // Null for rows without a skeleton
+    std::vector<uint32_t> dirtyRows;  // Scratch
+    std::vector<Block> blocks;        // Scratch
+    Stats stats;
+};
@@ -0,0 +1,457 @@
+#include "Terrain.h"
+#include "SceneGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+size_t getSampleSize(HeightFormat format) {
+    switch (format) {
+        case HeightFormat::R8: return 1;
+        case HeightFormat::R16: return 2;
+        case HeightFormat::F32: return 4;
+    }
+    return 2;
+}
+
+// True when every corner of the box lies outside one of the frustum's planes. The eye
+// is at the origin looking down -z, so the side planes pass through it.
+bool outsideFrustum(const ViewFrustum& frustum, const CFrame& cframe, const Bounds& bounds) {
+    float corners[8][3];
+    for (int corner = 0; corner < 8; corner++) {
+        float local[3] = {
+            (corner & 1) ? bounds.max[0] : bounds.min[0],
+            (corner & 2) ? bounds.max[1] : bounds.min[1],
+            (corner & 4) ? bounds.max[2] : bounds.min[2],
+        };
+        cframe.transformPoint(local, corners[corner]);
+    }
+    // Plane distances as a * x + b * y + c * z + d, positive inside
+    const float n = frustum.nearPlane;
+    const float planes[6][4] = {
+        {0.0f, 0.0f, -1.0f, -frustum.nearPlane},
+        {0.0f, 0.0f, 1.0f, frustum.farPlane},
+        {n, 0.0f, frustum.left, 0.0f},
+        {-n, 0.0f, -frustum.right, 0.0f},
+        {0.0f, n, frustum.bottom, 0.0f},
+        {0.0f, -n, -frustum.top, 0.0f},
+    };
+    for (const float* plane : planes) {
+        bool inside = false;
+        for (int corner = 0; corner < 8 && !inside; corner++) {
+            const float* p = corners[corner];
+            inside = plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2] + plane[3] >= 0.0f;
+        }
+        if (!inside) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+Terrain::Terrain(ThreadPool* threadPool)
+    : threadPool(threadPool), emptyMesh(std::make_shared<Mesh>()), finished(std::make_shared<std::vector<Build>>()) {
+}
+
+bool Terrain::open(const TerrainSettings& settings, std::string& error) {
+    if (settings.cellSize <= 0.0f) {
+        error = "cellSize must be positive";
+        return false;
+    }
+    if (settings.chunkSize < 2 || settings.chunkSize > 4096 || (settings.chunkSize & (settings.chunkSize - 1)) != 0) {
+        error = "chunkSize must be a power of two between 2 and 4096";
+        return false;
+    }
+
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->open(settings.path)) {
+        error = "Cannot open heightmap '" + settings.path + "'";
+        return false;
+    }
+
+    // Missing dimensions come from the file size
+    const size_t sampleSize = getSampleSize(settings.format);
+    const size_t samples = mapping->getSize() / sampleSize;
+    size_t columns = static_cast<size_t>(std::max(settings.columns, 0));
+    size_t rows = static_cast<size_t>(std::max(settings.rows, 0));
+    if (columns == 0 && rows == 0) {
+        columns = rows = static_cast<size_t>(std::sqrt(static_cast<double>(samples)) + 0.5);
+    } else if (columns == 0) {
+        columns = samples / rows;
+    } else if (rows == 0) {
+        rows = samples / columns;
+    }
+    if (columns < 2 || rows < 2 || columns * rows * sampleSize != mapping->getSize()) {
+        error = "Heightmap '" + settings.path + "' does not hold columns * rows samples";
+        return false;
+    }
+
+    auto shared = std::make_shared<Source>();
+    shared->mapping = mapping;
+    shared->settings = settings;
+    shared->columns = static_cast<int>(columns);
+    shared->rows = static_cast<int>(rows);
+    // Coarser levels than one cell per chunk side have nothing left to drop
+    int maxLevels = 1;
+    while ((settings.chunkSize >> maxLevels) >= 1 && maxLevels < 16) maxLevels++;
+    shared->settings.lodLevels = std::min(std::max(settings.lodLevels, 1), maxLevels);
+    shared->skirtDepth = settings.skirtDepth >= 0.0f ? settings.skirtDepth : std::fabs(settings.heightScale) * 0.05f;
+    shared->boundsMin[0] = -(shared->columns - 1) * 0.5f * settings.cellSize;
+    shared->boundsMax[0] = -shared->boundsMin[0];
+    shared->boundsMin[1] = std::min(0.0f, settings.heightScale);
+    shared->boundsMax[1] = std::max(0.0f, settings.heightScale);
+    shared->boundsMin[2] = -(shared->rows - 1) * 0.5f * settings.cellSize;
+    shared->boundsMax[2] = -shared->boundsMin[2];
+    source = shared;
+
+    chunksX = (shared->columns - 1 + settings.chunkSize - 1) / settings.chunkSize;
+    chunksZ = (shared->rows - 1 + settings.chunkSize - 1) / settings.chunkSize;
+    chunks.assign(static_cast<size_t>(chunksX) * chunksZ, Chunk());
+    for (int z = 0; z < chunksZ; z++) {
+        for (int x = 0; x < chunksX; x++) {
+            Chunk& chunk = chunks[z * chunksX + x];
+            chunk.firstColumn = x * settings.chunkSize;
+            chunk.firstRow = z * settings.chunkSize;
+            chunk.minHeight = shared->boundsMin[1];
+            chunk.maxHeight = shared->boundsMax[1];
+        }
+    }
+    stats.chunks = chunks.size();
+    return true;
+}
+
+float Terrain::Source::sample(int column, int row) const {
+    column = std::min(std::max(column, 0), columns - 1);
+    row = std::min(std::max(row, 0), rows - 1);
+    const size_t index = static_cast<size_t>(row) * columns + column;
+    const uint8_t* data = mapping->getData();
+    switch (settings.format) {
+        case HeightFormat::R8:
+            return data[index] * (settings.heightScale / 255.0f);
+        case HeightFormat::R16: {
+            const uint8_t* bytes = data + index * 2;
+            return static_cast<float>(bytes[0] | (bytes[1] << 8)) * (settings.heightScale / 65535.0f);
+        }
+        case HeightFormat::F32: {
+            float value;
+            std::memcpy(&value, data + index * 4, sizeof(value));
+            return value * settings.heightScale;
+        }
+    }
+    return 0.0f;
+}
+
+std::shared_ptr<Mesh> Terrain::Source::buildChunk(int column, int row, int lod, float& minHeight, float& maxHeight) const {
+    const int step = 1 << lod;
+    const int cellsX = std::min(settings.chunkSize, columns - 1 - column);
+    const int cellsZ = std::min(settings.chunkSize, rows - 1 - row);
+    // Segments per side; the last one is shorter when the chunk is cut by the map's edge
+    const int segmentsX = (cellsX + step - 1) / step;
+    const int segmentsZ = (cellsZ + step - 1) / step;
+    const int verticesX = segmentsX + 1;
+    const float cell = settings.cellSize;
+    const float spacing = cell * step;
+    // Vertices are relative to the chunk's center, which its model is placed at
+    const float centerX = (column + cellsX * 0.5f - (columns - 1) * 0.5f) * cell;
+    const float centerZ = (row + cellsZ * 0.5f - (rows - 1) * 0.5f) * cell;
+
+    const int gridVertices = verticesX * (segmentsZ + 1);
+    const int perimeter = 2 * (segmentsX + segmentsZ);
+    const int floatsPerVertex = settings.layout.getSourceFloatsPerVertex();
+    const int normalOffset = settings.layout.getSourceOffset(VertexAttribute::Normal);
+    std::vector<float> interleaved(static_cast<size_t>(gridVertices + perimeter) * floatsPerVertex, 0.0f);
+
+    minHeight = maxHeight = sample(column, row);
+    for (int j = 0; j <= segmentsZ; j++) {
+        const int sampleRow = row + std::min(j * step, cellsZ);
+        for (int i = 0; i < verticesX; i++) {
+            const int sampleColumn = column + std::min(i * step, cellsX);
+            const float height = sample(sampleColumn, sampleRow);
+            minHeight = std::min(minHeight, height);
+            maxHeight = std::max(maxHeight, height);
+            // Central differences at this level's spacing, as in MeshBuilder::heightfield
+            float normal[3] = {
+                (sample(sampleColumn - step, sampleRow) - sample(sampleColumn + step, sampleRow)) * spacing,
+                2.0f * spacing * spacing,
+                (sample(sampleColumn, sampleRow - step) - sample(sampleColumn, sampleRow + step)) * spacing,
+            };
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int c = 0; c < 3; c++) normal[c] /= length;
+
+            // Colors are evaluated in terrain space so neighbouring chunks match
+            const float terrainPosition[3] = {
+                (sampleColumn - (columns - 1) * 0.5f) * cell,
+                height,
+                (sampleRow - (rows - 1) * 0.5f) * cell,
+            };
+            float* out = &interleaved[static_cast<size_t>(j * verticesX + i) * floatsPerVertex];
+            out[0] = terrainPosition[0] - centerX;
+            out[1] = height;
+            out[2] = terrainPosition[2] - centerZ;
+            MeshBuilder::evaluateColor(settings.color, terrainPosition, normal, boundsMin, boundsMax, out + 3);
+            if (normalOffset >= 0) {
+                out[normalOffset] = normal[0];
+                out[normalOffset + 1] = normal[1];
+                out[normalOffset + 2] = normal[2];
+            }
+        }
+    }
+
+    // Walk the edge counter-clockwise seen from above: +x along the first row, +z up
+    // the last column, then back
+    std::vector<uint32_t> edge;
+    edge.reserve(perimeter);
+    for (int i = 0; i < segmentsX; i++) edge.push_back(i);
+    for (int j = 0; j < segmentsZ; j++) edge.push_back(j * verticesX + segmentsX);
+    for (int i = segmentsX; i > 0; i--) edge.push_back(segmentsZ * verticesX + i);
+    for (int j = segmentsZ; j > 0; j--) edge.push_back(j * verticesX);
+
+    // The skirt repeats the edge vertices skirtDepth lower
+    for (int k = 0; k < perimeter; k++) {
+        float* out = &interleaved[static_cast<size_t>(gridVertices + k) * floatsPerVertex];
+        std::memcpy(out, &interleaved[static_cast<size_t>(edge[k]) * floatsPerVertex], floatsPerVertex * sizeof(float));
+        out[1] -= skirtDepth;
+    }
+    minHeight -= skirtDepth;
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->layout = settings.layout;
+    mesh->vertexCount = gridVertices + perimeter;
+    mesh->vertices.resize(mesh->vertexCount * settings.layout.getStride());
+    packVertices(settings.layout, interleaved.data(), mesh->vertexCount, mesh->vertices.data());
+
+    // Same winding as MeshBuilder::heightfield; skirt quads face outwards
+    std::vector<uint32_t>& indices = mesh->indices;
+    indices.reserve(static_cast<size_t>(segmentsX) * segmentsZ * 6 + perimeter * 6);
+    for (int j = 0; j < segmentsZ; j++) {
+        for (int i = 0; i < segmentsX; i++) {
+            uint32_t a = j * verticesX + i;
+            uint32_t b = a + 1;
+            uint32_t c = a + verticesX;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    }
+    for (int k = 0; k < perimeter; k++) {
+        uint32_t top0 = edge[k], top1 = edge[(k + 1) % perimeter];
+        uint32_t low0 = gridVertices + k, low1 = gridVertices + (k + 1) % perimeter;
+        indices.insert(indices.end(), {top0, top1, low0, top1, low1, low0});
+    }
+    return mesh;
+}
+
+CFrame Terrain::getChunkCFrame(size_t index) const {
+    const Chunk& chunk = chunks[index];
+    const int cellsX = std::min(source->settings.chunkSize, source->columns - 1 - chunk.firstColumn);
+    const int cellsZ = std::min(source->settings.chunkSize, source->rows - 1 - chunk.firstRow);
+    CFrame cframe;
+    cframe.position[0] = (chunk.firstColumn + cellsX * 0.5f - (source->columns - 1) * 0.5f) * source->settings.cellSize;
+    cframe.position[2] = (chunk.firstRow + cellsZ * 0.5f - (source->rows - 1) * 0.5f) * source->settings.cellSize;
+    return cframe;
+}
+
+void Terrain::setChunkRow(size_t index, size_t row) {
+    if (rowChunks.size() <= row) {
+        rowChunks.resize(row + 1, -1);
+    }
+    rowChunks[row] = static_cast<int32_t>(index);
+    chunks[index].row = static_cast<uint32_t>(row);
+}
+
+void Terrain::getChunkRows(std::vector<uint32_t>& out) const {
+    out.clear();
+    for (const Chunk& chunk : chunks) {
+        if (chunk.row != NoRow) out.push_back(chunk.row);
+    }
+}
+
+void Terrain::removeRow(size_t index) {
+    if (index < rowChunks.size() && rowChunks[index] >= 0) {
+        Chunk& chunk = chunks[rowChunks[index]];
+        residentBytes -= chunk.bytes;
+        chunk.bytes = 0;
+        chunk.lod = -1;
+        chunk.row = NoRow;
+    }
+    if (index < rowChunks.size()) {
+        rowChunks.erase(rowChunks.begin() + index);
+    }
+    for (Chunk& chunk : chunks) {
+        if (chunk.row != NoRow && chunk.row > index) chunk.row--;
+    }
+    if (rootRow == index) {
+        rootRow = NoRow;
+    } else if (rootRow != NoRow && rootRow > index) {
+        rootRow--;
+    }
+}
+
+size_t Terrain::estimateBytes(int lod) const {
+    const size_t segments = std::max(source->settings.chunkSize >> lod, 1);
+    const size_t vertices = (segments + 1) * (segments + 1) + segments * 4;
+    const size_t indices = segments * segments * 6 + segments * 24;
+    return vertices * source->settings.layout.getStride() + indices * sizeof(uint32_t);
+}
+
+void Terrain::evict(Chunk& chunk, ModelStore& models) {
+    models.setMesh(chunk.row, emptyMesh);
+    residentBytes -= chunk.bytes;
+    chunk.bytes = 0;
+    chunk.lod = -1;
+    stats.evicted++;
+}
+
+void Terrain::update(ModelStore& models) {
+    stats.requested = 0;
+    stats.evicted = 0;
+    if (!source) {
+        return;
+    }
+    const TerrainSettings& settings = source->settings;
+
+    // Swap in the chunks finished since the last update
+    for (Build& build : *finished) {
+        pending--;
+        pendingBytes -= estimateBytes(build.lod);
+        Chunk& chunk = chunks[build.chunk];
+        chunk.pendingLod = -1;
+        if (chunk.row == NoRow) continue;
+        residentBytes -= chunk.bytes;
+        chunk.bytes = build.mesh->vertices.size() + build.mesh->indices.size() * sizeof(uint32_t);
+        residentBytes += chunk.bytes;
+        chunk.lod = static_cast<int8_t>(build.lod);
+        chunk.minHeight = build.minHeight;
+        chunk.maxHeight = build.maxHeight;
+        models.setMesh(chunk.row, std::move(build.mesh));
+    }
+    finished->clear();
+    if (rootRow == NoRow) {
+        return;
+    }
+
+    // Level of each chunk from the distance between the eye and its box, in the root's space
+    const float origin[3] = {0.0f, 0.0f, 0.0f};
+    float eye[3];
+    invertCFrame(models.getCFrame(rootRow)).transformPoint(origin, eye);
+    order.clear();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        Chunk& chunk = chunks[i];
+        chunk.wantedLod = -1;
+        if (chunk.row == NoRow) continue;
+        const CFrame center = getChunkCFrame(i);
+        const float half = settings.chunkSize * settings.cellSize * 0.5f;
+        float dx = std::max(std::fabs(eye[0] - center.position[0]) - half, 0.0f);
+        float dz = std::max(std::fabs(eye[2] - center.position[2]) - half, 0.0f);
+        float dy = std::max(std::max(chunk.minHeight - eye[1], eye[1] - chunk.maxHeight), 0.0f);
+        chunk.distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (chunk.distance > settings.viewDistance) continue;
+        int lod = 0;
+        if (chunk.distance >= settings.lodDistance && settings.lodDistance > 0.0f) {
+            lod = static_cast<int>(std::log2(chunk.distance / settings.lodDistance)) + 1;
+        }
+        chunk.wantedLod = static_cast<int8_t>(std::min(lod, settings.lodLevels - 1));
+        if (chunk.wantedLod != chunk.lod && chunk.pendingLod < 0) {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return chunks[a].distance < chunks[b].distance;
+    });
+
+    // Geometry to give up first: chunks out of range, then the farthest
+    victims.clear();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i].lod >= 0 && chunks[i].row != NoRow) victims.push_back(static_cast<uint32_t>(i));
+    }
+    std::sort(victims.begin(), victims.end(), [this](uint32_t a, uint32_t b) {
+        const Chunk& first = chunks[a];
+        const Chunk& second = chunks[b];
+        if ((first.wantedLod < 0) != (second.wantedLod < 0)) return first.wantedLod < 0;
+        return first.distance > second.distance;
+    });
+    size_t victim = 0;
+    auto makeRoom = [&](size_t bytes, const Chunk* keep, float distance) {
+        while (residentBytes + pendingBytes + bytes > settings.memoryBudget) {
+            if (victim == victims.size()) return false;
+            Chunk& chunk = chunks[victims[victim]];
+            // Never trade nearer geometry for farther
+            if (chunk.wantedLod >= 0 && chunk.distance <= distance) return false;
+            victim++;
+            if (&chunk != keep && chunk.lod >= 0) evict(chunk, models);
+        }
+        return true;
+    };
+
+    // Request the nearest missing levels; a chunk's old level stays until the new arrives
+    const size_t maxPending = std::max<size_t>(threadPool->getThreadCount() * 2, 2);
+    for (uint32_t index : order) {
+        if (pending >= maxPending) break;
+        Chunk& chunk = chunks[index];
+        const int lod = chunk.wantedLod;
+        const size_t bytes = estimateBytes(lod);
+        if (!makeRoom(bytes, &chunk, chunk.distance)) break;
+
+        chunk.pendingLod = static_cast<int8_t>(lod);
+        pending++;
+        pendingBytes += bytes;
+        stats.requested++;
+        auto build = std::make_shared<Build>();
+        build->chunk = index;
+        build->lod = lod;
+        std::shared_ptr<const Source> shared = source;
+        std::shared_ptr<std::vector<Build>> done = finished;
+        const int column = chunk.firstColumn, row = chunk.firstRow;
+        threadPool->submit(
+            [shared, build, column, row]() {
+                build->mesh = shared->buildChunk(column, row, build->lod, build->minHeight, build->maxHeight);
+            },
+            [done, build]() {
+                done->push_back(std::move(*build));
+            });
+    }
+    // A lowered budget still drops what is out of range
+    makeRoom(0, nullptr, settings.viewDistance);
+
+    stats.resident = 0;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.lod >= 0) stats.resident++;
+    }
+    stats.residentBytes = residentBytes;
+    stats.pending = pending;
+}
+
+void Terrain::cull(const ModelStore& models, std::vector<DrawItem>& items) {
+    size_t kept = 0;
+    stats.submitted = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        const DrawItem& item = items[i];
+        if (item.model < rowChunks.size() && rowChunks[item.model] >= 0) {
+            const Chunk& chunk = chunks[rowChunks[item.model]];
+            if (chunk.wantedLod < 0 || outsideFrustum(frustum, item.cframe, models.getBounds(item.model))) {
+                continue;
+            }
+            stats.submitted++;
+        }
+        items[kept++] = item;
+    }
+    items.resize(kept);
+}
+
+bool Terrain::getHeight(float x, float z, float& height) const {
+    if (!source) {
+        return false;
+    }
+    const float column = x / source->settings.cellSize + (source->columns - 1) * 0.5f;
+    const float row = z / source->settings.cellSize + (source->rows - 1) * 0.5f;
+    if (!(column >= 0.0f && row >= 0.0f && column <= source->columns - 1 && row <= source->rows - 1)) {
+        return false;
+    }
+    const int i = std::min(static_cast<int>(column), source->columns - 2);
+    const int j = std::min(static_cast<int>(row), source->rows - 2);
+    const float u = column - i, v = row - j;
+    const float front = source->sample(i, j) + (source->sample(i + 1, j) - source->sample(i, j)) * u;
+    const float back = source->sample(i, j + 1) + (source->sample(i + 1, j + 1) - source->sample(i, j + 1)) * u;
+    height = front + (back - front) * v;
+    return true;
+}
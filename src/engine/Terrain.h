@@ -0,0 +1,141 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MeshBuilder.h"
+#include "ModelStore.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Sample types of raw heightmap files
+enum class HeightFormat : uint8_t {
+    R8,   // Unsigned bytes, 0-255 maps to 0-1
+    R16,  // Unsigned 16-bit little-endian, 0-65535 maps to 0-1
+    F32,  // Little-endian floats, used as they are
+};
+
+struct TerrainSettings {
+    std::string path;               // Raw heightmap, row-major, no header
+    HeightFormat format = HeightFormat::R16;
+    int columns = 0, rows = 0;      // Samples along x and z; 0 infers a square map
+    float cellSize = 1.0f;          // World units between samples
+    float heightScale = 100.0f;     // Height of a sample of 1
+    int chunkSize = 64;             // Cells per chunk side at full detail, a power of two
+    int lodLevels = 4;              // Level l keeps every 2^l-th sample
+    float lodDistance = 100.0f;     // Full detail range; each further level reaches twice as far
+    float viewDistance = 1000.0f;   // Chunks beyond are neither drawn nor loaded
+    float skirtDepth = -1.0f;       // Below chunk edges, hides cracks between levels; < 0 picks 5% of heightScale
+    size_t memoryBudget = 64 << 20; // Bytes of resident chunk geometry
+    VertexLayout layout;
+    VertexColorFunction color;      // Remapped across the whole terrain
+};
+
+// Heightmap terrain streamed in chunks. The heightmap file is memory-mapped and cut into
+// square chunks, each drawn by its own model parented to a root model; the terrain is
+// centered on the root. Every update picks a level of detail per chunk from its
+// distance to the eye, builds the chunk meshes that are missing on worker threads
+// (nearest first) and drops the farthest geometry to stay within the memory budget.
+// A chunk keeps drawing its old level until the new one arrives.
+class Terrain {
+public:
+    static const uint32_t NoRow = UINT32_MAX;
+
+    struct Stats {
+        size_t chunks = 0;
+        size_t resident = 0;       // Chunks with geometry
+        size_t residentBytes = 0;
+        size_t pending = 0;        // Builds in flight
+        size_t requested = 0;      // Builds started by the last update
+        size_t evicted = 0;        // Chunks dropped by the last update
+        size_t submitted = 0;      // Chunks drawn by the last cull
+    };
+
+    explicit Terrain(ThreadPool* threadPool);
+
+    // Map the heightmap and lay out the chunks; false with error on bad settings or files
+    bool open(const TerrainSettings& settings, std::string& error);
+
+    size_t getChunkCount() const { return chunks.size(); }
+    // Placement of a chunk relative to the root, for the chunk's model
+    CFrame getChunkCFrame(size_t chunk) const;
+    // Models are assigned once the rows exist
+    void setRootRow(size_t row) { rootRow = static_cast<uint32_t>(row); }
+    void setChunkRow(size_t chunk, size_t row);
+    uint32_t getRootRow() const { return rootRow; }
+    // Rows of the chunks that still have a model
+    void getChunkRows(std::vector<uint32_t>& out) const;
+
+    // Keep the rows parallel to the model rows; a removed chunk model is no longer streamed
+    void removeRow(size_t index);
+
+    // The eye sits at the world origin; the frustum decides which chunks are drawn
+    void setFrustum(const ViewFrustum& value) { frustum = value; }
+
+    // Install finished chunk meshes, then request and evict geometry for the current
+    // eye position. The root's world transform must be up to date.
+    void update(ModelStore& models);
+    // Drop the draw items of chunks that are out of view range or outside the frustum
+    void cull(const ModelStore& models, std::vector<DrawItem>& items);
+
+    // Bilinear terrain height at a point in the root's space, false outside the map
+    bool getHeight(float x, float z, float& height) const;
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Mapped samples and the settings workers need, shared with builds in flight
+    struct Source {
+        std::shared_ptr<MappedFile> mapping;
+        TerrainSettings settings;
+        int columns = 0, rows = 0;
+        float skirtDepth = 0.0f;
+        float boundsMin[3], boundsMax[3];  // Whole terrain, for colors
+
+        float sample(int column, int row) const;
+        // Mesh of the chunk whose first cell is (column, row) at a level of detail;
+        // minHeight and maxHeight receive its height range
+        std::shared_ptr<Mesh> buildChunk(int column, int row, int lod, float& minHeight, float& maxHeight) const;
+    };
+
+    struct Chunk {
+        uint32_t row = NoRow;
+        int firstColumn = 0, firstRow = 0;  // First sample
+        int8_t lod = -1;               // Resident level, -1 for none
+        int8_t pendingLod = -1;        // Level being built
+        int8_t wantedLod = -1;         // -1 when out of view range
+        float distance = 0.0f;
+        size_t bytes = 0;
+        float minHeight, maxHeight;    // Whole terrain until the chunk is first built
+    };
+
+    // A finished build, handed from a worker to the main thread
+    struct Build {
+        uint32_t chunk;
+        int lod;
+        std::shared_ptr<Mesh> mesh;
+        float minHeight, maxHeight;
+    };
+
+    // Geometry bytes of a full chunk at a level
+    size_t estimateBytes(int lod) const;
+    void evict(Chunk& chunk, ModelStore& models);
+
+    ThreadPool* threadPool;
+    std::shared_ptr<const Source> source;
+    int chunksX = 0, chunksZ = 0;
+    std::vector<Chunk> chunks;
+    std::vector<int32_t> rowChunks;  // Chunk per model row, -1 for none
+    uint32_t rootRow = NoRow;
+    ViewFrustum frustum;
+    std::shared_ptr<Mesh> emptyMesh;  // Stands in for evicted geometry
+    // Completions append here on the main thread; shared so builds can outlive the terrain
+    std::shared_ptr<std::vector<Build>> finished;
+    size_t pending = 0;
+    size_t pendingBytes = 0;   // Estimated, of the builds in flight
+    size_t residentBytes = 0;
+    std::vector<uint32_t> order;    // Scratch for update
+    std::vector<uint32_t> victims;
+    Stats stats;
+};
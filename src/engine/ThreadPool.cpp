@@ -0,0 +1,127 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threadCount) : activeTasks(0), stopping(false) {
+    if (threadCount == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.push_back(std::move(work));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::submit(std::function<void()> work, std::function<void()> completion) {
+    submit([this, work = std::move(work), completion = std::move(completion)]() mutable {
+        work();
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completions.push_back(std::move(completion));
+    });
+}
+
+size_t ThreadPool::runCompletions() {
+    std::vector<std::function<void()>> batch;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        batch.swap(completions);
+    }
+    for (auto& completion : batch) {
+        completion();
+    }
+    return batch.size();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(taskMutex);
+    tasksDone.wait(lock, [this] { return tasks.empty() && activeTasks == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+
+    struct Batch {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto batch = std::make_shared<Batch>();
+
+    // Helpers that start after every index is claimed return without touching body,
+    // which may be gone by then
+    const std::function<void(size_t)>* bodyPointer = &body;
+    auto claim = [batch, bodyPointer, count]() {
+        for (;;) {
+            size_t index = batch->next.fetch_add(1);
+            if (index >= count) return;
+            (*bodyPointer)(index);
+            if (batch->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min<size_t>(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit(claim);
+    }
+    claim();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch, count] { return batch->done.load() == count; });
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(taskMutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            activeTasks++;
+        }
+
+        // Jobs report their own failures; this only keeps a stray exception from
+        // terminating the process
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Worker task failed: " << e.what() << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            activeTasks--;
+            if (tasks.empty() && activeTasks == 0) {
+                tasksDone.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for background engine work.
+// Completions are queued back and run on the main thread by runCompletions().
+class ThreadPool {
+public:
+    // threadCount 0 picks one less than the hardware concurrency (at least one)
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run work on a worker thread
+    void submit(std::function<void()> work);
+
+    // Run work on a worker thread, then completion on the main thread
+    void submit(std::function<void()> work, std::function<void()> completion);
+
+    // Run every queued completion; call once per frame from the main thread.
+    // Returns the number of completions run.
+    size_t runCompletions();
+
+    // Block until all submitted work has finished (completions may still be queued)
+    void wait();
+
+    // Run body(0..count-1) across the workers and the calling thread, returning when all
+    // are done. The caller claims indices too, so it never waits behind unrelated
+    // queued work, only behind indices a worker has already started.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex taskMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable tasksDone;
+    size_t activeTasks;
+    bool stopping;
+
+    std::vector<std::function<void()>> completions;
+    std::mutex completionMutex;
+};
@@ -0,0 +1,451 @@
+#include "Trace.h"
+#include "lualib.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+const char TraceMagic[4] = {'L', '3', 'D', 'T'};
+const size_t FlushThreshold = 1 << 20;
+const int MaxValueDepth = 32;
+
+// Stand-in for recorded callbacks; the calls they made are replayed separately
+int replayPlaceholder(lua_State*) {
+    return 0;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Recorder
+
+TraceRecorder::TraceRecorder()
+    : bytesWritten(0), frames(0), calls(0), keyEvents(0), nextFunctionId(0) {}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open(const std::string& tracePath) {
+    file.open(tracePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open trace file: " << tracePath << std::endl;
+        return false;
+    }
+    path = tracePath;
+    buffer.insert(buffer.end(), TraceMagic, TraceMagic + 4);
+    uint32_t version = TraceFormat::Version;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&version);
+    buffer.insert(buffer.end(), bytes, bytes + 4);
+    started = lastFrame = std::chrono::steady_clock::now();
+    return true;
+}
+
+void TraceRecorder::close() {
+    if (!file.is_open()) {
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    bytesWritten += buffer.size();
+    buffer.clear();
+    file.close();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "Recorded trace " << path << ": " << frames << " frames, " << calls << " calls, "
+              << keyEvents << " key events, " << bytesWritten / 1024.0 << " KB ("
+              << (frames > 0 ? bytesWritten / frames : 0) << " bytes/frame, "
+              << (seconds > 0.0 ? bytesWritten / 1024.0 / seconds : 0.0) << " KB/s)" << std::endl;
+}
+
+int TraceRecorder::registerFunction(const std::string& moduleName, const char* name) {
+    int id = nextFunctionId++;
+    buffer.push_back(TraceFormat::DefineFunction);
+    writeVarint(static_cast<uint64_t>(id));
+    writeString(moduleName.data(), moduleName.size());
+    writeString(name, strlen(name));
+    return id;
+}
+
+void TraceRecorder::recordCall(int functionId, lua_State* L) {
+    int argumentCount = lua_gettop(L);
+    size_t recordStart = buffer.size();
+    buffer.push_back(TraceFormat::Call);
+    writeVarint(static_cast<uint64_t>(functionId));
+    writeVarint(static_cast<uint64_t>(argumentCount));
+    for (int i = 1; i <= argumentCount; i++) {
+        if (!writeValue(L, i, 0)) {
+            // Drop the whole record rather than write a partial one
+            buffer.resize(recordStart);
+            lua_settop(L, argumentCount);
+            std::cerr << "Trace: out of Lua stack recording a call; call not recorded" << std::endl;
+            return;
+        }
+    }
+    calls++;
+    flushIfLarge();
+}
+
+void TraceRecorder::recordKeyEvent(const std::string& key, const std::string& action) {
+    buffer.push_back(TraceFormat::KeyEvent);
+    writeString(key.data(), key.size());
+    writeString(action.data(), action.size());
+    keyEvents++;
+}
+
+void TraceRecorder::beginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame).count();
+    lastFrame = now;
+    buffer.push_back(TraceFormat::Frame);
+    writeVarint(static_cast<uint64_t>(delta));
+    frames++;
+    flushIfLarge();
+}
+
+void TraceRecorder::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void TraceRecorder::writeString(const char* data, size_t size) {
+    writeVarint(size);
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+bool TraceRecorder::writeValue(lua_State* L, int index, int depth) {
+    // Room for a table walk's key and value plus a __handle result
+    if (!lua_checkstack(L, 3)) {
+        return false;
+    }
+    switch (lua_type(L, index)) {
+        case LUA_TBOOLEAN:
+            buffer.push_back(lua_toboolean(L, index) ? TraceFormat::True : TraceFormat::False);
+            break;
+        case LUA_TNUMBER: {
+            // Most engine arguments are small integers (indices, handles), so store those as varints
+            // Range-check the double first; casting NaN, inf or huge values is undefined
+            double number = lua_tonumber(L, index);
+            if (std::fabs(number) < 0x1p52 && number == std::floor(number)) {
+                int64_t integer = static_cast<int64_t>(number);
+                buffer.push_back(TraceFormat::Integer);
+                writeVarint((static_cast<uint64_t>(integer) << 1) ^ static_cast<uint64_t>(integer >> 63));
+            } else {
+                buffer.push_back(TraceFormat::Number);
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&number);
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(double));
+            }
+            break;
+        }
+        case LUA_TSTRING: {
+            size_t length = 0;
+            const char* text = lua_tolstring(L, index, &length);
+            buffer.push_back(TraceFormat::String);
+            writeString(text, length);
+            break;
+        }
+        case LUA_TTABLE: {
+            if (depth >= MaxValueDepth) {
+                buffer.push_back(TraceFormat::Nil);
+                break;
+            }
+            // Pair count is patched in after the walk
+            buffer.push_back(TraceFormat::Table);
+            size_t countOffset = buffer.size();
+            buffer.resize(buffer.size() + 4);
+            uint32_t count = 0;
+            int table = index < 0 ? lua_gettop(L) + index + 1 : index;
+            lua_pushnil(L);
+            while (lua_next(L, table)) {
+                // On failure the caller resets the stack
+                if (!writeValue(L, -2, depth + 1) || !writeValue(L, -1, depth + 1)) return false;
+                lua_pop(L, 1);
+                count++;
+            }
+            memcpy(&buffer[countOffset], &count, sizeof(count));
+            break;
+        }
+        case LUA_TFUNCTION:
+            buffer.push_back(TraceFormat::Function);
+            break;
+        case LUA_TBUFFER: {
+            size_t size = 0;
+            const void* data = lua_tobuffer(L, index, &size);
+            buffer.push_back(TraceFormat::Buffer);
+            writeString(static_cast<const char*>(data), size);
+            break;
+        }
+        case LUA_TVECTOR: {
+            const float* vector = lua_tovector(L, index);
+            buffer.push_back(TraceFormat::Vector);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(vector);
+            buffer.insert(buffer.end(), bytes, bytes + 3 * sizeof(float));
+            break;
+        }
+        case LUA_TUSERDATA:
+            // Engine objects are recorded as the handle or model index they stand for
+            if (luaL_callmeta(L, index, "__handle")) {
+                if (!writeValue(L, -1, depth)) return false;
+                lua_pop(L, 1);
+            } else {
+                buffer.push_back(TraceFormat::Nil);
+            }
+            break;
+        default:
+            buffer.push_back(TraceFormat::Nil);
+            break;
+    }
+    return true;
+}
+
+void TraceRecorder::flushIfLarge() {
+    if (buffer.size() >= FlushThreshold) {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        bytesWritten += buffer.size();
+        buffer.clear();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Replayer
+
+TraceReplayer::TraceReplayer()
+    : cursor(nullptr), end(nullptr), setupDone(false), failed(false), frames(0), calls(0), failedCalls(0) {}
+
+bool TraceReplayer::open(const std::string& path) {
+    if (!file.open(path)) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+    cursor = file.getData();
+    end = cursor + file.getSize();
+
+    uint32_t version = 0;
+    if (file.getSize() < 8 || memcmp(cursor, TraceMagic, 4) != 0) {
+        std::cerr << "Not a trace file: " << path << std::endl;
+        return false;
+    }
+    memcpy(&version, cursor + 4, sizeof(version));
+    if (version != TraceFormat::Version) {
+        std::cerr << "Unsupported trace version " << version << " in " << path << std::endl;
+        return false;
+    }
+    cursor += 8;
+    started = nextFrameTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void TraceReplayer::addModule(ILuauModule* module) {
+    for (const LuauExport* entry = module->getExports(); entry->name; entry++) {
+        exports[std::string(module->getModuleName()) + "/" + entry->name] = {entry->func, module};
+    }
+}
+
+bool TraceReplayer::replayFrame(lua_State* L, IGUI* gui, bool fast) {
+    // Setup calls come before the first frame marker
+    while (!setupDone && cursor < end && *cursor != TraceFormat::Frame) {
+        uint8_t type = *cursor++;
+        if (!applyRecord(L, gui, type)) return false;
+    }
+    setupDone = true;
+
+    if (failed || cursor >= end) {
+        return false;
+    }
+
+    cursor++; // Frame marker
+    uint64_t delta = 0;
+    if (!readVarint(delta)) return false;
+    if (!fast) {
+        nextFrameTime += std::chrono::microseconds(delta);
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+    frames++;
+
+    while (cursor < end && *cursor != TraceFormat::Frame) {
+        uint8_t type = *cursor++;
+        if (!applyRecord(L, gui, type)) return false;
+    }
+    return true;
+}
+
+void TraceReplayer::report() const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    double megabytes = file.getSize() / (1024.0 * 1024.0);
+    std::cout << "Replayed " << frames << " frames, " << calls << " calls (" << failedCalls << " failed) in "
+              << seconds << " s: " << (seconds > 0.0 ? frames / seconds : 0.0) << " frames/s, "
+              << (seconds > 0.0 ? calls / seconds : 0.0) << " calls/s, "
+              << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s" << std::endl;
+}
+
+bool TraceReplayer::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    failed = true;
+    return false;
+}
+
+bool TraceReplayer::readString(std::string& value) {
+    uint64_t length = 0;
+    if (!readVarint(length) || length > static_cast<uint64_t>(end - cursor)) {
+        failed = true;
+        return false;
+    }
+    value.assign(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+    cursor += length;
+    return true;
+}
+
+bool TraceReplayer::readValue(lua_State* L, int depth) {
+    // A table being filled holds its key and value on top of itself
+    if (cursor >= end || depth > MaxValueDepth || !lua_checkstack(L, 3)) {
+        failed = true;
+        return false;
+    }
+    switch (*cursor++) {
+        case TraceFormat::Nil:
+            lua_pushnil(L);
+            return true;
+        case TraceFormat::False:
+            lua_pushboolean(L, 0);
+            return true;
+        case TraceFormat::True:
+            lua_pushboolean(L, 1);
+            return true;
+        case TraceFormat::Integer: {
+            uint64_t encoded = 0;
+            if (!readVarint(encoded)) return false;
+            int64_t integer = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+            lua_pushnumber(L, static_cast<double>(integer));
+            return true;
+        }
+        case TraceFormat::Number: {
+            double number;
+            if (end - cursor < static_cast<ptrdiff_t>(sizeof(number))) break;
+            memcpy(&number, cursor, sizeof(number));
+            cursor += sizeof(number);
+            lua_pushnumber(L, number);
+            return true;
+        }
+        case TraceFormat::String: {
+            std::string text;
+            if (!readString(text)) return false;
+            lua_pushlstring(L, text.data(), text.size());
+            return true;
+        }
+        case TraceFormat::Table: {
+            uint32_t count;
+            if (end - cursor < static_cast<ptrdiff_t>(sizeof(count))) break;
+            memcpy(&count, cursor, sizeof(count));
+            cursor += sizeof(count);
+            lua_createtable(L, 0, 0);
+            for (uint32_t i = 0; i < count; i++) {
+                if (!readValue(L, depth + 1) || !readValue(L, depth + 1)) return false;
+                if (lua_isnil(L, -2)) {
+                    lua_pop(L, 2);
+                    continue;
+                }
+                lua_rawset(L, -3);
+            }
+            return true;
+        }
+        case TraceFormat::Function:
+            lua_pushcfunction(L, replayPlaceholder, "replayPlaceholder");
+            return true;
+        case TraceFormat::Buffer: {
+            uint64_t size = 0;
+            if (!readVarint(size) || size > static_cast<uint64_t>(end - cursor)) break;
+            void* data = lua_newbuffer(L, static_cast<size_t>(size));
+            memcpy(data, cursor, static_cast<size_t>(size));
+            cursor += size;
+            return true;
+        }
+        case TraceFormat::Vector: {
+            float vector[3];
+            if (end - cursor < static_cast<ptrdiff_t>(sizeof(vector))) break;
+            memcpy(vector, cursor, sizeof(vector));
+            cursor += sizeof(vector);
+            lua_pushvector(L, vector[0], vector[1], vector[2]);
+            return true;
+        }
+        default:
+            break;
+    }
+    failed = true;
+    return false;
+}
+
+bool TraceReplayer::applyRecord(lua_State* L, IGUI* gui, uint8_t type) {
+    switch (type) {
+        case TraceFormat::DefineFunction: {
+            uint64_t id = 0;
+            std::string moduleName, name;
+            if (!readVarint(id) || !readString(moduleName) || !readString(name)) break;
+            if (id >= functions.size()) {
+                functions.resize(static_cast<size_t>(id) + 1);
+                functionNames.resize(static_cast<size_t>(id) + 1);
+            }
+            auto found = exports.find(moduleName + "/" + name);
+            functions[id] = found != exports.end() ? found->second : Export();
+            functionNames[id] = moduleName + "." + name;
+            if (!functions[id].function) {
+                std::cerr << "Trace calls unknown function " << functionNames[id] << std::endl;
+            }
+            return true;
+        }
+        case TraceFormat::Call: {
+            uint64_t id = 0, argumentCount = 0;
+            if (!readVarint(id) || !readVarint(argumentCount) || id >= functions.size()) break;
+
+            int base = lua_gettop(L);
+            // Exports find their module in the first upvalue, as when registered
+            const Export& function = functions[id];
+            if (function.function) {
+                lua_pushlightuserdata(L, function.module);
+                lua_pushcclosure(L, function.function, functionNames[id].c_str(), 1);
+            } else {
+                lua_pushcfunction(L, replayPlaceholder, functionNames[id].c_str());
+            }
+            for (uint64_t i = 0; i < argumentCount; i++) {
+                if (!readValue(L, 0)) {
+                    lua_settop(L, base);
+                    return false;
+                }
+            }
+            calls++;
+            if (lua_pcall(L, static_cast<int>(argumentCount), LUA_MULTRET, 0) != 0) {
+                // Calls that failed while recording fail again; keep going
+                failedCalls++;
+            } else {
+                // Keep returned objects (meshes, models) alive, as the recorded script
+                // did; collecting them would release or remove what later calls use
+                for (int i = base + 1; i <= lua_gettop(L); i++) {
+                    if (lua_type(L, i) == LUA_TUSERDATA) lua_ref(L, i);
+                }
+            }
+            lua_settop(L, base);
+            return true;
+        }
+        case TraceFormat::KeyEvent: {
+            std::string key, action;
+            if (!readString(key) || !readString(action)) break;
+            if (gui) {
+                gui->handleKeyEvent(key, action);
+            }
+            return true;
+        }
+        default:
+            break;
+    }
+    std::cerr << "Corrupt trace record" << std::endl;
+    failed = true;
+    return false;
+}
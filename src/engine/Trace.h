@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ILuauModule.h"
+#include "IGUI.h"
+#include "MappedFile.h"
+#include "lua.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binary trace of everything that drove a session: native API calls with their
+// arguments, input events and frame boundaries with timestamps.
+//   "L3DT" | u32 version | records...
+// Each record is a type byte followed by varint/tagged-value payloads. Function
+// names are defined once and then referenced by id. Lua functions passed as
+// arguments (callbacks) are recorded as placeholders, since the calls they make
+// are recorded themselves.
+namespace TraceFormat {
+    const uint32_t Version = 1;
+
+    enum Record : uint8_t {
+        DefineFunction = 1,  // varint id, string module, string name
+        Call = 2,            // varint id, varint argument count, values
+        Frame = 3,           // varint microseconds since the previous frame
+        KeyEvent = 4,        // string key, string action
+    };
+
+    enum Value : uint8_t {
+        Nil = 0,
+        False = 1,
+        True = 2,
+        Integer = 3,   // zigzag varint
+        Number = 4,    // 8-byte double
+        String = 5,    // varint length, bytes
+        Table = 6,     // u32 pair count, key/value pairs
+        Function = 7,  // placeholder
+        Buffer = 8,    // varint length, bytes
+        Vector = 9,    // 3 floats
+    };
+}
+
+class TraceRecorder {
+public:
+    TraceRecorder();
+    ~TraceRecorder();
+
+    bool open(const std::string& path);
+    // Flush and report the trace size
+    void close();
+
+    // Function ids are assigned when module tables are built
+    int registerFunction(const std::string& moduleName, const char* name);
+
+    // Record a call with the arguments currently on the stack of L
+    void recordCall(int functionId, lua_State* L);
+    void recordKeyEvent(const std::string& key, const std::string& action);
+    // Mark the start of a frame
+    void beginFrame();
+
+private:
+    void writeVarint(uint64_t value);
+    void writeString(const char* data, size_t size);
+    // False when the Lua stack cannot grow; the stack is then left for the caller to reset
+    bool writeValue(lua_State* L, int index, int depth);
+    void flushIfLarge();
+
+    std::ofstream file;
+    std::string path;
+    std::vector<uint8_t> buffer;
+    uint64_t bytesWritten;
+    uint64_t frames;
+    uint64_t calls;
+    uint64_t keyEvents;
+    int nextFunctionId;
+    std::chrono::steady_clock::time_point lastFrame;
+    std::chrono::steady_clock::time_point started;
+};
+
+class TraceReplayer {
+public:
+    TraceReplayer();
+
+    bool open(const std::string& path);
+
+    // Make a module's exports callable by the trace
+    void addModule(ILuauModule* module);
+
+    // Apply the records of the next frame. The first call also applies the setup calls
+    // made before the first frame. Without fast, waits to match the recorded frame timing.
+    // Returns false once the trace is exhausted.
+    bool replayFrame(lua_State* L, IGUI* gui, bool fast);
+
+    // Print frames, calls and throughput
+    void report() const;
+
+private:
+    // An export and the module it is called with
+    struct Export {
+        lua_CFunction function = nullptr;
+        ILuauModule* module = nullptr;
+    };
+
+    bool readVarint(uint64_t& value);
+    bool readString(std::string& value);
+    bool readValue(lua_State* L, int depth);
+    bool applyRecord(lua_State* L, IGUI* gui, uint8_t type);
+
+    MappedFile file;
+    const uint8_t* cursor;
+    const uint8_t* end;
+    bool setupDone;
+    bool failed;
+    std::unordered_map<std::string, Export> exports;  // "module/name"
+    std::vector<Export> functions;                    // By trace id
+    std::vector<std::string> functionNames;
+    uint64_t frames;
+    uint64_t calls;
+    uint64_t failedCalls;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point nextFrameTime;
+};
@@ -0,0 +1,365 @@
+#include "TweenSystem.h"
+#include "Simd.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+const float Pi = 3.14159265f;
+
+struct EasingName {
+    const char* name;
+    Easing easing;
+};
+
+const EasingName EasingNames[] = {
+    {"linear", Easing::Linear},
+    {"sineIn", Easing::SineIn},
+    {"sineOut", Easing::SineOut},
+    {"sineInOut", Easing::SineInOut},
+    {"quadIn", Easing::QuadIn},
+    {"quadOut", Easing::QuadOut},
+    {"quadInOut", Easing::QuadInOut},
+    {"cubicIn", Easing::CubicIn},
+    {"cubicOut", Easing::CubicOut},
+    {"cubicInOut", Easing::CubicInOut},
+    {"backOut", Easing::BackOut},
+    {"bounceOut", Easing::BounceOut},
+};
+
+float bounceOut(float t) {
+    const float n = 7.5625f, d = 2.75f;
+    if (t < 1.0f / d) return n * t * t;
+    if (t < 2.0f / d) { t -= 1.5f / d; return n * t * t + 0.75f; }
+    if (t < 2.5f / d) { t -= 2.25f / d; return n * t * t + 0.9375f; }
+    t -= 2.625f / d;
+    return n * t * t + 0.984375f;
+}
+
+float ease(Easing easing, float t) {
+    switch (easing) {
+        case Easing::Linear: return t;
+        case Easing::SineIn: return 1.0f - std::cos(t * Pi * 0.5f);
+        case Easing::SineOut: return std::sin(t * Pi * 0.5f);
+        case Easing::SineInOut: return 0.5f - 0.5f * std::cos(t * Pi);
+        case Easing::QuadIn: return t * t;
+        case Easing::QuadOut: return t * (2.0f - t);
+        case Easing::QuadInOut: return t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+        case Easing::CubicIn: return t * t * t;
+        case Easing::CubicOut: { float u = 1.0f - t; return 1.0f - u * u * u; }
+        case Easing::CubicInOut: {
+            if (t < 0.5f) return 4.0f * t * t * t;
+            float u = 1.0f - t;
+            return 1.0f - 4.0f * u * u * u;
+        }
+        case Easing::BackOut: {
+            const float c1 = 1.70158f, c3 = c1 + 1.0f;
+            float u = t - 1.0f;
+            return 1.0f + c3 * u * u * u + c1 * u * u;
+        }
+        case Easing::BounceOut: return bounceOut(t);
+    }
+    return t;
+}
+
+// Rotation of a CFrame as a unit quaternion; the matrix rows are right, up and -look
+void toQuaternion(const CFrame& cframe, float q[4]) {
+    const float m00 = cframe.right[0], m01 = cframe.right[1], m02 = cframe.right[2];
+    const float m10 = cframe.up[0], m11 = cframe.up[1], m12 = cframe.up[2];
+    const float m20 = -cframe.look[0], m21 = -cframe.look[1], m22 = -cframe.look[2];
+    float trace = m00 + m11 + m22;
+    if (trace > 0.0f) {
+        float s = std::sqrt(trace + 1.0f) * 2.0f;
+        q[3] = 0.25f * s;
+        q[0] = (m21 - m12) / s;
+        q[1] = (m02 - m20) / s;
+        q[2] = (m10 - m01) / s;
+    } else if (m00 > m11 && m00 > m22) {
+        float s = std::sqrt(1.0f + m00 - m11 - m22) * 2.0f;
+        q[3] = (m21 - m12) / s;
+        q[0] = 0.25f * s;
+        q[1] = (m01 + m10) / s;
+        q[2] = (m02 + m20) / s;
+    } else if (m11 > m22) {
+        float s = std::sqrt(1.0f + m11 - m00 - m22) * 2.0f;
+        q[3] = (m02 - m20) / s;
+        q[0] = (m01 + m10) / s;
+        q[1] = 0.25f * s;
+        q[2] = (m12 + m21) / s;
+    } else {
+        float s = std::sqrt(1.0f + m22 - m00 - m11) * 2.0f;
+        q[3] = (m10 - m01) / s;
+        q[0] = (m02 + m20) / s;
+        q[1] = (m12 + m21) / s;
+        q[2] = 0.25f * s;
+    }
+    float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; i++) q[i] /= length;
+}
+
+void setRotation(CFrame& cframe, float x, float y, float z, float w) {
+    cframe.right[0] = 1.0f - 2.0f * (y * y + z * z);
+    cframe.right[1] = 2.0f * (x * y - w * z);
+    cframe.right[2] = 2.0f * (x * z + w * y);
+    cframe.up[0] = 2.0f * (x * y + w * z);
+    cframe.up[1] = 1.0f - 2.0f * (x * x + z * z);
+    cframe.up[2] = 2.0f * (y * z - w * x);
+    cframe.look[0] = -2.0f * (x * z - w * y);
+    cframe.look[1] = -2.0f * (y * z + w * x);
+    cframe.look[2] = -(1.0f - 2.0f * (x * x + y * y));
+}
+
+} // namespace
+
+bool easingFromName(const std::string& name, Easing& easing) {
+    for (const EasingName& entry : EasingNames) {
+        if (name == entry.name) {
+            easing = entry.easing;
+            return true;
+        }
+    }
+    return false;
+}
+
+TweenSystem::TweenSystem() : nextId(1) {
+}
+
+uint32_t TweenSystem::start(size_t row, const CFrame& from, const CFrame& to, float duration, Easing easing, TweenLoop loop) {
+    if (rowTweens.size() <= row) {
+        rowTweens.resize(row + 1, -1);
+    }
+    if (rowTweens[row] >= 0) {
+        removeAt(static_cast<size_t>(rowTweens[row]));
+    }
+
+    float fromRotation[4], toRotation[4];
+    toQuaternion(from, fromRotation);
+    toQuaternion(to, toRotation);
+    const float values[LaneCount] = {
+        from.position[0], from.position[1], from.position[2],
+        to.position[0], to.position[1], to.position[2],
+        fromRotation[0], fromRotation[1], fromRotation[2], fromRotation[3],
+        toRotation[0], toRotation[1], toRotation[2], toRotation[3],
+    };
+    for (int lane = 0; lane < LaneCount; lane++) {
+        lanes[lane].push_back(values[lane]);
+    }
+
+    uint32_t id = nextId++;
+    rowTweens[row] = static_cast<int32_t>(ids.size());
+    ids.push_back(id);
+    rows.push_back(static_cast<uint32_t>(row));
+    elapsed.push_back(0.0f);
+    durations.push_back(duration > 0.0f ? duration : 0.0f);
+    easings.push_back(easing);
+    loops.push_back(loop);
+    return id;
+}
+
+bool TweenSystem::cancel(uint32_t id) {
+    for (size_t slot = 0; slot < ids.size(); slot++) {
+        if (ids[slot] == id) {
+            removeAt(slot);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TweenSystem::removeAt(size_t slot) {
+    // Swap with the last tween to keep the columns packed
+    size_t last = ids.size() - 1;
+    rowTweens[rows[slot]] = -1;
+    if (slot != last) {
+        ids[slot] = ids[last];
+        rows[slot] = rows[last];
+        elapsed[slot] = elapsed[last];
+        durations[slot] = durations[last];
+        easings[slot] = easings[last];
+        loops[slot] = loops[last];
+        for (int lane = 0; lane < LaneCount; lane++) {
+            lanes[lane][slot] = lanes[lane][last];
+        }
+        rowTweens[rows[slot]] = static_cast<int32_t>(slot);
+    }
+    ids.pop_back();
+    rows.pop_back();
+    elapsed.pop_back();
+    durations.pop_back();
+    easings.pop_back();
+    loops.pop_back();
+    for (int lane = 0; lane < LaneCount; lane++) {
+        lanes[lane].pop_back();
+    }
+}
+
+void TweenSystem::removeRow(size_t index) {
+    if (index < rowTweens.size() && rowTweens[index] >= 0) {
+        removeAt(static_cast<size_t>(rowTweens[index]));
+    }
+    if (index < rowTweens.size()) {
+        rowTweens.erase(rowTweens.begin() + index);
+    }
+    for (uint32_t& row : rows) {
+        if (row > index) row--;
+    }
+}
+
+void TweenSystem::clear() {
+    ids.clear();
+    rows.clear();
+    elapsed.clear();
+    durations.clear();
+    easings.clear();
+    loops.clear();
+    for (int lane = 0; lane < LaneCount; lane++) {
+        lanes[lane].clear();
+    }
+    rowTweens.clear();
+}
+
+void TweenSystem::interpolate(size_t count) {
+    const float* t = fractions.data();
+    const float* from[7] = {lanes[FromX].data(), lanes[FromY].data(), lanes[FromZ].data(),
+                            lanes[FromQX].data(), lanes[FromQY].data(), lanes[FromQZ].data(), lanes[FromQW].data()};
+    const float* to[7] = {lanes[ToX].data(), lanes[ToY].data(), lanes[ToZ].data(),
+                          lanes[ToQX].data(), lanes[ToQY].data(), lanes[ToQZ].data(), lanes[ToQW].data()};
+    float* out[7];
+    for (int c = 0; c < 7; c++) out[c] = outputs[c].data();
+
+    size_t i = 0;
+#if defined(L3D_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 f = _mm_loadu_ps(t + i);
+        for (int c = 0; c < 3; c++) {
+            __m128 a = _mm_loadu_ps(from[c] + i);
+            __m128 b = _mm_loadu_ps(to[c] + i);
+            _mm_storeu_ps(out[c] + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f)));
+        }
+        __m128 a[4], b[4];
+        __m128 dot = _mm_setzero_ps();
+        for (int c = 0; c < 4; c++) {
+            a[c] = _mm_loadu_ps(from[3 + c] + i);
+            b[c] = _mm_loadu_ps(to[3 + c] + i);
+            dot = _mm_add_ps(dot, _mm_mul_ps(a[c], b[c]));
+        }
+        // Negate the target where it lies on the far hemisphere
+        __m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+        __m128 q[4];
+        __m128 length = _mm_setzero_ps();
+        for (int c = 0; c < 4; c++) {
+            __m128 target = _mm_xor_ps(b[c], sign);
+            q[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(target, a[c]), f));
+            length = _mm_add_ps(length, _mm_mul_ps(q[c], q[c]));
+        }
+        __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length));
+        for (int c = 0; c < 4; c++) {
+            _mm_storeu_ps(out[3 + c] + i, _mm_mul_ps(q[c], inverse));
+        }
+    }
+#elif defined(L3D_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t f = vld1q_f32(t + i);
+        for (int c = 0; c < 3; c++) {
+            float32x4_t a = vld1q_f32(from[c] + i);
+            float32x4_t b = vld1q_f32(to[c] + i);
+            vst1q_f32(out[c] + i, vmlaq_f32(a, vsubq_f32(b, a), f));
+        }
+        float32x4_t a[4], b[4];
+        float32x4_t dot = vdupq_n_f32(0.0f);
+        for (int c = 0; c < 4; c++) {
+            a[c] = vld1q_f32(from[3 + c] + i);
+            b[c] = vld1q_f32(to[3 + c] + i);
+            dot = vmlaq_f32(dot, a[c], b[c]);
+        }
+        uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(dot), vdupq_n_u32(0x80000000u));
+        float32x4_t q[4];
+        float32x4_t length = vdupq_n_f32(0.0f);
+        for (int c = 0; c < 4; c++) {
+            float32x4_t target = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b[c]), sign));
+            q[c] = vmlaq_f32(a[c], vsubq_f32(target, a[c]), f);
+            length = vmlaq_f32(length, q[c], q[c]);
+        }
+        float32x4_t inverse = vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(length));
+        for (int c = 0; c < 4; c++) {
+            vst1q_f32(out[3 + c] + i, vmulq_f32(q[c], inverse));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            out[c][i] = from[c][i] + (to[c][i] - from[c][i]) * t[i];
+        }
+        float dot = 0.0f;
+        for (int c = 3; c < 7; c++) dot += from[c][i] * to[c][i];
+        float sign = dot < 0.0f ? -1.0f : 1.0f;
+        float length = 0.0f;
+        for (int c = 3; c < 7; c++) {
+            out[c][i] = from[c][i] + (to[c][i] * sign - from[c][i]) * t[i];
+            length += out[c][i] * out[c][i];
+        }
+        float inverse = 1.0f / std::sqrt(length);
+        for (int c = 3; c < 7; c++) out[c][i] *= inverse;
+    }
+}
+
+void TweenSystem::update(float seconds, SceneGraph& sceneGraph) {
+    auto startTime = std::chrono::steady_clock::now();
+    completedIds.clear();
+    completedRows.clear();
+    finished.clear();
+
+    // Eased fraction of each tween
+    size_t count = ids.size();
+    fractions.resize(count);
+    for (int c = 0; c < 7; c++) outputs[c].resize(count);
+    for (size_t i = 0; i < count; i++) {
+        elapsed[i] += seconds;
+        float duration = durations[i];
+        float phase = duration > 0.0f ? elapsed[i] / duration : 1.0f;
+        switch (loops[i]) {
+            case TweenLoop::Once:
+                if (phase >= 1.0f) {
+                    phase = 1.0f;
+                    finished.push_back(static_cast<uint32_t>(i));
+                }
+                break;
+            case TweenLoop::Repeat:
+                phase -= std::floor(phase);
+                // Keep elapsed small so precision holds over long runs
+                elapsed[i] = phase * duration;
+                break;
+            case TweenLoop::PingPong: {
+                float cycle = phase * 0.5f;
+                cycle -= std::floor(cycle);
+                elapsed[i] = cycle * 2.0f * duration;
+                phase = cycle < 0.5f ? cycle * 2.0f : 2.0f - cycle * 2.0f;
+                break;
+            }
+        }
+        fractions[i] = ease(easings[i], phase);
+    }
+
+    interpolate(count);
+
+    for (size_t i = 0; i < count; i++) {
+        CFrame cframe;
+        cframe.position[0] = outputs[0][i];
+        cframe.position[1] = outputs[1][i];
+        cframe.position[2] = outputs[2][i];
+        setRotation(cframe, outputs[3][i], outputs[4][i], outputs[5][i], outputs[6][i]);
+        sceneGraph.setLocalCFrame(rows[i], cframe);
+    }
+
+    // Finished slots are ascending; remove from the back so swaps don't move pending ones
+    for (size_t i = finished.size(); i-- > 0;) {
+        size_t slot = finished[i];
+        completedIds.push_back(ids[slot]);
+        completedRows.push_back(rows[slot]);
+        removeAt(slot);
+    }
+
+    stats.tweens = ids.size();
+    stats.completed = completedIds.size();
+    stats.microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+}
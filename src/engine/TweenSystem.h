@@ -0,0 +1,99 @@
+#pragma once
+
+#include "IRenderer.h"
+#include "SceneGraph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class Easing : uint8_t {
+    Linear,
+    SineIn,
+    SineOut,
+    SineInOut,
+    QuadIn,
+    QuadOut,
+    QuadInOut,
+    CubicIn,
+    CubicOut,
+    CubicInOut,
+    BackOut,
+    BounceOut,
+};
+
+enum class TweenLoop : uint8_t {
+    Once,      // Stops at the target and completes
+    Repeat,    // Jumps back to the start
+    PingPong,  // Plays forwards, then backwards
+};
+
+// Look up an easing by name ("linear", "sineIn", "quadInOut", "bounceOut", ...)
+bool easingFromName(const std::string& name, Easing& easing);
+
+// Native CFrame tweens. Each tween moves one model's local transform from where it was
+// when the tween started to a target, with an easing curve. Tweens are stored as
+// packed columns and advanced together once per frame: positions lerp and rotations
+// nlerp (as quaternions, along the shorter arc) four tweens at a time with SIMD.
+class TweenSystem {
+public:
+    struct Stats {
+        size_t tweens = 0;     // Running after the last update
+        size_t completed = 0;  // Completed in the last update
+        double microseconds = 0.0;
+    };
+
+    TweenSystem();
+
+    // Start tweening a row from its current local transform; replaces the row's running
+    // tween, if any. Returns the tween id.
+    uint32_t start(size_t row, const CFrame& from, const CFrame& to, float duration, Easing easing, TweenLoop loop);
+    // Stop a tween where it is; false when it is not running
+    bool cancel(uint32_t id);
+
+    // Keep the rows parallel to the model rows; tweens of a removed row are dropped
+    void removeRow(size_t index);
+    void clear();
+
+    // Advance every tween by seconds and write the results into the scene graph.
+    // Tweens that reached their target are listed by getCompleted until the next update.
+    void update(float seconds, SceneGraph& sceneGraph);
+
+    // Ids of the tweens completed by the last update, and their rows
+    const std::vector<uint32_t>& getCompleted() const { return completedIds; }
+    const std::vector<uint32_t>& getCompletedRows() const { return completedRows; }
+
+    size_t size() const { return ids.size(); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Float columns, one entry per tween
+    enum Lane {
+        FromX, FromY, FromZ,
+        ToX, ToY, ToZ,
+        FromQX, FromQY, FromQZ, FromQW,
+        ToQX, ToQY, ToQZ, ToQW,
+        LaneCount
+    };
+
+    void removeAt(size_t slot);
+    // Lerp/nlerp tweens [0, count) at the eased fractions into the output columns
+    void interpolate(size_t count);
+
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> rows;
+    std::vector<float> elapsed;
+    std::vector<float> durations;
+    std::vector<Easing> easings;
+    std::vector<TweenLoop> loops;
+    std::vector<float> lanes[LaneCount];
+    std::vector<int32_t> rowTweens;  // Slot per model row, -1 for none
+    uint32_t nextId;
+
+    // Scratch, rebuilt every update
+    std::vector<float> fractions;    // Eased, per tween
+    std::vector<float> outputs[7];   // Position x, y, z and rotation x, y, z, w columns
+    std::vector<uint32_t> finished;  // Slots of Once tweens that reached the target
+    std::vector<uint32_t> completedIds;
+    std::vector<uint32_t> completedRows;
+    Stats stats;
+};
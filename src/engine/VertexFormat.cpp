@@ -0,0 +1,433 @@
+#include "VertexFormat.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+size_t getAttributeSize(VertexComponentType type, int components) {
+    switch (type) {
+        case VertexComponentType::Float32: return 4 * components;
+        case VertexComponentType::Float16: return 2 * components;
+        case VertexComponentType::UNorm8:
+        case VertexComponentType::SNorm8: return components;
+        case VertexComponentType::Int2_10_10_10: return 4;
+    }
+    return 0;
+}
+
+VertexLayout::VertexLayout() : attributeCount(0), stride(0) {
+    addAttribute({VertexAttribute::Position, VertexComponentType::Float32, 3, false, 0});
+    addAttribute({VertexAttribute::Color, VertexComponentType::Float32, 3, false, 12});
+}
+
+VertexLayout VertexLayout::positionColor() {
+    return VertexLayout();
+}
+
+VertexLayout VertexLayout::compact() {
+    VertexLayout layout;
+    layout.clear();
+    // Position is padded to 4 halves so the color stays 4-byte aligned
+    layout.addAttribute({VertexAttribute::Position, VertexComponentType::Float16, 4, false, 0});
+    layout.addAttribute({VertexAttribute::Color, VertexComponentType::UNorm8, 4, true, 8});
+    return layout;
+}
+
+VertexLayout VertexLayout::compactNormal() {
+    VertexLayout layout = compact();
+    layout.addAttribute({VertexAttribute::Normal, VertexComponentType::Int2_10_10_10, 4, true, 12});
+    return layout;
+}
+
+VertexLayout VertexLayout::skinned() {
+    VertexLayout layout;
+    layout.clear();
+    layout.addAttribute({VertexAttribute::Position, VertexComponentType::Float32, 3, false, 0});
+    layout.addAttribute({VertexAttribute::Color, VertexComponentType::UNorm8, 4, true, 12});
+    layout.addAttribute({VertexAttribute::Normal, VertexComponentType::Int2_10_10_10, 4, true, 16});
+    layout.addAttribute({VertexAttribute::Joints, VertexComponentType::UNorm8, 4, false, 20});
+    layout.addAttribute({VertexAttribute::Weights, VertexComponentType::UNorm8, 4, true, 24});
+    return layout;
+}
+
+bool VertexLayout::fromName(const std::string& name, VertexLayout& layout) {
+    if (name == "float") {
+        layout = positionColor();
+    } else if (name == "compact") {
+        layout = compact();
+    } else if (name == "compact_normal") {
+        layout = compactNormal();
+    } else if (name == "skinned") {
+        layout = skinned();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void VertexLayout::clear() {
+    attributeCount = 0;
+    stride = 0;
+}
+
+bool VertexLayout::addAttribute(const VertexAttributeDesc& desc) {
+    if (attributeCount >= MaxAttributes || desc.components < 1 || desc.components > 4) {
+        return false;
+    }
+    if (desc.type == VertexComponentType::Int2_10_10_10 && desc.components != 4) {
+        return false;
+    }
+    if (find(desc.attribute)) {
+        return false;
+    }
+    attributes[attributeCount++] = desc;
+
+    uint32_t end = desc.offset + static_cast<uint32_t>(getAttributeSize(desc.type, desc.components));
+    end = (end + 3) & ~3u;
+    stride = std::max(stride, end);
+    return true;
+}
+
+bool VertexLayout::validate(std::string& error) const {
+    for (int i = 0; i < attributeCount; i++) {
+        const VertexAttributeDesc& a = attributes[i];
+        size_t end = a.offset + getAttributeSize(a.type, a.components);
+        if (end > stride) {
+            error = "attribute " + std::to_string(i + 1) + " ends at byte " + std::to_string(end) +
+                    ", past the stride of " + std::to_string(stride);
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            const VertexAttributeDesc& b = attributes[j];
+            size_t bEnd = b.offset + getAttributeSize(b.type, b.components);
+            if (a.offset < bEnd && b.offset < end) {
+                error = "attributes " + std::to_string(j + 1) + " and " + std::to_string(i + 1) + " overlap";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const VertexAttributeDesc* VertexLayout::find(VertexAttribute attribute) const {
+    for (int i = 0; i < attributeCount; i++) {
+        if (attributes[i].attribute == attribute) {
+            return &attributes[i];
+        }
+    }
+    return nullptr;
+}
+
+int getSourceComponents(VertexAttribute attribute) {
+    return attribute == VertexAttribute::Joints || attribute == VertexAttribute::Weights ? 4 : 3;
+}
+
+int VertexLayout::getSourceFloatsPerVertex() const {
+    int floats = 6;
+    for (VertexAttribute attribute : {VertexAttribute::Normal, VertexAttribute::Joints, VertexAttribute::Weights}) {
+        if (find(attribute)) {
+            floats += getSourceComponents(attribute);
+        }
+    }
+    return floats;
+}
+
+int VertexLayout::getSourceOffset(VertexAttribute attribute) const {
+    // Source vertices always hold position and color, then the optional attributes in enum order
+    if (attribute == VertexAttribute::Position) return 0;
+    if (attribute == VertexAttribute::Color) return 3;
+    if (!find(attribute)) return -1;
+    int offset = 6;
+    for (VertexAttribute before : {VertexAttribute::Normal, VertexAttribute::Joints}) {
+        if (before == attribute) break;
+        if (find(before)) {
+            offset += getSourceComponents(before);
+        }
+    }
+    return offset;
+}
+
+bool VertexLayout::operator==(const VertexLayout& other) const {
+    if (attributeCount != other.attributeCount || stride != other.stride) {
+        return false;
+    }
+    for (int i = 0; i < attributeCount; i++) {
+        const VertexAttributeDesc& a = attributes[i];
+        const VertexAttributeDesc& b = other.attributes[i];
+        if (a.attribute != b.attribute || a.type != b.type || a.components != b.components ||
+            a.normalized != b.normalized || a.offset != b.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t absBits = bits & 0x7fffffff;
+
+    if (absBits >= 0x7f800000) {
+        // Inf or NaN
+        return static_cast<uint16_t>(sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0));
+    }
+    if (absBits >= 0x477ff000) {
+        // Rounds past the largest half
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    if (absBits < 0x38800000) {
+        // Subnormal half (or zero): let the FPU do the rounding
+        float absValue;
+        std::memcpy(&absValue, &absBits, sizeof(absValue));
+        absValue += 0.5f;
+        uint32_t rounded;
+        std::memcpy(&rounded, &absValue, sizeof(rounded));
+        return static_cast<uint16_t>(sign | (rounded - 0x3f000000));
+    }
+
+    // Normal half with round-to-nearest-even
+    uint32_t mantOdd = (absBits >> 13) & 1;
+    absBits += 0xc8000fff + mantOdd;
+    return static_cast<uint16_t>(sign | (absBits >> 13));
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        // Zero or subnormal
+        float result = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -result : result;
+    }
+    if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+namespace {
+
+inline float clampUnit(float v) { return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v); }
+inline float clampSigned(float v) { return v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v); }
+
+// Pack signed normalized x/y/z into GL_INT_2_10_10_10_REV order
+inline uint32_t packInt2_10_10_10(const float* v) {
+    auto snorm10 = [](float f) -> uint32_t {
+        int i = static_cast<int>(std::lround(clampSigned(f) * 511.0f));
+        return static_cast<uint32_t>(i) & 0x3ff;
+    };
+    return snorm10(v[0]) | (snorm10(v[1]) << 10) | (snorm10(v[2]) << 20);
+}
+
+inline float unpackSigned10(uint32_t bits) {
+    int v = static_cast<int>(bits << 22) >> 22;
+    return std::max(static_cast<float>(v) / 511.0f, -1.0f);
+}
+
+} // namespace
+
+void packAttribute(const VertexAttributeDesc& desc, const float values[4], uint8_t* dst) {
+    switch (desc.type) {
+        case VertexComponentType::Float32:
+            std::memcpy(dst, values, 4 * desc.components);
+            break;
+        case VertexComponentType::Float16:
+            for (int c = 0; c < desc.components; c++) {
+                uint16_t h = floatToHalf(values[c]);
+                std::memcpy(dst + 2 * c, &h, sizeof(h));
+            }
+            break;
+        case VertexComponentType::UNorm8:
+            for (int c = 0; c < desc.components; c++) {
+                float v = desc.normalized ? clampUnit(values[c]) * 255.0f : std::min(std::max(values[c], 0.0f), 255.0f);
+                dst[c] = static_cast<uint8_t>(std::lround(v));
+            }
+            break;
+        case VertexComponentType::SNorm8:
+            for (int c = 0; c < desc.components; c++) {
+                float v = desc.normalized ? clampSigned(values[c]) * 127.0f : std::min(std::max(values[c], -128.0f), 127.0f);
+                dst[c] = static_cast<uint8_t>(static_cast<int8_t>(std::lround(v)));
+            }
+            break;
+        case VertexComponentType::Int2_10_10_10: {
+            uint32_t packed = packInt2_10_10_10(values);
+            std::memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+    }
+}
+
+namespace {
+
+#if defined(L3D_SSE2)
+// Four floats to four halves (round-to-nearest-even), result in the low 16 bits of each lane
+inline __m128i floatToHalf4(__m128 f) {
+#if defined(L3D_F16C)
+    return _mm_cvtepu16_epi32(_mm_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+#else
+    const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+    __m128 justSign = _mm_and_ps(_mm_set1_ps(-0.0f), f);
+    __m128 absF = _mm_xor_ps(f, justSign);
+    __m128i absBits = _mm_castps_si128(absF);
+    __m128 isNaN = _mm_cmpunord_ps(absF, absF);
+    __m128i isRegular = _mm_cmpgt_epi32(f16max, absBits);
+    __m128i infOrNaN = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNaN), nanBit), infinity);
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absBits);
+
+    __m128 subnormal1 = _mm_add_ps(absF, _mm_castsi128_ps(subnormMagic));
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormal1), subnormMagic);
+
+    __m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), mantOdd), 13);
+
+    __m128i nonSpecial = _mm_or_si128(_mm_and_si128(subnormal, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+    __m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, infOrNaN));
+    return _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(justSign), 16));
+#endif
+}
+
+inline void storeHalf4(__m128 f, uint8_t* dst, int components) {
+    __m128i lanes = floatToHalf4(f);
+    // Sign-extend so the signed saturating pack keeps the bit pattern intact
+    lanes = _mm_srai_epi32(_mm_slli_epi32(lanes, 16), 16);
+    __m128i packed = _mm_packs_epi32(lanes, lanes);
+    alignas(16) uint16_t halves[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(halves), packed);
+    std::memcpy(dst, halves, 2 * components);
+}
+
+inline void storeUNorm8x4(__m128 f, uint8_t* dst, int components) {
+    __m128 scaled = _mm_mul_ps(_mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(1.0f)), _mm_set1_ps(255.0f));
+    __m128i ints = _mm_cvtps_epi32(scaled);
+    __m128i words = _mm_packs_epi32(ints, ints);
+    __m128i bytes = _mm_packus_epi16(words, words);
+    uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+    std::memcpy(dst, &packed, components);
+}
+#elif defined(L3D_NEON)
+inline void storeHalf4(float32x4_t f, uint8_t* dst, int components) {
+    uint16_t halves[4];
+    vst1_u16(halves, vreinterpret_u16_f16(vcvt_f16_f32(f)));
+    std::memcpy(dst, halves, 2 * components);
+}
+
+inline void storeUNorm8x4(float32x4_t f, uint8_t* dst, int components) {
+    float32x4_t scaled = vmulq_n_f32(vminq_f32(vmaxq_f32(f, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f)), 255.0f);
+    uint32x4_t ints = vcvtnq_u32_f32(scaled);
+    uint8x8_t bytes = vmovn_u16(vcombine_u16(vmovn_u32(ints), vmovn_u32(ints)));
+    uint8_t out[8];
+    vst1_u8(out, bytes);
+    std::memcpy(dst, out, components);
+}
+#endif
+
+} // namespace
+
+void packVertices(const VertexLayout& layout, const float* src, size_t vertexCount, uint8_t* dst) {
+    const int srcStride = layout.getSourceFloatsPerVertex();
+    const uint32_t dstStride = layout.getStride();
+
+    if (dstStride == 0 || vertexCount == 0) {
+        return;
+    }
+    std::memset(dst, 0, vertexCount * dstStride);
+
+    for (int a = 0; a < layout.getAttributeCount(); a++) {
+        const VertexAttributeDesc& desc = layout.getAttribute(a);
+        const int srcOffset = layout.getSourceOffset(desc.attribute);
+        const bool fourComponents = getSourceComponents(desc.attribute) == 4;
+        // Three-component sources get an implicit w: 1 for points and colors, 0 for normals
+        const float w = desc.attribute == VertexAttribute::Normal ? 0.0f : 1.0f;
+
+        const float* in = src + srcOffset;
+        uint8_t* out = dst + desc.offset;
+
+#if defined(L3D_SSE2) || defined(L3D_NEON)
+        if (desc.type == VertexComponentType::Float16 ||
+            (desc.type == VertexComponentType::UNorm8 && desc.normalized)) {
+            const bool half = desc.type == VertexComponentType::Float16;
+            for (size_t i = 0; i < vertexCount; i++, in += srcStride, out += dstStride) {
+#if defined(L3D_SSE2)
+                __m128 v = _mm_setr_ps(in[0], in[1], in[2], fourComponents ? in[3] : w);
+#else
+                float lanes[4] = {in[0], in[1], in[2], fourComponents ? in[3] : w};
+                float32x4_t v = vld1q_f32(lanes);
+#endif
+                if (half) {
+                    storeHalf4(v, out, desc.components);
+                } else {
+                    storeUNorm8x4(v, out, desc.components);
+                }
+            }
+            continue;
+        }
+#endif
+
+        for (size_t i = 0; i < vertexCount; i++, in += srcStride, out += dstStride) {
+            float values[4] = {in[0], in[1], in[2], fourComponents ? in[3] : w};
+            packAttribute(desc, values, out);
+        }
+    }
+}
+
+bool unpackAttribute(const VertexLayout& layout, const uint8_t* data, size_t vertexIndex,
+                     VertexAttribute attribute, float out[4]) {
+    const VertexAttributeDesc* desc = layout.find(attribute);
+    if (!desc) {
+        return false;
+    }
+
+    out[0] = out[1] = out[2] = 0.0f;
+    out[3] = 1.0f;
+    const uint8_t* src = data + vertexIndex * layout.getStride() + desc->offset;
+
+    switch (desc->type) {
+        case VertexComponentType::Float32:
+            std::memcpy(out, src, 4 * desc->components);
+            break;
+        case VertexComponentType::Float16:
+            for (int c = 0; c < desc->components; c++) {
+                uint16_t h;
+                std::memcpy(&h, src + 2 * c, sizeof(h));
+                out[c] = halfToFloat(h);
+            }
+            break;
+        case VertexComponentType::UNorm8:
+            for (int c = 0; c < desc->components; c++) {
+                out[c] = desc->normalized ? src[c] / 255.0f : static_cast<float>(src[c]);
+            }
+            break;
+        case VertexComponentType::SNorm8:
+            for (int c = 0; c < desc->components; c++) {
+                int8_t v = static_cast<int8_t>(src[c]);
+                out[c] = desc->normalized ? std::max(v / 127.0f, -1.0f) : static_cast<float>(v);
+            }
+            break;
+        case VertexComponentType::Int2_10_10_10: {
+            uint32_t packed;
+            std::memcpy(&packed, src, sizeof(packed));
+            out[0] = unpackSigned10(packed & 0x3ff);
+            out[1] = unpackSigned10((packed >> 10) & 0x3ff);
+            out[2] = unpackSigned10((packed >> 20) & 0x3ff);
+            out[3] = static_cast<float>(static_cast<int>(packed) >> 30);
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Semantic meaning of a vertex attribute
+enum class VertexAttribute : uint8_t {
+    Position,
+    Color,
+    Normal,
+    Joints,   // Up to 4 skeleton joint indices (non-normalized UNorm8)
+    Weights,  // Matching joint weights
+};
+
+// Storage type of a vertex attribute
+enum class VertexComponentType : uint8_t {
+    Float32,        // 4 bytes per component
+    Float16,        // 2 bytes per component (IEEE half)
+    UNorm8,         // 1 byte per component, maps to [0, 1]
+    SNorm8,         // 1 byte per component, maps to [-1, 1]
+    Int2_10_10_10,  // 4 bytes total, signed 10:10:10:2 packed (x in the low bits)
+};
+
+// Describes where and how one attribute is stored inside a vertex
+struct VertexAttributeDesc {
+    VertexAttribute attribute;
+    VertexComponentType type;
+    uint8_t components;  // Number of components stored (1-4)
+    bool normalized;     // Integer types are mapped to [0, 1] / [-1, 1]
+    uint16_t offset;     // Byte offset from the start of the vertex
+};
+
+// Size in bytes of an attribute described by type and component count
+size_t getAttributeSize(VertexComponentType type, int components);
+
+class VertexLayout {
+public:
+    static const int MaxAttributes = 6;
+
+    // Defaults to the legacy float position + float color layout
+    VertexLayout();
+
+    // Built-in layouts
+    static VertexLayout positionColor();  // f32x3 position, f32x3 color (24 bytes)
+    static VertexLayout compact();        // f16x4 position, unorm8x4 color (12 bytes)
+    static VertexLayout compactNormal();  // compact + 10:10:10:2 normal (16 bytes)
+    // f32x3 position, unorm8x4 color, 10:10:10:2 normal, u8x4 joints, unorm8x4 weights (28 bytes)
+    static VertexLayout skinned();
+
+    // Look up a built-in layout by name ("float", "compact", "compact_normal", "skinned")
+    static bool fromName(const std::string& name, VertexLayout& layout);
+
+    // Remove all attributes
+    void clear();
+
+    // Append an attribute; returns false if the layout is full or the description is invalid
+    bool addAttribute(const VertexAttributeDesc& desc);
+
+    // Override the stride (defaults to the end of the last attribute rounded up to 4 bytes).
+    // Call validate() afterwards when the value comes from outside.
+    void setStride(uint32_t value) { stride = value; }
+
+    // Check every attribute ends within the stride and no two attributes overlap, so
+    // packVertices stays inside each vertex. Describes the first problem in error.
+    bool validate(std::string& error) const;
+
+    // Find an attribute, or nullptr if the layout does not contain it
+    const VertexAttributeDesc* find(VertexAttribute attribute) const;
+
+    int getAttributeCount() const { return attributeCount; }
+    const VertexAttributeDesc& getAttribute(int i) const { return attributes[i]; }
+    uint32_t getStride() const { return stride; }
+
+    // Floats per vertex expected in script-side vertex arrays:
+    // position (3), color (3) and, if the layout has them, normal (3), joints (4), weights (4)
+    int getSourceFloatsPerVertex() const;
+    // Where an attribute starts within a script-side vertex, or -1 if the layout lacks it
+    int getSourceOffset(VertexAttribute attribute) const;
+
+    bool operator==(const VertexLayout& other) const;
+    bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+
+private:
+    VertexAttributeDesc attributes[MaxAttributes];
+    int attributeCount;
+    uint32_t stride;
+};
+
+// Half-precision helpers
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+// Script-side floats of an attribute: 4 for joints and weights, 3 otherwise
+int getSourceComponents(VertexAttribute attribute);
+
+// Write one attribute of one vertex from up to 4 floats
+void packAttribute(const VertexAttributeDesc& desc, const float values[4], uint8_t* dst);
+
+// Convert interleaved source floats (see getSourceFloatsPerVertex) into the packed layout.
+// dst must hold vertexCount * layout.getStride() bytes.
+void packVertices(const VertexLayout& layout, const float* src, size_t vertexCount, uint8_t* dst);
+
+// Decode one attribute of one packed vertex back to floats. Missing components are
+// filled with 0 (and 1 for the fourth). Returns false if the layout lacks the attribute.
+bool unpackAttribute(const VertexLayout& layout, const uint8_t* data, size_t vertexIndex,
+                     VertexAttribute attribute, float out[4]);
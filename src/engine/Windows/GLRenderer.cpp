@@ -1,16 +1,56 @@
 #include "GLRenderer.h"
 #include "GUI.h"
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <string>
 
-GLRenderer::GLRenderer(IGUI* gui) : gui(gui), hrc(nullptr) {
+// Vertex types from GL 3.x that fixed-function pointers accept on compatibility contexts
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_INT_2_10_10_10_REV
+#define GL_INT_2_10_10_10_REV 0x8D9F
+#endif
+
+// Pixel pack buffer enums from GL 1.5 / 2.1
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+
+// Map an engine vertex component type to its GL equivalent
+static GLenum toGLType(VertexComponentType type) {
+    switch (type) {
+        case VertexComponentType::Float32: return GL_FLOAT;
+        case VertexComponentType::Float16: return GL_HALF_FLOAT;
+        case VertexComponentType::UNorm8: return GL_UNSIGNED_BYTE;
+        case VertexComponentType::SNorm8: return GL_BYTE;
+        case VertexComponentType::Int2_10_10_10: return GL_INT_2_10_10_10_REV;
+    }
+    return GL_FLOAT;
+}
+
+GLRenderer::GLRenderer(IGUI* gui) : bufferAge(0), frameCounter(0), readbackNext(0), hrc(nullptr), gui(gui) {
     clearColor[0] = 0.0f;
     clearColor[1] = 0.0f;
     clearColor[2] = 0.0f;
     clearColor[3] = 1.0f;
+    for (int slot = 0; slot < MaxLights; slot++) {
+        boundLights[slot] = -1;
+    }
 }
 
 GLRenderer::~GLRenderer() {
     if (hrc) {
+        for (Readback& readback : readbacks) {
+            if (readback.pbo) buffers.deleteBuffers(1, &readback.pbo);
+        }
         wglMakeCurrent(nullptr, nullptr);
         wglDeleteContext(hrc);
     }
@@ -33,6 +73,19 @@ bool GLRenderer::initialize() {
         return false;
     }
 
+    loadBufferFunctions();
+
+    // Partial redraws need to know what the back buffer holds after a swap
+    PIXELFORMATDESCRIPTOR pfd = {};
+    DescribePixelFormat(hdc, GetPixelFormat(hdc), sizeof(pfd), &pfd);
+    if (pfd.dwFlags & PFD_SWAP_COPY) {
+        bufferAge = 1;
+    } else if (pfd.dwFlags & PFD_SWAP_EXCHANGE) {
+        bufferAge = 2;
+    } else {
+        bufferAge = 0;
+    }
+
     // Enable only point smoothing
     glEnable(GL_POINT_SMOOTH);
     glHint(GL_POINT_SMOOTH_HINT, GL_NICEST);
@@ -54,6 +107,29 @@ bool GLRenderer::initialize() {
     return true;
 }
 
+void GLRenderer::loadBufferFunctions() {
+    // Core names first, then the ARB_vertex_buffer_object ones. Returned as void (*)(),
+    // which converts to any function pointer type without a warning.
+    auto load = [](const char* name) -> void (*)() {
+        PROC function = wglGetProcAddress(name);
+        if (!function) function = wglGetProcAddress((std::string(name) + "ARB").c_str());
+        return reinterpret_cast<void (*)()>(function);
+    };
+    BufferFunctions loaded;
+    loaded.genBuffers = reinterpret_cast<decltype(loaded.genBuffers)>(load("glGenBuffers"));
+    loaded.deleteBuffers = reinterpret_cast<decltype(loaded.deleteBuffers)>(load("glDeleteBuffers"));
+    loaded.bindBuffer = reinterpret_cast<decltype(loaded.bindBuffer)>(load("glBindBuffer"));
+    loaded.bufferData = reinterpret_cast<decltype(loaded.bufferData)>(load("glBufferData"));
+    loaded.mapBuffer = reinterpret_cast<decltype(loaded.mapBuffer)>(load("glMapBuffer"));
+    loaded.unmapBuffer = reinterpret_cast<decltype(loaded.unmapBuffer)>(load("glUnmapBuffer"));
+    if (loaded.genBuffers && loaded.deleteBuffers && loaded.bindBuffer && loaded.bufferData &&
+        loaded.mapBuffer && loaded.unmapBuffer) {
+        buffers = loaded;
+    } else {
+        std::cerr << "No OpenGL buffer objects; frame capture reads back synchronously" << std::endl;
+    }
+}
+
 void GLRenderer::beginFrame() {
 }
 
@@ -65,7 +141,27 @@ void GLRenderer::endFrame() {
 
 void GLRenderer::clear() {
     glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (damage.empty()) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return;
+    }
+    glEnable(GL_SCISSOR_TEST);
+    for (const ScreenRect& rect : damage) {
+        scissor(rect);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void GLRenderer::scissor(const ScreenRect& rect) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    // Round outwards so neighbouring rectangles share their edge pixels
+    GLint x0 = viewport[0] + static_cast<GLint>(rect.minX * viewport[2]);
+    GLint y0 = viewport[1] + static_cast<GLint>(rect.minY * viewport[3]);
+    GLint x1 = viewport[0] + static_cast<GLint>(std::ceil(rect.maxX * viewport[2]));
+    GLint y1 = viewport[1] + static_cast<GLint>(std::ceil(rect.maxY * viewport[3]));
+    glScissor(x0, y0, x1 - x0, y1 - y0);
 }
 
 void GLRenderer::setClearColor(float r, float g, float b, float a) {
@@ -83,96 +179,218 @@ void GLRenderer::enableLighting(bool enable) {
     }
 }
 
-void GLRenderer::render(const std::vector<Model>& models) {
+void GLRenderer::render(const std::vector<DrawItem>& items) {
+    frameCounter++;
+    if (damage.empty()) {
+        drawItems(items);
+        return;
+    }
+    // Items were already limited to those touching the damage; each pass only fills its rectangle
+    glEnable(GL_SCISSOR_TEST);
+    for (const ScreenRect& rect : damage) {
+        scissor(rect);
+        drawItems(items);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void GLRenderer::drawItems(const std::vector<DrawItem>& items) {
     // Enable vertex arrays for both position and color
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_COLOR_ARRAY);
+    bool normalArrayEnabled = false;
     
     // Set up the modelview matrix
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     
-    // Render all visible models
-    for (const auto& model : models) {
-        if (!model.visible) continue;
+    // Render the draw list; it only holds visible models with geometry
+    for (const DrawItem& item : items) {
+        const Mesh& mesh = *item.mesh;
+        const CFrame& cframe = item.cframe;
+
+        // Light positions are transformed by the modelview matrix, so bind before the model's transform
+        bindLights(item);
         
         // Apply CFrame transform
         glPushMatrix();
         
         // Translate to position
-        glTranslatef(model.cframe.position[0], model.cframe.position[1], model.cframe.position[2]);
+        glTranslatef(cframe.position[0], cframe.position[1], cframe.position[2]);
         
         // Create rotation matrix from look, up, and right vectors
         float matrix[16] = {
-            model.cframe.right[0], model.cframe.up[0], -model.cframe.look[0], 0.0f,
-            model.cframe.right[1], model.cframe.up[1], -model.cframe.look[1], 0.0f,
-            model.cframe.right[2], model.cframe.up[2], -model.cframe.look[2], 0.0f,
+            cframe.right[0], cframe.up[0], -cframe.look[0], 0.0f,
+            cframe.right[1], cframe.up[1], -cframe.look[1], 0.0f,
+            cframe.right[2], cframe.up[2], -cframe.look[2], 0.0f,
             0.0f, 0.0f, 0.0f, 1.0f
         };
         glMultMatrixf(matrix);
         
-        const float* data = model.vertices.data();
-        // Stride is 6 floats (3 for position, 3 for color)
-        glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), data);
-        // Color data starts 3 floats after each vertex
-        glColorPointer(3, GL_FLOAT, 6 * sizeof(float), data + 3);
+        // Point the fixed-function arrays straight at the packed vertex data
+        const uint8_t* data = mesh.getVertexData();
+        const GLsizei stride = static_cast<GLsizei>(mesh.layout.getStride());
+        const VertexAttributeDesc* position = mesh.layout.find(VertexAttribute::Position);
+        const VertexAttributeDesc* color = mesh.layout.find(VertexAttribute::Color);
+        const VertexAttributeDesc* normal = mesh.layout.find(VertexAttribute::Normal);
+
+        glVertexPointer(position->components, toGLType(position->type), stride, data + position->offset);
+        if (color) {
+            glEnableClientState(GL_COLOR_ARRAY);
+            glColorPointer(color->components, toGLType(color->type), stride, data + color->offset);
+        } else {
+            glDisableClientState(GL_COLOR_ARRAY);
+            glColor3f(1.0f, 1.0f, 1.0f);
+        }
+        if (normal) {
+            if (!normalArrayEnabled) {
+                glEnableClientState(GL_NORMAL_ARRAY);
+                normalArrayEnabled = true;
+            }
+            glNormalPointer(toGLType(normal->type), stride, data + normal->offset);
+        } else if (normalArrayEnabled) {
+            glDisableClientState(GL_NORMAL_ARRAY);
+            normalArrayEnabled = false;
+        }
         
-        glDrawArrays(GL_TRIANGLES, 0, model.vertices.size() / 6);
+        if (!mesh.isIndexed()) {
+            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh.vertexCount));
+        } else {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.getIndexCount()), GL_UNSIGNED_INT, mesh.getIndexData());
+        }
         
         glPopMatrix();
     }
     
+    if (normalArrayEnabled) {
+        glDisableClientState(GL_NORMAL_ARRAY);
+    }
     glDisableClientState(GL_COLOR_ARRAY);
     glDisableClientState(GL_VERTEX_ARRAY);
 }
 
-void GLRenderer::setLight(int lightNum, const LightProperties& properties) {
-    if (lightNum < 0 || lightNum > 7) return;
-    GLenum light = GL_LIGHT0 + lightNum;
-    
-    // Helper function to set float array
-    auto setFloatArray = [light](GLenum param, const std::vector<float>& values, int minSize, int maxSize) {
-        if (values.size() >= minSize && values.size() <= maxSize) {
-            float data[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+void GLRenderer::setLights(const std::vector<LightProperties>& lights) {
+    this->lights = lights;
+    // Slots may hold stale copies of the old list
+    for (int slot = 0; slot < MaxLights; slot++) {
+        boundLights[slot] = -1;
+        glDisable(GL_LIGHT0 + slot);
+    }
+}
+
+void GLRenderer::bindLights(const DrawItem& item) {
+    int count = static_cast<int>(item.lightCount < MaxLights ? item.lightCount : MaxLights);
+    for (int slot = 0; slot < MaxLights; slot++) {
+        int light = slot < count ? static_cast<int>(item.lights[slot]) : -1;
+        if (light == boundLights[slot]) continue;
+        if (light < 0) {
+            glDisable(GL_LIGHT0 + slot);
+        } else {
+            applyLight(slot, lights[light]);
+            if (boundLights[slot] < 0) glEnable(GL_LIGHT0 + slot);
+        }
+        boundLights[slot] = light;
+    }
+}
+
+void GLRenderer::applyLight(int slot, const LightProperties& properties) {
+    GLenum light = GL_LIGHT0 + slot;
+
+    // Slots are shared between lights, so every parameter is set; missing ones get the
+    // GL_LIGHT0 defaults
+    auto setFloatArray = [light](GLenum param, const std::vector<float>& values, int minSize, int maxSize,
+                                 const float* defaults) {
+        float data[4] = {defaults[0], defaults[1], defaults[2], defaults[3]};
+        if (values.size() >= static_cast<size_t>(minSize) && values.size() <= static_cast<size_t>(maxSize)) {
             for (size_t i = 0; i < values.size(); i++) {
                 data[i] = values[i];
             }
-            glLightfv(light, param, data);
         }
+        glLightfv(light, param, data);
     };
-    
-    // Set light properties
-    if (!properties.position.empty()) {
-        setFloatArray(GL_POSITION, properties.position, 3, 4);
-    }
-    if (!properties.ambient.empty()) {
-        setFloatArray(GL_AMBIENT, properties.ambient, 3, 4);
-    }
-    if (!properties.diffuse.empty()) {
-        setFloatArray(GL_DIFFUSE, properties.diffuse, 3, 4);
-    }
-    if (!properties.specular.empty()) {
-        setFloatArray(GL_SPECULAR, properties.specular, 3, 4);
-    }
-    if (!properties.spotDirection.empty()) {
-        setFloatArray(GL_SPOT_DIRECTION, properties.spotDirection, 3, 3);
+    static const float defaultPosition[4] = {0.0f, 0.0f, 1.0f, 0.0f};
+    static const float pointPosition[4] = {0.0f, 0.0f, 0.0f, 1.0f};  // xyz positions are point lights
+    static const float defaultAmbient[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    static const float defaultColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const float defaultDirection[4] = {0.0f, 0.0f, -1.0f, 0.0f};
+
+    setFloatArray(GL_POSITION, properties.position, 3, 4, properties.position.size() == 3 ? pointPosition : defaultPosition);
+    setFloatArray(GL_AMBIENT, properties.ambient, 3, 4, defaultAmbient);
+    setFloatArray(GL_DIFFUSE, properties.diffuse, 3, 4, defaultColor);
+    setFloatArray(GL_SPECULAR, properties.specular, 3, 4, defaultColor);
+    setFloatArray(GL_SPOT_DIRECTION, properties.spotDirection, 3, 3, defaultDirection);
+
+    glLightf(light, GL_SPOT_EXPONENT, properties.spotExponent >= 0.0f ? properties.spotExponent : 0.0f);
+    glLightf(light, GL_SPOT_CUTOFF, properties.spotCutoff >= 0.0f ? properties.spotCutoff : 180.0f);
+    glLightf(light, GL_CONSTANT_ATTENUATION, properties.constantAttenuation >= 0.0f ? properties.constantAttenuation : 1.0f);
+    glLightf(light, GL_LINEAR_ATTENUATION, properties.linearAttenuation >= 0.0f ? properties.linearAttenuation : 0.0f);
+    glLightf(light, GL_QUADRATIC_ATTENUATION, properties.quadraticAttenuation >= 0.0f ? properties.quadraticAttenuation : 0.0f);
+}
+
+bool GLRenderer::readPixels(std::vector<uint8_t>& pixels, int& width, int& height) {
+    // Errors left by earlier calls must not fail this read
+    glGetError();
+
+    // The viewport covers the whole back buffer
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) {
+        return false;
     }
-    
-    if (properties.spotExponent >= 0.0f) {
-        glLightf(light, GL_SPOT_EXPONENT, properties.spotExponent);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    if (!buffers.mapBuffer) {
+        width = viewport[2];
+        height = viewport[3];
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return glGetError() == GL_NO_ERROR;
     }
-    if (properties.spotCutoff >= 0.0f) {
-        glLightf(light, GL_SPOT_CUTOFF, properties.spotCutoff);
+
+    // Start this frame's transfer; glReadPixels into a bound pack buffer returns at once
+    Readback& current = readbacks[readbackNext];
+    readbackNext = (readbackNext + 1) % ReadbackRing;
+    if (!current.pbo) buffers.genBuffers(1, &current.pbo);
+    buffers.bindBuffer(GL_PIXEL_PACK_BUFFER, current.pbo);
+    if (current.width != viewport[2] || current.height != viewport[3]) {
+        current.width = viewport[2];
+        current.height = viewport[3];
+        buffers.bufferData(GL_PIXEL_PACK_BUFFER, static_cast<ptrdiff_t>(current.width) * current.height * 4, nullptr,
+                           GL_STREAM_READ);
     }
-    if (properties.constantAttenuation >= 0.0f) {
-        glLightf(light, GL_CONSTANT_ATTENUATION, properties.constantAttenuation);
+    glReadPixels(0, 0, current.width, current.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    buffers.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        current.filled = false;
+        return false;
     }
-    if (properties.linearAttenuation >= 0.0f) {
-        glLightf(light, GL_LINEAR_ATTENUATION, properties.linearAttenuation);
+    current.filled = true;
+    current.frame = frameCounter;
+
+    // The oldest buffer in the ring finished transferring while later frames rendered.
+    // Use it when it holds a recent frame; after a gap in the reads it is stale, so wait
+    // for the current frame instead.
+    Readback& oldest = readbacks[readbackNext];
+    if (&oldest != &current && oldest.filled && frameCounter - oldest.frame < ReadbackRing) {
+        return mapReadback(oldest, pixels, width, height);
     }
-    if (properties.quadraticAttenuation >= 0.0f) {
-        glLightf(light, GL_QUADRATIC_ATTENUATION, properties.quadraticAttenuation);
+    return mapReadback(current, pixels, width, height);
+}
+
+bool GLRenderer::mapReadback(Readback& readback, std::vector<uint8_t>& pixels, int& width, int& height) {
+    // Each frame is handed out once
+    readback.filled = false;
+    width = readback.width;
+    height = readback.height;
+    size_t size = static_cast<size_t>(width) * height * 4;
+    buffers.bindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    const void* data = buffers.mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data) {
+        pixels.resize(size);
+        memcpy(pixels.data(), data, size);
+        buffers.unmapBuffer(GL_PIXEL_PACK_BUFFER);
     }
-    
-    glEnable(light);
+    buffers.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return data != nullptr && glGetError() == GL_NO_ERROR;
 }
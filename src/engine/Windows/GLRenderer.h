@@ -31,14 +31,67 @@ public:
     int getHeight() const override { return height; }
 
     // Light management
-    void setLight(int lightNum, const LightProperties& properties) override;
+    void setLights(const std::vector<LightProperties>& lights) override;
     void enableLighting(bool enable) override;
 
+    // Vertex arrays point straight at mesh memory, so in-place writes need no upload
+    void updateMeshes(const std::vector<MeshUpdate>& updates) override {}
+    // Draws from client memory, so there are no copies to drop
+    void releaseMeshes(const std::vector<const Mesh*>& meshes) override {}
+
     // Render all visible models
-    void render(const std::vector<Model>& models) override;
+    void render(const std::vector<DrawItem>& items) override;
+
+    // Damage: clear and render run once per rectangle, scissored to it
+    int getBufferAge() const override { return bufferAge; }
+    void setDamage(const std::vector<ScreenRect>& rects) override { damage = rects; }
+
+    // Read back the back buffer through a ring of pixel pack buffers. While reads come
+    // every frame, this returns the frame rendered ReadbackRing - 1 frames earlier
+    // without waiting on the GPU; otherwise it waits for the current frame. Drivers
+    // without GL 1.5 buffer objects read synchronously.
+    bool readPixels(std::vector<uint8_t>& pixels, int& width, int& height) override;
 
 private:
+    // Fixed-function lighting has 8 light slots; draw items bind their lights into them
+    static const int MaxLights = 8;
+    void bindLights(const DrawItem& item);
+    void applyLight(int slot, const LightProperties& properties);
+    void drawItems(const std::vector<DrawItem>& items);
+    // Scissor to a damage rectangle in window pixels
+    void scissor(const ScreenRect& rect);
+
     float clearColor[4];
+    std::vector<LightProperties> lights;
+    int boundLights[MaxLights];  // Light index in each slot, -1 when disabled
+    std::vector<ScreenRect> damage;
+    int bufferAge;  // From the pixel format's swap method
+    uint64_t frameCounter;
+
+    // GL 1.5 buffer entry points, which opengl32.dll does not export; loaded in
+    // initialize and null when the driver lacks them
+    struct BufferFunctions {
+        void (APIENTRY* genBuffers)(GLsizei, GLuint*) = nullptr;
+        void (APIENTRY* deleteBuffers)(GLsizei, const GLuint*) = nullptr;
+        void (APIENTRY* bindBuffer)(GLenum, GLuint) = nullptr;
+        void (APIENTRY* bufferData)(GLenum, ptrdiff_t, const void*, GLenum) = nullptr;
+        void* (APIENTRY* mapBuffer)(GLenum, GLenum) = nullptr;
+        GLboolean (APIENTRY* unmapBuffer)(GLenum) = nullptr;
+    };
+    BufferFunctions buffers;
+    void loadBufferFunctions();
+
+    // Pixel pack buffer readPixels started a transfer into
+    struct Readback {
+        GLuint pbo = 0;
+        int width = 0, height = 0;
+        bool filled = false;
+        uint64_t frame = 0;  // frameCounter when filled
+    };
+    static constexpr int ReadbackRing = 3;
+    Readback readbacks[ReadbackRing];
+    int readbackNext;
+    bool mapReadback(Readback& readback, std::vector<uint8_t>& pixels, int& width, int& height);
     HGLRC hrc;
     IGUI* gui;
     int width;
@@ -3,13 +3,18 @@
 #include <windows.h>
 #include "lua.h"
 #include "lualib.h"
+#include "../Trace.h"
 #include <iostream>
 
-// Initialize global instance pointer
-static GUI* g_gui = nullptr;
-
-// Window procedure callback
+// Window procedure callback. Each window keeps its GUI in GWLP_USERDATA, set from the
+// creation parameter.
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    if (uMsg == WM_NCCREATE) {
+        CREATESTRUCT* create = reinterpret_cast<CREATESTRUCT*>(lParam);
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(create->lpCreateParams));
+    }
+    GUI* gui = reinterpret_cast<GUI*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+
     switch (uMsg) {
         case WM_CLOSE:
             PostQuitMessage(0);
@@ -17,7 +22,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
         case WM_KEYDOWN:
         case WM_KEYUP:
-            if (g_gui) {
+            if (gui) {
                 // Convert virtual key code to string
                 char keyName[32];
                 if (GetKeyNameTextA(lParam, keyName, sizeof(keyName)) > 0) {
@@ -26,7 +31,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                         *p = tolower(*p);
                     }
                     // Forward the event to the GUI module
-                    g_gui->handleKeyEvent(std::string(keyName), uMsg == WM_KEYDOWN ? "press" : "release");
+                    gui->handleKeyEvent(std::string(keyName), uMsg == WM_KEYDOWN ? "press" : "release");
                 }
             }
             return 0;
@@ -35,11 +40,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 }
 
 GUI::GUI(LuauBinding* luauBinding) : luauBinding(luauBinding), width(0), height(0), hwnd(nullptr), hdc(nullptr), windowOpen(true) {
-    g_gui = this;
 }
 
 GUI::~GUI() {
-    g_gui = nullptr;
     if (hwnd) {
         ReleaseDC(hwnd, hdc);
         hdc = nullptr;
@@ -61,7 +64,8 @@ bool GUI::initialize(const std::string& windowTitle, int width, int height) {
     wc.lpszClassName = "Luau3DWindow";
     wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
     
-    if (!RegisterClassEx(&wc)) {
+    // The class outlives its first window; later engines reuse it
+    if (!RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
         std::cerr << "Failed to register window class" << std::endl;
         return false;
     }
@@ -77,7 +81,7 @@ bool GUI::initialize(const std::string& windowTitle, int width, int height) {
         nullptr,
         nullptr,
         GetModuleHandle(nullptr),
-        nullptr
+        this
     );
 
     if (!hwnd) {
@@ -92,7 +96,8 @@ bool GUI::initialize(const std::string& windowTitle, int width, int height) {
     PIXELFORMATDESCRIPTOR pfd = {};
     pfd.nSize = sizeof(PIXELFORMATDESCRIPTOR);
     pfd.nVersion = 1;
-    pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+    // Ask for swaps that keep the back buffer so unchanged regions need no redraw
+    pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER | PFD_SWAP_COPY;
     pfd.iPixelType = PFD_TYPE_RGBA;
     pfd.cColorBits = 32;
     pfd.cDepthBits = 24;
@@ -130,11 +135,12 @@ void GUI::pumpMessages() {
 }
 
 GUI* GUI::getInstance(lua_State* L) {
-    if (!g_gui) {
+    GUI* instance = static_cast<GUI*>(LuauBinding::getModule(L));
+    if (!instance) {
         luaL_error(L, "GUI instance not initialized");
         return nullptr;
     }
-    return g_gui;
+    return instance;
 }
 
 // Register a keyboard callback from Lua
@@ -173,6 +179,10 @@ void GUI::handleKeyEvent(const std::string& key, const std::string& action) {
     lua_State* L = luauBinding->getLuaState();
     if (!L) return;
 
+    if (TraceRecorder* recorder = luauBinding->getRecorder()) {
+        recorder->recordKeyEvent(key, action);
+    }
+
     // Call each registered callback
     for (int ref : keyboardCallbacks) {
         lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
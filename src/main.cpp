@@ -1,7 +1,44 @@
 #include "engine/Engine.h"
 #include "engine/Config.h"
+#include "engine/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <filesystem>
+#include <thread>
+
+// Run the script in several headless engines at once, one per pool thread, and print
+// their combined throughput. Engines share nothing, so each keeps its own Lua state,
+// models and workers; the hardware threads are split between them.
+static int runInstances(const Config& config) {
+    int instanceCount = config.getInstanceCount();
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int engineThreads = std::max(1u, hardwareThreads / instanceCount);
+
+    // The calling thread runs engines too
+    ThreadPool pool(std::max(1, instanceCount - 1));
+    std::atomic<int> failed(0);
+    std::atomic<long long> frames(0);
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(instanceCount, [&](size_t) {
+        Engine engine;
+        engine.setThreadCount(engineThreads);
+        if (!engine.initialize("Luau3D Engine", 800, 600, true) || !engine.loadScript(config.getScriptPath())) {
+            failed++;
+            return;
+        }
+        if (config.getFixedDeltaTime() > 0.0) {
+            engine.setFixedDeltaTime(config.getFixedDeltaTime());
+        }
+        frames += engine.run(config.getFrameLimit(), false);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Instances: " << instanceCount << " (" << failed.load() << " failed), " << frames.load() << " frames in "
+              << seconds << " s: " << (seconds > 0.0 ? frames.load() / seconds : 0.0) << " frames/s combined" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
 
 int main(int argc, char* argv[]) {
     Config config;
@@ -18,14 +55,31 @@ int main(int argc, char* argv[]) {
     }
 
     std::cout << "Current working directory: " << std::filesystem::current_path() << std::endl;
+
+    if (config.getInstanceCount() > 1) {
+        return runInstances(config);
+    }
     
     Engine engine;
 
-    // Initialize the engine with a window
-    if (!engine.initialize("Luau3D Engine", 800, 600)) {
+    // Recording wraps the module tables, so it has to start before initialization
+    if (!config.getRecordPath().empty() && !engine.startRecording(config.getRecordPath())) {
+        return 1;
+    }
+
+    // Initialize the engine with a window, or without one for CI and simulation servers
+    if (!engine.initialize("Luau3D Engine", 800, 600, config.isHeadless())) {
         std::cerr << "Failed to initialize engine" << std::endl;
         return 1;
     }
+    if (config.getFixedDeltaTime() > 0.0) {
+        engine.setFixedDeltaTime(config.getFixedDeltaTime());
+    }
+
+    // Replay a recorded trace instead of running a script
+    if (!config.getReplayPath().empty()) {
+        return engine.replay(config.getReplayPath(), config.isReplayFast()) ? 0 : 1;
+    }
 
     // Load and execute the script
     if (!engine.loadScript(config.getScriptPath())) {
@@ -34,7 +88,7 @@ int main(int argc, char* argv[]) {
     }
 
     // Run the main game loop
-    engine.run();
+    engine.run(config.getFrameLimit());
 
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,266 @@
+// Checks for vertex layout validation, half-float conversion and vertex packing.
+// Exits non-zero if any check fails:
+//   luau3d_tests
+#include "engine/VertexFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool isValid(const VertexLayout& layout) {
+    std::string error;
+    return layout.validate(error);
+}
+
+std::string hex(uint16_t value) {
+    char text[8];
+    std::snprintf(text, sizeof(text), "0x%04x", value);
+    return text;
+}
+
+void expectHalf(float value, uint16_t expected, const char* what) {
+    uint16_t half = floatToHalf(value);
+    expect(half == expected, std::string(what) + ": got " + hex(half) + ", expected " + hex(expected));
+}
+
+void checkValidation() {
+    expect(isValid(VertexLayout::positionColor()), "float layout is valid");
+    expect(isValid(VertexLayout::compact()), "compact layout is valid");
+    expect(isValid(VertexLayout::compactNormal()), "compact_normal layout is valid");
+    expect(isValid(VertexLayout::skinned()), "skinned layout is valid");
+
+    // f32x3 position and color need 24 bytes
+    VertexLayout small = VertexLayout::positionColor();
+    small.setStride(16);
+    expect(!isValid(small), "stride smaller than the attributes is rejected");
+    small.setStride(0);
+    expect(!isValid(small), "zero stride is rejected");
+
+    VertexLayout padded = VertexLayout::positionColor();
+    padded.setStride(32);
+    expect(isValid(padded), "stride larger than the attributes is accepted");
+
+    VertexLayout overlapping;
+    overlapping.clear();
+    overlapping.addAttribute({VertexAttribute::Position, VertexComponentType::Float32, 3, false, 0});
+    overlapping.addAttribute({VertexAttribute::Color, VertexComponentType::Float32, 3, false, 8});
+    expect(!isValid(overlapping), "overlapping attributes are rejected");
+}
+
+void checkHalfFloats() {
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    expectHalf(0.0f, 0x0000, "zero");
+    expectHalf(-0.0f, 0x8000, "negative zero");
+    expectHalf(1.0f, 0x3c00, "one");
+    expectHalf(-2.0f, 0xc000, "minus two");
+    expectHalf(65504.0f, 0x7bff, "largest half");
+    expectHalf(65519.0f, 0x7bff, "just below the overflow midpoint");
+    expectHalf(65520.0f, 0x7c00, "overflow midpoint rounds to infinity");
+    expectHalf(1e10f, 0x7c00, "large value overflows to infinity");
+    expectHalf(-1e10f, 0xfc00, "large negative value overflows to -infinity");
+    expectHalf(infinity, 0x7c00, "infinity");
+    expectHalf(-infinity, 0xfc00, "-infinity");
+    expectHalf(std::ldexp(1.0f, -14), 0x0400, "smallest normal");
+    expectHalf(std::ldexp(1.0f, -24), 0x0001, "smallest subnormal");
+    expectHalf(std::ldexp(1.0f, -25), 0x0000, "half the smallest subnormal ties to even zero");
+    expectHalf(std::ldexp(3.0f, -25), 0x0002, "1.5 subnormal steps tie to even");
+    expectHalf(std::ldexp(1.0f, -30), 0x0000, "tiny value flushes to zero");
+    expectHalf(1.0f + std::ldexp(1.0f, -11), 0x3c00, "tie below an even mantissa rounds down");
+    expectHalf(1.0f + std::ldexp(3.0f, -11), 0x3c02, "tie below an odd mantissa rounds up");
+
+    uint16_t nan = floatToHalf(std::numeric_limits<float>::quiet_NaN());
+    expect((nan & 0x7c00) == 0x7c00 && (nan & 0x3ff) != 0, "NaN stays NaN, got " + hex(nan));
+    expect(std::isnan(halfToFloat(0x7e00)), "half NaN decodes to NaN");
+    expect(halfToFloat(0x7c00) == infinity, "half infinity decodes to infinity");
+    expect(halfToFloat(0x0001) == std::ldexp(1.0f, -24), "smallest subnormal decodes exactly");
+    expect(halfToFloat(0x03ff) == std::ldexp(1023.0f, -24), "largest subnormal decodes exactly");
+    expect(std::signbit(halfToFloat(0x8000)), "negative zero keeps its sign");
+
+    // Every half that is not NaN survives a round trip through float
+    int mismatches = 0;
+    for (uint32_t h = 0; h <= 0xffff; h++) {
+        uint16_t half = static_cast<uint16_t>(h);
+        if ((half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0) continue;
+        if (floatToHalf(halfToFloat(half)) != half) mismatches++;
+    }
+    expect(mismatches == 0, "all halves round trip (" + std::to_string(mismatches) + " mismatches)");
+}
+
+// Source values that hit rounding edges, clamping and special values
+std::vector<float> edgeValues() {
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::vector<float> values = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 2.0f, -3.0f, 65504.0f, 65520.0f, 1e10f, -1e10f,
+        infinity, -infinity, std::ldexp(1.0f, -14), std::ldexp(1.0f, -24), std::ldexp(3.0f, -25),
+        std::ldexp(1.0f, -30), 1.0f + std::ldexp(1.0f, -11), 1.0f + std::ldexp(3.0f, -11),
+        1.0f / 255.0f, 127.5f / 255.0f, 0.999f, 1.001f,
+    };
+    // A sweep through [-2, 2] in steps that do not line up with any format
+    for (int i = -2000; i <= 2000; i += 7) {
+        values.push_back(i * 0.001f);
+    }
+    return values;
+}
+
+// packVertices takes SIMD paths (SSE2, F16C, NEON) for half and unorm8 attributes;
+// they must produce exactly the bytes of the scalar packAttribute
+void checkSimdMatchesScalar(const char* name, const VertexLayout& layout) {
+    std::vector<float> values = edgeValues();
+    const int floatsPerVertex = layout.getSourceFloatsPerVertex();
+    const size_t vertexCount = values.size();
+    std::vector<float> source(vertexCount * floatsPerVertex);
+    for (size_t v = 0; v < vertexCount; v++) {
+        for (int f = 0; f < floatsPerVertex; f++) {
+            // Each component sees a different value from the list
+            source[v * floatsPerVertex + f] = values[(v + f * 5) % values.size()];
+        }
+    }
+
+    const uint32_t stride = layout.getStride();
+    std::vector<uint8_t> packed(vertexCount * stride);
+    packVertices(layout, source.data(), vertexCount, packed.data());
+
+    std::vector<uint8_t> expected(vertexCount * stride, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* in = &source[v * floatsPerVertex];
+        for (int a = 0; a < layout.getAttributeCount(); a++) {
+            const VertexAttributeDesc& desc = layout.getAttribute(a);
+            const float* src = in + layout.getSourceOffset(desc.attribute);
+            float w = desc.attribute == VertexAttribute::Normal ? 0.0f : 1.0f;
+            float attribute[4] = {src[0], src[1], src[2], getSourceComponents(desc.attribute) == 4 ? src[3] : w};
+            packAttribute(desc, attribute, &expected[v * stride + desc.offset]);
+        }
+    }
+
+    size_t mismatches = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (std::memcmp(&packed[v * stride], &expected[v * stride], stride) != 0) mismatches++;
+    }
+    expect(mismatches == 0, std::string(name) + ": packVertices matches packAttribute (" +
+                                std::to_string(mismatches) + " vertices differ)");
+}
+
+// Largest error a component of desc may pick up in a round trip of value
+float tolerance(const VertexAttributeDesc& desc, float value) {
+    switch (desc.type) {
+        case VertexComponentType::Float32: return 0.0f;
+        case VertexComponentType::Float16: return std::fabs(value) * std::ldexp(1.0f, -11) + std::ldexp(1.0f, -25);
+        case VertexComponentType::UNorm8: return desc.normalized ? 0.5f / 255.0f + 1e-6f : 0.0f;
+        case VertexComponentType::SNorm8: return desc.normalized ? 0.5f / 127.0f + 1e-6f : 0.0f;
+        case VertexComponentType::Int2_10_10_10: return 0.5f / 511.0f + 1e-6f;
+    }
+    return 0.0f;
+}
+
+// packVertices then unpackAttribute gives back every in-range source value
+void checkRoundTrip(const char* name, const VertexLayout& layout) {
+    const int floatsPerVertex = layout.getSourceFloatsPerVertex();
+    const size_t vertexCount = 257;
+    std::vector<float> source(vertexCount * floatsPerVertex);
+    for (size_t v = 0; v < vertexCount; v++) {
+        float t = static_cast<float>(v) / (vertexCount - 1);
+        for (int a = 0; a < layout.getAttributeCount(); a++) {
+            const VertexAttributeDesc& desc = layout.getAttribute(a);
+            float* out = &source[v * floatsPerVertex + layout.getSourceOffset(desc.attribute)];
+            switch (desc.attribute) {
+                case VertexAttribute::Position:
+                    out[0] = (t - 0.5f) * 200.0f;
+                    out[1] = t * t * 10.0f;
+                    out[2] = -t * 3.0f;
+                    break;
+                case VertexAttribute::Color:
+                    out[0] = t;
+                    out[1] = 1.0f - t;
+                    out[2] = 0.5f;
+                    break;
+                case VertexAttribute::Normal: {
+                    float angle = t * 6.2831853f;
+                    out[0] = std::cos(angle) * 0.6f;
+                    out[1] = 0.8f;
+                    out[2] = std::sin(angle) * 0.6f;
+                    break;
+                }
+                case VertexAttribute::Joints:
+                    for (int c = 0; c < 4; c++) out[c] = static_cast<float>((v * 7 + c * 61) % 256);
+                    break;
+                case VertexAttribute::Weights:
+                    out[0] = t;
+                    out[1] = (1.0f - t) * 0.5f;
+                    out[2] = (1.0f - t) * 0.25f;
+                    out[3] = (1.0f - t) * 0.25f;
+                    break;
+            }
+        }
+    }
+
+    const uint32_t stride = layout.getStride();
+    std::vector<uint8_t> packed(vertexCount * stride);
+    packVertices(layout, source.data(), vertexCount, packed.data());
+
+    size_t mismatches = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        for (int a = 0; a < layout.getAttributeCount(); a++) {
+            const VertexAttributeDesc& desc = layout.getAttribute(a);
+            const float* in = &source[v * floatsPerVertex + layout.getSourceOffset(desc.attribute)];
+            float out[4];
+            if (!unpackAttribute(layout, packed.data(), v, desc.attribute, out)) {
+                mismatches++;
+                continue;
+            }
+            int components = desc.type == VertexComponentType::Int2_10_10_10 ? 3 : desc.components;
+            components = std::min(components, getSourceComponents(desc.attribute));
+            for (int c = 0; c < components; c++) {
+                if (std::fabs(out[c] - in[c]) > tolerance(desc, in[c])) mismatches++;
+            }
+        }
+    }
+    expect(mismatches == 0, std::string(name) + ": values survive packing (" + std::to_string(mismatches) +
+                                " components out of tolerance)");
+}
+
+} // namespace
+
+int main() {
+    checkValidation();
+    checkHalfFloats();
+
+    VertexLayout snorm;
+    snorm.clear();
+    snorm.addAttribute({VertexAttribute::Position, VertexComponentType::Float16, 4, false, 0});
+    snorm.addAttribute({VertexAttribute::Color, VertexComponentType::UNorm8, 4, true, 8});
+    snorm.addAttribute({VertexAttribute::Normal, VertexComponentType::SNorm8, 4, true, 12});
+
+    const std::pair<const char*, VertexLayout> layouts[] = {
+        {"float", VertexLayout::positionColor()},
+        {"compact", VertexLayout::compact()},
+        {"compact_normal", VertexLayout::compactNormal()},
+        {"skinned", VertexLayout::skinned()},
+        {"snorm8 normal", snorm},
+    };
+    for (const auto& entry : layouts) {
+        expect(isValid(entry.second), std::string(entry.first) + " layout is valid");
+        checkSimdMatchesScalar(entry.first, entry.second);
+        checkRoundTrip(entry.first, entry.second);
+    }
+
+    if (failures == 0) {
+        std::cout << "All vertex format checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}